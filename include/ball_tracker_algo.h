@@ -1,9 +1,33 @@
 #ifndef BALL_TRACKER_ALGO_H
 #define BALL_TRACKER_ALGO_H
 
+#include <memory>
+#include <vector>
+
 #include <opencv2/opencv.hpp>
 
 #include "ball_tracker_common.h"
+#include "blob_extractor.h"
+#include "kalman_bank.h"
+#include "track_corridor.h"
+#include "track_path.h"
+
+/**
+ * @struct BallTrackerSnapshot
+ * @brief Internal tracker state after the last UpdateWithImage() call, for recording and debugging.
+ */
+struct BallTrackerSnapshot {
+    int id;                          ///< Ball id
+    cv::Rect_<int> search_roi;       ///< ROI searched in the last frame (image coordinates)
+    bool detected;                   ///< Whether the ball was detected in the last frame
+    cv::Point_<float> center;        ///< Detected center (image coordinates), valid if detected
+    float radius;                    ///< Detected radius, valid if detected
+    cv::Scalar_<double> hsv;         ///< Mean HSV of the detected blob, valid if detected
+    float state[4];                  ///< Kalman state x, y, vx, vy
+    float covariance[4];             ///< Diagonal of the Kalman error covariance
+    TrackState track_state;          ///< Search state after the update
+    bool resting;                    ///< The ball is at rest and only checked on a small patch
+};
 
 /**
  * @class BallTracker
@@ -26,6 +50,19 @@ public:
      */
     ~BallTracker();
 
+    /**
+     * @brief Reinitializes the tracker for another ball, keeping its scratch buffers and Kalman lane.
+     * @param ball_id Unique identifier for the ball.
+     * @param color Color description of the ball.
+     * @param hsv_mean Mean HSV color values for detection.
+     * @param hsv_stddev Standard deviation of HSV color values for detection.
+     * @param init_pos Initial position to start tracking from.
+     */
+    void Restart(int ball_id, const std::string& color, const cv::Scalar_<double>& hsv_mean,
+                 const cv::Scalar_<double>& hsv_stddev, const cv::Point_<double>& init_pos);
+
+    BallTracker(BallTracker&&) = default;
+
     /**
      * @brief Get current ball status.
      * @return BallStatus structure.
@@ -39,29 +76,235 @@ public:
      */
     bool UpdateWithImage(const cv::Mat& image) override;
 
+    /**
+     * @brief Moves the Kalman filter into a lane of a shared bank, keeping the current position.
+     * @param bank Bank holding the filters of all balls; must outlive the tracker.
+     * @param lane Lane of this ball in the bank.
+     */
+    void AttachKalman(KalmanBank* bank, int lane);
+
+    /**
+     * @brief First phase of a split update: requests the Kalman prediction of this frame from the bank.
+     *
+     * UpdateWithImage() runs BeginUpdate(), Detect() and FinishUpdate() with the
+     * single-lane Kalman updates in between. TrackerBank runs the phases for all balls
+     * with batched predictions and corrections instead.
+     */
+    void BeginUpdate();
+
+    /**
+     * @brief Second phase: searches the ball in the image and queues the measurement in the bank.
+     * @param image Input image
+     * @return true if the ball was detected
+     */
+    bool Detect(const cv::Mat& image);
+
+    /**
+     * @brief Last phase, after the queued measurement was applied: updates the velocity and rest state of a detected ball.
+     * @param image Input image
+     */
+    void FinishUpdate(const cv::Mat& image);
+
+    /**
+     * @brief Hands the result of a joint search of several balls to the next Detect() call, which then skips its own search.
+     * @param detected Whether a blob was assigned to this ball
+     * @param center Center of the assigned blob (image coordinates)
+     * @param radius Radius of the assigned blob
+     * @param hsv_detected Mean HSV of the assigned blob
+     * @param window Region searched for this ball (image coordinates)
+     */
+    void AssignMeasurement(bool detected, const cv::Point_<float>& center, float radius,
+                           const cv::Scalar_<double>& hsv_detected, const cv::Rect_<int>& window);
+
+    /**
+     * @brief Region the next Detect() call would search (image coordinates).
+     * @param image_size Size of the input image.
+     */
+    cv::Rect_<int> GetSearchWindow(const cv::Size& image_size) const;
+
+    /**
+     * @brief Whether the ball is followed by its Kalman prediction (tracking or coasting with a known radius).
+     */
+    bool IsLocked() const;
+
+    /**
+     * @brief HSV range accepted as the ball color.
+     * @param lower Lower bound output.
+     * @param upper Upper bound output.
+     */
+    void GetColorRange(cv::Scalar_<double>& lower, cv::Scalar_<double>& upper) const;
+
+    float GetRadius() const { return last_radius_; }
+    int GetMissCount() const { return miss_count_; }
+    cv::Point_<float> GetPosition() const {
+        return cv::Point_<float>(static_cast<float>(ball_status_.x), static_cast<float>(ball_status_.y));
+    }
+    const cv::Scalar_<double>& GetHsvMean() const { return hsv_mean_; }
+    const cv::Scalar_<double>& GetHsvStddev() const { return hsv_stddev_; }
+
     /**
      * @brief Get the region of interest (ROI) for the ball tracker.
      * @return The region of interest as a cv::Rect.
      */
     cv::Rect GetROI() const { return detect_roi_; }
 
+    /**
+     * @brief Get the tracker state after the last update.
+     * @return Snapshot of ROI, detection result and Kalman state.
+     */
+    BallTrackerSnapshot GetSnapshot() const;
+
+    /**
+     * @brief Sets the search bounds used while the ball is not locked.
+     * @param config Pixel budget and state durations.
+     */
+    void SetSearchConfig(const LostBallSearchConfig& config) { search_config_ = config; }
+
+    /**
+     * @brief Sets the expected ball positions (usually the recorded track) searched first when the ball is lost.
+     * @param points Positions in image coordinates.
+     */
+    void SetSearchPrior(const std::vector<cv::Point_<float>>& points);
+
+    /**
+     * @brief Restricts every search of the ball to the track corridor.
+     * @param corridor Corridor of the track, nullptr or empty to search everywhere; must outlive the tracker.
+     */
+    void SetCorridor(const TrackCorridor* corridor);
+
+    /**
+     * @brief Tracks the ball by arc length along a trajectory instead of in 2D pixel space.
+     *
+     * Detections are projected onto the path and filtered by ArcKalman; the predicted
+     * search window is the interval of the path the ball can reach, and the progress
+     * of the status is the arc length over the path length.
+     * @param path Recorded trajectory, nullptr or empty for 2D tracking; must outlive the tracker.
+     */
+    void SetTrackPath(const TrackPath* path);
+
+    /**
+     * @brief Sets the expected speed along the track used by the arc-length prediction.
+     *
+     * With a profile the prediction adds the expected acceleration at the current arc
+     * length, a reacquired ball starts at the expected speed instead of at rest, and the
+     * process noise is TrackModeConfig::profile_process_noise.
+     * @param profile Profile learned for the path set by SetTrackPath(), nullptr or empty for constant velocity; must outlive the tracker.
+     */
+    void SetSpeedProfile(const SpeedProfile* profile);
+
+    /**
+     * @brief Sets the noise and window of the arc-length tracking.
+     * @param config Track mode settings.
+     */
+    void SetTrackModeConfig(const TrackModeConfig& config);
+
+    /**
+     * @brief Sets how the detection rate drops while the ball is at rest.
+     * @param config Rest thresholds and full detection cadence.
+     */
+    void SetAdaptiveUpdateConfig(const AdaptiveUpdateConfig& config);
+
+    /**
+     * @brief Whether the ball is at rest and skips full detection.
+     */
+    bool IsResting() const { return resting_; }
+
+    /**
+     * @brief Get the current search state.
+     * @return Search state after the last update.
+     */
+    TrackState GetTrackState() const { return track_state_; }
+
 private:
+    /**
+     * @brief Detection handed over by AssignMeasurement().
+     */
+    struct AssignedMeasurement {
+        bool valid = false;
+        bool detected = false;
+        cv::Point_<float> center;
+        float radius = 0.0f;
+        cv::Scalar_<double> hsv;
+        cv::Rect_<int> window;
+    };
+
     cv::Scalar_<double> hsv_mean_;            ///< Mean HSV values for color detection.
     cv::Scalar_<double> hsv_stddev_;          ///< HSV standard deviation for color detection.
     cv::Point_<double> init_pos_;            ///< Initial position to start tracking from.
     cv::Rect_<int> detect_roi_;            ///< Region of interest for detecting the ball.
-    cv::KalmanFilter kalman_filter_; ///< Kalman filter instance for tracking.
+    std::unique_ptr<KalmanBank> own_kalman_; ///< Single-lane bank used until AttachKalman().
+    KalmanBank* kalman_;             ///< Bank holding the Kalman filter of this ball.
+    int lane_;                       ///< Lane of this ball in kalman_.
+    bool predicted_ = false;         ///< The Kalman state was already predicted for this frame.
+    bool rest_pending_ = false;      ///< FinishUpdate() must update the rest state.
+    float pending_moved_ = 0.0f;     ///< Motion since the previous detection, for FinishUpdate().
+    AssignedMeasurement assigned_;   ///< Joint search result for this frame, if any.
     BallStatus ball_status_;         ///< Current ball status data.
+    cv::Rect_<int> last_search_roi_; ///< ROI searched in the last frame.
+    cv::Point_<float> last_center_;  ///< Last detected center (image coordinates).
+    float last_radius_ = 0.0f;       ///< Last detected radius.
+    cv::Scalar_<double> last_hsv_;   ///< Mean HSV of the last detected blob.
+    BlobExtractor blob_extractor_;   ///< Connected components of the color mask.
+    std::vector<Blob> blobs_;        ///< Blobs of the last frame, reused across frames.
+    cv::Mat seed_state_;             ///< Per-pixel state of the seeded fill window (unknown / background / ball).
+    std::vector<cv::Point> seed_stack_; ///< Pending scanline seeds of the seeded fill.
+    cv::Mat hsv_image_;              ///< HSV pixels of the region thresholded by DetectCircle().
+    cv::Mat mask_;                   ///< Color mask of the region thresholded by DetectCircle().
+    const TrackCorridor* corridor_ = nullptr; ///< Pixels the ball can occupy, shared by all trackers.
+    const TrackPath* track_path_ = nullptr;   ///< Trajectory for arc-length tracking, shared by all trackers.
+    TrackModeConfig track_mode_config_;       ///< Arc-length tracking settings.
+    const SpeedProfile* speed_profile_ = nullptr;  ///< Expected speed along track_path_, shared by all trackers.
+    ArcKalman arc_;                  ///< Arc length and speed along track_path_.
+    bool arc_valid_ = false;         ///< arc_ follows the ball; reset on every reacquisition.
+    LostBallSearchConfig search_config_;  ///< Search bounds while the ball is not locked.
+    TrackState track_state_ = TrackState::LOCAL_SEARCH; ///< Current search state, starting around the initial position.
+    int miss_count_ = 0;             ///< Consecutive frames without detection.
+    cv::Point_<float> search_anchor_; ///< Center of the local search windows.
+    int search_cursor_ = 0;          ///< Local windows searched, or index of the next global tile.
+    std::vector<cv::Rect_<int>> search_tiles_;        ///< Global search tiles in search order.
+    std::vector<cv::Point_<float>> search_prior_;     ///< Positions whose tiles are searched first.
+    AdaptiveUpdateConfig adaptive_config_;  ///< Detection rate settings for resting balls.
+    bool resting_ = false;           ///< Whether the ball is at rest.
+    int rest_count_ = 0;             ///< Consecutive still detections.
+    int frames_since_full_ = 0;      ///< Frames since the last full detection while resting.
+    cv::Rect_<int> still_rect_;      ///< Patch compared by the resting check (image coordinates).
+    cv::Mat still_reference_;        ///< Patch content at the last full detection.
 
     /**
-     * @brief Detects a circular shape within the image.
-     * @param image Input image to detect circles in.
-     * @param center Detected circle center output.
+     * @brief Detects a circular shape within a region of the image.
+     * @param image Full input image (BGR).
+     * @param rect Region to search (image coordinates).
+     * @param center Detected circle center output (region coordinates).
      * @param radius Detected circle radius output.
      * @param hsv_detected Detected HSV color output.
      * @return True if circle is detected, false otherwise.
      */
-    bool DetectCircle(const cv::Mat& image, cv::Point_<float>& center, float& radius, cv::Scalar_<double>& hsv_detected);
+    bool DetectCircle(const cv::Mat& image, const cv::Rect_<int>& rect, cv::Point_<float>& center, float& radius,
+                      cv::Scalar_<double>& hsv_detected);
+
+    /**
+     * @brief Whether a non-empty corridor restricts the search.
+     */
+    bool HasCorridor() const { return corridor_ != nullptr && !corridor_->Empty(); }
+
+    /**
+     * @brief Detects the ball by growing a region from a seed point instead of thresholding a whole ROI.
+     *
+     * Only pixels reached from the seed are color tested, so the cost is proportional to the
+     * ball area. Fails if no pixel near the seed passes the color test or the region leaks
+     * out of a window of a few radii around the seed.
+     * @param image Full input image (BGR).
+     * @param seed Seed point in image coordinates, usually the Kalman prediction.
+     * @param expected_radius Radius of the ball in the last frame.
+     * @param center Detected center output (image coordinates).
+     * @param radius Detected radius output.
+     * @param hsv_detected Mean HSV of the region output.
+     * @param window Searched window output (image coordinates).
+     * @return True if the ball is detected, false otherwise.
+     */
+    bool DetectFromSeed(const cv::Mat& image, const cv::Point_<float>& seed, float expected_radius,
+                        cv::Point_<float>& center, float& radius, cv::Scalar_<double>& hsv_detected,
+                        cv::Rect_<int>& window);
 
     /**
      * @brief Calculates the color distance between two HSV values.
@@ -72,9 +315,91 @@ private:
     double ColorDistance(const cv::Scalar_<double>& hsv1, const cv::Scalar_<double>& hsv2);
 
     /**
-     * @brief Updates ball position using prediction when detection fails.
+     * @brief Predicts the Kalman state now unless it was already predicted for this frame.
+     */
+    void EnsurePredicted();
+
+    /**
+     * @brief Whether the ball is tracked by arc length along track_path_.
+     */
+    bool OnTrack() const;
+
+    /**
+     * @brief Whether a speed profile drives the arc-length prediction.
+     */
+    bool HasSpeedProfile() const {
+        return track_mode_config_.speed_profile && speed_profile_ != nullptr && !speed_profile_->Empty();
+    }
+
+    /**
+     * @brief Expected acceleration of the ball at its current arc length, 0 without a speed profile.
+     */
+    float ArcAcceleration() const;
+
+    /**
+     * @brief Process noise of the arc-length filter.
+     */
+    float ArcProcessNoise() const;
+
+    /**
+     * @brief Position of the ball predicted for this frame (image coordinates).
+     */
+    cv::Point_<float> PredictedPosition() const;
+
+    /**
+     * @brief Updates the arc-length filter with a detection and derives progress and velocity from it.
+     * @param center Detected center (image coordinates).
+     * @param reacquired Whether the ball was found by a search, so the previous arc length is stale.
+     */
+    void UpdateArc(const cv::Point_<float>& center, bool reacquired);
+
+    /**
+     * @brief Search window covering the track interval the ball can reach.
+     * @param s Predicted arc length.
+     * @param variance Variance of the predicted arc length.
+     * @param image_size Size of the input image.
+     */
+    cv::Rect_<int> TrackWindow(float s, float variance, const cv::Size& image_size) const;
+
+    /**
+     * @brief Advances the lost-ball state machine after a missed detection and picks the next search window.
+     * @param image_size Size of the input image.
+     */
+    void PredictAndUpdate(const cv::Size& image_size);
+
+    /**
+     * @brief Cheap check that a resting ball has not moved, comparing a small patch with its reference.
+     * @param image Full input image.
+     * @return True if the patch is unchanged.
+     */
+    bool IsStillThere(const cv::Mat& image) const;
+
+    /**
+     * @brief Updates the rest state after a full detection and captures the reference patch when resting.
+     * @param image Full input image.
+     * @param moved Distance between this and the previous detection.
+     */
+    void UpdateRestState(const cv::Mat& image, float moved);
+
+    /**
+     * @brief Side of the largest square search window allowed by the pixel budget.
+     */
+    int MaxSearchSide() const;
+
+    /**
+     * @brief Places a square window centered at a point, shifted to lie inside the image.
+     * @param center Window center in image coordinates.
+     * @param side Window side.
+     * @param image_size Size of the input image.
+     * @return Window, clipped to the image if it is larger.
+     */
+    static cv::Rect_<int> FitWindow(const cv::Point_<float>& center, int side, const cv::Size& image_size);
+
+    /**
+     * @brief Builds the global search tiles ordered by the search prior and the distance to the search anchor.
+     * @param image_size Size of the input image.
      */
-    void PredictAndUpdate();
+    void BuildSearchTiles(const cv::Size& image_size);
 };
 
 #endif // BALL_TRACKER_ALGO_H
@@ -1,7 +1,9 @@
 #ifndef BALL_TRACKER_COMMON_H
 #define BALL_TRACKER_COMMON_H
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 // Forward declaration of cv::Mat
 namespace cv {
@@ -19,6 +21,7 @@ struct BallStatus {
     double vx, vy;
     double progress;
     bool detected;
+    bool deferred;  ///< The update of this frame missed the frame deadline and was deferred
 };
 
 /**
@@ -26,10 +29,211 @@ struct BallStatus {
  * @brief Stores the target position and velocity for the robotic arm.
  */
 struct RobotTarget {
+    int id;          ///< Ball id of the target
+    bool valid;      ///< Whether a ball was mapped; false without a camera calibration or a tracked ball
     double X_arm, Y_arm;
     double V_arm_x, V_arm_y;
 };
 
+/**
+ * @struct CameraCalibration
+ * @brief Intrinsics, lens distortion and pose of the camera relative to the robot arm.
+ *
+ * Arm coordinates have Z pointing up from the ground, in the length unit of
+ * HeightParameters. The optical center is at (camera_x, camera_y, camera_height).
+ */
+struct CameraCalibration {
+    int image_width = 0;             ///< Calibrated image width (pixels)
+    int image_height = 0;            ///< Calibrated image height (pixels)
+    double fx = 0.0, fy = 0.0;       ///< Focal lengths (pixels)
+    double cx = 0.0, cy = 0.0;       ///< Principal point (pixels)
+    double k1 = 0.0, k2 = 0.0, p1 = 0.0, p2 = 0.0, k3 = 0.0;  ///< Brown-Conrady distortion, OpenCV order
+    double rotation[9] = {1.0, 0.0, 0.0, 0.0, -1.0, 0.0, 0.0, 0.0, -1.0};  ///< Camera-to-arm rotation, row-major; default looks straight down
+    double camera_x = 0.0;           ///< Optical center X in arm coordinates
+    double camera_y = 0.0;           ///< Optical center Y in arm coordinates
+    int grid_step = 16;              ///< Pixel spacing of the precomputed lookup grid
+};
+
+/**
+ * @enum CameraSourceType
+ * @brief 定义相机输入源类型
+ */
+enum class CameraSourceType {
+    HUARUI_CAMERA,  // 华睿相机
+    USB_CAMERA,     // USB免驱相机
+    VIDEO_FILE,     // 视频文件
+    SYNTHETIC,      // 合成图像（无需相机，用于基准测试）
+    RAW_REPLAY      // 原始帧文件回放
+};
+
+/**
+ * @enum CaptureStatus
+ * @brief Result of a frame capture, used to pick the recovery action after a failure.
+ */
+enum class CaptureStatus {
+    OK = 0,            ///< A frame was captured.
+    END_OF_STREAM,     ///< A file source delivered its last frame.
+    TIMEOUT,           ///< No frame arrived within the backend wait; the source is still usable.
+    DEVICE_LOST,       ///< The device disconnected or stopped streaming and needs a reconnect.
+    CONVERSION_ERROR,  ///< A frame arrived but could not be converted to BGR.
+    NOT_OPEN,          ///< No source is open.
+};
+
+/**
+ * @enum TrackState
+ * @brief Search state of a single ball tracker.
+ */
+enum class TrackState {
+    TRACKING = 0,    ///< The ball was detected in the last frame.
+    COASTING,        ///< Recently missed; the Kalman prediction is searched with a growing window.
+    LOCAL_SEARCH,    ///< Windows around the last known position are searched in turn.
+    GLOBAL_SEARCH,   ///< The whole image is searched one tile per frame.
+};
+
+/**
+ * @struct LostBallSearchConfig
+ * @brief Bounds the work spent on a ball that is not locked.
+ */
+struct LostBallSearchConfig {
+    int pixel_budget = 640 * 640;   ///< Pixels searched per ball per frame when the ball is not locked
+    int coast_frames = 3;           ///< Missed frames spent searching around the Kalman prediction
+    int local_search_frames = 9;    ///< Missed frames spent on the windows around the last position afterwards
+    float coast_growth = 1.5f;      ///< Growth of the search window per coasting frame
+};
+
+/**
+ * @struct AdaptiveUpdateConfig
+ * @brief Lowers the detection rate of balls at rest.
+ */
+struct AdaptiveUpdateConfig {
+    bool enabled = true;               ///< Whether resting balls skip full detection
+    float rest_speed = 0.5f;           ///< Kalman speed and frame-to-frame motion (pixels) below which a ball counts as still
+    float rest_max_covariance = 1.0f;  ///< Position variance of the Kalman filter below which a ball counts as still
+    int rest_frames = 5;               ///< Consecutive still detections before the ball is considered at rest
+    int full_update_interval = 15;     ///< A resting ball still gets a full detection every this many frames
+    double change_threshold = 8.0;     ///< Mean absolute difference per channel of the check patch that counts as motion
+};
+
+/**
+ * @struct AssociationConfig
+ * @brief Joint detection and assignment of balls sharing a color model.
+ */
+struct AssociationConfig {
+    bool enabled = true;            ///< Whether balls of the same color are detected once per frame and assigned jointly
+    float gate = 9.21f;             ///< Squared Mahalanobis distance gate (chi-square, 2 dof, 99%)
+    float min_sigma_radii = 1.0f;   ///< Position uncertainty floor added to the Kalman innovation, in ball radii
+};
+
+/**
+ * @struct TrackerLifecycleConfig
+ * @brief Creation of trackers for balls entering the track and retirement of balls that left it.
+ */
+struct TrackerLifecycleConfig {
+    bool enabled = false;             ///< Whether trackers are spawned and retired while tracking
+    int max_trackers = 32;            ///< Trackers preallocated in the pool, including the configured balls
+    int spawn_zone_radius = 60;       ///< Half side (pixels) of the square spawn zone around each spawn point
+    int spawn_confirm_frames = 3;     ///< Consecutive frames an unclaimed blob must be seen in a spawn zone
+    int retire_lost_frames = 90;      ///< Trackers missing the ball for this many frames are retired
+    float retire_end_radius = 30.0f;  ///< Tracked balls within this distance (pixels) of the end point are retired
+};
+
+/**
+ * @struct TrackCorridorConfig
+ * @brief Restriction of all detection to the pixels around the recorded track.
+ */
+struct TrackCorridorConfig {
+    bool enabled = true;              ///< Whether InitTrack() restricts detection to the corridor around the trajectory
+    float half_width_radii = 2.0f;    ///< Corridor half width in radii of the ball recorded by InitTrack()
+    int min_half_width = 16;          ///< Lower bound of the corridor half width (pixels)
+};
+
+/**
+ * @struct TrackModeConfig
+ * @brief Tracking of balls by arc length along the recorded trajectory instead of in 2D pixel space.
+ */
+struct TrackModeConfig {
+    bool enabled = true;                ///< Whether balls are tracked along the trajectory recorded by InitTrack()
+    float process_noise = 0.05f;        ///< Variance added to arc length and speed per frame
+    float measurement_noise = 1.0f;     ///< Variance of a measurement projected onto the track (pixels^2)
+    float initial_speed_variance = 25.0f;  ///< Speed variance when a ball is (re)acquired (pixels^2 per frame^2)
+    float window_sigmas = 3.0f;         ///< Half length of the searched track interval in standard deviations of the arc length
+    bool speed_profile = true;          ///< Whether InitTrack() learns the expected speed and acceleration along the track from its runs
+    float profile_segment_length = 32.0f;  ///< Arc length of a speed profile segment (pixels)
+    float profile_process_noise = 0.01f;   ///< Variance added to arc length and speed per frame while a speed profile is known
+};
+
+/**
+ * @struct TrajectoryCompactionConfig
+ * @brief Smoothing, simplification and resampling of the trajectories recorded by InitTrack().
+ */
+struct TrajectoryCompactionConfig {
+    bool enabled = true;              ///< Whether a compact trajectory is stored next to the raw points and used as the track model
+    float process_noise = 0.05f;      ///< Acceleration variance of the constant-velocity smoother (pixels^2 per frame^4)
+    float measurement_noise = 1.0f;   ///< Variance of a raw trajectory point (pixels^2)
+    float tolerance = 1.0f;           ///< Largest distance of the simplified polyline from the smoothed points (pixels)
+    float spacing = 16.0f;            ///< Arc length between the resampled points (pixels, 0: keep the simplified vertices)
+};
+
+/**
+ * @struct OfflineInitTrackConfig
+ * @brief Parallel trajectory initialization from a recorded video by InitTrackOffline().
+ */
+struct OfflineInitTrackConfig {
+    int segments = 0;               ///< Segments of the video decoded and detected in parallel (0: one per OpenMP thread)
+    int min_segment_frames = 64;    ///< The video is not split into segments shorter than this
+    int detect_scale = 2;           ///< Frames are color thresholded at 1 / detect_scale of their resolution
+    int max_gap_frames = 10;        ///< Missed frames bridged by interpolating between the detections around them
+};
+
+/**
+ * @struct StatusStreamConfig
+ * @brief UDP delivery of the ball status of every tracked frame, see status_datagram.h.
+ */
+struct StatusStreamConfig {
+    std::string address = "127.0.0.1";   ///< Destination IPv4 address, unicast or multicast
+    int port = 9870;                     ///< Destination UDP port
+    std::string interface_address;       ///< Local interface for multicast (empty: system default)
+    int multicast_ttl = 1;               ///< Hops a multicast datagram may cross
+    int max_balls_per_datagram = 44;     ///< Balls batched per datagram; 44 keeps a datagram within a 1500 byte MTU
+    int queue_frames = 64;               ///< Frames waiting for the sender thread; the oldest is dropped when full
+};
+
+/**
+ * @struct MetricValue
+ * @brief Value of a counter or gauge in a metrics snapshot.
+ */
+struct MetricValue {
+    std::string name;
+    std::string labels;   ///< Prometheus label set without braces, e.g. slot="3"
+    double value = 0.0;
+};
+
+/**
+ * @struct LatencySummary
+ * @brief Distribution of a latency histogram in a metrics snapshot, in milliseconds.
+ */
+struct LatencySummary {
+    std::string name;
+    std::string labels;
+    uint64_t count = 0;
+    double sum_ms = 0.0;
+    double p50_ms = 0.0;
+    double p90_ms = 0.0;
+    double p99_ms = 0.0;
+    double p999_ms = 0.0;
+    double max_ms = 0.0;
+};
+
+/**
+ * @struct MetricsSnapshot
+ * @brief Values of all pipeline metrics at one point in time.
+ */
+struct MetricsSnapshot {
+    std::vector<MetricValue> counters;
+    std::vector<MetricValue> gauges;
+    std::vector<LatencySummary> latencies;
+};
+
 /**
  * @enum InitTrackErrorCode
  * @brief Error codes for track trajectory initialization.
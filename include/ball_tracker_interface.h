@@ -1,15 +1,27 @@
 #ifndef BALL_TRACKER_INTERFACE_H
 #define BALL_TRACKER_INTERFACE_H
 
+#include <atomic>
 #include <vector>
 #include <memory>
 #include <functional>
 #include <string>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <omp.h>
 
 #include "ball_tracker_common.h"
+#include "frame_scheduler.h"
+
+class MetricsHttpServer;
+class PixelToArmMap;
+class RoiRecorder;
+class StatusRingPublisher;
+class UdpStatusPublisher;
+class TrackerBank;
+class TrajectoryWriter;
+struct SpeedRun;
 
 /**
  * @struct HeightParameters
@@ -21,6 +33,35 @@ struct HeightParameters {
     double track_end_height;   ///< Height of the track ending point
 };
 
+/**
+ * @struct CaptureRetryPolicy
+ * @brief How the tracking loop recovers from capture failures
+ */
+struct CaptureRetryPolicy {
+    int initial_backoff_ms = 10;         ///< First wait before reconnecting a lost device
+    int max_backoff_ms = 2000;           ///< Upper bound of the doubling reconnect wait
+    int timeouts_before_reconnect = 20;  ///< Consecutive timeouts after which the device is treated as lost
+    int conversion_errors_before_reconnect = 20;  ///< Consecutive conversion failures after which the source is reopened with backoff
+    int max_reconnect_attempts = -1;     ///< Reconnect attempts before tracking stops (-1: unlimited)
+};
+
+/**
+ * @struct InitTrackBallStats
+ * @brief Per-ball result of the last InitTrack() or InitTrackOffline() run
+ */
+struct InitTrackBallStats {
+    int id = -1;                       ///< Ball id from the balls configuration
+    std::string trajectory_file;       ///< File the trajectory of this ball was written to
+    int points = 0;                    ///< Recorded trajectory points
+    int compact_points = 0;            ///< Points of the compact trajectory, 0 when compaction is disabled
+    double compact_max_error = 0.0;    ///< Largest distance of the smoothed trajectory from the compact one (pixels)
+    double length = 0.0;               ///< Trajectory length in pixels
+    int total_frames = 0;              ///< Frames processed while this ball was recorded
+    int success_frames = 0;            ///< Frames with a valid detection
+    int max_consecutive_failures = 0;  ///< Longest run of frames without a valid detection
+    bool lost = false;                 ///< Recording stopped with a success rate below 50%
+};
+
 /**
  * @class BallTrackerInterface
  * @brief Interface to manage ball tracking, trajectory initialization, and robot target acquisition.
@@ -47,12 +88,40 @@ public:
     bool GetFirstFrame(cv::Mat& frame);
 
     /**
-     * @brief Initializes the track trajectory by running one ball around the track.
+     * @brief Initializes the track trajectory by running the configured balls around the track.
+     *
+     * All balls are tracked in one capture pass, with the detection spread over the
+     * OpenMP threads. The first ball's trajectory is written to out_trajectory_file_path,
+     * the trajectory of every other ball next to it with "_ball<id>" before the
+     * extension. All trajectories form the search prior and the detection corridor; the
+     * longest one is the track model for arc-length tracking, spawning and retirement,
+     * and the speeds of all balls along it form the speed profile used by the prediction.
      * @param out_trajectory_file_path File path to save the generated trajectory data.
-     * @return Initialization status code defined by InitTrackErrorCode.
+     * @return Initialization status code defined by InitTrackErrorCode; BALL_LOST_DURING_TRACKING if any ball was lost.
      */
     int InitTrack(const std::string& out_trajectory_file_path);
 
+    /**
+     * @brief Initializes the track trajectories from a recorded video, using all cores.
+     *
+     * The video is split into segments that are decoded and searched for the ball
+     * colors in parallel; a sequential pass then links the detections of each ball
+     * with a Kalman filter and fills short gaps. Output files, statistics and the
+     * track model are the same as for InitTrack(). The points are not bit-identical
+     * to those of InitTrack(): the color search runs at 1 / detect_scale resolution,
+     * so positions agree to within about a pixel. The camera is not used.
+     * @param video_path Recorded video file
+     * @param out_trajectory_file_path File path to save the generated trajectory data.
+     * @return Initialization status code defined by InitTrackErrorCode; CAMERA_NOT_CONNECTED if the video cannot be read.
+     */
+    int InitTrackOffline(const std::string& video_path, const std::string& out_trajectory_file_path);
+
+    /**
+     * @brief Gets the per-ball results of the last InitTrack() or InitTrackOffline() run
+     * @return One entry per configured ball
+     */
+    std::vector<InitTrackBallStats> GetInitTrackStats() const { return init_track_stats_; }
+
     /**
      * @brief Starts the ball tracking algorithm upon receiving the start signal.
      */
@@ -65,16 +134,40 @@ public:
 
     /**
      * @brief Retrieves the status of all tracked balls.
+     *
+     * Returns the snapshot taken at the end of the last tracked frame; empty until
+     * the tracking loop has processed a frame.
      * @return Vector containing the status of each ball.
      */
     std::vector<BallStatus> GetBallStatus();
 
     /**
      * @brief Retrieves the current target position and velocity for the robotic arm.
-     * @return RobotTarget structure containing position and velocity data.
+     *
+     * The target is taken from the ball status at the end of the last tracked frame:
+     * the ball ranked first by SetBallPriority(), or by progress along the track
+     * without priorities. Its image position and velocity are mapped
+     * through the camera calibration onto the horizontal plane at the track height,
+     * interpolated from HeightParameters by the ball's progress. Velocities are per
+     * second when the source frame rate is known, per frame otherwise.
+     * @return RobotTarget structure containing position and velocity data; valid is false without a calibration or a tracked ball.
      */
     RobotTarget GetRobotTarget();
 
+    /**
+     * @brief Loads the camera calibration used by GetRobotTarget(); ignored while tracking is running
+     * @param path Calibration file, see PixelToArmMap::LoadCalibration()
+     * @return Whether the calibration was read and its lookup grid built
+     */
+    bool LoadCameraCalibration(const std::string& path);
+
+    /**
+     * @brief Sets the camera calibration used by GetRobotTarget(); ignored while tracking is running
+     * @param calibration Intrinsics, distortion and pose of the camera in arm coordinates
+     * @return Whether the lookup grid was built
+     */
+    bool SetCameraCalibration(const CameraCalibration& calibration);
+
     /**
      * @brief Callback function type for ball status updates
      */
@@ -91,6 +184,123 @@ public:
      */
     void UnregisterBallStatusCallback();
 
+    /**
+     * @brief Callback function type for capture failures and recoveries
+     * @param status Failure class, or CaptureStatus::OK when capture recovers
+     * @param consecutive_failures Failed captures in a row; for OK, the length of the outage that just ended
+     */
+    using CaptureEventCallback = std::function<void(CaptureStatus status, int consecutive_failures)>;
+
+    /**
+     * @brief Registers a callback called from the tracking thread on capture failures and recoveries
+     * @param callback The callback function to register
+     */
+    void RegisterCaptureEventCallback(CaptureEventCallback callback);
+
+    /**
+     * @brief Sets the capture failure recovery policy; ignored while tracking is running
+     * @param policy Backoff and reconnect settings
+     */
+    void SetCaptureRetryPolicy(const CaptureRetryPolicy& policy);
+
+    /**
+     * @brief Sets the per-ball search bounds used while a ball is lost; ignored while tracking is running
+     * @param config Pixel budget and search state durations
+     */
+    void SetLostBallSearchConfig(const LostBallSearchConfig& config);
+
+    /**
+     * @brief Sets how often balls at rest get a full detection; ignored while tracking is running
+     * @param config Rest thresholds and full detection cadence
+     */
+    void SetAdaptiveUpdateConfig(const AdaptiveUpdateConfig& config);
+
+    /**
+     * @brief Sets the joint assignment of balls sharing a color; ignored while tracking is running
+     * @param config Mahalanobis gate and position uncertainty floor
+     */
+    void SetAssociationConfig(const AssociationConfig& config);
+
+    /**
+     * @brief Enables spawning trackers for balls entering the track and retiring balls that left it; ignored while tracking is running
+     *
+     * The tracker pool is preallocated here. InitTrack() sets the spawn zone to the trajectory
+     * start point and the end point to its last point; both can be overridden below.
+     * GetBallStatus() only reports balls currently tracked.
+     * @param config Pool size, spawn confirmation and retirement thresholds
+     */
+    void SetTrackerLifecycleConfig(const TrackerLifecycleConfig& config);
+
+    /**
+     * @brief Sets the centers of the zones watched for new balls; ignored while tracking is running
+     * @param centers Zone centers in image coordinates
+     */
+    void SetSpawnZones(const std::vector<std::pair<double, double>>& centers);
+
+    /**
+     * @brief Sets the point where balls leave the track; ignored while tracking is running
+     * @param point End point in image coordinates
+     */
+    void SetTrackEndPoint(const std::pair<double, double>& point);
+
+    /**
+     * @brief Sets the corridor around the trajectory that InitTrack() restricts detection to; ignored while tracking is running
+     * @param config Corridor width, or disabled to search the whole image
+     */
+    void SetTrackCorridorConfig(const TrackCorridorConfig& config);
+
+    /**
+     * @brief Sets the arc-length tracking along the trajectory recorded by InitTrack(); ignored while tracking is running
+     *
+     * In track mode a ball's state is its arc length and speed along the trajectory;
+     * BallStatus::progress is the arc length over the trajectory length.
+     * @param config Noise and search window settings, or disabled for 2D tracking
+     */
+    void SetTrackModeConfig(const TrackModeConfig& config);
+
+    /**
+     * @brief Sets how InitTrack() and InitTrackOffline() compact the recorded trajectories; ignored while tracking is running
+     *
+     * The raw points are smoothed with a Kalman/RTS pass, simplified within a tolerance and
+     * resampled at uniform arc length. The compact trajectory is stored under "compact" in the
+     * trajectory file next to the raw points and is used as the track model.
+     * @param config Smoother noise, simplification tolerance and resampling spacing, or disabled to keep the raw points only
+     */
+    void SetTrajectoryCompactionConfig(const TrajectoryCompactionConfig& config);
+
+    /**
+     * @brief Sets the segmentation and gap filling of InitTrackOffline(); ignored while tracking is running
+     * @param config Segment count, detection resolution and longest bridged gap
+     */
+    void SetOfflineInitTrackConfig(const OfflineInitTrackConfig& config);
+
+    /**
+     * @brief Sets the per-frame deadline of the tracker scheduler; ignored while tracking is running
+     * @param config Deadline settings
+     */
+    void SetFrameSchedulerConfig(const FrameSchedulerConfig& config);
+
+    /**
+     * @brief Sets the scheduling priority of a ball; higher priorities are updated first
+     *
+     * Without a priority a ball is ranked by its progress along the track.
+     * @param ball_id Ball id from the balls configuration
+     * @param priority Priority, e.g. the pick order of the robot arm
+     */
+    void SetBallPriority(int ball_id, double priority);
+
+    /**
+     * @brief Gets the deadline counters of the tracker scheduler
+     * @return Scheduler statistics
+     */
+    FrameSchedulerStats GetSchedulerStats() const;
+
+    /**
+     * @brief Gets the result of the last capture in the tracking loop
+     * @return Last capture status
+     */
+    CaptureStatus GetLastCaptureStatus() const { return last_capture_status_; }
+
     /**
      * @brief Sets the height parameters for the ball tracking system
      * @param heights Height parameters including camera height and track heights
@@ -117,29 +327,213 @@ public:
      */
     bool InitializeCamera(const std::string& video_path, int width = -1, int height = -1, int fps = -1);
 
+    /**
+     * @brief Initialize any supported input source
+     * @param source_type Type of camera source
+     * @param source Camera device ID, file path, or camera serial number
+     * @param width Image width
+     * @param height Image height
+     * @param fps Frame rate
+     * @return Whether initialization was successful
+     */
+    bool InitializeCamera(CameraSourceType source_type, const std::string& source, int width = -1, int height = -1, int fps = -1);
+
+    /**
+     * @brief Starts recording per-ball ROI patches and tracker state from the tracking loop
+     * @param path Output file path (.btroi)
+     * @param full_frame_interval A full frame is stored every this many frames and on lost-ball events (0: lost events only)
+     * @return Whether the recording was created; the camera must be initialized
+     */
+    bool StartRoiRecording(const std::string& path, int full_frame_interval = 300);
+
+    /**
+     * @brief Stops the ROI recording and finalizes the file
+     */
+    void StopRoiRecording();
+
+    /**
+     * @brief Starts publishing the ball status of every tracked frame to a POSIX shared-memory ring
+     *
+     * Other processes read the ring with StatusRingReader from status_ring.h, without
+     * syscalls and without blocking the tracking loop. A frame holds at most
+     * kStatusRingMaxBalls balls, so sharing is refused for a larger tracker pool.
+     * @param name Shared memory object name
+     * @param slot_count Frames kept in the ring
+     * @param replace_existing Take over an existing object of the same name (e.g. left by a crash)
+     * @return Whether the shared memory object was created
+     */
+    bool StartStatusSharing(const std::string& name = "/ball_tracker_status", int slot_count = 256,
+                            bool replace_existing = false);
+
+    /**
+     * @brief Stops publishing and removes the shared memory object
+     */
+    void StopStatusSharing();
+
+    /**
+     * @brief Starts sending the ball status of every tracked frame as UDP datagrams
+     *
+     * Datagrams have the fixed binary layout of status_datagram.h and are sent from a
+     * dedicated thread to a unicast or multicast address. UdpStatusReceiver in the same
+     * header is a reference receiver with loss and latency accounting.
+     * @param config Destination, multicast settings and batching
+     * @return Whether the socket was created
+     */
+    bool StartStatusStreaming(const StatusStreamConfig& config);
+
+    /**
+     * @brief Sends the queued frames and stops streaming
+     */
+    void StopStatusStreaming();
+
+    /**
+     * @brief Gets the pipeline metrics: frame, drop and failure counters, fps, and stage and per-tracker-slot latencies
+     * @return Current values of all metrics
+     */
+    MetricsSnapshot GetMetrics() const;
+
+    /**
+     * @brief Starts serving the pipeline metrics in Prometheus text format at http://<address>:<port>/metrics
+     * @param port TCP port
+     * @param bind_address Local IPv4 address to listen on. The endpoint has no authentication, so it
+     *        only accepts local scrapers by default; pass "0.0.0.0" or an interface address to expose it
+     * @return Whether the port was bound
+     */
+    bool StartMetricsServer(int port = 9464, const std::string& bind_address = "127.0.0.1");
+
+    /**
+     * @brief Stops the metrics endpoint
+     */
+    void StopMetricsServer();
+
 private:
-    std::vector<std::unique_ptr<IBallTracker>> ball_trackers_;  ///< Trackers for multiple balls
-    HeightParameters height_params_;                             ///< Height parameters for the system
+    std::unique_ptr<TrackerBank> trackers_;                     ///< Trackers for multiple balls
+    HeightParameters height_params_{};                           ///< Height parameters for the system, guarded by scheduler_mutex_
+    std::unique_ptr<PixelToArmMap> arm_map_;                    ///< Pixel to arm coordinate lookup of GetRobotTarget(), guarded by scheduler_mutex_
     std::string balls_config_file_path_;                        ///< Path to the balls configuration file
 
-    bool is_tracking_ = false;                                  ///< Flag indicating if tracking is active
+    std::atomic<bool> is_tracking_{false};                      ///< Flag indicating if tracking is active
     std::thread tracking_thread_;                               ///< Thread for running the tracking loop
     std::mutex tracking_mutex_;                                 ///< Mutex for thread synchronization
+    std::mutex stop_mutex_;                                     ///< Guards stop_cv_ waits against StopTracking
+    std::condition_variable stop_cv_;                           ///< Wakes the tracking loop out of backoff waits
+
+    CaptureRetryPolicy retry_policy_;                           ///< Capture failure recovery policy
+    TrackCorridorConfig corridor_config_;                       ///< Corridor built by InitTrack()
+    OfflineInitTrackConfig offline_config_;                     ///< Segmentation of InitTrackOffline()
+    TrajectoryCompactionConfig compaction_config_;              ///< Compact form of the recorded trajectories
+    CaptureEventCallback capture_event_callback_;               ///< Callback for capture failures
+    std::atomic<CaptureStatus> last_capture_status_{CaptureStatus::NOT_OPEN};  ///< Result of the last capture
 
     BallStatusCallback status_callback_;                        ///< Callback function for ball status updates
 
     class CameraImpl;                                           ///< Forward declaration of camera implementation
     std::unique_ptr<CameraImpl> camera_;                        ///< Camera implementation using PIMPL pattern
 
+    struct PipelineMetrics;                                     ///< Metrics registry and the metrics recorded by the tracking loop
+    std::unique_ptr<PipelineMetrics> metrics_;                  ///< Recorded by the tracking loop; slots are registered while it is stopped
+    std::unique_ptr<MetricsHttpServer> metrics_server_;         ///< Prometheus endpoint, null when not serving
+
+    std::unique_ptr<RoiRecorder> roi_recorder_;                 ///< ROI recorder, null when not recording
+    std::mutex roi_recorder_mutex_;                             ///< Guards roi_recorder_ against the tracking loop
+    uint64_t tracking_frame_index_ = 0;                         ///< Frames processed by the tracking loop
+
+    std::unique_ptr<StatusRingPublisher> status_ring_;          ///< Shared-memory status ring, null when not sharing
+    std::unique_ptr<UdpStatusPublisher> status_stream_;         ///< UDP status stream, null when not streaming
+    std::mutex status_output_mutex_;                            ///< Guards status_ring_ and status_stream_ against the tracking loop
+
+    FrameScheduler scheduler_;                                  ///< Orders tracker updates within the frame deadline
+    mutable std::mutex scheduler_mutex_;                        ///< Guards the members below against the tracking loop
+    std::vector<double> ball_priorities_;                       ///< Caller-supplied priority per tracker
+    std::vector<uint8_t> has_ball_priority_;                    ///< Whether ball_priorities_ is set per tracker
+    std::vector<uint8_t> deferred_updates_;                     ///< Trackers deferred in the last frame
+    FrameSchedulerStats scheduler_stats_;                       ///< Copy of the scheduler counters
+    std::vector<int> lifecycle_changes_;                        ///< Tracker slots spawned or retired in the last frame
+    std::vector<BallStatus> status_snapshot_;                   ///< Status of the active trackers at the end of the last frame
+    std::vector<int> status_snapshot_slots_;                    ///< Tracker slot of each entry of status_snapshot_
+    std::vector<InitTrackBallStats> init_track_stats_;          ///< Per-ball results of the last InitTrack()
+
     /**
      * @brief Calls the registered callback function with current ball status
      */
     void NotifyBallStatusUpdate();
 
+    /**
+     * @brief Compacts a recorded trajectory, closes its file and fills the point counts of its statistics
+     * @param writer Writer of the trajectory
+     * @param stats Statistics of the ball
+     * @param compact Output compact trajectory, empty when compaction is disabled
+     * @return false if the file could not be written
+     */
+    bool CloseTrajectory(TrajectoryWriter& writer, InitTrackBallStats& stats, std::vector<cv::Point_<float>>& compact);
+
+    /**
+     * @brief File an InitTrack() trajectory is written to
+     * @param path Trajectory file path passed to InitTrack()
+     * @param index Index of the ball among the configured balls
+     * @param ball_id Ball id
+     * @return path for the first ball, path with "_ball<id>" before the extension otherwise
+     */
+    static std::string TrajectoryFilePath(const std::string& path, int index, int ball_id);
+
+    /**
+     * @brief Sets the search prior, corridor, track path, speed profile, spawn zone and end point from recorded trajectories
+     * @param paths Trajectory of each ball
+     * @param runs Raw points and frame indices of each ball, merged into the speed profile
+     * @param frame_size Size of the recorded frames
+     */
+    void ApplyTrackModel(const std::vector<const std::vector<cv::Point_<float>>*>& paths,
+                         const std::vector<SpeedRun>& runs, const cv::Size& frame_size);
+
     /**
      * @brief Main tracking loop that runs in a separate thread
      */
     void TrackingLoop();
+
+    /**
+     * @brief Waits until the timeout expires or StopTracking() is called
+     * @param timeout_ms Wait limit in milliseconds
+     * @return true if tracking was stopped during the wait
+     */
+    bool WaitForStop(int timeout_ms);
+
+    /**
+     * @brief Applies the retry policy after a failed capture
+     * @param status Failure class
+     * @param consecutive_failures Failed captures in a row, including this one
+     * @param reconnect_attempts Reconnect attempts since the last successful capture
+     * @return false if tracking must stop
+     */
+    bool HandleCaptureFailure(CaptureStatus status, int consecutive_failures, int& reconnect_attempts);
+
+    /**
+     * @brief Passes the tracked frame and tracker snapshots to the ROI recorder, if recording
+     * @param frame Frame the trackers were updated with
+     * @param capture_ns Capture time of the frame on the steady clock, as in raw recordings
+     */
+    void RecordRoiFrame(const cv::Mat& frame, int64_t capture_ns);
+
+    /**
+     * @brief Publishes the ball status of the tracked frame to the shared-memory ring and the UDP stream, if enabled
+     */
+    void PublishStatus();
+
+    /**
+     * @brief Updates all trackers with a frame through the deadline scheduler
+     * @param frame Captured frame
+     */
+    void UpdateTrackers(const cv::Mat& frame);
+
+    /**
+     * @brief Records the capture interval, source frame drops and capture latency of a captured frame
+     * @param capture_start_ns Steady clock time the capture call started
+     */
+    void RecordCaptureMetrics(int64_t capture_start_ns);
+
+    /**
+     * @brief Counts balls that were lost in the last frame, per ball
+     */
+    void RecordBallMetrics();
 };
 
 #endif  // BALL_TRACKER_INTERFACE_H
\ No newline at end of file
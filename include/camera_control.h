@@ -2,38 +2,20 @@
 #define CAMERA_CONTROL_H
 
 #include <string>
-#include <thread>
-#include <mutex>
-#include <atomic>
+#include <memory>
 #include <vector>
 
 #include <opencv2/opencv.hpp>
-#include "IMV/IMVApi.h"
 
 #include "ball_tracker_common.h"
-
-/**
- * @enum CameraSourceType
- * @brief 定义相机输入源类型
- */
-enum class CameraSourceType {
-    HUARUI_CAMERA,  // 华睿相机
-    USB_CAMERA,     // USB免驱相机
-    VIDEO_FILE      // 视频文件
-};
-
-struct CameraDeviceInfo {
-    std::string vendor_name;
-    std::string model_name;
-    std::string serial_number;
-    std::string camera_name;
-    std::string ip_address;  // 仅GigE相机有效
-    int camera_type;  // 0: GigE, 1: U3V, 2: CL, 3: PCIe
-};
+#include "frame_source.h"
 
 /**
  * @class BallTrackerCamera
  * @brief Camera control class for ball tracking system
+ *
+ * Thin wrapper over an IFrameSource backend that delivers BGR frames through the
+ * cheapest conversion path the backend advertises.
  */
 class BallTrackerCamera {
 public:
@@ -62,6 +44,21 @@ public:
              int fps = -1, 
              CameraSourceType source_type = CameraSourceType::USB_CAMERA);
 
+    /**
+     * @brief Opens an already constructed frame source backend
+     * @param frame_source Backend to take ownership of
+     * @param source Backend specific source string
+     * @param width Desired image width (-1 for default)
+     * @param height Desired image height (-1 for default)
+     * @param fps Desired frame rate (-1 for default)
+     * @return true if the backend was successfully opened, false otherwise
+     */
+    bool Open(std::unique_ptr<IFrameSource> frame_source,
+              const std::string& source,
+              int width = -1,
+              int height = -1,
+              int fps = -1);
+
     /**
      * @brief Closes the camera and releases resources
      */
@@ -69,17 +66,69 @@ public:
 
     /**
      * @brief Captures a new frame from the camera
-     * @param frame Output frame
+     *
+     * For zero-copy backends the frame may reference source-owned memory that is
+     * reused by the next Capture() call. A frame returned by the previous call is
+     * released first so that recycling backends get its buffer back; clone() it
+     * to keep it.
+     * @param frame Output BGR frame
      * @return true if frame was successfully captured, false otherwise
      */
     bool Capture(cv::Mat& frame);
 
+    /**
+     * @brief Captures a new frame in the native pixel format of the backend
+     * @param frame Output raw frame
+     * @return true if frame was successfully captured, false otherwise
+     */
+    bool CaptureRaw(RawFrame& frame);
+
+    /**
+     * @brief Whether a file-backed source has delivered its last frame
+     * @return true once Capture() fails because the end of the file was reached
+     */
+    bool IsEndOfStream() const { return source_ && source_->IsEndOfStream(); }
+
+    /**
+     * @brief Gets the result of the last Capture() or CaptureRaw() call
+     * @return CaptureStatus::OK after a successful capture, otherwise the failure class
+     */
+    CaptureStatus GetLastStatus() const { return last_status_; }
+
+    /**
+     * @brief Gets the capture time of the last frame on the steady clock, in nanoseconds
+     */
+    int64_t GetLastTimestamp() const { return raw_frame_.timestamp_ns; }
+
+    /**
+     * @brief Gets the source frame counter of the last frame; gaps are frames dropped before capture
+     */
+    uint64_t GetLastFrameId() const { return raw_frame_.frame_id; }
+
+    /**
+     * @brief Closes and reopens the backend with the current source and settings
+     *
+     * The backend is kept when reopening fails, so Reconnect() can be retried.
+     * @return true if the source was reopened
+     */
+    bool Reconnect();
+
     /**
      * @brief Gets the current camera parameters
      * @return A string containing camera information
      */
     std::string GetInfo() const;
 
+    /**
+     * @brief Gets the capabilities of the opened backend
+     */
+    FrameSourceCaps GetCaps() const;
+
+    /**
+     * @brief Gets the opened backend, or nullptr when closed
+     */
+    IFrameSource* GetFrameSource() const { return source_.get(); }
+
     // Getter methods for testing
     bool IsOpen() const { return is_open_; }
     int GetWidth() const { return width_; }
@@ -93,22 +142,15 @@ public:
     bool OpenByIndex(int index, int width = 640, int height = 480, int fps = 30);
 
 private:
-    cv::VideoCapture cap_;
+    std::unique_ptr<IFrameSource> source_;  // 输入源后端
+    RawFrame raw_frame_;                    // 复用的原始帧
     int width_;
     int height_;
     int fps_;
     bool is_open_;
+    CaptureStatus last_status_;             // 上一次采集的结果
     CameraSourceType source_type_;
     std::string source_path_;
-    
-    // 华睿相机相关成员
-    IMV_HANDLE dev_handle_;           // 相机句柄
-    std::thread grab_thread_;         // 拉流线程
-    std::atomic<bool> is_grabbing_;   // 拉流状态
-    std::mutex frame_mutex_;          // 帧数据互斥锁
-    cv::Mat current_frame_;           // 当前帧
-    unsigned char* dst_buffer_;       // 预分配的输出缓冲区
-    unsigned int dst_buffer_size_;    // 输出缓冲区大小
 };
 
-#endif // CAMERA_CONTROL_H 
\ No newline at end of file
+#endif // CAMERA_CONTROL_H
@@ -0,0 +1,49 @@
+#ifndef DATA_ASSOCIATION_H
+#define DATA_ASSOCIATION_H
+
+#include <limits>
+#include <vector>
+
+/// Cost of a track/measurement pair outside the gate.
+constexpr float kNotGated = std::numeric_limits<float>::infinity();
+
+/**
+ * @class AssignmentSolver
+ * @brief Minimum-cost assignment of tracks (rows) to measurements (columns) restricted to gated pairs.
+ *
+ * The bipartite graph of gated pairs is split into connected components and each
+ * component is solved exactly with the Hungarian method, so the cost grows with the
+ * size of the largest cluster of nearby balls rather than with the number of balls.
+ * Scratch buffers are kept between calls.
+ */
+class AssignmentSolver {
+public:
+    /**
+     * @brief Solves the assignment.
+     * @param cost Row-major rows x cols non-negative costs, kNotGated for pairs outside the gate
+     * @param rows Number of tracks
+     * @param cols Number of measurements
+     * @param row_to_col Output measurement per track, -1 if unassigned
+     * @return Number of assigned tracks
+     */
+    int Solve(const std::vector<float>& cost, int rows, int cols, std::vector<int>& row_to_col);
+
+private:
+    std::vector<int> parent_;          ///< Union-find over rows and columns
+    std::vector<int> component_rows_;
+    std::vector<int> component_cols_;
+    std::vector<double> matrix_;       ///< Square cost matrix of one component
+    std::vector<double> u_, v_;        ///< Row and column potentials
+    std::vector<int> match_, way_;
+    std::vector<double> min_slack_;
+    std::vector<char> used_;
+
+    int Find(int node);
+
+    /**
+     * @brief Hungarian method on matrix_ (size x size), writes the column of each row to match_.
+     */
+    void Hungarian(int size);
+};
+
+#endif // DATA_ASSOCIATION_H
@@ -0,0 +1,146 @@
+#ifndef FRAME_RECORDER_H
+#define FRAME_RECORDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "frame_source.h"
+#include "raw_recording.h"
+
+/**
+ * @enum RecorderBackpressure
+ * @brief What FrameRecorder::Submit() does when every buffer is in flight.
+ */
+enum class RecorderBackpressure {
+    DROP_NEWEST,  ///< Drop the submitted frame and count it (never stalls the capture thread)
+    BLOCK         ///< Wait up to block_timeout_ms for a free buffer, then drop
+};
+
+/**
+ * @struct FrameRecorderConfig
+ * @brief Tuning parameters of FrameRecorder.
+ */
+struct FrameRecorderConfig {
+    int num_buffers = 32;          ///< Frame buffers in the pool (bounds memory use)
+    int num_writer_threads = 2;    ///< Threads issuing disk writes
+    int max_batch_frames = 4;      ///< Consecutive frames merged into one write call
+    bool direct_io = true;         ///< Bypass the page cache (O_DIRECT / FILE_FLAG_NO_BUFFERING) when supported
+    RecorderBackpressure backpressure = RecorderBackpressure::DROP_NEWEST;
+    int block_timeout_ms = 100;    ///< Wait limit for RecorderBackpressure::BLOCK
+};
+
+/**
+ * @struct FrameRecorderStats
+ * @brief Counters of a FrameRecorder.
+ */
+struct FrameRecorderStats {
+    uint64_t submitted = 0;        ///< Frames passed to Submit()
+    uint64_t written = 0;          ///< Frames written to disk
+    uint64_t dropped = 0;          ///< Frames dropped because no buffer was free
+    uint64_t write_errors = 0;     ///< Frames whose write failed
+    uint64_t bytes_written = 0;    ///< Bytes written, including slot padding
+    uint64_t write_calls = 0;      ///< Write system calls issued
+    int max_in_flight = 0;         ///< Peak number of buffers in use
+};
+
+/**
+ * @class FrameRecorder
+ * @brief Asynchronous raw recording engine writing the .btraw format (see raw_recording.h).
+ *
+ * Submit() copies the frame into a recycled, page-aligned slot buffer and returns;
+ * writer threads write slots at their fixed file offsets, merging consecutive slots
+ * into a single vectored write. Memory is bounded by num_buffers and frames that do
+ * not fit are dropped and counted instead of queueing without bound.
+ */
+class FrameRecorder {
+public:
+    explicit FrameRecorder(const FrameRecorderConfig& config = FrameRecorderConfig());
+    ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    /**
+     * @brief Creates the recording, allocates the buffer pool and starts the writer threads.
+     * @param path Output file path
+     * @param info Stream description
+     * @return true if the recording was created
+     */
+    bool Open(const std::string& path, const RawRecordingInfo& info);
+
+    /**
+     * @brief Queues a frame for writing.
+     * @param frame Frame matching the stream geometry and format
+     * @return true if the frame was queued, false if it was dropped or invalid
+     */
+    bool Submit(const RawFrame& frame);
+
+    /**
+     * @brief Blocks until every queued frame has been written.
+     */
+    void Flush();
+
+    /**
+     * @brief Flushes, stops the writer threads, writes the final header and closes the file.
+     */
+    void Close();
+
+    bool IsOpen() const { return is_open_; }
+
+    /**
+     * @brief Gets a snapshot of the counters.
+     */
+    FrameRecorderStats GetStats() const;
+
+    /**
+     * @brief Whether the file was opened with page-cache bypass.
+     */
+    bool IsDirectIO() const { return direct_io_active_; }
+
+private:
+    struct Slot {
+        unsigned char* data = nullptr;  ///< frame_stride bytes, page aligned
+        uint64_t index = 0;             ///< Slot index in the file
+    };
+
+    class File;
+
+    FrameRecorderConfig config_;
+    std::unique_ptr<File> file_;
+    RawRecordingHeader header_;
+    std::atomic<bool> is_open_;
+    bool direct_io_active_;
+
+    std::vector<Slot> slots_;
+    std::vector<int> free_slots_;       ///< Recycled buffers
+    std::deque<int> pending_slots_;     ///< Filled buffers in file order
+    int writes_in_progress_;
+    int submits_in_progress_;           ///< Submit() calls holding a buffer outside the lock
+    uint64_t next_index_;
+    uint64_t first_failed_index_;       ///< Lowest slot index of a failed write, UINT64_MAX if none
+    bool stop_;
+    mutable std::mutex mutex_;
+    std::condition_variable pending_cv_;   ///< Signals writers
+    std::condition_variable free_cv_;      ///< Signals Submit() and Flush()
+    std::vector<std::thread> writers_;
+
+    std::atomic<uint64_t> submitted_;
+    std::atomic<uint64_t> written_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint64_t> write_errors_;
+    std::atomic<uint64_t> bytes_written_;
+    std::atomic<uint64_t> write_calls_;
+    int max_in_flight_;
+
+    void WriterThread();
+    void ReleaseBuffers();
+};
+
+#endif // FRAME_RECORDER_H
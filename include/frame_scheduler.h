@@ -0,0 +1,89 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @struct FrameSchedulerConfig
+ * @brief Per-frame deadline of FrameScheduler.
+ */
+struct FrameSchedulerConfig {
+    double deadline_ms = 0.0;         ///< Processing deadline per frame, 0 to derive it from the camera period
+    double period_fraction = 0.8;     ///< Share of the camera period available when deadline_ms is 0
+    double default_period_ms = 33.3;  ///< Camera period assumed when the frame rate is unknown
+};
+
+/**
+ * @struct ScheduledTask
+ * @brief A unit of per-frame work, usually the update of one ball tracker.
+ */
+struct ScheduledTask {
+    int index;        ///< Caller's task index, stable across frames
+    int tier;         ///< Lower tiers run first (e.g. 0: locked balls, 1: searches)
+    double priority;  ///< Higher priorities run first within a tier
+};
+
+/**
+ * @struct FrameSchedulerStats
+ * @brief Counters of FrameScheduler since construction.
+ */
+struct FrameSchedulerStats {
+    uint64_t frames = 0;           ///< Frames scheduled
+    uint64_t deadline_misses = 0;  ///< Frames whose work finished after the deadline
+    uint64_t deferred_tasks = 0;   ///< Tasks skipped because the deadline had passed
+    double last_frame_ms = 0.0;    ///< Duration of the last frame's work
+};
+
+/**
+ * @class FrameScheduler
+ * @brief Runs per-frame tasks in priority order on the OpenMP threads until a deadline.
+ *
+ * Tasks are started in order of tier, then priority. A task that has not been
+ * started when the deadline passes is deferred to the next frame, where it runs
+ * ahead of the non-deferred tasks of its tier. The first task always runs.
+ */
+class FrameScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FrameScheduler(const FrameSchedulerConfig& config = FrameSchedulerConfig());
+
+    void SetConfig(const FrameSchedulerConfig& config) { config_ = config; }
+    const FrameSchedulerConfig& GetConfig() const { return config_; }
+
+    /**
+     * @brief Deadline per frame for a camera frame rate.
+     * @param fps Camera frame rate, 0 or negative if unknown
+     * @return Deadline in milliseconds
+     */
+    double GetDeadlineMs(int fps) const;
+
+    /**
+     * @brief Runs the tasks of one frame.
+     * @param tasks Tasks of this frame; reordered into execution order
+     * @param deadline Time after which no further task is started
+     * @param work Called with the task index, possibly from several threads at once
+     * @return Number of deferred tasks
+     */
+    int Run(std::vector<ScheduledTask>& tasks, Clock::time_point deadline, const std::function<void(int)>& work);
+
+    /**
+     * @brief Whether the task was deferred in the last Run().
+     */
+    bool IsDeferred(int index) const {
+        return index >= 0 && index < static_cast<int>(deferred_.size()) && deferred_[index] != 0;
+    }
+
+    const FrameSchedulerStats& GetStats() const { return stats_; }
+
+private:
+    FrameSchedulerConfig config_;
+    FrameSchedulerStats stats_;
+    std::vector<uint8_t> deferred_;       ///< Deferred flags of the last Run(), by task index
+    std::vector<uint8_t> was_deferred_;   ///< Deferred flags of the Run() before, used for ordering
+};
+
+#endif // FRAME_SCHEDULER_H
@@ -0,0 +1,183 @@
+#ifndef FRAME_SOURCE_H
+#define FRAME_SOURCE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+#include "ball_tracker_common.h"
+
+/**
+ * @enum PixelFormat
+ * @brief Pixel layout of the frames delivered by a frame source.
+ */
+enum class PixelFormat {
+    UNKNOWN = 0,
+    MONO8,      ///< 8-bit grayscale (CV_8UC1)
+    BGR8,       ///< 8-bit interleaved BGR (CV_8UC3)
+    BAYER_RG8,  ///< 8-bit Bayer, RGGB sensor layout (CV_8UC1)
+    BAYER_GR8,  ///< 8-bit Bayer, GRBG sensor layout (CV_8UC1)
+    BAYER_GB8,  ///< 8-bit Bayer, GBRG sensor layout (CV_8UC1)
+    BAYER_BG8,  ///< 8-bit Bayer, BGGR sensor layout (CV_8UC1)
+};
+
+/**
+ * @brief Get the number of bytes per pixel of a pixel format.
+ * @param format Pixel format.
+ * @return Bytes per pixel, 0 for PixelFormat::UNKNOWN.
+ */
+int PixelFormatBytesPerPixel(PixelFormat format);
+
+/**
+ * @brief Get a printable name for a pixel format.
+ * @param format Pixel format.
+ * @return Static string naming the format.
+ */
+const char* PixelFormatName(PixelFormat format);
+
+/**
+ * @struct CameraDeviceInfo
+ * @brief Description of an enumerated Huarui camera device.
+ */
+struct CameraDeviceInfo {
+    std::string vendor_name;
+    std::string model_name;
+    std::string serial_number;
+    std::string camera_name;
+    std::string ip_address;  // 仅GigE相机有效
+    int camera_type;  // 0: GigE, 1: U3V, 2: CL, 3: PCIe
+};
+
+/**
+ * @struct FrameSourceCaps
+ * @brief Capabilities advertised by a frame source, used to pick the cheapest conversion path.
+ */
+struct FrameSourceCaps {
+    PixelFormat native_format = PixelFormat::UNKNOWN;  ///< Pixel layout delivered by Read()
+    bool zero_copy = false;            ///< Read() hands out views into source-owned memory
+    bool native_bgr_convert = false;   ///< Source provides a BGR conversion cheaper than cv::cvtColor
+    bool is_live = false;              ///< Frames come from a live device rather than a file
+};
+
+/**
+ * @struct RawFrame
+ * @brief A frame in the native pixel format of its source.
+ *
+ * When the source advertises zero_copy, image is a view into memory owned by the
+ * source and stays valid only until the next Read() or Close() on that source.
+ */
+struct RawFrame {
+    cv::Mat image;                             ///< Native pixel data
+    PixelFormat format = PixelFormat::UNKNOWN; ///< Pixel layout of image
+    uint64_t frame_id = 0;                     ///< Monotonic frame counter of the source
+    int64_t timestamp_ns = 0;                  ///< Capture time on the steady clock, in nanoseconds
+};
+
+/**
+ * @class IFrameSource
+ * @brief Interface implemented by every camera / file backend.
+ */
+class IFrameSource {
+public:
+    virtual ~IFrameSource() = default;
+
+    /**
+     * @brief Opens the source.
+     * @param source Backend specific source string (device id, file path, serial number...)
+     * @param width Desired image width (-1 for default)
+     * @param height Desired image height (-1 for default)
+     * @param fps Desired frame rate (-1 for default)
+     * @return true if the source was opened, false otherwise
+     */
+    virtual bool Open(const std::string& source, int width, int height, int fps) = 0;
+
+    /**
+     * @brief Closes the source and releases its resources.
+     */
+    virtual void Close() = 0;
+
+    /**
+     * @brief Whether the source is currently open.
+     */
+    virtual bool IsOpen() const = 0;
+
+    /**
+     * @brief Reads the next frame in the native pixel format.
+     * @param frame Output frame
+     * @return true if a frame was read, false otherwise
+     */
+    virtual bool Read(RawFrame& frame) = 0;
+
+    /**
+     * @brief Whether a file-backed source has delivered its last frame.
+     *
+     * Distinguishes the end of a file from a transient Read() failure. Live
+     * sources never reach the end of stream.
+     */
+    virtual bool IsEndOfStream() const { return false; }
+
+    /**
+     * @brief Classifies why the last Read() returned false.
+     *
+     * The default reports END_OF_STREAM, NOT_OPEN or else TIMEOUT; backends that
+     * can tell a lost device from a late frame override it.
+     */
+    virtual CaptureStatus GetReadStatus() const;
+
+    /**
+     * @brief Converts a frame read from this source to BGR8.
+     *
+     * The default implementation uses cv::cvtColor and returns a shallow copy for
+     * frames that are already BGR8. Backends with a cheaper path override it.
+     * @param frame Frame previously returned by Read()
+     * @param bgr Output BGR8 image
+     * @return true if the conversion succeeded, false otherwise
+     */
+    virtual bool ConvertToBGR(const RawFrame& frame, cv::Mat& bgr);
+
+    /**
+     * @brief Gets the capabilities of the source.
+     */
+    virtual FrameSourceCaps GetCaps() const = 0;
+
+    /**
+     * @brief Gets the source type implemented by this backend.
+     */
+    virtual CameraSourceType GetType() const = 0;
+
+    virtual int GetWidth() const = 0;
+    virtual int GetHeight() const = 0;
+    virtual int GetFps() const = 0;
+};
+
+/**
+ * @brief Get a printable name for a capture status.
+ * @param status Capture status.
+ * @return Static string naming the status.
+ */
+const char* CaptureStatusName(CaptureStatus status);
+
+/**
+ * @brief Converts a raw frame to BGR8 with OpenCV.
+ * @param frame Input raw frame
+ * @param bgr Output BGR8 image (shallow copy when the frame is already BGR8)
+ * @return true if the conversion succeeded, false otherwise
+ */
+bool ConvertRawFrameToBGR(const RawFrame& frame, cv::Mat& bgr);
+
+/**
+ * @brief Creates the backend for a source type.
+ * @param source_type Type of camera source
+ * @return The backend, or nullptr when the backend is not compiled into this build
+ */
+std::unique_ptr<IFrameSource> CreateFrameSource(CameraSourceType source_type);
+
+/**
+ * @brief Whether the backend for a source type is compiled into this build.
+ * @param source_type Type of camera source
+ */
+bool IsFrameSourceAvailable(CameraSourceType source_type);
+
+#endif // FRAME_SOURCE_H
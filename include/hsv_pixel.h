@@ -0,0 +1,49 @@
+#ifndef HSV_PIXEL_H
+#define HSV_PIXEL_H
+
+#include <algorithm>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief Converts one BGR pixel to HSV with the ranges of cv::COLOR_BGR2HSV (H: 0-180, S/V: 0-255).
+ *
+ * Used where only a sparse set of pixels is color tested, so converting a whole image
+ * region with cv::cvtColor would do more work.
+ */
+inline void BgrToHsv(const uchar* bgr, int& h, int& s, int& v) {
+    int b = bgr[0];
+    int g = bgr[1];
+    int r = bgr[2];
+    v = std::max(b, std::max(g, r));
+    int diff = v - std::min(b, std::min(g, r));
+    s = v == 0 ? 0 : (diff * 255 + v / 2) / v;
+    if (diff == 0) {
+        h = 0;
+        return;
+    }
+    float hue;
+    if (v == r) {
+        hue = 60.0f * (g - b) / diff;
+    } else if (v == g) {
+        hue = 120.0f + 60.0f * (b - r) / diff;
+    } else {
+        hue = 240.0f + 60.0f * (r - g) / diff;
+    }
+    if (hue < 0.0f) {
+        hue += 360.0f;
+    }
+    h = cvRound(hue * 0.5f);
+    if (h >= 180) {
+        h -= 180;
+    }
+}
+
+/**
+ * @brief Whether an HSV pixel lies in [lower, upper], like cv::inRange.
+ */
+inline bool HsvInRange(int h, int s, int v, const cv::Scalar_<double>& lower, const cv::Scalar_<double>& upper) {
+    return h >= lower[0] && h <= upper[0] && s >= lower[1] && s <= upper[1] && v >= lower[2] && v <= upper[2];
+}
+
+#endif // HSV_PIXEL_H
@@ -0,0 +1,96 @@
+#ifndef HUARUI_CAMERA_SOURCE_H
+#define HUARUI_CAMERA_SOURCE_H
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "frame_source.h"
+
+/**
+ * @class HuaruiCameraSource
+ * @brief Frame source for Huarui industrial cameras through the IMV SDK.
+ *
+ * Only compiled when BALL_TRACKER_WITH_HUARUI_SDK is enabled. Frames are handed
+ * out as views into the SDK frame buffer (BayerRG8); the buffer is returned to the
+ * SDK on the next Read() or on Close().
+ */
+class HuaruiCameraSource final : public IFrameSource {
+public:
+    HuaruiCameraSource();
+    ~HuaruiCameraSource() override;
+
+    /**
+     * @brief Opens a camera.
+     * @param source Serial number of the camera, or empty for the first device
+     * @param width Ignored, the sensor is always read out at 4096x3000
+     * @param height Ignored, the sensor is always read out at 4096x3000
+     * @param fps Nominal frame rate reported by GetFps()
+     * @return true if the camera was opened and started grabbing
+     */
+    bool Open(const std::string& source, int width, int height, int fps) override;
+
+    /**
+     * @brief Opens a camera by its enumeration index.
+     * @param index Index in the device list returned by EnumDevices()
+     * @param width Ignored, the sensor is always read out at 4096x3000
+     * @param height Ignored, the sensor is always read out at 4096x3000
+     * @param fps Nominal frame rate reported by GetFps()
+     * @return true if the camera was opened and started grabbing
+     */
+    bool OpenByIndex(int index, int width, int height, int fps);
+
+    void Close() override;
+    bool IsOpen() const override { return dev_handle_ != nullptr; }
+    bool Read(RawFrame& frame) override;
+    CaptureStatus GetReadStatus() const override { return read_status_; }
+
+    /**
+     * @brief Sets how long Read() waits for a frame. Bounds how long a stop request waits for Read() to return.
+     * @param timeout_ms Wait limit in milliseconds
+     */
+    void SetGrabTimeout(int timeout_ms) { grab_timeout_ms_ = timeout_ms; }
+
+    /**
+     * @brief Converts a Bayer frame to BGR8 with the SDK demosaic.
+     */
+    bool ConvertToBGR(const RawFrame& frame, cv::Mat& bgr) override;
+
+    FrameSourceCaps GetCaps() const override;
+    CameraSourceType GetType() const override { return CameraSourceType::HUARUI_CAMERA; }
+    int GetWidth() const override { return width_; }
+    int GetHeight() const override { return height_; }
+    int GetFps() const override { return fps_; }
+
+    /**
+     * @brief Gets the serial number of the opened camera.
+     */
+    const std::string& GetSerialNumber() const { return serial_number_; }
+
+    /**
+     * @brief Enumerates all connected Huarui cameras.
+     * @param device_list Output device list
+     * @return true if enumeration succeeded
+     */
+    static bool EnumDevices(std::vector<CameraDeviceInfo>& device_list);
+
+private:
+    void* dev_handle_;                // 相机句柄（IMV_HANDLE）
+    struct HeldFrame;
+    std::unique_ptr<HeldFrame> held_frame_;  // 当前借出的SDK帧，下次Read或Close时归还
+    cv::Mat bgr_buffer_;              // 预分配的BGR输出缓冲区
+    int width_;
+    int height_;
+    int fps_;
+    std::string serial_number_;
+    int grab_timeout_ms_;             // IMV_GetFrame 等待超时
+    CaptureStatus read_status_;       // 上一次Read的结果分类
+
+    /**
+     * @brief Returns the currently held SDK frame buffer, if any.
+     */
+    void ReleaseHeldFrame();
+};
+
+#endif // HUARUI_CAMERA_SOURCE_H
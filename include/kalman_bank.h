@@ -0,0 +1,125 @@
+#ifndef KALMAN_BANK_H
+#define KALMAN_BANK_H
+
+#include <vector>
+
+/// Lanes processed together by the batch updates of KalmanBank.
+constexpr int kKalmanBlock = 8;
+
+/**
+ * @struct KalmanNoise
+ * @brief Noise model shared by all lanes of a KalmanBank.
+ */
+struct KalmanNoise {
+    float process = 0.01f;      ///< Process noise variance added to every state per frame
+    float measurement = 0.1f;   ///< Measurement noise variance of x and y
+    float initial = 0.1f;       ///< State variance after Reset()
+};
+
+/**
+ * @class KalmanBank
+ * @brief Constant-velocity Kalman filters (state x, y, vx, vy; measurement x, y) for many balls.
+ *
+ * States and the upper triangle of the covariances are stored as structure of
+ * arrays, padded to a multiple of kKalmanBlock lanes, so the batch updates run
+ * kKalmanBlock filters per SIMD iteration. The single-lane updates use the same
+ * arithmetic.
+ */
+class KalmanBank {
+public:
+    explicit KalmanBank(const KalmanNoise& noise = KalmanNoise());
+
+    /**
+     * @brief Preallocates lanes so AddLane() does not allocate.
+     */
+    void Reserve(int lanes);
+
+    /**
+     * @brief Adds a lane initialized at the origin.
+     * @return Lane index
+     */
+    int AddLane();
+
+    int Size() const { return size_; }
+
+    /**
+     * @brief Restarts a lane at a position with the initial covariance.
+     */
+    void Reset(int lane, float x, float y, float vx = 0.0f, float vy = 0.0f);
+
+    /**
+     * @brief Advances one lane by one frame.
+     */
+    void Predict(int lane);
+
+    /**
+     * @brief Updates one lane with a measured position.
+     */
+    void Correct(int lane, float x, float y);
+
+    /**
+     * @brief Marks a lane for the next PredictBatch().
+     */
+    void RequestPredict(int lane) { predict_mask_[lane] = 1.0f; }
+
+    /**
+     * @brief Applies the requested prediction of one lane, if any.
+     */
+    void PredictPending(int lane);
+
+    /**
+     * @brief Queues a measured position for the next CorrectBatch() or CorrectPending().
+     */
+    void SetMeasurement(int lane, float x, float y) {
+        zx_[lane] = x;
+        zy_[lane] = y;
+        correct_mask_[lane] = 1.0f;
+    }
+
+    /**
+     * @brief Applies the queued measurement of one lane, if any.
+     */
+    void CorrectPending(int lane);
+
+    /**
+     * @brief Predicts all lanes marked with RequestPredict() and clears the marks.
+     */
+    void PredictBatch();
+
+    /**
+     * @brief Corrects all lanes with a queued measurement and clears the queue.
+     */
+    void CorrectBatch();
+
+    float X(int lane) const { return x_[lane]; }
+    float Y(int lane) const { return y_[lane]; }
+    float Vx(int lane) const { return vx_[lane]; }
+    float Vy(int lane) const { return vy_[lane]; }
+
+    /**
+     * @brief Diagonal of the covariance: variances of x, y, vx, vy.
+     */
+    float Variance(int lane, int state) const;
+
+    /**
+     * @brief Squared Mahalanobis distance of a measured position from the current state.
+     * @param extra_variance Added to the innovation variance of x and y, e.g. to floor the gate
+     */
+    float Mahalanobis2(int lane, float x, float y, float extra_variance = 0.0f) const;
+
+private:
+    KalmanNoise noise_;
+    int size_;
+    int padded_;
+    std::vector<float> x_, y_, vx_, vy_;
+    std::vector<float> p00_, p01_, p02_, p03_, p11_, p12_, p13_, p22_, p23_, p33_;
+    std::vector<float> zx_, zy_;
+    std::vector<float> predict_mask_;   ///< 1 for lanes to predict, 0 otherwise (blended, not branched on)
+    std::vector<float> correct_mask_;   ///< 1 for lanes with a queued measurement
+
+    void Resize(int padded);
+    void PredictRange(int begin, int end, const float* mask);
+    void CorrectRange(int begin, int end, const float* mask);
+};
+
+#endif // KALMAN_BANK_H
@@ -0,0 +1,171 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ball_tracker_common.h"
+
+/**
+ * @class MetricCounter
+ * @brief Monotonic counter; Add() is a single relaxed atomic increment.
+ */
+class MetricCounter {
+public:
+    void Add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+/**
+ * @class MetricGauge
+ * @brief Last value of a quantity; Set() is a single relaxed atomic store.
+ */
+class MetricGauge {
+public:
+    void Set(double value) { value_.store(value, std::memory_order_relaxed); }
+    double Value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value_{0.0};
+};
+
+/**
+ * @class LatencyHistogram
+ * @brief HDR-style histogram of durations in nanoseconds.
+ *
+ * Buckets are log-linear: every power of two is split into kSubBuckets linear
+ * buckets, so a recorded value is known to within 1 / kSubBuckets (about 6%) from
+ * 1 ns to over a minute. Record() is a bucket index computation and two relaxed
+ * atomic increments; there are no locks or allocations.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kMaxExponent = 40;   ///< Values from 2^40 ns (about 18 minutes) share the last buckets
+    static constexpr int kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+    /**
+     * @brief Records a duration.
+     * @param value_ns Duration in nanoseconds; negative values count as 0
+     */
+    void Record(int64_t value_ns);
+
+    uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t SumNs() const { return sum_ns_.load(std::memory_order_relaxed); }
+    uint64_t MaxNs() const { return max_ns_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Upper bound of the bucket holding a quantile of the recorded values.
+     * @param quantile Quantile between 0 and 1
+     * @return Duration in nanoseconds, capped at the largest recorded value; 0 when empty
+     */
+    uint64_t QuantileNs(double quantile) const;
+
+    /**
+     * @brief Bucket of a value.
+     */
+    static int BucketIndex(uint64_t value);
+
+    /**
+     * @brief Largest value of a bucket.
+     */
+    static uint64_t BucketUpperBound(int index);
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+};
+
+/**
+ * @class ScopedLatency
+ * @brief Records the lifetime of a scope into a histogram.
+ */
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyHistogram& histogram);
+    ~ScopedLatency();
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    LatencyHistogram& histogram_;
+    int64_t start_ns_;
+};
+
+/**
+ * @brief Current steady clock time in nanoseconds.
+ */
+int64_t MetricsNowNs();
+
+/**
+ * @class MetricsRegistry
+ * @brief Named counters, gauges and latency histograms of the tracking pipeline.
+ *
+ * Registration takes a lock and returns a reference that stays valid for the life of
+ * the registry; callers keep it and record through it without further lookups. A
+ * metric is identified by its name and its Prometheus label set, e.g. stage="capture".
+ */
+class MetricsRegistry {
+public:
+    /**
+     * @brief Gets or creates a counter.
+     * @param name Metric name, e.g. "ball_tracker_frames_total"
+     * @param help Description for the exposition format
+     * @param labels Label set without braces, e.g. slot="3"; empty for none
+     */
+    MetricCounter& Counter(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    /**
+     * @brief Gets or creates a gauge, see Counter().
+     */
+    MetricGauge& Gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    /**
+     * @brief Gets or creates a latency histogram, see Counter().
+     */
+    LatencyHistogram& Histogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    /**
+     * @brief Copies the current values of all metrics.
+     */
+    MetricsSnapshot Snapshot() const;
+
+    /**
+     * @brief Renders all metrics in the Prometheus text exposition format.
+     *
+     * Histograms are exported as summaries with quantiles in seconds.
+     */
+    std::string RenderPrometheus() const;
+
+private:
+    template <typename T>
+    struct Entry {
+        std::string name;
+        std::string help;
+        std::string labels;
+        std::unique_ptr<T> metric;
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<Entry<MetricCounter>> counters_;
+    std::vector<Entry<MetricGauge>> gauges_;
+    std::vector<Entry<LatencyHistogram>> histograms_;
+
+    template <typename T>
+    static T& GetOrCreate(std::vector<Entry<T>>& entries, const std::string& name, const std::string& help,
+                          const std::string& labels);
+};
+
+#endif // METRICS_H
@@ -0,0 +1,64 @@
+#ifndef METRICS_HTTP_SERVER_H
+#define METRICS_HTTP_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+class MetricsRegistry;
+
+/**
+ * @class MetricsHttpServer
+ * @brief Minimal HTTP endpoint serving a MetricsRegistry at /metrics for Prometheus.
+ *
+ * One thread accepts and answers connections one at a time with HTTP/1.0 and closes
+ * them; it is meant for a scraper polling every few seconds, not for general traffic.
+ */
+class MetricsHttpServer {
+public:
+    MetricsHttpServer() = default;
+    ~MetricsHttpServer();
+
+    MetricsHttpServer(const MetricsHttpServer&) = delete;
+    MetricsHttpServer& operator=(const MetricsHttpServer&) = delete;
+
+    /**
+     * @brief Binds the listening socket and starts the server thread.
+     * @param registry Metrics to serve; must outlive the server
+     * @param port TCP port (0: any free port, see GetPort())
+     * @param bind_address Local IPv4 address to listen on (loopback by default; any other
+     *        address exposes the unauthenticated endpoint to the network)
+     * @return false if the socket cannot be bound
+     */
+    bool Start(const MetricsRegistry* registry, int port, const std::string& bind_address = "127.0.0.1");
+
+    /**
+     * @brief Stops the server thread and closes the socket.
+     */
+    void Stop();
+
+    bool IsRunning() const { return running_; }
+
+    /**
+     * @brief Port the server listens on.
+     */
+    int GetPort() const { return port_; }
+
+private:
+    const MetricsRegistry* registry_ = nullptr;
+    intptr_t socket_ = -1;           ///< Listening socket (SOCKET on Windows)
+    bool started_ = false;
+    int port_ = 0;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+
+    void ServeLoop();
+
+    /**
+     * @brief Reads one request from a connection and writes the response.
+     */
+    void Serve(intptr_t connection);
+};
+
+#endif // METRICS_HTTP_SERVER_H
@@ -0,0 +1,205 @@
+#ifndef OFFLINE_TRACK_BUILDER_H
+#define OFFLINE_TRACK_BUILDER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "ball_tracker_common.h"
+#include "blob_extractor.h"
+#include "data_association.h"
+#include "kalman_bank.h"
+
+/**
+ * @struct OfflineDetection
+ * @brief A blob of a color model found by the coarse detection of a frame.
+ */
+struct OfflineDetection {
+    cv::Point_<float> center;  ///< Blob centroid (image coordinates)
+    float radius;              ///< Moment radius (pixels)
+};
+
+/**
+ * @struct OfflineFrame
+ * @brief Coarse detections of one frame.
+ */
+struct OfflineFrame {
+    std::vector<OfflineDetection> detections;  ///< Blobs of all color models, grouped by model
+    std::vector<int> model_begin;              ///< First detection of each color model, models + 1 entries
+};
+
+/**
+ * @struct OfflineBallTrack
+ * @brief Trajectory of one ball linked by OfflineTrackBuilder::Link().
+ */
+struct OfflineBallTrack {
+    int id = -1;                             ///< Ball id
+    std::vector<cv::Point_<float>> points;   ///< Detections and bridged gaps, in frame order
+    std::vector<int> frames;                 ///< Frame index of each point
+    int total_frames = 0;                    ///< Frames processed while the ball was recorded
+    int success_frames = 0;                  ///< Frames with a valid detection
+    int filled_frames = 0;                   ///< Missed frames bridged by interpolation
+    int max_consecutive_failures = 0;        ///< Longest run of frames without a valid detection
+    bool lost = false;                       ///< Recording stopped with a success rate below 50%
+};
+
+/**
+ * @class OfflineTrackBuilder
+ * @brief Builds the InitTrack() trajectories of a recorded video in two passes.
+ *
+ * Detect() splits the video into segments that are decoded and searched in parallel,
+ * each with its own decoder. The search of a frame is a global color threshold at
+ * reduced resolution with no tracking state, so the segments are independent.
+ * Link() then walks the detections in frame order once: every ball keeps a Kalman
+ * filter, balls of a color are assigned jointly by Mahalanobis distance like in
+ * TrackerBank::Associate(), and short runs of missed frames are filled by
+ * interpolation. Only Link() is sequential and it touches no pixels.
+ */
+class OfflineTrackBuilder {
+public:
+    explicit OfflineTrackBuilder(const OfflineInitTrackConfig& config = OfflineInitTrackConfig());
+
+    /**
+     * @brief Adds a ball. Balls with the same color range share a color model.
+     * @param id Ball id
+     * @param lower Lower HSV bound
+     * @param upper Upper HSV bound
+     * @param start Position the ball starts from; the first detection closest to it is taken
+     * @return Index of the ball
+     */
+    int AddBall(int id, const cv::Scalar_<double>& lower, const cv::Scalar_<double>& upper,
+                const cv::Point_<float>& start);
+
+    /**
+     * @brief Decodes and detects a video file in parallel segments.
+     *
+     * Containers without frame accurate seeking are decoded as one segment.
+     * @param video_path Video file
+     * @return false if the file cannot be opened or holds no frames
+     */
+    bool Detect(const std::string& video_path);
+
+    /**
+     * @brief Detects frames already in memory, in parallel segments.
+     * @param images BGR frames in order
+     */
+    void Detect(const std::vector<cv::Mat>& images);
+
+    /**
+     * @brief Links the detections of all frames into one trajectory per ball.
+     * @param association Mahalanobis gate and position uncertainty floor of locked balls
+     * @param max_velocity Detections implying a faster motion (pixels per frame) are rejected
+     * @param max_consecutive_failures A ball stops being recorded after this many missed frames
+     */
+    void Link(const AssociationConfig& association, double max_velocity, int max_consecutive_failures);
+
+    int GetFrameCount() const { return static_cast<int>(frames_.size()); }
+    const OfflineFrame& GetFrame(int index) const { return frames_[index]; }
+    cv::Size GetFrameSize() const { return frame_size_; }
+
+    /**
+     * @brief Number of segments used by the last Detect().
+     */
+    int GetSegmentCount() const { return segment_count_; }
+
+    int GetBallCount() const { return static_cast<int>(balls_.size()); }
+    const OfflineBallTrack& GetTrack(int ball) const { return tracks_[ball]; }
+
+private:
+    struct ColorModel {
+        cv::Scalar_<double> lower;
+        cv::Scalar_<double> upper;
+    };
+
+    struct Ball {
+        int id;                   ///< Ball id
+        int model;                ///< Color model index
+        cv::Point_<float> start;  ///< Start position hint
+    };
+
+    struct Segment {
+        int64_t start = 0;                ///< First frame
+        int64_t end = -1;                 ///< First frame of the next segment, -1 for the end of the file
+        std::vector<OfflineFrame> frames;
+        cv::Size frame_size;
+        bool complete = false;            ///< Every frame up to end was decoded
+    };
+
+    /**
+     * @brief Per-thread scratch of the coarse detection.
+     */
+    class FrameDetector {
+    public:
+        explicit FrameDetector(const OfflineTrackBuilder& builder);
+        void Detect(const cv::Mat& image, OfflineFrame& frame);
+
+    private:
+        const OfflineTrackBuilder& builder_;
+        BlobExtractor extractor_;
+        std::vector<Blob> blobs_;
+        cv::Mat small_;
+        cv::Mat hsv_image_;
+        cv::Mat mask_;
+    };
+
+    /**
+     * @brief Linking state of a ball.
+     */
+    struct LinkState {
+        bool started = false;      ///< The ball was detected at least once
+        bool recording = true;     ///< The ball has not exceeded the failure limit
+        int last_frame = -1;       ///< Frame of the last valid detection
+        cv::Point_<float> last;    ///< Position of the last valid detection
+        float radius = 0.0f;       ///< Radius of the last valid detection
+        int misses = 0;            ///< Consecutive frames without a valid detection
+    };
+
+    OfflineInitTrackConfig config_;
+    std::vector<ColorModel> models_;
+    std::vector<Ball> balls_;
+    std::vector<Segment> segments_;
+    int segment_count_ = 0;
+    std::vector<OfflineFrame> frames_;
+    cv::Size frame_size_;
+
+    KalmanBank kalman_;                    ///< One lane per ball
+    AssignmentSolver solver_;
+    std::vector<LinkState> states_;
+    std::vector<OfflineBallTrack> tracks_;
+    std::vector<int> rows_;                ///< Balls of the stage being assigned
+    std::vector<int> cols_;                ///< Detections still free in the stage being assigned
+    std::vector<float> cost_;
+    std::vector<int> row_to_col_;
+    std::vector<uint8_t> taken_;
+    std::vector<int> assigned_;            ///< Detection assigned to each ball in the current frame, -1 if none
+
+    /**
+     * @brief Number of segments for a video of the given length.
+     */
+    int SegmentCount(int64_t frame_count) const;
+
+    /**
+     * @brief Concatenates the segments into frames_, up to the first incomplete one.
+     */
+    void MergeSegments();
+
+    /**
+     * @brief Assigns the free detections of a color model in a frame to its locked or searching balls.
+     */
+    void AssignStage(const OfflineFrame& frame, int model, int frame_index, bool locked,
+                     const AssociationConfig& association, double max_velocity);
+
+    /**
+     * @brief Whether a ball is followed by its Kalman filter rather than searched for.
+     */
+    bool IsLocked(int ball) const;
+
+    /**
+     * @brief Records the detection or the miss of a ball in a frame.
+     */
+    void Record(int ball, int frame_index, const OfflineDetection* detection, int max_consecutive_failures);
+};
+
+#endif // OFFLINE_TRACK_BUILDER_H
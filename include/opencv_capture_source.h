@@ -0,0 +1,46 @@
+#ifndef OPENCV_CAPTURE_SOURCE_H
+#define OPENCV_CAPTURE_SOURCE_H
+
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+#include "frame_source.h"
+
+/**
+ * @class OpenCVCaptureSource
+ * @brief Frame source for UVC / USB cameras opened through cv::VideoCapture.
+ */
+class OpenCVCaptureSource final : public IFrameSource {
+public:
+    OpenCVCaptureSource();
+    ~OpenCVCaptureSource() override;
+
+    /**
+     * @brief Opens the camera.
+     * @param source Camera device ID as a decimal string
+     * @param width Desired image width (-1 for default)
+     * @param height Desired image height (-1 for default)
+     * @param fps Desired frame rate (-1 for default)
+     * @return true if the camera was opened with the requested settings
+     */
+    bool Open(const std::string& source, int width, int height, int fps) override;
+    void Close() override;
+    bool IsOpen() const override { return cap_.isOpened(); }
+    bool Read(RawFrame& frame) override;
+    CaptureStatus GetReadStatus() const override;
+    FrameSourceCaps GetCaps() const override;
+    CameraSourceType GetType() const override { return CameraSourceType::USB_CAMERA; }
+    int GetWidth() const override { return width_; }
+    int GetHeight() const override { return height_; }
+    int GetFps() const override { return fps_; }
+
+private:
+    cv::VideoCapture cap_;
+    int width_;
+    int height_;
+    int fps_;
+    uint64_t frame_id_;
+};
+
+#endif // OPENCV_CAPTURE_SOURCE_H
@@ -0,0 +1,87 @@
+#ifndef PIXEL_TO_ARM_MAP_H
+#define PIXEL_TO_ARM_MAP_H
+
+#include <string>
+#include <vector>
+
+#include "ball_tracker_common.h"
+
+/**
+ * @class PixelToArmMap
+ * @brief Maps tracked image points and velocities to robot arm coordinates.
+ *
+ * The lens distortion is inverted once per node of a coarse pixel grid; a point is
+ * then undistorted by bilinear interpolation between the four surrounding nodes and
+ * its viewing ray is intersected with the horizontal plane at the ball height. Only
+ * tracked points are mapped, so no image is ever undistorted or remapped.
+ */
+class PixelToArmMap {
+public:
+    /**
+     * @brief Reads a calibration file.
+     *
+     * The file is JSON with "image_size" [w, h], "camera_matrix" (3x3 row-major),
+     * "distortion" [k1, k2, p1, p2, k3], and optionally "rotation" (3x3 row-major,
+     * camera to arm), "camera_position" [x, y] and "grid_step".
+     * @param path Calibration file path
+     * @param calibration Output calibration
+     * @return false if the file cannot be read or misses a required entry
+     */
+    static bool LoadCalibration(const std::string& path, CameraCalibration& calibration);
+
+    /**
+     * @brief Precomputes the undistortion grid.
+     * @param calibration Camera calibration
+     * @return false if the calibration is incomplete
+     */
+    bool Build(const CameraCalibration& calibration);
+
+    /**
+     * @brief Sets the height of the optical center above the ground.
+     */
+    void SetCameraHeight(double height) { camera_height_ = height; }
+
+    bool Empty() const { return grid_.empty(); }
+
+    /**
+     * @brief Undistorted normalized image coordinates of a pixel, interpolated from the grid.
+     * @param u Pixel column
+     * @param v Pixel row
+     * @param x Output normalized x ((u - cx) / fx without distortion)
+     * @param y Output normalized y
+     */
+    void Undistort(double u, double v, double& x, double& y) const;
+
+    /**
+     * @brief Arm coordinates of a pixel on the horizontal plane at a height.
+     * @param u Pixel column
+     * @param v Pixel row
+     * @param height Height of the plane above the ground
+     * @param x Output arm X
+     * @param y Output arm Y
+     * @return false if the map is empty or the ray does not reach the plane in front of the camera
+     */
+    bool ToArm(double u, double v, double height, double& x, double& y) const;
+
+    /**
+     * @brief Arm velocity of a point moving in the image, by a central difference over one time step.
+     * @param u Pixel column
+     * @param v Pixel row
+     * @param vu Image velocity along u (pixels per time step)
+     * @param vv Image velocity along v (pixels per time step)
+     * @param height Height of the plane above the ground
+     * @param vx Output arm velocity along X (per time step)
+     * @param vy Output arm velocity along Y (per time step)
+     * @return false if either end point cannot be mapped
+     */
+    bool VelocityToArm(double u, double v, double vu, double vv, double height, double& vx, double& vy) const;
+
+private:
+    CameraCalibration calibration_;
+    double camera_height_ = 0.0;
+    int grid_cols_ = 0;
+    int grid_rows_ = 0;
+    std::vector<float> grid_;   ///< Undistorted normalized (x, y) per grid node, row-major
+};
+
+#endif // PIXEL_TO_ARM_MAP_H
@@ -0,0 +1,81 @@
+#ifndef PLAYBACK_PACER_H
+#define PLAYBACK_PACER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @enum ReplayPacing
+ * @brief How fast a file-backed frame source hands out frames.
+ */
+enum class ReplayPacing {
+    MAX_SPEED,  ///< Return frames as fast as they are decoded (offline processing)
+    REAL_TIME,  ///< Pace frames by their media timestamps (latency testing)
+    STEP        ///< Return a frame only for every frame granted through Step()
+};
+
+constexpr int kPlaybackStepWaitMs = 100;  ///< How long a read waits for a Step() grant before returning no frame
+
+/**
+ * @class PlaybackPacer
+ * @brief Pacing shared by the file-backed frame sources.
+ *
+ * The reading thread calls AcquireStep() before and WaitUntil() after fetching a
+ * frame; Step() and SetPacing() may be called from any thread.
+ */
+class PlaybackPacer {
+public:
+    PlaybackPacer();
+
+    /**
+     * @brief Sets the pacing mode and restarts the timing reference.
+     */
+    void SetPacing(ReplayPacing pacing);
+    ReplayPacing GetPacing() const;
+
+    /**
+     * @brief Grants frames in ReplayPacing::STEP mode.
+     * @param frames Number of frames the reader may fetch
+     */
+    void Step(int frames = 1);
+
+    /**
+     * @brief Waits for a granted frame in STEP mode; returns immediately in the other modes.
+     * @param timeout_ms Maximum wait
+     * @return true if the reader may fetch a frame
+     */
+    bool AcquireStep(int timeout_ms);
+
+    /**
+     * @brief Wakes a reader blocked in AcquireStep() and drops pending grants.
+     */
+    void Cancel();
+
+    /**
+     * @brief Restarts the timing reference, e.g. after a seek.
+     */
+    void Reset();
+
+    /**
+     * @brief In REAL_TIME mode, sleeps until the wall time matching a media timestamp.
+     *
+     * The first frame after a reset sets the reference and is returned immediately.
+     * @param media_time_ns Media timestamp of the frame
+     * @return How late the frame is in ns (0 when on time or not in REAL_TIME mode)
+     */
+    int64_t WaitUntil(int64_t media_time_ns);
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable step_cv_;
+    ReplayPacing pacing_;
+    int step_credits_;
+    uint64_t cancel_count_;
+    bool started_;                                      ///< Timing reference has been set
+    std::chrono::steady_clock::time_point wall_start_;  ///< Wall time of the reference frame
+    int64_t media_start_ns_;                            ///< Media timestamp of the reference frame
+};
+
+#endif // PLAYBACK_PACER_H
@@ -0,0 +1,175 @@
+#ifndef RAW_RECORDING_H
+#define RAW_RECORDING_H
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "frame_source.h"
+
+/**
+ * Raw recording container (.btraw)
+ *
+ *   [RawRecordingHeader, padded to header_size]
+ *   [slot 0][slot 1]...[slot N-1]
+ *
+ * Every slot is frame_stride bytes: a RawFrameRecord followed by the tightly
+ * packed pixel rows and zero padding. header_size and frame_stride are multiples
+ * of kRawRecordingAlignment so that slots can be mapped and written page-aligned.
+ */
+
+constexpr char kRawRecordingMagic[8] = {'B', 'T', 'R', 'A', 'W', '0', '0', '1'};
+constexpr uint32_t kRawRecordingVersion = 1;
+constexpr uint32_t kRawRecordingAlignment = 4096;
+
+/**
+ * @struct RawRecordingHeader
+ * @brief File header of a raw recording. All fields are little-endian.
+ */
+struct RawRecordingHeader {
+    char magic[8];             ///< kRawRecordingMagic
+    uint32_t version;          ///< kRawRecordingVersion
+    uint32_t header_size;      ///< Bytes before the first frame slot
+    uint32_t width;            ///< Frame width in pixels
+    uint32_t height;           ///< Frame height in pixels
+    uint32_t pixel_format;     ///< PixelFormat of the stored frames
+    uint32_t bytes_per_line;   ///< Bytes per stored pixel row
+    uint64_t frame_data_size;  ///< Bytes of pixel data per frame
+    uint64_t frame_stride;     ///< Bytes per frame slot
+    uint64_t frame_count;      ///< Frames before the first failed write, written on close (0 if the writer crashed)
+    double fps;                ///< Nominal frame rate of the source
+    int64_t start_time_ns;     ///< Wall clock time the recording started, in ns since the epoch
+    uint32_t source_type;      ///< CameraSourceType of the recorded source
+    uint32_t reserved;
+    char vendor_name[32];      ///< Camera metadata, zero terminated
+    char model_name[32];
+    char serial_number[32];
+};
+
+/**
+ * @struct RawFrameRecord
+ * @brief Per-frame metadata stored at the start of every slot.
+ */
+struct RawFrameRecord {
+    uint64_t frame_id;         ///< Frame counter of the source
+    int64_t timestamp_ns;      ///< Capture time on the steady clock, in ns
+    uint64_t index;            ///< Slot index in the file
+    uint32_t flags;            ///< Reserved for per-frame flags
+    uint32_t reserved[9];
+};
+
+static_assert(sizeof(RawRecordingHeader) <= kRawRecordingAlignment, "header must fit in one page");
+static_assert(sizeof(RawFrameRecord) == 64, "frame record must be 64 bytes");
+
+/**
+ * @struct RawRecordingInfo
+ * @brief Stream description passed to RawRecordingWriter::Open().
+ */
+struct RawRecordingInfo {
+    int width = 0;
+    int height = 0;
+    PixelFormat pixel_format = PixelFormat::UNKNOWN;
+    double fps = 0.0;
+    CameraSourceType source_type = CameraSourceType::HUARUI_CAMERA;
+    std::string vendor_name;
+    std::string model_name;
+    std::string serial_number;
+};
+
+/**
+ * @brief Builds the file header for a stream.
+ * @param info Stream description
+ * @param header Output header
+ * @return false if the stream geometry or pixel format is invalid
+ */
+bool MakeRawRecordingHeader(const RawRecordingInfo& info, RawRecordingHeader& header);
+
+/**
+ * @class RawRecordingWriter
+ * @brief Writes frames sequentially into a raw recording.
+ */
+class RawRecordingWriter {
+public:
+    RawRecordingWriter();
+    ~RawRecordingWriter();
+
+    /**
+     * @brief Creates the file and writes the header.
+     * @param path Output file path
+     * @param info Stream description
+     * @return true if the file was created
+     */
+    bool Open(const std::string& path, const RawRecordingInfo& info);
+
+    /**
+     * @brief Appends a frame. The frame must match the stream geometry and format.
+     * @param frame Frame to append
+     * @return true if the frame was written
+     */
+    bool Write(const RawFrame& frame);
+
+    /**
+     * @brief Writes the final frame count and closes the file.
+     */
+    void Close();
+
+    bool IsOpen() const { return file_.is_open(); }
+    uint64_t GetFrameCount() const { return header_.frame_count; }
+    const RawRecordingHeader& GetHeader() const { return header_; }
+
+private:
+    std::ofstream file_;
+    RawRecordingHeader header_;
+    std::vector<char> padding_;   ///< Zero bytes used to pad every slot
+};
+
+/**
+ * @class RawRecordingReader
+ * @brief Memory-maps a raw recording and hands out zero-copy frames by index.
+ */
+class RawRecordingReader {
+public:
+    RawRecordingReader();
+    ~RawRecordingReader();
+
+    RawRecordingReader(const RawRecordingReader&) = delete;
+    RawRecordingReader& operator=(const RawRecordingReader&) = delete;
+
+    /**
+     * @brief Maps a recording.
+     * @param path Recording file path
+     * @return true if the file is a valid recording
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * @brief Unmaps the recording. Frames handed out become invalid.
+     */
+    void Close();
+
+    bool IsOpen() const;
+    const RawRecordingHeader& GetHeader() const { return header_; }
+
+    /**
+     * @brief Number of complete frames, recovered from the file size when the writer did not close cleanly.
+     */
+    uint64_t GetFrameCount() const { return frame_count_; }
+
+    /**
+     * @brief Gets a frame by index.
+     * @param index Frame index in [0, GetFrameCount())
+     * @param frame Output frame; image is a read-only view into the mapping
+     * @return true if the index is valid
+     */
+    bool GetFrame(uint64_t index, RawFrame& frame) const;
+
+private:
+    struct Mapping;
+    std::unique_ptr<Mapping> mapping_;
+    RawRecordingHeader header_;
+    uint64_t frame_count_;
+};
+
+#endif // RAW_RECORDING_H
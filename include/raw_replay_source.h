@@ -0,0 +1,80 @@
+#ifndef RAW_REPLAY_SOURCE_H
+#define RAW_REPLAY_SOURCE_H
+
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+#include "frame_source.h"
+#include "playback_pacer.h"
+#include "raw_recording.h"
+
+/**
+ * @class RawReplaySource
+ * @brief Replays a raw recording (see raw_recording.h) through a memory mapping.
+ *
+ * Frames are zero-copy, read-only views into the mapped file and keep their
+ * recorded frame ids and timestamps, so a replay is bit-exact.
+ */
+class RawReplaySource final : public IFrameSource {
+public:
+    RawReplaySource();
+    ~RawReplaySource() override;
+
+    /**
+     * @brief Sets the playback pacing. May be changed while open.
+     */
+    void SetPacing(ReplayPacing pacing) { pacer_.SetPacing(pacing); }
+
+    /**
+     * @brief Grants frames in ReplayPacing::STEP mode. May be called from any thread.
+     */
+    void Step(int frames = 1) { pacer_.Step(frames); }
+
+    /**
+     * @brief Opens a raw recording.
+     * @param source Path to the recording
+     * @param width Expected frame width (-1 to accept any)
+     * @param height Expected frame height (-1 to accept any)
+     * @param fps Ignored, the recorded frame rate is reported by GetFps()
+     * @return true if the recording was opened
+     */
+    bool Open(const std::string& source, int width, int height, int fps) override;
+    void Close() override;
+    bool IsOpen() const override { return reader_.IsOpen(); }
+    bool Read(RawFrame& frame) override;
+    bool IsEndOfStream() const override { return IsOpen() && next_index_ >= reader_.GetFrameCount(); }
+    FrameSourceCaps GetCaps() const override;
+    CameraSourceType GetType() const override { return CameraSourceType::RAW_REPLAY; }
+    int GetWidth() const override { return static_cast<int>(reader_.GetHeader().width); }
+    int GetHeight() const override { return static_cast<int>(reader_.GetHeader().height); }
+    int GetFps() const override { return static_cast<int>(reader_.GetHeader().fps); }
+
+    /**
+     * @brief Number of frames in the recording.
+     */
+    uint64_t GetFrameCount() const { return reader_.GetFrameCount(); }
+
+    /**
+     * @brief Moves the read position. The next Read() returns frame index.
+     * @return false if index is out of range
+     */
+    bool Seek(uint64_t index);
+
+    /**
+     * @brief Random access to a frame without moving the read position or pacing.
+     */
+    bool ReadFrame(uint64_t index, RawFrame& frame) const { return reader_.GetFrame(index, frame); }
+
+    /**
+     * @brief Gets the recording header (camera metadata, geometry).
+     */
+    const RawRecordingHeader& GetHeader() const { return reader_.GetHeader(); }
+
+private:
+    RawRecordingReader reader_;
+    PlaybackPacer pacer_;
+    uint64_t next_index_;
+};
+
+#endif // RAW_REPLAY_SOURCE_H
@@ -0,0 +1,230 @@
+#ifndef ROI_RECORDING_H
+#define ROI_RECORDING_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+struct BallTrackerSnapshot;
+
+/**
+ * ROI recording container (.btroi)
+ *
+ *   [RoiRecordingHeader]
+ *   [RoiFrameHeader][RoiBallRecord + BGR patch] * num_balls [BGR full frame]   (one per frame)
+ *   ...
+ *   [uint64 offset of every frame record]                                     (index, written on close)
+ *
+ * The index offset is patched into the header on close. A file whose recorder did
+ * not close cleanly is indexed by scanning the frame records.
+ */
+
+constexpr char kRoiRecordingMagic[8] = {'B', 'T', 'R', 'O', 'I', '0', '0', '1'};
+constexpr uint32_t kRoiRecordingVersion = 1;
+constexpr uint32_t kRoiFrameMagic = 0x46494F52;  // "ROIF"
+
+/**
+ * @struct RoiRecordingHeader
+ * @brief File header of an ROI recording.
+ */
+struct RoiRecordingHeader {
+    char magic[8];                 ///< kRoiRecordingMagic
+    uint32_t version;              ///< kRoiRecordingVersion
+    uint32_t frame_width;          ///< Width of the tracked frames
+    uint32_t frame_height;         ///< Height of the tracked frames
+    uint32_t full_frame_interval;  ///< A full frame is stored every this many frames (0: only on lost events)
+    int64_t start_time_ns;         ///< Wall clock time the recording started, in ns since the epoch
+    uint64_t index_offset;         ///< File offset of the frame index, 0 if the recorder did not close
+    uint64_t frame_count;          ///< Frames in the index
+};
+
+/**
+ * @enum RoiFrameFlags
+ * @brief Flags of a frame record.
+ */
+enum RoiFrameFlags : uint32_t {
+    ROI_FRAME_HAS_FULL_FRAME = 1u << 0,  ///< A BGR full frame follows the ball records
+    ROI_FRAME_LOST_EVENT = 1u << 1,      ///< At least one ball was lost in this frame
+};
+
+/**
+ * @struct RoiFrameHeader
+ * @brief Header of one frame record.
+ */
+struct RoiFrameHeader {
+    uint32_t magic;            ///< kRoiFrameMagic
+    uint32_t num_balls;        ///< Ball records that follow
+    uint64_t frame_index;      ///< Frame counter of the tracking loop
+    int64_t timestamp_ns;      ///< Capture time on the steady clock, in ns
+    uint32_t flags;            ///< RoiFrameFlags
+    uint32_t reserved;
+    uint64_t record_size;      ///< Bytes of this record including this header
+};
+
+/**
+ * @struct RoiBallRecord
+ * @brief Tracker state of one ball, followed by patch_bytes of BGR patch pixels.
+ */
+struct RoiBallRecord {
+    int32_t id;
+    int32_t roi_x, roi_y, roi_width, roi_height;  ///< Searched ROI; the patch covers this rectangle
+    uint32_t detected;
+    float center_x, center_y, radius;
+    float hsv[3];
+    float state[4];            ///< Kalman state x, y, vx, vy
+    float covariance[4];       ///< Diagonal of the Kalman error covariance
+    uint32_t patch_bytes;      ///< 0 when the patch was too large to store
+};
+
+/**
+ * @struct RoiRecordingOptions
+ * @brief Options of RoiRecorder.
+ */
+struct RoiRecordingOptions {
+    int full_frame_interval = 300;         ///< Store a full frame every K frames (0: only on lost events)
+    bool full_frame_on_lost = true;        ///< Store a full frame when a ball goes from detected to lost
+    int max_patch_pixels = 256 * 256;      ///< Larger ROIs are recorded without pixels
+    size_t max_queued_bytes = 256u << 20;  ///< Records beyond this backlog are dropped
+};
+
+/**
+ * @struct RoiRecordedFrame
+ * @brief A frame record read back from an ROI recording.
+ */
+struct RoiRecordedFrame {
+    RoiFrameHeader header;
+    std::vector<RoiBallRecord> balls;
+    std::vector<cv::Mat> patches;   ///< BGR patch of each ball, empty when not stored
+    cv::Mat full_frame;             ///< BGR full frame, empty when not stored
+};
+
+/**
+ * @class RoiRecorder
+ * @brief Records per-ball ROI patches and tracker state from the tracking pipeline.
+ *
+ * RecordFrame() serializes into a recycled buffer on the calling thread and hands it
+ * to a writer thread; the backlog is bounded and overflowing records are dropped.
+ */
+class RoiRecorder {
+public:
+    RoiRecorder();
+    ~RoiRecorder();
+
+    RoiRecorder(const RoiRecorder&) = delete;
+    RoiRecorder& operator=(const RoiRecorder&) = delete;
+
+    /**
+     * @brief Creates the recording and starts the writer thread.
+     * @param path Output file path
+     * @param frame_width Width of the tracked frames
+     * @param frame_height Height of the tracked frames
+     * @param options Recording options
+     * @return true if the file was created
+     */
+    bool Open(const std::string& path, int frame_width, int frame_height,
+              const RoiRecordingOptions& options = RoiRecordingOptions());
+
+    /**
+     * @brief Records one tracked frame.
+     * @param frame_index Frame counter of the tracking loop
+     * @param timestamp_ns Capture time on the steady clock
+     * @param frame BGR frame the trackers were updated with
+     * @param snapshots Tracker state after the update
+     * @return true if the record was queued, false if it was dropped
+     */
+    bool RecordFrame(uint64_t frame_index, int64_t timestamp_ns, const cv::Mat& frame,
+                     const std::vector<BallTrackerSnapshot>& snapshots);
+
+    /**
+     * @brief Drains the backlog, writes the index and closes the file.
+     */
+    void Close();
+
+    bool IsOpen() const { return is_open_; }
+    uint64_t GetRecordedFrames() const { return recorded_frames_; }
+    uint64_t GetDroppedFrames() const { return dropped_frames_; }
+    uint64_t GetBytesWritten() const { return bytes_written_; }
+
+private:
+    std::ofstream file_;
+    RoiRecordingHeader header_;
+    RoiRecordingOptions options_;
+    bool is_open_;
+    std::vector<uint64_t> frame_offsets_;       ///< Index, owned by the writer thread
+    std::vector<bool> last_detected_;           ///< Per-ball detection state of the previous frame
+    uint64_t frames_seen_;
+
+    std::deque<std::vector<char>> queue_;       ///< Serialized records waiting for the writer
+    std::vector<std::vector<char>> free_buffers_;  ///< Recycled record buffers
+    size_t queued_bytes_;
+    bool stop_;
+    std::mutex mutex_;
+    std::condition_variable queue_cv_;
+    std::thread writer_thread_;
+
+    std::atomic<uint64_t> recorded_frames_;
+    std::atomic<uint64_t> dropped_frames_;
+    std::atomic<uint64_t> bytes_written_;
+
+    void WriterThread();
+};
+
+/**
+ * @class RoiReplay
+ * @brief Reads an ROI recording and rebuilds tracker input frames from it.
+ */
+class RoiReplay {
+public:
+    RoiReplay();
+
+    /**
+     * @brief Opens a recording and builds its frame index.
+     * @param path Recording file path
+     * @return true if the file is a valid ROI recording
+     */
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return file_.is_open(); }
+
+    const RoiRecordingHeader& GetHeader() const { return header_; }
+    uint64_t GetFrameCount() const { return offsets_.size(); }
+
+    /**
+     * @brief Reads a frame record.
+     * @param index Frame index in [0, GetFrameCount())
+     * @param frame Output record
+     * @return true on success
+     */
+    bool ReadFrame(uint64_t index, RoiRecordedFrame& frame);
+
+    /**
+     * @brief Rebuilds a full-size BGR frame for BallTracker::UpdateWithImage().
+     *
+     * The most recent stored full frame (or black) is used as background and the
+     * ball patches of this record are pasted at their recorded ROIs. Frames must be
+     * composed in increasing order for the background to be up to date.
+     * @param index Frame index in [0, GetFrameCount())
+     * @param image Output BGR frame
+     * @return true on success
+     */
+    bool ComposeFrame(uint64_t index, cv::Mat& image);
+
+private:
+    std::ifstream file_;
+    RoiRecordingHeader header_;
+    std::vector<uint64_t> offsets_;
+    RoiRecordedFrame scratch_;
+    cv::Mat background_;
+
+    bool ScanFrames(uint64_t file_size);
+};
+
+#endif // ROI_RECORDING_H
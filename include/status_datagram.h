@@ -0,0 +1,308 @@
+#ifndef STATUS_DATAGRAM_H
+#define STATUS_DATAGRAM_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Status datagram (UDP, little-endian, fixed layout)
+ *
+ *   [StatusDatagramHeader][StatusDatagramBall] * ball_count
+ *
+ * The balls of one tracked frame are batched into as few datagrams as the per
+ * datagram limit allows; part and part_count number the datagrams of a frame.
+ * sequence counts datagrams, so a gap in it is a lost datagram. Timestamps are
+ * on the sender's steady clock; one-way latency is only meaningful when the
+ * receiver shares that clock (same host) or synchronizes to it.
+ *
+ * This header is self-contained so that receivers only need it and the system
+ * socket library, not the tracker library.
+ */
+
+constexpr uint32_t kStatusDatagramMagic = 0x44555442;  // "BTUD"
+constexpr uint16_t kStatusDatagramVersion = 1;
+constexpr int kStatusDatagramMaxBalls = 44;            ///< Balls that fit a 1500 byte MTU
+
+/**
+ * @enum StatusDatagramFlags
+ * @brief Flags of a ball in a datagram.
+ */
+enum StatusDatagramFlags : uint16_t {
+    STATUS_BALL_DETECTED = 1u << 0,  ///< Detected in this frame
+    STATUS_BALL_DEFERRED = 1u << 1,  ///< Update deferred past the frame deadline
+};
+
+/**
+ * @struct StatusDatagramHeader
+ * @brief Header of a status datagram.
+ */
+struct StatusDatagramHeader {
+    uint32_t magic;          ///< kStatusDatagramMagic
+    uint16_t version;        ///< kStatusDatagramVersion
+    uint16_t ball_count;     ///< Ball records that follow
+    uint64_t sequence;       ///< Datagram counter of the sender, starting at 1
+    uint64_t frame_index;    ///< Frame counter of the tracking loop
+    int64_t capture_ns;      ///< Capture time of the frame on the sender's steady clock
+    int64_t publish_ns;      ///< Send time of this datagram on the sender's steady clock
+    uint16_t part;           ///< Index of this datagram among those of the frame
+    uint16_t part_count;     ///< Datagrams carrying the frame
+    uint32_t reserved;
+};
+
+/**
+ * @struct StatusDatagramBall
+ * @brief Status of one ball.
+ */
+struct StatusDatagramBall {
+    int32_t id;
+    uint16_t flags;          ///< StatusDatagramFlags
+    uint16_t reserved;
+    float x, y;              ///< Image position (pixels)
+    float vx, vy;            ///< Image velocity (pixels per frame)
+    float progress;          ///< Progress along the track, 0 to 1
+    float reserved2;
+};
+
+static_assert(sizeof(StatusDatagramHeader) == 48, "Status datagram header layout changed");
+static_assert(sizeof(StatusDatagramBall) == 32, "Status datagram ball layout changed");
+
+constexpr size_t kStatusDatagramMaxSize = sizeof(StatusDatagramHeader) + kStatusDatagramMaxBalls * sizeof(StatusDatagramBall);
+
+/**
+ * @struct StatusDatagram
+ * @brief A received datagram and its arrival time.
+ */
+struct StatusDatagram {
+    StatusDatagramHeader header;
+    StatusDatagramBall balls[kStatusDatagramMaxBalls];
+    int64_t receive_ns;      ///< Arrival time on the receiver's steady clock
+};
+
+/**
+ * @brief Validates and copies a received datagram.
+ * @param data Datagram bytes
+ * @param size Datagram size
+ * @param datagram Output datagram; receive_ns is not touched
+ * @return false if the bytes are not a complete status datagram
+ */
+inline bool ParseStatusDatagram(const void* data, size_t size, StatusDatagram& datagram) {
+    if (size < sizeof(StatusDatagramHeader)) {
+        return false;
+    }
+    std::memcpy(&datagram.header, data, sizeof(StatusDatagramHeader));
+    const StatusDatagramHeader& header = datagram.header;
+    if (header.magic != kStatusDatagramMagic || header.version != kStatusDatagramVersion ||
+        header.ball_count > kStatusDatagramMaxBalls ||
+        size != sizeof(StatusDatagramHeader) + header.ball_count * sizeof(StatusDatagramBall)) {
+        return false;
+    }
+    std::memcpy(datagram.balls, static_cast<const char*>(data) + sizeof(StatusDatagramHeader),
+                header.ball_count * sizeof(StatusDatagramBall));
+    return true;
+}
+
+#ifdef _WIN32
+using StatusSocket = SOCKET;
+constexpr StatusSocket kInvalidStatusSocket = INVALID_SOCKET;
+#else
+using StatusSocket = int;
+constexpr StatusSocket kInvalidStatusSocket = -1;
+#endif
+
+/**
+ * @brief Initializes the socket library of the platform; pair with StatusSocketCleanup().
+ */
+inline bool StatusSocketStartup() {
+#ifdef _WIN32
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+#else
+    return true;
+#endif
+}
+
+inline void StatusSocketCleanup() {
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+inline void CloseStatusSocket(StatusSocket socket) {
+#ifdef _WIN32
+    closesocket(socket);
+#else
+    close(socket);
+#endif
+}
+
+/**
+ * @class UdpStatusReceiver
+ * @brief Reference receiver of status datagrams with loss and latency accounting.
+ */
+class UdpStatusReceiver {
+public:
+    UdpStatusReceiver() = default;
+    ~UdpStatusReceiver() { Close(); }
+    UdpStatusReceiver(const UdpStatusReceiver&) = delete;
+    UdpStatusReceiver& operator=(const UdpStatusReceiver&) = delete;
+
+    /**
+     * @brief Binds the receiving socket.
+     * @param port UDP port (0: any free port, see GetPort())
+     * @param multicast_group Multicast group to join (empty: unicast)
+     * @param interface_address Local interface of the group (empty: system default)
+     * @return false if the socket cannot be bound or the group joined
+     */
+    bool Open(uint16_t port, const std::string& multicast_group = "", const std::string& interface_address = "") {
+        Close();
+        if (!StatusSocketStartup()) {
+            return false;
+        }
+        started_ = true;
+        socket_ = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (socket_ == kInvalidStatusSocket) {
+            Close();
+            return false;
+        }
+        int reuse = 1;
+        setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        if (bind(socket_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            Close();
+            return false;
+        }
+        if (!multicast_group.empty()) {
+            ip_mreq request{};
+            if (inet_pton(AF_INET, multicast_group.c_str(), &request.imr_multiaddr) != 1) {
+                Close();
+                return false;
+            }
+            request.imr_interface.s_addr = htonl(INADDR_ANY);
+            if (!interface_address.empty() && inet_pton(AF_INET, interface_address.c_str(), &request.imr_interface) != 1) {
+                Close();
+                return false;
+            }
+            if (setsockopt(socket_, IPPROTO_IP, IP_ADD_MEMBERSHIP, reinterpret_cast<const char*>(&request),
+                           sizeof(request)) != 0) {
+                Close();
+                return false;
+            }
+        }
+        received_ = 0;
+        lost_ = 0;
+        last_sequence_ = 0;
+        return true;
+    }
+
+    void Close() {
+        if (socket_ != kInvalidStatusSocket) {
+            CloseStatusSocket(socket_);
+            socket_ = kInvalidStatusSocket;
+        }
+        if (started_) {
+            StatusSocketCleanup();
+            started_ = false;
+        }
+    }
+
+    bool IsOpen() const { return socket_ != kInvalidStatusSocket; }
+
+    /**
+     * @brief Port the socket is bound to, e.g. after Open(0).
+     */
+    uint16_t GetPort() const {
+        sockaddr_in address{};
+        socklen_t length = sizeof(address);
+        if (!IsOpen() || getsockname(socket_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+            return 0;
+        }
+        return ntohs(address.sin_port);
+    }
+
+    /**
+     * @brief Waits for the next valid datagram; invalid datagrams are skipped.
+     * @param datagram Output datagram, stamped with its arrival time
+     * @param timeout_ms Wait limit in milliseconds
+     * @return false on timeout or socket error
+     */
+    bool Receive(StatusDatagram& datagram, int timeout_ms) {
+        char buffer[kStatusDatagramMaxSize + 1];
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        while (IsOpen()) {
+            auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining < 0) {
+                return false;
+            }
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(socket_, &readable);
+            timeval timeout;
+            timeout.tv_sec = static_cast<long>(remaining / 1000000);
+            timeout.tv_usec = static_cast<long>(remaining % 1000000);
+            int ready = select(static_cast<int>(socket_ + 1), &readable, nullptr, nullptr, &timeout);
+            if (ready <= 0) {
+                return false;
+            }
+            int size = static_cast<int>(recv(socket_, buffer, sizeof(buffer), 0));
+            int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            if (size < 0) {
+                return false;
+            }
+            if (!ParseStatusDatagram(buffer, static_cast<size_t>(size), datagram)) {
+                continue;
+            }
+            datagram.receive_ns = now_ns;
+
+            // 序号跳跃即丢包；序号回退视为发送端重启
+            uint64_t sequence = datagram.header.sequence;
+            if (last_sequence_ != 0 && sequence > last_sequence_ + 1) {
+                lost_ += sequence - last_sequence_ - 1;
+            }
+            last_sequence_ = sequence;
+            received_++;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Valid datagrams received since Open().
+     */
+    uint64_t Received() const { return received_; }
+
+    /**
+     * @brief Datagrams missing from the sequence since Open().
+     */
+    uint64_t Lost() const { return lost_; }
+
+private:
+    StatusSocket socket_ = kInvalidStatusSocket;
+    bool started_ = false;
+    uint64_t received_ = 0;
+    uint64_t lost_ = 0;
+    uint64_t last_sequence_ = 0;
+};
+
+#endif // STATUS_DATAGRAM_H
@@ -0,0 +1,241 @@
+#ifndef STATUS_RING_H
+#define STATUS_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Shared-memory status ring (POSIX shm object, e.g. "/ball_tracker_status")
+ *
+ *   [StatusRingHeader][StatusRingSlot] * slot_count
+ *
+ * One writer, the tracking loop, publishes a StatusFrame per processed frame into
+ * slot (sequence - 1) % slot_count. Each slot is a sequence lock: its sequence is
+ * kStatusRingWriting while the frame is being written and equals the frame
+ * sequence once it is complete. Readers map the object read-only and never write
+ * to it, so any number of processes can read without syscalls or coordination.
+ * Timestamps are on the steady clock (CLOCK_MONOTONIC), which all processes of a
+ * host share.
+ *
+ * This header is self-contained so that consumers only need it and the system
+ * library, not the tracker library.
+ */
+
+constexpr uint64_t kStatusRingMagic = 0x474E495254535442ull;  // "BTSTRING"
+constexpr uint32_t kStatusRingVersion = 1;
+constexpr int kStatusRingMaxBalls = 16;
+constexpr size_t kStatusRingCacheLine = 64;
+constexpr uint64_t kStatusRingWriting = ~0ull;  ///< Slot sequence while its frame is being written
+
+/**
+ * @struct StatusRingBall
+ * @brief Status of one ball in a frame.
+ */
+struct StatusRingBall {
+    int32_t id;
+    uint8_t detected;     ///< Detected in this frame
+    uint8_t deferred;     ///< Update deferred past the frame deadline
+    uint8_t reserved[2];
+    float x, y;           ///< Image position (pixels)
+    float vx, vy;         ///< Image velocity (pixels per frame)
+    float progress;       ///< Progress along the track, 0 to 1
+    float reserved2;
+};
+
+/**
+ * @struct StatusFrame
+ * @brief Status of all tracked balls in one frame.
+ */
+struct StatusFrame {
+    uint64_t sequence;        ///< Publish count, starting at 1
+    uint64_t frame_index;     ///< Frame counter of the tracking loop
+    int64_t capture_ns;       ///< Capture time on the steady clock
+    int64_t publish_ns;       ///< Publish time on the steady clock
+    uint32_t ball_count;      ///< Valid entries of balls
+    uint32_t reserved[7];
+    StatusRingBall balls[kStatusRingMaxBalls];
+};
+
+/**
+ * @struct StatusRingSlot
+ * @brief A frame and its sequence lock, padded to whole cache lines.
+ */
+struct alignas(kStatusRingCacheLine) StatusRingSlot {
+    std::atomic<uint64_t> sequence;  ///< kStatusRingWriting while written, else the sequence of frame
+    StatusFrame frame;
+};
+
+/**
+ * @struct StatusRingHeader
+ * @brief Ring geometry and the publish counter, each on its own cache line.
+ */
+struct alignas(kStatusRingCacheLine) StatusRingHeader {
+    uint64_t magic;                                         ///< kStatusRingMagic
+    uint32_t version;                                       ///< kStatusRingVersion
+    uint32_t slot_count;                                    ///< Slots in the ring
+    uint32_t slot_size;                                     ///< sizeof(StatusRingSlot)
+    uint32_t max_balls;                                     ///< kStatusRingMaxBalls
+    alignas(kStatusRingCacheLine) std::atomic<uint64_t> published;  ///< Sequence of the last complete frame
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "The status ring needs lock-free 64-bit atomics");
+static_assert(sizeof(StatusRingSlot) % kStatusRingCacheLine == 0, "Slots must fill whole cache lines");
+
+/**
+ * @brief Bytes of a ring with the given number of slots.
+ */
+inline size_t StatusRingSize(uint32_t slot_count) {
+    return sizeof(StatusRingHeader) + static_cast<size_t>(slot_count) * sizeof(StatusRingSlot);
+}
+
+/**
+ * @class StatusRingReader
+ * @brief Read-only view of a status ring published by another process.
+ */
+class StatusRingReader {
+public:
+    StatusRingReader() = default;
+    ~StatusRingReader() { Close(); }
+    StatusRingReader(const StatusRingReader&) = delete;
+    StatusRingReader& operator=(const StatusRingReader&) = delete;
+
+    /**
+     * @brief Maps a ring.
+     * @param name Shared memory object name, e.g. "/ball_tracker_status"
+     * @return false if the object does not exist or is not a compatible ring
+     */
+    bool Open(const std::string& name) {
+        Close();
+#ifdef _WIN32
+        (void)name;
+        return false;
+#else
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(StatusRingHeader)) {
+            close(fd);
+            return false;
+        }
+        size_t size = static_cast<size_t>(st.st_size);
+        void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            return false;
+        }
+        const auto* header = static_cast<const StatusRingHeader*>(base);
+        if (header->magic != kStatusRingMagic || header->version != kStatusRingVersion ||
+            header->slot_size != sizeof(StatusRingSlot) || header->slot_count == 0 ||
+            size < StatusRingSize(header->slot_count)) {
+            munmap(base, size);
+            return false;
+        }
+        base_ = base;
+        size_ = size;
+        header_ = header;
+        slots_ = reinterpret_cast<const StatusRingSlot*>(static_cast<const char*>(base) + sizeof(StatusRingHeader));
+        next_ = header_->published.load(std::memory_order_acquire) + 1;
+        return true;
+#endif
+    }
+
+    /**
+     * @brief Unmaps the ring.
+     */
+    void Close() {
+#ifndef _WIN32
+        if (base_) {
+            munmap(base_, size_);
+        }
+#endif
+        base_ = nullptr;
+        size_ = 0;
+        header_ = nullptr;
+        slots_ = nullptr;
+    }
+
+    bool IsOpen() const { return header_ != nullptr; }
+
+    /**
+     * @brief Sequence of the last complete frame, 0 before the first publish.
+     */
+    uint64_t Published() const { return header_ ? header_->published.load(std::memory_order_acquire) : 0; }
+
+    /**
+     * @brief Copies the newest frame.
+     * @param frame Output frame
+     * @return false if nothing was published yet
+     */
+    bool ReadLatest(StatusFrame& frame) const {
+        for (;;) {
+            uint64_t sequence = Published();
+            if (sequence == 0) {
+                return false;
+            }
+            if (ReadSequence(sequence, frame)) {
+                return true;
+            }
+            // 最新帧在拷贝期间被覆盖，重新读取
+        }
+    }
+
+    /**
+     * @brief Copies the frame after the last one returned, for consumers that need every frame.
+     * @param frame Output frame
+     * @param missed Output frames overwritten before they were read
+     * @return false if no new frame was published
+     */
+    bool ReadNext(StatusFrame& frame, uint64_t& missed) {
+        missed = 0;
+        for (;;) {
+            uint64_t published = Published();
+            if (published < next_) {
+                return false;
+            }
+            // 落后超过一圈的帧已被覆盖，跳到仍在环中的最早一帧
+            uint64_t oldest = published >= header_->slot_count ? published - header_->slot_count + 1 : 1;
+            if (next_ < oldest) {
+                missed += oldest - next_;
+                next_ = oldest;
+            }
+            if (ReadSequence(next_, frame)) {
+                next_++;
+                return true;
+            }
+        }
+    }
+
+private:
+    void* base_ = nullptr;
+    size_t size_ = 0;
+    const StatusRingHeader* header_ = nullptr;
+    const StatusRingSlot* slots_ = nullptr;
+    uint64_t next_ = 1;  ///< Sequence returned by the next ReadNext()
+
+    /**
+     * @brief Copies the frame with a sequence; false if its slot was rewritten meanwhile.
+     */
+    bool ReadSequence(uint64_t sequence, StatusFrame& frame) const {
+        const StatusRingSlot& slot = slots_[(sequence - 1) % header_->slot_count];
+        if (slot.sequence.load(std::memory_order_acquire) != sequence) {
+            return false;
+        }
+        std::memcpy(&frame, &slot.frame, sizeof(StatusFrame));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == sequence;
+    }
+};
+
+#endif // STATUS_RING_H
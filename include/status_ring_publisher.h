@@ -0,0 +1,61 @@
+#ifndef STATUS_RING_PUBLISHER_H
+#define STATUS_RING_PUBLISHER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ball_tracker_common.h"
+#include "status_ring.h"
+
+/**
+ * @class StatusRingPublisher
+ * @brief Writer side of the shared-memory status ring read by StatusRingReader.
+ */
+class StatusRingPublisher {
+public:
+    StatusRingPublisher() = default;
+    ~StatusRingPublisher() { Close(); }
+    StatusRingPublisher(const StatusRingPublisher&) = delete;
+    StatusRingPublisher& operator=(const StatusRingPublisher&) = delete;
+
+    /**
+     * @brief Creates the shared memory object.
+     * @param name Shared memory object name, e.g. "/ball_tracker_status"
+     * @param slot_count Frames kept in the ring
+     * @param replace_existing Remove an object of the same name first, e.g. one left by a crashed
+     *        publisher; otherwise an existing object is treated as a running publisher and Open() fails
+     * @return false if the object exists, cannot be created or POSIX shared memory is unavailable
+     */
+    bool Open(const std::string& name, uint32_t slot_count, bool replace_existing = false);
+
+    /**
+     * @brief Unmaps and removes the shared memory object; mapped readers keep their view.
+     *
+     * An object that another publisher has since replaced under the same name is left in place.
+     */
+    void Close();
+
+    bool IsOpen() const { return header_ != nullptr; }
+
+    /**
+     * @brief Publishes the status of one frame; balls beyond kStatusRingMaxBalls are dropped with a one-time warning.
+     * @param frame_index Frame counter of the tracking loop
+     * @param capture_ns Capture time on the steady clock
+     * @param statuses Status of the tracked balls
+     */
+    void Publish(uint64_t frame_index, int64_t capture_ns, const std::vector<BallStatus>& statuses);
+
+private:
+    std::string name_;
+    void* base_ = nullptr;
+    size_t size_ = 0;
+    StatusRingHeader* header_ = nullptr;
+    StatusRingSlot* slots_ = nullptr;
+    uint64_t device_ = 0;    ///< Identity of the created object, checked before unlinking
+    uint64_t inode_ = 0;
+    uint64_t sequence_ = 0;  ///< Sequence of the last published frame
+    bool overflow_reported_ = false;  ///< Dropped balls were reported since Open()
+};
+
+#endif // STATUS_RING_PUBLISHER_H
@@ -0,0 +1,90 @@
+#ifndef SYNTHETIC_FRAME_SOURCE_H
+#define SYNTHETIC_FRAME_SOURCE_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "frame_source.h"
+
+/**
+ * @struct SyntheticSourceConfig
+ * @brief Scene rendered by SyntheticFrameSource.
+ */
+struct SyntheticSourceConfig {
+    cv::Scalar_<double> background_bgr = cv::Scalar_<double>(40, 40, 40);  ///< Background color
+    cv::Scalar_<double> ball_hsv = cv::Scalar_<double>(37.30, 181.83, 252.62); ///< Ball color (OpenCV HSV)
+    int ball_radius = 12;                         ///< Ball radius in pixels
+    std::vector<cv::Point_<double>> path;         ///< Polyline followed by the ball, empty for a default path
+    double speed = 8.0;                           ///< Ball speed in pixels per frame
+    int num_frames = -1;                          ///< Frames before end of stream, -1 to loop forever
+    PixelFormat output_format = PixelFormat::BGR8; ///< BGR8 or BAYER_RG8
+    bool real_time = false;                       ///< Pace Read() to the configured frame rate
+};
+
+/**
+ * @class SyntheticFrameSource
+ * @brief Renders a ball rolling along a polyline, so the tracking engine and its
+ *        benchmarks can run without a camera.
+ */
+class SyntheticFrameSource final : public IFrameSource {
+public:
+    SyntheticFrameSource();
+    explicit SyntheticFrameSource(const SyntheticSourceConfig& config);
+    ~SyntheticFrameSource() override;
+
+    /**
+     * @brief Sets the rendered scene. Takes effect on the next Open().
+     */
+    void SetConfig(const SyntheticSourceConfig& config) { config_ = config; }
+
+    /**
+     * @brief Opens the source.
+     * @param source Ignored
+     * @param width Image width (-1 for 1280)
+     * @param height Image height (-1 for 720)
+     * @param fps Nominal frame rate (-1 for 30)
+     * @return true if the source was opened
+     */
+    bool Open(const std::string& source, int width, int height, int fps) override;
+    void Close() override;
+    bool IsOpen() const override { return is_open_; }
+    bool Read(RawFrame& frame) override;
+    bool IsEndOfStream() const override {
+        return is_open_ && config_.num_frames >= 0 && frame_id_ >= static_cast<uint64_t>(config_.num_frames);
+    }
+    FrameSourceCaps GetCaps() const override;
+    CameraSourceType GetType() const override { return CameraSourceType::SYNTHETIC; }
+    int GetWidth() const override { return width_; }
+    int GetHeight() const override { return height_; }
+    int GetFps() const override { return fps_; }
+
+    /**
+     * @brief Gets the ground-truth ball position of the last frame returned by Read().
+     */
+    cv::Point_<double> GetGroundTruth() const { return ground_truth_; }
+
+private:
+    SyntheticSourceConfig config_;
+    std::vector<cv::Point_<double>> path_;    ///< Path in use
+    std::vector<double> path_length_;         ///< Cumulative arc length of path_
+    cv::Mat canvas_;                          ///< BGR render target
+    cv::Mat output_;                          ///< Buffer handed out by Read()
+    cv::Scalar_<double> ball_bgr_;
+    cv::Point_<double> ground_truth_;
+    bool is_open_;
+    int width_;
+    int height_;
+    int fps_;
+    uint64_t frame_id_;
+    std::chrono::steady_clock::time_point next_frame_time_;
+
+    /**
+     * @brief Gets the point at arc length s along the path.
+     */
+    cv::Point_<double> PointAt(double s) const;
+};
+
+#endif // SYNTHETIC_FRAME_SOURCE_H
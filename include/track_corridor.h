@@ -0,0 +1,99 @@
+#ifndef TRACK_CORRIDOR_H
+#define TRACK_CORRIDOR_H
+
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @struct CorridorSpan
+ * @brief A horizontal run of corridor pixels in one image row.
+ */
+struct CorridorSpan {
+    int start;  ///< First column inside the corridor
+    int end;    ///< Last column inside the corridor (inclusive)
+};
+
+/**
+ * @class TrackCorridor
+ * @brief The pixels a ball on the track can cover: the recorded trajectory dilated by a half width.
+ *
+ * The corridor is stored as sorted, disjoint spans per image row, so restricting a
+ * search to it costs a few span bounds per row instead of a full-image mask test.
+ * Thresholding a region only converts and tests the pixels of the spans inside it;
+ * for a thin track this is a small fraction of the region.
+ */
+class TrackCorridor {
+public:
+    /**
+     * @brief Rasterizes the corridor around a polyline.
+     * @param path Trajectory points in image coordinates
+     * @param half_width Distance (pixels) from the trajectory still inside the corridor
+     * @param image_size Size of the images searched
+     */
+    void Build(const std::vector<cv::Point_<float>>& path, int half_width, const cv::Size& image_size);
+
+    /**
+     * @brief Rasterizes the union of the corridors around several polylines, e.g. one per lane.
+     */
+    void Build(const std::vector<std::vector<cv::Point_<float>>>& paths, int half_width, const cv::Size& image_size);
+
+    /**
+     * @brief Removes the corridor; an empty corridor does not restrict any search.
+     */
+    void Clear();
+
+    bool Empty() const { return spans_.empty(); }
+
+    /**
+     * @brief Spans of an image row.
+     * @param row Image row
+     * @param count Output number of spans, 0 outside the image
+     * @return First span of the row
+     */
+    const CorridorSpan* RowSpans(int row, int& count) const;
+
+    /**
+     * @brief Whether a pixel lies inside the corridor.
+     */
+    bool Contains(int x, int y) const;
+
+    /**
+     * @brief Bounding box of the corridor pixels inside a rectangle, empty if there are none.
+     */
+    cv::Rect_<int> BoundingRect(const cv::Rect_<int>& rect) const;
+
+    /**
+     * @brief Number of corridor pixels.
+     */
+    long long Area() const { return area_; }
+
+    /**
+     * @brief Color thresholds the corridor pixels of a region, like cv::cvtColor followed by cv::inRange.
+     *
+     * Pixels outside the corridor are 0 in both the mask and hsv_image.
+     * @param image Full input image (BGR)
+     * @param rect Region in image coordinates
+     * @param lower Lower HSV bound
+     * @param upper Upper HSV bound
+     * @param hsv_image Output HSV pixels of the region
+     * @param mask Output color mask of the region
+     */
+    void Threshold(const cv::Mat& image, const cv::Rect_<int>& rect, const cv::Scalar_<double>& lower,
+                   const cv::Scalar_<double>& upper, cv::Mat& hsv_image, cv::Mat& mask) const;
+
+    /**
+     * @brief Clears the mask pixels of a region that lie outside the corridor.
+     * @param mask Mask of the region
+     * @param rect Region in image coordinates
+     */
+    void ClearOutside(cv::Mat& mask, const cv::Rect_<int>& rect) const;
+
+private:
+    cv::Size image_size_;
+    std::vector<CorridorSpan> spans_;  ///< Spans of all rows, row by row
+    std::vector<int> row_offsets_;     ///< First span of each row, image_size_.height + 1 entries
+    long long area_ = 0;
+};
+
+#endif // TRACK_CORRIDOR_H
@@ -0,0 +1,180 @@
+#ifndef TRACK_PATH_H
+#define TRACK_PATH_H
+
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @class TrackPath
+ * @brief The recorded trajectory as a polyline parameterized by arc length.
+ *
+ * Arc length s runs from 0 at the first point to Length() at the last. Lookups by
+ * arc length are binary searches over the cumulative segment lengths; projections
+ * can be restricted to an interval of s so a ball is never matched to another
+ * part of the track that passes nearby.
+ */
+class TrackPath {
+public:
+    /**
+     * @brief Builds the path from trajectory points; repeated points are dropped.
+     * @param points Trajectory points in image coordinates
+     */
+    void Build(const std::vector<cv::Point_<float>>& points);
+
+    void Clear();
+
+    /**
+     * @brief Whether the path has no segment.
+     */
+    bool Empty() const { return points_.size() < 2; }
+
+    float Length() const { return Empty() ? 0.0f : cumulative_.back(); }
+
+    /**
+     * @brief Point at an arc length, clamped to the path.
+     */
+    cv::Point_<float> PointAt(float s) const;
+
+    /**
+     * @brief Unit direction of travel at an arc length.
+     */
+    cv::Point_<float> TangentAt(float s) const;
+
+    /**
+     * @brief Arc length of the point of the path closest to a point, searched within [s_min, s_max].
+     * @param point Point in image coordinates
+     * @param s_min Start of the searched interval
+     * @param s_max End of the searched interval
+     * @param distance Output distance from the point to the path
+     * @return Arc length of the closest point
+     */
+    float Project(const cv::Point_<float>& point, float s_min, float s_max, float& distance) const;
+
+    /**
+     * @brief Bounding box of the path between two arc lengths, grown by a margin.
+     */
+    cv::Rect_<int> Bounds(float s_min, float s_max, float margin) const;
+
+private:
+    std::vector<cv::Point_<float>> points_;
+    std::vector<float> cumulative_;  ///< Arc length at each point
+
+    /**
+     * @brief Index of the segment containing an arc length (clamped).
+     */
+    int Segment(float s) const;
+};
+
+/**
+ * @struct SpeedRun
+ * @brief One recorded pass of a ball over the track, used to learn a SpeedProfile.
+ */
+struct SpeedRun {
+    const std::vector<cv::Point_<float>>* points;  ///< Raw trajectory points
+    const std::vector<int>* frames;                ///< Frame index of each point
+};
+
+/**
+ * @class SpeedProfile
+ * @brief Expected speed and acceleration of a ball along a TrackPath, learned from recorded runs.
+ *
+ * The track is divided into segments of equal arc length. Each run is projected
+ * onto the track point by point; the arc length covered between two points over
+ * the frames between them is a speed sample of the segment in the middle. Samples
+ * of all runs are averaged per segment, segments without samples are interpolated
+ * from their neighbours, and the acceleration along the track follows from the
+ * speed profile as a = v dv/ds.
+ */
+class SpeedProfile {
+public:
+    /**
+     * @brief Learns the profile from runs over a track.
+     * @param path Track the runs are projected onto
+     * @param runs Recorded runs
+     * @param segment_length Arc length of a profile segment (pixels)
+     * @return false if the runs gave no speed sample; the profile is then empty
+     */
+    bool Build(const TrackPath& path, const std::vector<SpeedRun>& runs, float segment_length);
+
+    void Clear();
+
+    bool Empty() const { return speed_.empty(); }
+
+    int Segments() const { return static_cast<int>(speed_.size()); }
+
+    /**
+     * @brief Expected speed at an arc length (pixels per frame).
+     */
+    float Speed(float s) const { return Interpolate(speed_, s); }
+
+    /**
+     * @brief Variance of the speed samples around the expected speed at an arc length.
+     */
+    float SpeedVariance(float s) const { return Interpolate(speed_variance_, s); }
+
+    /**
+     * @brief Expected acceleration along the track at an arc length (pixels per frame^2).
+     */
+    float Acceleration(float s) const { return Interpolate(acceleration_, s); }
+
+private:
+    float segment_length_ = 0.0f;
+    std::vector<float> speed_;           ///< Mean speed per segment
+    std::vector<float> speed_variance_;  ///< Speed variance per segment
+    std::vector<float> acceleration_;    ///< Acceleration per segment
+
+    /**
+     * @brief Linear interpolation of per-segment values between segment centers.
+     */
+    float Interpolate(const std::vector<float>& values, float s) const;
+};
+
+/**
+ * @class ArcKalman
+ * @brief Kalman filter of a ball along a TrackPath (state s, v; measurement s).
+ *
+ * Constant velocity unless an expected acceleration is given to Predict().
+ */
+class ArcKalman {
+public:
+    /**
+     * @brief Restarts at an arc length with the given variances.
+     */
+    void Reset(float s, float v, float s_variance, float v_variance);
+
+    /**
+     * @brief Advances by one frame, adding the process noise variance to s and v.
+     * @param process_noise Process noise variance
+     * @param acceleration Expected acceleration over the frame, e.g. from a SpeedProfile
+     */
+    void Predict(float process_noise, float acceleration = 0.0f);
+
+    /**
+     * @brief Updates with a projected measurement.
+     */
+    void Correct(float s, float measurement_noise);
+
+    float S() const { return s_; }
+    float V() const { return v_; }
+    float VarianceS() const { return p00_; }
+
+    /**
+     * @brief Arc length after the next Predict().
+     */
+    float PredictedS(float acceleration = 0.0f) const { return s_ + v_ + 0.5f * acceleration; }
+
+    /**
+     * @brief Variance of s after the next Predict().
+     */
+    float PredictedVarianceS(float process_noise) const { return p00_ + 2.0f * p01_ + p11_ + process_noise; }
+
+private:
+    float s_ = 0.0f;
+    float v_ = 0.0f;
+    float p00_ = 0.0f;  ///< Covariance, upper triangle
+    float p01_ = 0.0f;
+    float p11_ = 0.0f;
+};
+
+#endif // TRACK_PATH_H
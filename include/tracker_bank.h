@@ -0,0 +1,296 @@
+#ifndef TRACKER_BANK_H
+#define TRACKER_BANK_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "ball_tracker_algo.h"
+#include "blob_extractor.h"
+#include "data_association.h"
+#include "kalman_bank.h"
+#include "track_corridor.h"
+
+/**
+ * @struct TrackerLifecycleStats
+ * @brief Counters of TrackerBank::UpdateLifecycle() since the lifecycle config was last set.
+ */
+struct TrackerLifecycleStats {
+    uint64_t spawned = 0;           ///< Trackers started for balls entering a spawn zone
+    uint64_t retired_finished = 0;  ///< Balls retired at the end point
+    uint64_t retired_lost = 0;      ///< Balls retired after staying lost
+    uint64_t spawns_skipped = 0;    ///< Confirmed new balls left untracked because the pool was full
+};
+
+/**
+ * @class TrackerBank
+ * @brief Owns the trackers of all balls and updates them frame by frame in phases.
+ *
+ * The Kalman filters of all balls live in one KalmanBank and are predicted and
+ * corrected in SIMD batches. The trackers themselves are stored contiguously and
+ * called directly, without per-ball heap objects or virtual dispatch. The per-ball
+ * values read every frame to schedule the updates (id, search state, progress, ROI)
+ * are mirrored in plain arrays after each frame.
+ *
+ * Balls sharing a color model are searched jointly by Associate(): the blobs of the
+ * color are extracted once over the merged search windows, gated by the Kalman
+ * Mahalanobis distance and assigned to the balls, so two balls of the same color
+ * never lock onto the same blob.
+ *
+ * With a lifecycle config, the bank is a pool of preallocated slots. Balls entering
+ * a spawn zone get an inactive slot, reinitialized in place, and slots of balls that
+ * passed the end point or stayed lost are deactivated. Indices are slot indices;
+ * inactive slots are skipped by every phase.
+ *
+ * A frame is BeginFrame(), Associate(), Detect() for every active ball to update (from
+ * any thread, each ball at most once), EndFrame(), then UpdateLifecycle().
+ */
+class TrackerBank {
+public:
+    /**
+     * @param capacity Number of balls to preallocate for
+     */
+    explicit TrackerBank(int capacity = 0);
+
+    TrackerBank(const TrackerBank&) = delete;
+    TrackerBank& operator=(const TrackerBank&) = delete;
+
+    /**
+     * @brief Adds a ball tracker.
+     * @return Index of the ball in the bank
+     */
+    int Add(int ball_id, const std::string& color, const cv::Scalar_<double>& hsv_mean,
+            const cv::Scalar_<double>& hsv_stddev, const cv::Point_<double>& init_pos);
+
+    /**
+     * @brief Number of slots, active or not.
+     */
+    int Size() const { return static_cast<int>(trackers_.size()); }
+
+    bool IsActive(int index) const { return active_[index] != 0; }
+
+    /**
+     * @brief Enables spawning and retirement and grows the pool to config.max_trackers slots.
+     */
+    void SetLifecycleConfig(const TrackerLifecycleConfig& config);
+
+    /**
+     * @brief Sets the points whose surrounding zones are watched for new balls.
+     */
+    void SetSpawnZones(const std::vector<cv::Point_<float>>& centers);
+
+    /**
+     * @brief Sets the point where balls leave the track.
+     */
+    void SetEndPoint(const cv::Point_<float>& point);
+
+    /**
+     * @brief Retires lost or finished balls and spawns trackers for new blobs in the spawn zones.
+     * @param image Input image
+     * @param changed Output slots spawned or retired in this call
+     */
+    void UpdateLifecycle(const cv::Mat& image, std::vector<int>& changed);
+
+    /**
+     * @brief Spawn and retirement counters, reset by SetLifecycleConfig().
+     */
+    const TrackerLifecycleStats& GetLifecycleStats() const { return lifecycle_stats_; }
+
+    BallTracker& Get(int index) { return trackers_[index]; }
+    const BallTracker& Get(int index) const { return trackers_[index]; }
+
+    /**
+     * @brief Index of the ball with the given id, or -1.
+     */
+    int Find(int ball_id) const;
+
+    /**
+     * @brief Predicts the Kalman states of all balls for the new frame in one batch.
+     */
+    void BeginFrame();
+
+    /**
+     * @brief Detects the balls of each color shared by several balls once and assigns the blobs.
+     *
+     * Locked balls are assigned first by minimum total Mahalanobis distance within the
+     * gate; balls still searching then take the remaining blobs in their search windows.
+     * @param image Input image
+     */
+    void Associate(const cv::Mat& image);
+
+    /**
+     * @brief Sets the gating of Associate().
+     */
+    void SetAssociationConfig(const AssociationConfig& config) { association_config_ = config; }
+
+    const AssociationConfig& GetAssociationConfig() const { return association_config_; }
+
+    /**
+     * @brief Sets the lost-ball search bounds of all slots, including slots added later.
+     */
+    void SetSearchConfig(const LostBallSearchConfig& config);
+
+    /**
+     * @brief Sets the rest detection of all slots, including slots added later.
+     */
+    void SetAdaptiveUpdateConfig(const AdaptiveUpdateConfig& config);
+
+    /**
+     * @brief Sets the global search prior of all slots, including slots added later.
+     */
+    void SetSearchPrior(const std::vector<cv::Point_<float>>& points);
+
+    /**
+     * @brief Restricts the searches of all slots, including slots added later, to the track corridor.
+     * @param paths Recorded trajectories, empty to search everywhere
+     * @param half_width Distance (pixels) from the trajectory still searched
+     * @param image_size Size of the input images
+     */
+    void SetCorridor(const std::vector<std::vector<cv::Point_<float>>>& paths, int half_width, const cv::Size& image_size);
+
+    const TrackCorridor& GetCorridor() const { return corridor_; }
+
+    /**
+     * @brief Sets the trajectory along which all slots, including slots added later, track by arc length.
+     *
+     * Clears the speed profile, which belongs to the previous path.
+     * @param points Recorded trajectory, empty for 2D tracking
+     */
+    void SetTrackPath(const std::vector<cv::Point_<float>>& points);
+
+    /**
+     * @brief Learns the expected speed along the track path from recorded runs for all slots.
+     * @param runs Runs of the balls over the track; merged into one profile
+     * @return false if no profile was learned (no path, disabled or no speed sample)
+     */
+    bool SetSpeedProfile(const std::vector<SpeedRun>& runs);
+
+    const SpeedProfile& GetSpeedProfile() const { return speed_profile_; }
+
+    /**
+     * @brief Sets the arc-length tracking of all slots, including slots added later.
+     */
+    void SetTrackModeConfig(const TrackModeConfig& config);
+
+    /**
+     * @brief Runs the image work of one ball; the measurement is applied by EndFrame().
+     * @param index Ball index
+     * @param image Input image
+     * @return true if the ball was detected
+     */
+    bool Detect(int index, const cv::Mat& image) { return trackers_[index].Detect(image); }
+
+    /**
+     * @brief Corrects all measured balls in one batch and finishes the per-ball updates.
+     * @param image Input image
+     */
+    void EndFrame(const cv::Mat& image);
+
+    /**
+     * @brief Runs all phases of a frame except UpdateLifecycle(), detecting the balls sequentially.
+     * @param image Input image
+     * @return false if the image is empty
+     */
+    bool Update(const cv::Mat& image);
+
+    int GetId(int index) const { return ids_[index]; }
+    TrackState GetTrackState(int index) const { return states_[index]; }
+    double GetProgress(int index) const { return progress_[index]; }
+    const cv::Rect_<int>& GetROI(int index) const { return rois_[index]; }
+
+    const KalmanBank& GetKalman() const { return kalman_; }
+
+private:
+    /**
+     * @brief A blob found by Associate() (image coordinates).
+     */
+    struct Candidate {
+        cv::Point_<float> center;
+        float radius;
+        cv::Scalar_<double> hsv;
+    };
+
+    /**
+     * @brief Color model shared by the balls of a group.
+     */
+    struct ColorModel {
+        std::string color;
+        cv::Scalar_<double> hsv_mean;
+        cv::Scalar_<double> hsv_stddev;
+    };
+
+    KalmanBank kalman_;                  ///< Kalman filters of all balls, lane i belongs to trackers_[i]
+    std::vector<BallTracker> trackers_;  ///< Per-ball detection state
+    std::vector<int> ids_;               ///< Ball id per tracker
+    std::vector<TrackState> states_;     ///< Search state per tracker after the last frame
+    std::vector<double> progress_;       ///< Track progress per tracker after the last frame
+    std::vector<cv::Rect_<int>> rois_;   ///< Detection ROI per tracker after the last frame
+    std::vector<int> groups_;            ///< Color model index per tracker, -1 for unused slots
+    std::vector<uint8_t> active_;        ///< Whether the slot holds a tracked ball
+    std::vector<ColorModel> models_;     ///< Color models, indexed by group
+
+    LostBallSearchConfig search_config_;
+    AdaptiveUpdateConfig adaptive_config_;
+    std::vector<cv::Point_<float>> search_prior_;
+    TrackCorridor corridor_;             ///< Pixels the balls can occupy; the trackers point here
+    TrackPath track_path_;               ///< Trajectory for arc-length tracking; the trackers point here
+    SpeedProfile speed_profile_;         ///< Expected speed along track_path_; the trackers point here
+    TrackModeConfig track_mode_config_;
+    TrackerLifecycleConfig lifecycle_config_;
+    std::vector<cv::Point_<float>> spawn_zones_;  ///< Centers of the spawn zones
+    std::vector<int> spawn_hits_;        ///< Consecutive frames with a new blob, per zone and color model
+    cv::Point_<float> end_point_;
+    bool has_end_point_ = false;
+    int next_id_ = 0;                    ///< Id of the next spawned ball
+    TrackerLifecycleStats lifecycle_stats_;
+
+    AssociationConfig association_config_;
+    AssignmentSolver solver_;
+    BlobExtractor blob_extractor_;
+    std::vector<Blob> blobs_;
+    cv::Mat hsv_image_;
+    cv::Mat mask_;
+    std::vector<int> members_;              ///< Trackers of the color being associated
+    std::vector<cv::Rect_<int>> windows_;   ///< Search window per member
+    std::vector<cv::Rect_<int>> regions_;   ///< Merged windows, each segmented once
+    std::vector<Candidate> candidates_;
+    std::vector<int> member_candidate_;     ///< Assigned candidate per member, -1 if none
+    std::vector<char> taken_;               ///< Candidates already assigned
+    std::vector<int> stage_rows_;
+    std::vector<int> stage_cols_;
+    std::vector<float> cost_;
+    std::vector<int> row_to_col_;
+
+    /**
+     * @brief Associates the trackers in members_.
+     */
+    void AssociateGroup(const cv::Mat& image);
+
+    /**
+     * @brief Assigns the free candidates to the locked or to the searching members.
+     */
+    void AssignStage(bool locked);
+
+    /**
+     * @brief Index of the color model, added if new.
+     */
+    int FindModel(const std::string& color, const cv::Scalar_<double>& hsv_mean, const cv::Scalar_<double>& hsv_stddev);
+
+    /**
+     * @brief Appends an inactive slot.
+     */
+    void AddSlot();
+
+    /**
+     * @brief Looks for a blob of a color model in a spawn zone that no active tracker claims.
+     * @param zone Spawn zone; hsv_image_ holds its HSV pixels
+     * @param model Color model index
+     * @param center Center of the largest such blob (image coordinates)
+     * @return Whether one was found
+     */
+    bool FindNewBlob(const cv::Rect_<int>& zone, int model, cv::Point_<float>& center);
+};
+
+#endif // TRACKER_BANK_H
@@ -0,0 +1,55 @@
+#ifndef TRAJECTORY_COMPACTION_H
+#define TRAJECTORY_COMPACTION_H
+
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "ball_tracker_common.h"
+
+/**
+ * @brief Smooths a trajectory with a forward Kalman filter and a backward Rauch-Tung-Striebel pass.
+ *
+ * Each axis is a constant-velocity model with one step per point, so the result
+ * follows the track without the detection jitter and without the lag of a forward
+ * filter alone.
+ * @param points Raw trajectory points
+ * @param process_noise Acceleration variance (pixels^2 per step^4)
+ * @param measurement_noise Variance of a raw point (pixels^2)
+ * @return Smoothed points, one per raw point
+ */
+std::vector<cv::Point_<float>> SmoothTrajectory(const std::vector<cv::Point_<float>>& points, float process_noise,
+                                                float measurement_noise);
+
+/**
+ * @brief Simplifies a polyline with the Douglas-Peucker algorithm.
+ * @param points Polyline points
+ * @param tolerance Largest distance (pixels) of a dropped point from the simplified polyline
+ * @return The kept points, including the first and the last
+ */
+std::vector<cv::Point_<float>> SimplifyTrajectory(const std::vector<cv::Point_<float>>& points, float tolerance);
+
+/**
+ * @brief Resamples a polyline at uniform arc length.
+ * @param points Polyline points
+ * @param spacing Arc length between two output points (pixels); the last point is always kept
+ * @return Resampled points, or a copy of points if spacing is not positive
+ */
+std::vector<cv::Point_<float>> ResampleTrajectory(const std::vector<cv::Point_<float>>& points, float spacing);
+
+/**
+ * @brief Largest distance of the points from a polyline.
+ */
+float TrajectoryDeviation(const std::vector<cv::Point_<float>>& points, const std::vector<cv::Point_<float>>& polyline);
+
+/**
+ * @brief Smooths, simplifies and resamples a recorded trajectory.
+ * @param points Raw trajectory points
+ * @param config Compaction settings
+ * @param max_error Output largest distance of the smoothed points from the compact trajectory (pixels)
+ * @return Compact trajectory
+ */
+std::vector<cv::Point_<float>> CompactTrajectory(const std::vector<cv::Point_<float>>& points,
+                                                 const TrajectoryCompactionConfig& config, float& max_error);
+
+#endif // TRAJECTORY_COMPACTION_H
@@ -0,0 +1,112 @@
+#ifndef TRAJECTORY_WRITER_H
+#define TRAJECTORY_WRITER_H
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @class TrajectoryWriter
+ * @brief Records the trajectory of InitTrack() and streams it to its JSON file while recording.
+ *
+ * Points are kept in a compact preallocated buffer and the total length is
+ * accumulated per point. Every chunk_points points, the new points are appended
+ * to the file followed by the closing part (length, start and end point), which
+ * the next chunk overwrites. After each flush the file is a complete trajectory
+ * file of the points recorded so far:
+ *
+ *   {
+ *       "track_trajectory": {
+ *           "timestamp": "...",
+ *           "points": [
+ *               {"x": ..., "y": ...},
+ *               ...
+ *           ],
+ *           "length": ...,
+ *           "start_point": {"x": ..., "y": ...},
+ *           "end_point": {"x": ..., "y": ...},
+ *           "compact": {
+ *               "spacing": ...,
+ *               "max_error": ...,
+ *               "points": [...]
+ *           }
+ *       }
+ *   }
+ *
+ * The "compact" part is only written once SetCompact() was called.
+ */
+class TrajectoryWriter {
+public:
+    /**
+     * @param chunk_points Points buffered between two writes to the file
+     * @param reserve_points Points preallocated in memory
+     */
+    explicit TrajectoryWriter(size_t chunk_points = 256, size_t reserve_points = 1 << 16);
+    ~TrajectoryWriter();
+
+    TrajectoryWriter(const TrajectoryWriter&) = delete;
+    TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+    /**
+     * @brief Creates the file and writes an empty trajectory.
+     * @param path Output file path
+     * @param timestamp Start time of the recording
+     * @return false if the file cannot be written
+     */
+    bool Open(const std::string& path, const std::string& timestamp);
+
+    /**
+     * @brief Appends a point; writes a chunk to the file when chunk_points are pending.
+     * @return false if writing the chunk failed
+     */
+    bool Add(double x, double y);
+
+    /**
+     * @brief Writes the pending points and the closing part.
+     * @return false if the file is not open or the write failed
+     */
+    bool Flush();
+
+    /**
+     * @brief Sets the compact form of the trajectory, written with the closing part.
+     * @param points Compact trajectory, see CompactTrajectory()
+     * @param spacing Arc length between the compact points
+     * @param max_error Largest distance of the smoothed trajectory from the compact one
+     */
+    void SetCompact(const std::vector<cv::Point_<float>>& points, float spacing, float max_error);
+
+    /**
+     * @brief Flushes and closes the file.
+     * @return false if the final flush failed
+     */
+    bool Close();
+
+    bool IsOpen() const { return file_.is_open(); }
+
+    const std::vector<cv::Point_<float>>& Points() const { return points_; }
+
+    /**
+     * @brief Length of the polyline through the recorded points.
+     */
+    double Length() const { return length_; }
+
+private:
+    std::ofstream file_;
+    size_t chunk_points_;
+    std::vector<cv::Point_<float>> points_;  ///< All recorded points
+    size_t written_ = 0;                     ///< Points already in the file
+    double length_ = 0.0;
+    std::streamoff tail_offset_ = 0;         ///< File offset of the closing part
+    size_t tail_size_ = 0;                   ///< Bytes from tail_offset_ to the end of the file
+    std::string buffer_;                     ///< Text of a chunk, reused between flushes
+    std::vector<cv::Point_<float>> compact_; ///< Compact trajectory, empty until SetCompact()
+    float compact_spacing_ = 0.0f;
+    float compact_error_ = 0.0f;
+
+    void AppendPoint(const cv::Point_<float>& point);
+};
+
+#endif // TRAJECTORY_WRITER_H
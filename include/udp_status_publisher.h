@@ -0,0 +1,90 @@
+#ifndef UDP_STATUS_PUBLISHER_H
+#define UDP_STATUS_PUBLISHER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ball_tracker_common.h"
+#include "status_datagram.h"
+
+/**
+ * @class UdpStatusPublisher
+ * @brief Sends the ball status of every tracked frame as status datagrams over UDP.
+ *
+ * Publish() packs the balls on the calling thread into a recycled buffer and hands it
+ * to a sender thread, so the tracking loop never waits on the network. The backlog is
+ * bounded; when the sender falls behind the oldest frame is dropped, since a controller
+ * wants the newest state.
+ */
+class UdpStatusPublisher {
+public:
+    UdpStatusPublisher() = default;
+    ~UdpStatusPublisher();
+
+    UdpStatusPublisher(const UdpStatusPublisher&) = delete;
+    UdpStatusPublisher& operator=(const UdpStatusPublisher&) = delete;
+
+    /**
+     * @brief Creates the socket and starts the sender thread.
+     * @param config Destination, multicast settings and batching
+     * @return false if the address is invalid or the socket cannot be configured
+     */
+    bool Open(const StatusStreamConfig& config);
+
+    /**
+     * @brief Sends the backlog and stops the sender thread.
+     */
+    void Close();
+
+    bool IsOpen() const { return socket_ != kInvalidStatusSocket; }
+
+    /**
+     * @brief Queues the status of one frame.
+     * @param frame_index Frame counter of the tracking loop
+     * @param capture_ns Capture time on the steady clock
+     * @param statuses Status of the tracked balls
+     */
+    void Publish(uint64_t frame_index, int64_t capture_ns, const std::vector<BallStatus>& statuses);
+
+    uint64_t GetSentDatagrams() const { return sent_datagrams_; }
+    uint64_t GetDroppedFrames() const { return dropped_frames_; }
+    uint64_t GetSendErrors() const { return send_errors_; }
+
+private:
+    struct PendingFrame {
+        uint64_t frame_index = 0;
+        int64_t capture_ns = 0;
+        std::vector<StatusDatagramBall> balls;
+    };
+
+    StatusStreamConfig config_;
+    StatusSocket socket_ = kInvalidStatusSocket;
+    bool started_ = false;
+    sockaddr_in destination_{};
+    uint64_t sequence_ = 0;                     ///< Datagram counter, owned by the sender thread
+
+    std::deque<PendingFrame> queue_;            ///< Frames waiting for the sender
+    std::vector<PendingFrame> free_frames_;     ///< Recycled frames
+    bool stop_ = false;
+    std::mutex mutex_;
+    std::condition_variable queue_cv_;
+    std::thread sender_thread_;
+
+    std::atomic<uint64_t> sent_datagrams_{0};
+    std::atomic<uint64_t> dropped_frames_{0};
+    std::atomic<uint64_t> send_errors_{0};
+
+    void SenderThread();
+
+    /**
+     * @brief Sends a frame as one or more datagrams.
+     */
+    void Send(const PendingFrame& frame, std::vector<char>& buffer);
+};
+
+#endif // UDP_STATUS_PUBLISHER_H
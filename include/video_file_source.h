@@ -0,0 +1,129 @@
+#ifndef VIDEO_FILE_SOURCE_H
+#define VIDEO_FILE_SOURCE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "frame_source.h"
+#include "playback_pacer.h"
+
+/**
+ * @struct VideoFileSourceConfig
+ * @brief Decoding and playback options of VideoFileSource.
+ */
+struct VideoFileSourceConfig {
+    ReplayPacing pacing = ReplayPacing::MAX_SPEED;
+    int prefetch_frames = 8;        ///< Decoded frames queued ahead of Read() (0: decode on the reading thread)
+    int decode_threads = 1;         ///< Decoder threads; more than one decodes interleaved chunks of the file in parallel
+    int chunk_frames = 32;          ///< Frames per chunk when decode_threads > 1 (the ring then holds decode_threads * chunk_frames frames)
+    bool drop_late_frames = false;  ///< REAL_TIME: skip frames already overdue by a frame period, like a live camera
+};
+
+/**
+ * @class VideoFileSource
+ * @brief Frame source decoding a video file through cv::VideoCapture.
+ *
+ * Frames are decoded ahead on decoder threads into a bounded ring of reused
+ * images. With several decoder threads each thread owns its own capture and
+ * decodes every decode_threads-th chunk of the file; Read() still returns the
+ * frames in file order.
+ */
+class VideoFileSource final : public IFrameSource {
+public:
+    VideoFileSource();
+    explicit VideoFileSource(const VideoFileSourceConfig& config);
+    ~VideoFileSource() override;
+
+    /**
+     * @brief Sets the decoding options used by the next Open().
+     */
+    void SetConfig(const VideoFileSourceConfig& config) { config_ = config; }
+
+    /**
+     * @brief Sets the playback pacing. May be changed while open.
+     */
+    void SetPacing(ReplayPacing pacing) { pacer_.SetPacing(pacing); }
+
+    /**
+     * @brief Grants frames in ReplayPacing::STEP mode. May be called from any thread.
+     */
+    void Step(int frames = 1) { pacer_.Step(frames); }
+
+    /**
+     * @brief Opens the video file and starts decoding.
+     * @param source Path to the video file
+     * @param width Desired image width (-1 for default)
+     * @param height Desired image height (-1 for default)
+     * @param fps Desired frame rate (-1 for default)
+     * @return true if the file was opened with the requested settings
+     */
+    bool Open(const std::string& source, int width, int height, int fps) override;
+    void Close() override;
+    bool IsOpen() const override { return is_open_; }
+    bool Read(RawFrame& frame) override;
+    bool IsEndOfStream() const override;
+    FrameSourceCaps GetCaps() const override;
+    CameraSourceType GetType() const override { return CameraSourceType::VIDEO_FILE; }
+    int GetWidth() const override { return width_; }
+    int GetHeight() const override { return height_; }
+    int GetFps() const override { return fps_; }
+
+    /**
+     * @brief Frames skipped by drop_late_frames.
+     */
+    uint64_t GetDroppedFrames() const { return dropped_frames_; }
+
+    /**
+     * @brief Frame buffers allocated by the decoder threads.
+     *
+     * Stays near the ring size while the reader hands its previous frame back;
+     * grows by one per frame when consumers keep references to every frame.
+     */
+    uint64_t GetAllocatedFrames() const { return allocated_frames_; }
+
+    /**
+     * @brief Number of decoder threads actually running (0 when decoding on the reading thread).
+     */
+    int GetDecodeThreads() const { return static_cast<int>(decoders_.size()); }
+
+private:
+    struct Slot {
+        cv::Mat image;       ///< Decoded frame, reused across frames
+        int64_t index = -1;  ///< Frame index held by this slot, -1 when free
+    };
+
+    VideoFileSourceConfig config_;
+    PlaybackPacer pacer_;
+    cv::VideoCapture cap_;
+    std::string path_;
+    bool is_open_;
+    int width_;
+    int height_;
+    int fps_;
+    double media_fps_;      ///< Exact container frame rate, used for pacing
+    int64_t frame_count_;   ///< Frame count reported by the container (0 if unknown)
+    int64_t next_index_;    ///< Next frame index returned by Read()
+    uint64_t dropped_frames_;
+    std::atomic<uint64_t> allocated_frames_;
+
+    std::vector<Slot> slots_;             ///< Ring of prefetched frames, frame n in slot n % size
+    std::vector<std::thread> decoders_;
+    int64_t end_index_;                   ///< Index of the first frame past the end, -1 until known
+    bool stop_;
+    mutable std::mutex mutex_;
+    std::condition_variable ready_cv_;    ///< Signals Read() that a slot was filled
+    std::condition_variable free_cv_;     ///< Signals decoders that a slot was consumed
+
+    bool ProbeSeek(int64_t index);
+    void DecoderThread(int thread_index, int num_threads);
+    bool DecodeFrame(cv::VideoCapture& cap, int64_t index, bool seek);
+    bool NextFrame(cv::Mat& image, int64_t& index);
+};
+
+#endif // VIDEO_FILE_SOURCE_H
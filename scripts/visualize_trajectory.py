@@ -15,6 +15,7 @@ class TrajectoryVisualizer:
         self.trajectory_path = trajectory_path
         self.cap = None
         self.trajectory_data = []
+        self.compact_data = []
         self.frame_width = 0
         self.frame_height = 0
         self.fps = 0
@@ -33,6 +34,8 @@ class TrajectoryVisualizer:
             with open(self.trajectory_path, 'r') as f:
                 data = json.load(f)
                 self.trajectory_data = data["track_trajectory"]["points"]
+                # 压缩后的轨迹（平滑、简化并等弧长重采样），旧文件中没有
+                self.compact_data = data["track_trajectory"].get("compact", {}).get("points", [])
             return True
         except Exception as e:
             print(f"加载轨迹文件失败: {e}")
@@ -73,12 +76,17 @@ class TrajectoryVisualizer:
 
         frame_idx = 0
         trajectory_points = []  # 存储轨迹点
+        compact_points = np.array([[int(p["x"]), int(p["y"])] for p in self.compact_data], dtype=np.int32)
 
         while True:
             ret, frame = self.cap.read()
             if not ret:
                 break
 
+            # 绘制压缩后的完整轨迹
+            if len(compact_points) > 1:
+                cv2.polylines(frame, [compact_points], False, (255, 128, 0), 1)
+
             # 绘制当前帧的轨迹点
             if frame_idx < len(self.trajectory_data):
                 point = self.trajectory_data[frame_idx]
@@ -1,38 +1,58 @@
 #include <opencv2/opencv.hpp>
 
 #include "ball_tracker_algo.h"
+#include "hsv_pixel.h"
+
+namespace {
+
+// 种子区域生长的搜索窗口半径（以上一帧半径为单位）
+constexpr float kSeedWindowRadii = 3.0f;
+// 种子点未命中时，在该半径比例的圆周上补充探测
+constexpr float kSeedProbeRadius = 0.5f;
+// 区域面积超过期望面积的倍数时视为泄漏到背景
+constexpr float kSeedMaxAreaRatio = 4.0f;
+
+// 种子填充窗口中的像素状态
+constexpr uchar kSeedUnknown = 0;
+constexpr uchar kSeedBackground = 1;
+constexpr uchar kSeedBall = 2;
+
+// 局部搜索的 3x3 窗口顺序（以步长为单位，先中心后外圈）
+constexpr int kLocalWindowOffsets[9][2] = {
+    {0, 0}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+// 尚未检测到球时用于计算搜索窗口重叠的半径
+constexpr float kDefaultSearchRadius = 16.0f;
+
+}  // namespace
 
 BallTracker::BallTracker(int ball_id, const std::string& color, const cv::Scalar_<double>& hsv_mean, const cv::Scalar_<double>& hsv_stddev, const cv::Point_<double>& init_pos)
     : hsv_mean_(hsv_mean)
     , hsv_stddev_(hsv_stddev)
     , init_pos_(init_pos)
-    , kalman_filter_(4, 2)  // 状态向量：x, y, vx, vy；测量向量：x, y
+    , own_kalman_(std::make_unique<KalmanBank>())  // 状态向量：x, y, vx, vy；测量向量：x, y
+    , kalman_(own_kalman_.get())
+    , lane_(own_kalman_->AddLane())
 {
-    // 初始化卡尔曼滤波器
-    kalman_filter_.transitionMatrix = (cv::Mat_<float>(4, 4) <<
-        1, 0, 1, 0,
-        0, 1, 0, 1,
-        0, 0, 1, 0,
-        0, 0, 0, 1);
-
-    kalman_filter_.measurementMatrix = (cv::Mat_<float>(2, 4) <<
-        1, 0, 0, 0,
-        0, 1, 0, 0);
-
-    // 设置过程噪声和测量噪声
-    kalman_filter_.processNoiseCov = cv::Mat::eye(4, 4, CV_32F) * 0.01;
-    kalman_filter_.measurementNoiseCov = cv::Mat::eye(2, 2, CV_32F) * 0.1;
-    kalman_filter_.errorCovPost = cv::Mat::eye(4, 4, CV_32F) * 0.1;
-
-    // 初始化状态
-    kalman_filter_.statePost.at<float>(0) = static_cast<float>(init_pos.x);
-    kalman_filter_.statePost.at<float>(1) = static_cast<float>(init_pos.y);
-    kalman_filter_.statePost.at<float>(2) = 0.0f;
-    kalman_filter_.statePost.at<float>(3) = 0.0f;
+    Restart(ball_id, color, hsv_mean, hsv_stddev, init_pos);
+    printf("Constructor: init_pos=(%f, %f), roi=(%d, %d)\n", 
+           init_pos.x, init_pos.y, 
+           detect_roi_.x, detect_roi_.y);
+}
+
+BallTracker::~BallTracker() = default;
+
+void BallTracker::Restart(int ball_id, const std::string& color, const cv::Scalar_<double>& hsv_mean,
+                          const cv::Scalar_<double>& hsv_stddev, const cv::Point_<double>& init_pos) {
+    hsv_mean_ = hsv_mean;
+    hsv_stddev_ = hsv_stddev;
+    init_pos_ = init_pos;
+
+    // 初始化卡尔曼滤波器状态
+    kalman_->Reset(lane_, static_cast<float>(init_pos.x), static_cast<float>(init_pos.y));
 
     printf("Kalman init: pos=(%f, %f)\n", 
-           kalman_filter_.statePost.at<float>(0),
-           kalman_filter_.statePost.at<float>(1));
+           kalman_->X(lane_),
+           kalman_->Y(lane_));
 
     // 初始化球状态
     ball_status_.id = ball_id;
@@ -43,174 +63,617 @@ BallTracker::BallTracker(int ball_id, const std::string& color, const cv::Scalar
     ball_status_.vy = 0.0;
     ball_status_.progress = 0.0;
     ball_status_.detected = false;
+    ball_status_.deferred = false;
+
+    // 首帧在初始位置周围做局部搜索
+    search_anchor_ = cv::Point_<float>(static_cast<float>(init_pos.x), static_cast<float>(init_pos.y));
 
     // 只设置 ROI 的初始位置
-    detect_roi_.x = static_cast<int>(init_pos.x);
-    detect_roi_.y = static_cast<int>(init_pos.y);
-    printf("Constructor: init_pos=(%f, %f), roi=(%d, %d)\n", 
-           init_pos.x, init_pos.y, 
-           detect_roi_.x, detect_roi_.y);
+    detect_roi_ = cv::Rect_<int>(static_cast<int>(init_pos.x), static_cast<int>(init_pos.y), 0, 0);
+
+    // 清除上一个球留下的检测与搜索状态；缓冲区保留容量，复用时不再分配
+    last_search_roi_ = cv::Rect_<int>();
+    last_center_ = cv::Point_<float>();
+    last_radius_ = 0.0f;
+    last_hsv_ = cv::Scalar_<double>();
+    track_state_ = TrackState::LOCAL_SEARCH;
+    miss_count_ = 0;
+    search_cursor_ = 0;
+    search_tiles_.clear();
+    resting_ = false;
+    rest_count_ = 0;
+    frames_since_full_ = 0;
+    still_rect_ = cv::Rect_<int>();
+    predicted_ = false;
+    rest_pending_ = false;
+    assigned_.valid = false;
+    arc_valid_ = false;
 }
 
-BallTracker::~BallTracker() = default;
-
 BallStatus BallTracker::GetStatus() const {
     return ball_status_;
 }
 
+void BallTracker::AttachKalman(KalmanBank* bank, int lane) {
+    bank->Reset(lane, kalman_->X(lane_), kalman_->Y(lane_), kalman_->Vx(lane_), kalman_->Vy(lane_));
+    kalman_ = bank;
+    lane_ = lane;
+    own_kalman_.reset();
+}
+
 bool BallTracker::UpdateWithImage(const cv::Mat& image) {
     if (image.empty()) {
         return false;
     }
 
-    // 如果是第一次检测，只设置 ROI 的大小
+    BeginUpdate();
+    kalman_->PredictPending(lane_);
+    bool detected = Detect(image);
+    kalman_->CorrectPending(lane_);
+    FinishUpdate(image);
+    return detected;
+}
+
+void BallTracker::BeginUpdate() {
+    // 跟踪或外推中的球本帧一定需要预测，静止的球只在完整检测时需要
+    bool full_update = !resting_ || frames_since_full_ + 1 >= adaptive_config_.full_update_interval;
+    if (full_update && (track_state_ == TrackState::TRACKING || track_state_ == TrackState::COASTING)) {
+        kalman_->RequestPredict(lane_);
+        if (OnTrack()) {
+            arc_.Predict(ArcProcessNoise(), ArcAcceleration());
+        }
+        predicted_ = true;
+    } else {
+        predicted_ = false;
+    }
+    rest_pending_ = false;
+    assigned_.valid = false;
+}
+
+void BallTracker::AssignMeasurement(bool detected, const cv::Point_<float>& center, float radius,
+                                    const cv::Scalar_<double>& hsv_detected, const cv::Rect_<int>& window) {
+    assigned_.valid = true;
+    assigned_.detected = detected;
+    assigned_.center = center;
+    assigned_.radius = radius;
+    assigned_.hsv = hsv_detected;
+    assigned_.window = window;
+}
+
+void BallTracker::GetColorRange(cv::Scalar_<double>& lower, cv::Scalar_<double>& upper) const {
+    lower = hsv_mean_ - hsv_stddev_ * 2.0;  // 扩大颜色范围
+    upper = hsv_mean_ + hsv_stddev_ * 2.0;
+}
+
+bool BallTracker::IsLocked() const {
+    return (track_state_ == TrackState::TRACKING || track_state_ == TrackState::COASTING) && last_radius_ > 0.0f;
+}
+
+cv::Rect_<int> BallTracker::GetSearchWindow(const cv::Size& image_size) const {
     if (detect_roi_.width == 0 || detect_roi_.height == 0) {
-        int roi_size = static_cast<int>(std::min(image.cols, image.rows) / 2.0);
-        detect_roi_.width = roi_size;
-        detect_roi_.height = roi_size;
-        detect_roi_.x = static_cast<int>(init_pos_.x - static_cast<double>(roi_size)/2.0);
-        detect_roi_.y = static_cast<int>(init_pos_.y - static_cast<double>(roi_size)/2.0);
-    }
-
-    // 如果 ROI 超出图像范围，重置为全图
-    if (detect_roi_.x < 0 || detect_roi_.y < 0 || 
-        detect_roi_.x >= image.cols || detect_roi_.y >= image.rows) {
-        detect_roi_.width = image.cols;
-        detect_roi_.height = image.rows;
-        detect_roi_.x = 0;
-        detect_roi_.y = 0;
-        
-        // 重置卡尔曼滤波器状态
-        kalman_filter_.statePost.at<float>(0) = static_cast<float>(image.cols / 2);
-        kalman_filter_.statePost.at<float>(1) = static_cast<float>(image.rows / 2);
-        kalman_filter_.statePost.at<float>(2) = 0.0f;
-        kalman_filter_.statePost.at<float>(3) = 0.0f;
-        
-        printf("ROI reset to full image: roi=(%d, %d, %d, %d)\n",
-               detect_roi_.x, detect_roi_.y,
-               detect_roi_.width, detect_roi_.height);
+        return FitWindow(search_anchor_, MaxSearchSide(), image_size);
+    }
+    // 与 Detect 相同：ROI 离开图像时改为贴边的同尺寸窗口
+    cv::Rect_<int> window = detect_roi_ & cv::Rect_<int>(0, 0, image_size.width, image_size.height);
+    if (window.width <= 0 || window.height <= 0) {
+        cv::Point_<float> roi_center(detect_roi_.x + detect_roi_.width / 2.0f,
+                                     detect_roi_.y + detect_roi_.height / 2.0f);
+        window = FitWindow(roi_center, std::max(detect_roi_.width, detect_roi_.height), image_size);
+    }
+    if (IsLocked()) {
+        // 锁定的球再加上预测位置周围种子区域生长的窗口
+        cv::Point_<float> predicted = PredictedPosition();
+        int side = static_cast<int>(std::ceil(2.0f * kSeedWindowRadii * last_radius_)) + 1;
+        window |= FitWindow(predicted, side, image_size);
     }
+    if (HasCorridor()) {
+        window = corridor_->BoundingRect(window);
+    }
+    return window;
+}
 
-    // 确保ROI在图像范围内
-    detect_roi_.x = std::max(0, std::min(detect_roi_.x, image.cols - 1));
-    detect_roi_.y = std::max(0, std::min(detect_roi_.y, image.rows - 1));
-    detect_roi_.width = std::min(detect_roi_.width, image.cols - detect_roi_.x);
-    detect_roi_.height = std::min(detect_roi_.height, image.rows - detect_roi_.y);
+void BallTracker::EnsurePredicted() {
+    if (!predicted_) {
+        kalman_->Predict(lane_);
+        if (OnTrack()) {
+            arc_.Predict(ArcProcessNoise(), ArcAcceleration());
+        }
+        predicted_ = true;
+    }
+}
+
+bool BallTracker::OnTrack() const {
+    return arc_valid_ && track_mode_config_.enabled && track_path_ != nullptr && !track_path_->Empty();
+}
 
-    // 如果ROI无效，重置为全图
-    if (detect_roi_.width <= 0 || detect_roi_.height <= 0) {
-        detect_roi_.width = image.cols;
-        detect_roi_.height = image.rows;
-        detect_roi_.x = 0;
-        detect_roi_.y = 0;
+float BallTracker::ArcAcceleration() const {
+    return HasSpeedProfile() ? speed_profile_->Acceleration(arc_.S()) : 0.0f;
+}
+
+float BallTracker::ArcProcessNoise() const {
+    // 已知速度曲线时预测更准，过程噪声随之减小，搜索窗口也更小
+    return HasSpeedProfile() ? track_mode_config_.profile_process_noise : track_mode_config_.process_noise;
+}
+
+cv::Point_<float> BallTracker::PredictedPosition() const {
+    if (OnTrack()) {
+        // 沿轨道外推弧长后映射回图像，弯道处不会偏离轨道
+        return track_path_->PointAt(predicted_ ? arc_.S() : arc_.PredictedS(ArcAcceleration()));
     }
+    cv::Point_<float> predicted(kalman_->X(lane_), kalman_->Y(lane_));
+    if (!predicted_) {
+        predicted.x += kalman_->Vx(lane_);
+        predicted.y += kalman_->Vy(lane_);
+    }
+    return predicted;
+}
 
-    // 获取ROI区域
-    cv::Mat roi_image = image(detect_roi_);
-    if (roi_image.empty()) {
-        return false;
+void BallTracker::UpdateArc(const cv::Point_<float>& center, bool reacquired) {
+    if (!track_mode_config_.enabled || track_path_ == nullptr || track_path_->Empty()) {
+        return;
+    }
+    float distance;
+    if (reacquired || !arc_valid_) {
+        // 重新捕获时在整条轨道上投影；速度未知，有速度曲线时取该处的期望速度
+        float s = track_path_->Project(center, 0.0f, track_path_->Length(), distance);
+        if (HasSpeedProfile()) {
+            arc_.Reset(s, speed_profile_->Speed(s), track_mode_config_.measurement_noise,
+                       speed_profile_->SpeedVariance(s) + track_mode_config_.profile_process_noise);
+        } else {
+            arc_.Reset(s, 0.0f, track_mode_config_.measurement_noise, track_mode_config_.initial_speed_variance);
+        }
+        arc_valid_ = true;
+    } else {
+        // 只投影到预测区间内，避免跳到相邻的另一段轨道
+        float half = track_mode_config_.window_sigmas * std::sqrt(arc_.VarianceS()) + last_radius_;
+        float s = track_path_->Project(center, arc_.S() - half, arc_.S() + half, distance);
+        arc_.Correct(s, track_mode_config_.measurement_noise);
+    }
+
+    cv::Point_<float> tangent = track_path_->TangentAt(arc_.S());
+    ball_status_.vx = arc_.V() * tangent.x;
+    ball_status_.vy = arc_.V() * tangent.y;
+    ball_status_.progress = arc_.S() / track_path_->Length();
+}
+
+cv::Rect_<int> BallTracker::TrackWindow(float s, float variance, const cv::Size& image_size) const {
+    // 预测弧长前后若干倍标准差的一段轨道，再向两侧扩展一个半径
+    float radius = last_radius_ > 0.0f ? last_radius_ : kDefaultSearchRadius;
+    float half = track_mode_config_.window_sigmas * std::sqrt(variance) + radius;
+    cv::Point_<float> center = track_path_->PointAt(s);
+    cv::Rect_<int> window = track_path_->Bounds(s - half, s + half, radius + 2.0f) &
+                            cv::Rect_<int>(0, 0, image_size.width, image_size.height);
+    int max_side = MaxSearchSide();
+    if (window.width > max_side || window.height > max_side) {
+        window &= FitWindow(center, max_side, image_size);
+    }
+    if (window.width <= 0 || window.height <= 0) {
+        window = FitWindow(center, static_cast<int>(std::ceil(4.0f * radius)), image_size);
+    }
+    return window;
+}
+
+void BallTracker::FinishUpdate(const cv::Mat& image) {
+    if (rest_pending_) {
+        rest_pending_ = false;
+        // 沿轨道跟踪时速度已由弧长滤波给出，否则取批量校正后的卡尔曼速度
+        if (!OnTrack()) {
+            ball_status_.vx = kalman_->Vx(lane_);
+            ball_status_.vy = kalman_->Vy(lane_);
+        }
+        UpdateRestState(image, pending_moved_);
+    }
+    predicted_ = false;
+}
+
+bool BallTracker::Detect(const cv::Mat& image) {
+    // 静止的球只比较球上的小块，按较低频率做完整检测
+    if (resting_) {
+        if (++frames_since_full_ < adaptive_config_.full_update_interval && IsStillThere(image)) {
+            last_search_roi_ = still_rect_;
+            ball_status_.detected = true;
+            return true;
+        }
+        frames_since_full_ = 0;
     }
 
-    // 检测小球
     cv::Point2f center;
-    float radius;
+    float radius = 0.0f;
     cv::Scalar hsv_detected;
-    bool detected = DetectCircle(roi_image, center, radius, hsv_detected);
+    bool detected = false;
+    bool searched = false;
+
+    // 第一次检测时以初始位置为中心，窗口大小受像素预算限制
+    if (detect_roi_.width == 0 || detect_roi_.height == 0) {
+        detect_roi_ = FitWindow(search_anchor_, MaxSearchSide(), image.size());
+        search_cursor_ = 1;
+    }
+
+    // 同色的球由 TrackerBank 统一检测并分配，直接使用分配结果，避免多个跟踪器锁定同一个球
+    if (assigned_.valid) {
+        searched = true;
+        detected = assigned_.detected;
+        center = assigned_.center;
+        radius = assigned_.radius;
+        hsv_detected = assigned_.hsv;
+        last_search_roi_ = assigned_.window;
+        assigned_.valid = false;
+    }
+
+    // 锁定状态下先从卡尔曼预测位置做种子区域生长，代价只与球的面积有关
+    if (!searched && ball_status_.detected && last_radius_ > 0.0f) {
+        cv::Point2f predicted = PredictedPosition();
+        cv::Rect window;
+        detected = DetectFromSeed(image, predicted, last_radius_, center, radius, hsv_detected, window);
+        if (!detected) {
+            // 预测偏差较大时再以上一帧的检测位置为种子
+            detected = DetectFromSeed(image, last_center_, last_radius_, center, radius, hsv_detected, window);
+        }
+        if (detected) {
+            last_search_roi_ = window;
+        }
+    }
+
+    if (!detected && !searched) {
+        // ROI 限制在图像范围内；预测位置已离开图像时改为贴边的同尺寸窗口
+        cv::Rect_<int> roi = detect_roi_ & cv::Rect_<int>(0, 0, image.cols, image.rows);
+        if (roi.width <= 0 || roi.height <= 0) {
+            cv::Point_<float> roi_center(detect_roi_.x + detect_roi_.width / 2.0f,
+                                         detect_roi_.y + detect_roi_.height / 2.0f);
+            roi = FitWindow(roi_center, std::max(detect_roi_.width, detect_roi_.height), image.size());
+        }
+        detect_roi_ = roi;
+
+        // 走廊外不会有球，只搜索 ROI 中走廊所占的外接矩形
+        cv::Rect_<int> search_rect = HasCorridor() ? corridor_->BoundingRect(detect_roi_) : detect_roi_;
+        last_search_roi_ = search_rect;
+
+        // 种子未命中时在整个 ROI 内检测小球
+        if (search_rect.width > 0 && search_rect.height > 0) {
+            detected = DetectCircle(image, search_rect, center, radius, hsv_detected);
+        }
+        if (detected) {
+            // 将 ROI 局部坐标转换为全局坐标
+            center.x += search_rect.x;
+            center.y += search_rect.y;
+        }
+    }
 
     if (detected) {
-        // 将 ROI 局部坐标转换为全局坐标
-        float global_x = center.x + detect_roi_.x;
-        float global_y = center.y + detect_roi_.y;
+        float global_x = center.x;
+        float global_y = center.y;
+        float moved = static_cast<float>(cv::norm(center - last_center_));
+        last_center_ = cv::Point_<float>(global_x, global_y);
+        last_radius_ = radius;
+        last_hsv_ = hsv_detected;
         
         // 直接使用检测结果更新球状态
         ball_status_.x = global_x;
         ball_status_.y = global_y;
         ball_status_.detected = true;
 
-        // 更新卡尔曼滤波器的状态（但不使用其预测结果）
-        cv::Mat measurement = (cv::Mat_<float>(2, 1) << global_x, global_y);
-        kalman_filter_.correct(measurement);
-
-        // 更新ROI位置和大小（以球为中心，大小为球直径的2倍）
-        int new_size = static_cast<int>(radius * 4);  // 2倍直径
-        detect_roi_.x = static_cast<int>(global_x - static_cast<double>(new_size)/2.0);
-        detect_roi_.y = static_cast<int>(global_y - static_cast<double>(new_size)/2.0);
-        detect_roi_.width = new_size;
-        detect_roi_.height = new_size;
-        
+        bool reacquired = track_state_ == TrackState::LOCAL_SEARCH || track_state_ == TrackState::GLOBAL_SEARCH;
+        if (reacquired) {
+            // 搜索中重新捕获：旧的运动状态已失效，从检测位置重新开始
+            kalman_->Reset(lane_, global_x, global_y);
+        } else {
+            // 更新卡尔曼滤波器的状态（但不使用其预测结果），先预测再校正以保持速度和协方差有效
+            // 测量只排队，由 UpdateWithImage 或 TrackerBank 的批量校正统一应用
+            EnsurePredicted();
+            kalman_->SetMeasurement(lane_, global_x, global_y);
+        }
+        UpdateArc(last_center_, reacquired);
+        track_state_ = TrackState::TRACKING;
+        miss_count_ = 0;
+        search_cursor_ = 0;
+
+        if (OnTrack()) {
+            // 沿轨道跟踪时，下一帧的 ROI 为预测弧长附近的一段轨道
+            detect_roi_ = TrackWindow(arc_.PredictedS(ArcAcceleration()), arc_.PredictedVarianceS(ArcProcessNoise()),
+                                      image.size());
+        } else {
+            // 更新ROI位置和大小（以球为中心，大小为球直径的2倍，不超过像素预算）
+            int new_size = std::min(static_cast<int>(radius * 4), MaxSearchSide());  // 2倍直径
+            detect_roi_.x = static_cast<int>(global_x - static_cast<double>(new_size)/2.0);
+            detect_roi_.y = static_cast<int>(global_y - static_cast<double>(new_size)/2.0);
+            detect_roi_.width = new_size;
+            detect_roi_.height = new_size;
+        }
+
+        // 静止判断依赖校正后的速度和协方差，留到 FinishUpdate
+        rest_pending_ = true;
+        pending_moved_ = moved;
         return true;
     } else {
-        // 检测失败时，使用卡尔曼滤波预测
-        PredictAndUpdate();
+        // 检测失败时推进丢失状态机
+        resting_ = false;
+        rest_count_ = 0;
+        PredictAndUpdate(image.size());
         return false;
     }
 }
 
-void BallTracker::PredictAndUpdate() {
-    // 预测
-    cv::Mat prediction = kalman_filter_.predict();
+BallTrackerSnapshot BallTracker::GetSnapshot() const {
+    BallTrackerSnapshot snapshot;
+    snapshot.id = ball_status_.id;
+    snapshot.search_roi = last_search_roi_;
+    snapshot.detected = ball_status_.detected;
+    snapshot.center = last_center_;
+    snapshot.radius = last_radius_;
+    snapshot.hsv = last_hsv_;
+    snapshot.track_state = track_state_;
+    snapshot.resting = resting_;
+    snapshot.state[0] = kalman_->X(lane_);
+    snapshot.state[1] = kalman_->Y(lane_);
+    snapshot.state[2] = kalman_->Vx(lane_);
+    snapshot.state[3] = kalman_->Vy(lane_);
+    for (int i = 0; i < 4; ++i) {
+        snapshot.covariance[i] = kalman_->Variance(lane_, i);
+    }
+    return snapshot;
+}
 
-    // 更新状态
-    ball_status_.x = prediction.at<float>(0);
-    ball_status_.y = prediction.at<float>(1);
-    ball_status_.vx = prediction.at<float>(2);
-    ball_status_.vy = prediction.at<float>(3);
-    ball_status_.detected = false;
+void BallTracker::SetSearchPrior(const std::vector<cv::Point_<float>>& points) {
+    search_prior_ = points;
+    search_tiles_.clear();  // 下次进入全局搜索时按新的先验重新排序
+}
 
-    // 扩大ROI
-    int new_width = detect_roi_.width * 2;
-    int new_height = detect_roi_.height * 2;
-    
-    // 计算新的ROI位置
-    detect_roi_.x = static_cast<int>(ball_status_.x - static_cast<double>(new_width)/2.0);
-    detect_roi_.y = static_cast<int>(ball_status_.y - static_cast<double>(new_height)/2.0);
-    detect_roi_.width = new_width;
-    detect_roi_.height = new_height;
-    
-    printf("Predict: pos=(%f, %f), roi=(%d, %d, %d, %d)\n",
-           ball_status_.x, ball_status_.y,
-           detect_roi_.x, detect_roi_.y,
-           detect_roi_.width, detect_roi_.height);
+void BallTracker::SetCorridor(const TrackCorridor* corridor) {
+    corridor_ = corridor;
+    search_tiles_.clear();  // 走廊外的块不再搜索，下次进入全局搜索时重新生成
 }
 
-bool BallTracker::DetectCircle(const cv::Mat& image, cv::Point_<float>& center, float& radius, cv::Scalar_<double>& hsv_detected) {
-    // 转换为HSV颜色空间
-    cv::Mat hsv_image;
-    cv::cvtColor(image, hsv_image, cv::COLOR_BGR2HSV);
+void BallTracker::SetTrackPath(const TrackPath* path) {
+    track_path_ = path;
+    arc_valid_ = false;  // 下次检测时投影到新的轨迹上
+}
 
-    // 创建颜色范围掩码
-    cv::Mat mask;
-    cv::Scalar lower_bound = hsv_mean_ - hsv_stddev_ * 2.0;  // 扩大颜色范围
-    cv::Scalar upper_bound = hsv_mean_ + hsv_stddev_ * 2.0;
-    cv::inRange(hsv_image, lower_bound, upper_bound, mask);
+void BallTracker::SetSpeedProfile(const SpeedProfile* profile) {
+    speed_profile_ = profile;
+}
 
-    // 形态学操作
-    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(5, 5));
-    cv::morphologyEx(mask, mask, cv::MORPH_OPEN, kernel);
-    cv::morphologyEx(mask, mask, cv::MORPH_CLOSE, kernel);
+void BallTracker::SetTrackModeConfig(const TrackModeConfig& config) {
+    track_mode_config_ = config;
+    if (!track_mode_config_.enabled) {
+        arc_valid_ = false;
+    }
+}
 
-    // 查找轮廓
-    std::vector<std::vector<cv::Point>> contours;
-    cv::findContours(mask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+void BallTracker::SetAdaptiveUpdateConfig(const AdaptiveUpdateConfig& config) {
+    adaptive_config_ = config;
+    if (!adaptive_config_.enabled) {
+        resting_ = false;
+        rest_count_ = 0;
+    }
+}
 
-    if (contours.empty()) {
-        printf("No contours found\n");
+bool BallTracker::IsStillThere(const cv::Mat& image) const {
+    if (still_reference_.empty() || still_rect_.x + still_rect_.width > image.cols ||
+        still_rect_.y + still_rect_.height > image.rows || image.type() != still_reference_.type()) {
         return false;
     }
+    double diff = cv::norm(image(still_rect_), still_reference_, cv::NORM_L1);
+    return diff <= adaptive_config_.change_threshold * static_cast<double>(still_reference_.total() * still_reference_.channels());
+}
 
-    // 找到最大的轮廓
-    auto max_contour = std::max_element(contours.begin(), contours.end(),
-        [](const auto& c1, const auto& c2) {
-            return cv::contourArea(c1) < cv::contourArea(c2);
-        });
+void BallTracker::UpdateRestState(const cv::Mat& image, float moved) {
+    if (!adaptive_config_.enabled) {
+        return;
+    }
 
-    // 拟合圆
-    cv::Point2f center_temp;
-    float radius_temp;
-    cv::minEnclosingCircle(*max_contour, center_temp, radius_temp);
+    // 由卡尔曼速度、位置协方差和两次检测间的位移判断是否静止
+    float speed = std::hypot(kalman_->Vx(lane_), kalman_->Vy(lane_));
+    float position_variance = kalman_->Variance(lane_, 0) + kalman_->Variance(lane_, 1);
+    bool still = speed < adaptive_config_.rest_speed && moved < adaptive_config_.rest_speed &&
+                 position_variance < adaptive_config_.rest_max_covariance;
+    if (!still) {
+        rest_count_ = 0;
+        resting_ = false;
+        return;
+    }
+    if (++rest_count_ < adaptive_config_.rest_frames) {
+        return;
+    }
+
+    // 进入或保持静止：以球所在的小块作为后续检查的参考
+    int side = std::max(8, static_cast<int>(2.0f * last_radius_));
+    still_rect_ = FitWindow(last_center_, side, image.size());
+    image(still_rect_).copyTo(still_reference_);
+    resting_ = true;
+    frames_since_full_ = 0;
+}
 
-    // 计算平均HSV值
-    cv::Scalar mean_hsv = cv::mean(hsv_image, mask);
+int BallTracker::MaxSearchSide() const {
+    return std::max(16, static_cast<int>(std::sqrt(static_cast<double>(search_config_.pixel_budget))));
+}
+
+cv::Rect_<int> BallTracker::FitWindow(const cv::Point_<float>& center, int side, const cv::Size& image_size) {
+    int width = std::min(side, image_size.width);
+    int height = std::min(side, image_size.height);
+    int x = static_cast<int>(center.x - width / 2.0f);
+    int y = static_cast<int>(center.y - height / 2.0f);
+    x = std::max(0, std::min(x, image_size.width - width));
+    y = std::max(0, std::min(y, image_size.height - height));
+    return cv::Rect_<int>(x, y, width, height);
+}
+
+void BallTracker::BuildSearchTiles(const cv::Size& image_size) {
+    // 相邻块重叠一个球的直径，保证球总能完整落在某一块内
+    int side = MaxSearchSide();
+    float radius = last_radius_ > 0.0f ? last_radius_ : kDefaultSearchRadius;
+    int stride = std::max(side / 2, side - static_cast<int>(std::ceil(2.0f * radius)) - 2);
+
+    auto tile_starts = [stride](int length, int tile) {
+        std::vector<int> starts;
+        for (int start = 0; ; start += stride) {
+            if (start + tile >= length) {
+                starts.push_back(std::max(0, length - tile));
+                break;
+            }
+            starts.push_back(start);
+        }
+        return starts;
+    };
+    int tile_width = std::min(side, image_size.width);
+    int tile_height = std::min(side, image_size.height);
+    std::vector<int> xs = tile_starts(image_size.width, tile_width);
+    std::vector<int> ys = tile_starts(image_size.height, tile_height);
+
+    // 包含先验位置的块优先，其次按与最后位置的距离排序
+    struct RankedTile {
+        cv::Rect_<int> rect;
+        bool prior;
+        float distance;
+    };
+    std::vector<RankedTile> ranked;
+    ranked.reserve(xs.size() * ys.size());
+    for (int y : ys) {
+        for (int x : xs) {
+            RankedTile tile;
+            tile.rect = cv::Rect_<int>(x, y, tile_width, tile_height);
+            if (HasCorridor() && corridor_->BoundingRect(tile.rect).area() == 0) {
+                continue;  // 与走廊不相交的块不可能有球
+            }
+            tile.prior = false;
+            for (const auto& point : search_prior_) {
+                if (tile.rect.contains(cv::Point(static_cast<int>(point.x), static_cast<int>(point.y)))) {
+                    tile.prior = true;
+                    break;
+                }
+            }
+            float dx = x + tile_width / 2.0f - search_anchor_.x;
+            float dy = y + tile_height / 2.0f - search_anchor_.y;
+            tile.distance = dx * dx + dy * dy;
+            ranked.push_back(tile);
+        }
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](const RankedTile& a, const RankedTile& b) {
+        if (a.prior != b.prior) {
+            return a.prior;
+        }
+        return a.distance < b.distance;
+    });
+
+    search_tiles_.clear();
+    for (const auto& tile : ranked) {
+        search_tiles_.push_back(tile.rect);
+    }
+    if (search_tiles_.empty()) {
+        search_tiles_.push_back(cv::Rect_<int>(0, 0, tile_width, tile_height));
+    }
+}
+
+void BallTracker::PredictAndUpdate(const cv::Size& image_size) {
+    ++miss_count_;
+    ball_status_.detected = false;
+    int max_side = MaxSearchSide();
+
+    bool coasting = (track_state_ == TrackState::TRACKING || track_state_ == TrackState::COASTING) &&
+                    miss_count_ <= search_config_.coast_frames;
+    int local_searched = track_state_ == TrackState::LOCAL_SEARCH ? search_cursor_ : 0;
+    bool local = !coasting && track_state_ != TrackState::GLOBAL_SEARCH &&
+                 local_searched < search_config_.local_search_frames;
+
+    if (coasting) {
+        // 短暂丢失：沿卡尔曼预测外推，窗口逐帧扩大但不超过像素预算
+        track_state_ = TrackState::COASTING;
+        EnsurePredicted();
+        if (OnTrack()) {
+            // 沿轨道外推：窗口为下一帧可能到达的一段轨道，随弧长方差自然扩大
+            cv::Point_<float> position = track_path_->PointAt(arc_.S());
+            cv::Point_<float> tangent = track_path_->TangentAt(arc_.S());
+            ball_status_.x = position.x;
+            ball_status_.y = position.y;
+            ball_status_.vx = arc_.V() * tangent.x;
+            ball_status_.vy = arc_.V() * tangent.y;
+            ball_status_.progress = arc_.S() / track_path_->Length();
+            search_anchor_ = position;
+            detect_roi_ = TrackWindow(arc_.PredictedS(ArcAcceleration()), arc_.PredictedVarianceS(ArcProcessNoise()),
+                                      image_size);
+        } else {
+            ball_status_.x = kalman_->X(lane_);
+            ball_status_.y = kalman_->Y(lane_);
+            ball_status_.vx = kalman_->Vx(lane_);
+            ball_status_.vy = kalman_->Vy(lane_);
+
+            int side = static_cast<int>(std::max(detect_roi_.width, detect_roi_.height) * search_config_.coast_growth);
+            side = std::min(std::max(side, 1), max_side);
+            search_anchor_.x = std::max(0.0f, std::min(static_cast<float>(ball_status_.x), image_size.width - 1.0f));
+            search_anchor_.y = std::max(0.0f, std::min(static_cast<float>(ball_status_.y), image_size.height - 1.0f));
+            detect_roi_ = FitWindow(search_anchor_, side, image_size);
+        }
+    } else if (local) {
+        // 预测已不可信：轮流搜索最后位置周围的 3x3 个预算大小的窗口
+        if (track_state_ != TrackState::LOCAL_SEARCH) {
+            track_state_ = TrackState::LOCAL_SEARCH;
+            search_cursor_ = 0;
+        }
+        float radius = last_radius_ > 0.0f ? last_radius_ : kDefaultSearchRadius;
+        int stride = std::max(max_side / 2, max_side - static_cast<int>(std::ceil(2.0f * radius)) - 2);
+        cv::Point_<float> center;
+        if (OnTrack()) {
+            // 沿轨道在丢失位置前后交替搜索：0, +1, -1, +2, -2, ... 个步长
+            int step = (search_cursor_ % 9 + 1) / 2 * (search_cursor_ % 2 == 1 ? 1 : -1);
+            center = track_path_->PointAt(arc_.S() + step * stride);
+        } else {
+            const int* offset = kLocalWindowOffsets[search_cursor_ % 9];
+            center = cv::Point_<float>(search_anchor_.x + offset[0] * stride, search_anchor_.y + offset[1] * stride);
+        }
+        detect_roi_ = FitWindow(center, max_side, image_size);
+        ++search_cursor_;
+        ball_status_.x = search_anchor_.x;
+        ball_status_.y = search_anchor_.y;
+        ball_status_.vx = 0.0;
+        ball_status_.vy = 0.0;
+    } else {
+        // 全局搜索：每帧只搜索一块，按优先级轮转覆盖全图
+        if (track_state_ != TrackState::GLOBAL_SEARCH || search_tiles_.empty()) {
+            track_state_ = TrackState::GLOBAL_SEARCH;
+            BuildSearchTiles(image_size);
+            search_cursor_ = 0;
+        }
+        detect_roi_ = search_tiles_[search_cursor_];
+        search_cursor_ = (search_cursor_ + 1) % static_cast<int>(search_tiles_.size());
+        ball_status_.vx = 0.0;
+        ball_status_.vy = 0.0;
+    }
+
+    printf("Predict: state=%d, pos=(%f, %f), roi=(%d, %d, %d, %d)\n",
+           static_cast<int>(track_state_),
+           ball_status_.x, ball_status_.y,
+           detect_roi_.x, detect_roi_.y,
+           detect_roi_.width, detect_roi_.height);
+}
+
+bool BallTracker::DetectCircle(const cv::Mat& image, const cv::Rect_<int>& rect, cv::Point_<float>& center,
+                               float& radius, cv::Scalar_<double>& hsv_detected) {
+    cv::Scalar lower_bound;
+    cv::Scalar upper_bound;
+    GetColorRange(lower_bound, upper_bound);
+    if (HasCorridor()) {
+        // 只转换并判定走廊内的像素
+        corridor_->Threshold(image, rect, lower_bound, upper_bound, hsv_image_, mask_);
+    } else {
+        // 转换为HSV颜色空间并创建颜色范围掩码
+        cv::cvtColor(image(rect), hsv_image_, cv::COLOR_BGR2HSV);
+        cv::inRange(hsv_image_, lower_bound, upper_bound, mask_);
+    }
+
+    // 游程编码连通域分析，游程长度与面积过滤代替形态学开闭运算
+    int num_blobs = blob_extractor_.Extract(mask_, blobs_);
+    if (num_blobs == 0) {
+        printf("No blobs found\n");
+        return false;
+    }
+
+    // 取面积最大的连通域，用二阶矩拟合圆
+    int best = BlobExtractor::LargestBlob(blobs_);
+    const Blob& blob = blobs_[best];
+    cv::Point2f center_temp = blob.centroid;
+    float radius_temp = blob.MomentRadius();
+
+    // 仅在该连通域的游程上计算平均HSV值
+    cv::Scalar mean_hsv = blob_extractor_.MeanColor(blobs_, best, hsv_image_);
 
     // 更新输出参数
     center = center_temp;
@@ -224,4 +687,129 @@ bool BallTracker::DetectCircle(const cv::Mat& image, cv::Point_<float>& center,
     return true;
 }
 
+bool BallTracker::DetectFromSeed(const cv::Mat& image, const cv::Point_<float>& seed, float expected_radius,
+                                 cv::Point_<float>& center, float& radius, cv::Scalar_<double>& hsv_detected,
+                                 cv::Rect_<int>& window) {
+    // 以种子为中心、数倍半径的窗口限定生长范围
+    int half = std::max(4, static_cast<int>(std::ceil(expected_radius * kSeedWindowRadii)));
+    window = cv::Rect(cvRound(seed.x) - half, cvRound(seed.y) - half, 2 * half + 1, 2 * half + 1) &
+             cv::Rect(0, 0, image.cols, image.rows);
+    if (window.width <= 0 || window.height <= 0) {
+        return false;
+    }
+
+    cv::Scalar lower_bound = hsv_mean_ - hsv_stddev_ * 2.0;  // 与 DetectCircle 相同的颜色范围
+    cv::Scalar upper_bound = hsv_mean_ + hsv_stddev_ * 2.0;
+    seed_state_.create(window.height, window.width, CV_8UC1);
+    seed_state_.setTo(cv::Scalar(kSeedUnknown));
+
+    double area = 0.0;
+    double sum_x = 0.0, sum_y = 0.0, sum_xx = 0.0, sum_yy = 0.0;
+    double sum_h = 0.0, sum_s = 0.0, sum_v = 0.0;
+    bool touches_border = false;
+    bool has_corridor = HasCorridor();
+
+    // 按需做颜色判定，每个像素至多判定一次
+    auto is_ball = [&](int x, int y) -> bool {
+        uchar& state = seed_state_.at<uchar>(y, x);
+        if (state == kSeedUnknown) {
+            // 走廊外的像素直接视为背景
+            if (has_corridor && !corridor_->Contains(window.x + x, window.y + y)) {
+                state = kSeedBackground;
+                return false;
+            }
+            int h, sat, v;
+            BgrToHsv(image.ptr<uchar>(window.y + y) + 3 * (window.x + x), h, sat, v);
+            if (!HsvInRange(h, sat, v, lower_bound, upper_bound)) {
+                state = kSeedBackground;
+                return false;
+            }
+            sum_h += h;
+            sum_s += sat;
+            sum_v += v;
+            state = kSeedBall;
+            return true;
+        }
+        return false;  // 已判定为背景或已填充
+    };
+
+    // 种子点未命中时在其周围的圆周上补充探测
+    cv::Point start(-1, -1);
+    int cx = cvRound(seed.x) - window.x;
+    int cy = cvRound(seed.y) - window.y;
+    float probe = expected_radius * kSeedProbeRadius;
+    for (int i = 0; i < 9 && start.x < 0; ++i) {
+        int px = cx;
+        int py = cy;
+        if (i > 0) {
+            double angle = (i - 1) * CV_PI / 4.0;
+            px += cvRound(probe * std::cos(angle));
+            py += cvRound(probe * std::sin(angle));
+        }
+        if (px >= 0 && py >= 0 && px < window.width && py < window.height && is_ball(px, py)) {
+            start = cv::Point(px, py);
+        }
+    }
+    if (start.x < 0) {
+        return false;
+    }
+
+    // 扫描线填充（8连通），整行游程一次累加矩
+    seed_stack_.clear();
+    seed_stack_.push_back(start);
+    while (!seed_stack_.empty()) {
+        cv::Point p = seed_stack_.back();
+        seed_stack_.pop_back();
+
+        int x0 = p.x;
+        int x1 = p.x;
+        while (x0 > 0 && is_ball(x0 - 1, p.y)) {
+            --x0;
+        }
+        while (x1 < window.width - 1 && is_ball(x1 + 1, p.y)) {
+            ++x1;
+        }
+        if (x0 == 0 || p.y == 0 || x1 == window.width - 1 || p.y == window.height - 1) {
+            touches_border = true;
+        }
+
+        double n = x1 - x0 + 1;
+        double y = p.y;
+        double run_sum_x = n * (x0 + x1) / 2.0;
+        area += n;
+        sum_x += run_sum_x;
+        sum_y += n * y;
+        sum_xx += (static_cast<double>(x1) * (x1 + 1) * (2 * x1 + 1) -
+                   static_cast<double>(x0 - 1) * x0 * (2 * x0 - 1)) / 6.0;
+        sum_yy += n * y * y;
+
+        // 上下两行中与该游程相邻的像素作为新的种子
+        for (int ny = p.y - 1; ny <= p.y + 1; ny += 2) {
+            if (ny < 0 || ny >= window.height) {
+                continue;
+            }
+            for (int nx = std::max(0, x0 - 1); nx <= std::min(window.width - 1, x1 + 1); ++nx) {
+                if (is_ball(nx, ny)) {
+                    seed_stack_.push_back(cv::Point(nx, ny));
+                }
+            }
+        }
+    }
+
+    // 区域触及窗口边界或面积过大说明泄漏到同色背景，交给 ROI 检测
+    float expected_area = static_cast<float>(CV_PI) * expected_radius * expected_radius;
+    if (touches_border || area > expected_area * kSeedMaxAreaRatio || area < blob_extractor_.GetConfig().min_area) {
+        return false;
+    }
+
+    double mean_x = sum_x / area;
+    double mean_y = sum_y / area;
+    double mu20 = sum_xx / area - mean_x * mean_x;
+    double mu02 = sum_yy / area - mean_y * mean_y;
+    center = cv::Point_<float>(static_cast<float>(mean_x + window.x), static_cast<float>(mean_y + window.y));
+    radius = static_cast<float>(std::sqrt(std::max(0.0, 2.0 * (mu20 + mu02))));
+    hsv_detected = cv::Scalar_<double>(sum_h / area, sum_s / area, sum_v / area);
+    return true;
+}
+
 // ... 其他现有方法的实现 ...
\ No newline at end of file
@@ -1,6 +1,8 @@
+#include <algorithm>
 #include <fstream>
 #include <chrono>
 #include <iomanip>
+#include <memory>
 #include <sstream>
 
 #include <nlohmann/json.hpp>
@@ -9,6 +11,129 @@
 #include "ball_tracker_interface.h"
 #include "ball_tracker_algo.h"
 #include "camera_control.h"
+#include "metrics.h"
+#include "metrics_http_server.h"
+#include "offline_track_builder.h"
+#include "pixel_to_arm_map.h"
+#include "roi_recording.h"
+#include "status_ring_publisher.h"
+#include "tracker_bank.h"
+#include "trajectory_compaction.h"
+#include "trajectory_writer.h"
+#include "udp_status_publisher.h"
+
+namespace {
+
+// 初始化轨迹时单个球允许的连续检测失败次数与最大速度（像素/帧）
+constexpr int kInitTrackMaxFailures = 200;
+constexpr double kInitTrackMaxVelocity = 500.0;
+
+std::string CurrentTimestamp() {
+    auto time_t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::stringstream ss;
+    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
+    return ss.str();
+}
+
+}  // namespace
+
+// 跟踪循环记录的指标，注册一次后通过引用无锁记录
+struct BallTrackerInterface::PipelineMetrics {
+    struct BallMetrics {
+        int id = -1;                          // 槽位上一帧的球，换球时重新判断丢失
+        bool searching = false;               // 上一帧是否处于丢失后的搜索状态
+        MetricCounter* lost = nullptr;
+        LatencyHistogram* detect = nullptr;
+    };
+
+    MetricsRegistry registry;
+    MetricCounter& frames;
+    MetricCounter& dropped_frames;
+    MetricCounter& deferred_updates;
+    MetricCounter& spawned;
+    MetricCounter& retired_finished;
+    MetricCounter& retired_lost;
+    MetricCounter& spawns_skipped;
+    MetricGauge& fps;
+    MetricGauge& active_balls;
+    LatencyHistogram& capture;
+    LatencyHistogram& associate;
+    LatencyHistogram& detect;
+    LatencyHistogram& update;
+    LatencyHistogram& lifecycle;
+    LatencyHistogram& output;
+    LatencyHistogram& frame;
+    LatencyHistogram& status_latency;
+    std::vector<MetricCounter*> capture_failures;  // 按 CaptureStatus 取值
+    std::vector<BallMetrics> balls;           // 按槽位
+    TrackerLifecycleStats lifecycle_stats;    // 上一帧的生命周期计数，计数器只累加增量
+    uint64_t last_frame_id = 0;
+    int64_t last_capture_ns = 0;
+    double interval_ns = 0.0;                 // 采集间隔的指数平均
+
+    PipelineMetrics()
+        : frames(registry.Counter("ball_tracker_frames_total", "Frames captured by the tracking loop"))
+        , dropped_frames(registry.Counter("ball_tracker_dropped_frames_total",
+                                          "Frames missing from the source frame counter"))
+        , deferred_updates(registry.Counter("ball_tracker_deferred_updates_total",
+                                            "Ball updates deferred past the frame deadline"))
+        , spawned(registry.Counter("ball_tracker_spawned_total", "Trackers started for balls entering the track"))
+        , retired_finished(registry.Counter("ball_tracker_retired_total", "Trackers retired by reason",
+                                            "reason=\"end_point\""))
+        , retired_lost(registry.Counter("ball_tracker_retired_total", "Trackers retired by reason",
+                                        "reason=\"lost\""))
+        , spawns_skipped(registry.Counter("ball_tracker_spawn_skipped_total",
+                                          "New balls not tracked because the tracker pool was full"))
+        , fps(registry.Gauge("ball_tracker_fps", "Capture rate of the tracking loop"))
+        , active_balls(registry.Gauge("ball_tracker_active_balls", "Balls currently tracked"))
+        , capture(Stage("capture"))
+        , associate(Stage("associate"))
+        , detect(Stage("detect"))
+        , update(Stage("update"))
+        , lifecycle(Stage("lifecycle"))
+        , output(Stage("output"))
+        , frame(Stage("frame"))
+        , status_latency(registry.Histogram("ball_tracker_status_latency_seconds",
+                                            "Time from frame capture to the ball status being ready")) {
+        for (int i = 0; i <= static_cast<int>(CaptureStatus::NOT_OPEN); ++i) {
+            CaptureStatus status = static_cast<CaptureStatus>(i);
+            capture_failures.push_back(status == CaptureStatus::OK ? nullptr :
+                &registry.Counter("ball_tracker_capture_failures_total", "Failed captures by failure class",
+                                  std::string("status=\"") + CaptureStatusName(status) + "\""));
+        }
+    }
+
+    LatencyHistogram& Stage(const char* stage) {
+        return registry.Histogram("ball_tracker_stage_seconds", "Time spent per frame in each pipeline stage",
+                                  std::string("stage=\"") + stage + "\"");
+    }
+
+    MetricCounter& CaptureFailures(CaptureStatus status) {
+        return *capture_failures[static_cast<int>(status)];
+    }
+
+    void RecordLifecycle(const TrackerLifecycleStats& stats) {
+        spawned.Add(stats.spawned - lifecycle_stats.spawned);
+        retired_finished.Add(stats.retired_finished - lifecycle_stats.retired_finished);
+        retired_lost.Add(stats.retired_lost - lifecycle_stats.retired_lost);
+        spawns_skipped.Add(stats.spawns_skipped - lifecycle_stats.spawns_skipped);
+        lifecycle_stats = stats;
+    }
+
+    // 为新增的跟踪器槽位注册指标；按槽位而不是球编号标记，序列数量不随出生的球增长
+    // 只在跟踪线程未运行时调用，跟踪过程中各线程只通过已注册的引用记录
+    void AddSlots(int count) {
+        for (int slot = static_cast<int>(balls.size()); slot < count; ++slot) {
+            std::string label = "slot=\"" + std::to_string(slot) + "\"";
+            BallMetrics ball;
+            ball.lost = &registry.Counter("ball_tracker_ball_lost_total",
+                                          "Times the ball in a tracker slot was lost", label);
+            ball.detect = &registry.Histogram("ball_tracker_ball_detect_seconds",
+                                              "Detection time per tracker slot and frame", label);
+            balls.push_back(ball);
+        }
+    }
+};
 
 // Implementation of CameraImpl class
 class BallTrackerInterface::CameraImpl {
@@ -26,6 +151,11 @@ public:
         return is_initialized;
     }
 
+    bool Initialize(CameraSourceType source_type, const std::string& source, int width, int height, int fps) {
+        is_initialized = camera.Open(source, width, height, fps, source_type);
+        return is_initialized;
+    }
+
     void Release() {
         if (is_initialized) {
             camera.Close();
@@ -40,14 +170,32 @@ public:
         return camera.Capture(frame);
     }
 
+    bool IsEndOfStream() const {
+        return is_initialized && camera.IsEndOfStream();
+    }
+
+    CaptureStatus GetLastStatus() const {
+        return is_initialized ? camera.GetLastStatus() : CaptureStatus::NOT_OPEN;
+    }
+
+    bool Reconnect() {
+        return is_initialized && camera.Reconnect();
+    }
+
+    int GetFps() const {
+        return is_initialized ? camera.GetFps() : 0;
+    }
+
     std::string GetInfo() const {
         return camera.GetInfo();
     }
 };
 
 BallTrackerInterface::BallTrackerInterface(const std::string& balls_config_file_path, const std::pair<double, double>& init_pos)
-    : camera_(std::make_unique<CameraImpl>())
+    : arm_map_(std::make_unique<PixelToArmMap>())
     , balls_config_file_path_(balls_config_file_path)
+    , camera_(std::make_unique<CameraImpl>())
+    , metrics_(std::make_unique<PipelineMetrics>())
 {
     // 读取配置文件
     std::ifstream config_file(balls_config_file_path);
@@ -59,6 +207,7 @@ BallTrackerInterface::BallTrackerInterface(const std::string& balls_config_file_
     config_file >> config;
 
     // 创建球检测器
+    trackers_ = std::make_unique<TrackerBank>(static_cast<int>(config["balls"].size()));
     for (const auto& ball_config : config["balls"]) {
         int ball_id = ball_config["id"];
         std::string color = ball_config["color"];
@@ -67,18 +216,44 @@ BallTrackerInterface::BallTrackerInterface(const std::string& balls_config_file_
         
         // 使用传入的初始位置
         cv::Point2d init_pos_point(init_pos.first, init_pos.second);
-        ball_trackers_.push_back(std::make_unique<BallTracker>(ball_id, color, hsv_mean, hsv_stddev, init_pos_point));
+        trackers_->Add(ball_id, color, hsv_mean, hsv_stddev, init_pos_point);
     }
+    ball_priorities_.assign(trackers_->Size(), 0.0);
+    has_ball_priority_.assign(trackers_->Size(), 0);
+    deferred_updates_.assign(trackers_->Size(), 0);
+    metrics_->AddSlots(trackers_->Size());
 }
 
 BallTrackerInterface::~BallTrackerInterface() {
     StopTracking();  // 确保在析构时停止跟踪
+    StopRoiRecording();
+    StopStatusSharing();
+    StopStatusStreaming();
+    StopMetricsServer();
 }
 
 void BallTrackerInterface::SetHeightParameters(const HeightParameters& heights) {
+    std::lock_guard<std::mutex> lock(scheduler_mutex_);
     height_params_ = heights;
-    // TODO: 在这里可以添加基于高度参数的预计算逻辑
-    // 例如：计算小球的像素大小等
+    arm_map_->SetCameraHeight(heights.camera_height);
+}
+
+bool BallTrackerInterface::LoadCameraCalibration(const std::string& path) {
+    CameraCalibration calibration;
+    if (!PixelToArmMap::LoadCalibration(path, calibration)) {
+        return false;
+    }
+    return SetCameraCalibration(calibration);
+}
+
+bool BallTrackerInterface::SetCameraCalibration(const CameraCalibration& calibration) {
+    std::lock_guard<std::mutex> lock(tracking_mutex_);
+    if (is_tracking_) {
+        std::cerr << "Camera calibration cannot be changed while tracking" << std::endl;
+        return false;
+    }
+    std::lock_guard<std::mutex> scheduler_lock(scheduler_mutex_);
+    return arm_map_->Build(calibration);
 }
 
 bool BallTrackerInterface::InitializeCamera(int camera_id, int width, int height, int fps) {
@@ -89,6 +264,10 @@ bool BallTrackerInterface::InitializeCamera(const std::string& video_path, int w
     return camera_->Initialize(video_path, width, height, fps);
 }
 
+bool BallTrackerInterface::InitializeCamera(CameraSourceType source_type, const std::string& source, int width, int height, int fps) {
+    return camera_->Initialize(source_type, source, width, height, fps);
+}
+
 int BallTrackerInterface::InitTrack(const std::string &out_trajectory_file_path)
 {
     // 检查相机是否已初始化
@@ -99,125 +278,308 @@ int BallTrackerInterface::InitTrack(const std::string &out_trajectory_file_path)
         }
     }
 
-    // 创建轨迹数据结构
-    nlohmann::json trajectory_data;
-    trajectory_data["track_trajectory"]["points"] = nlohmann::json::array();
-    trajectory_data["track_trajectory"]["length"] = 0.0;
-    trajectory_data["track_trajectory"]["start_point"] = nlohmann::json::object();
-    trajectory_data["track_trajectory"]["end_point"] = nlohmann::json::object();
-    
     // 记录开始时间
-    auto start_time = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(start_time);
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-    trajectory_data["track_trajectory"]["timestamp"] = ss.str();
+    std::string timestamp = CurrentTimestamp();
+
+    // 所有配置的球在同一次采集中一起跟踪，每个球一条轨迹
+    // 轨迹点记录在紧凑的预分配缓冲区中，边记录边分块写入文件，中途崩溃也留下可用的轨迹
+    std::vector<int> slots;
+    for (int i = 0; i < trackers_->Size(); ++i) {
+        if (trackers_->IsActive(i)) {
+            slots.push_back(i);
+        }
+    }
+    int num_balls = static_cast<int>(slots.size());
+    std::vector<std::unique_ptr<TrajectoryWriter>> trajectories;
+    init_track_stats_.assign(num_balls, InitTrackBallStats());
+    for (int k = 0; k < num_balls; ++k) {
+        InitTrackBallStats& stats = init_track_stats_[k];
+        stats.id = trackers_->GetId(slots[k]);
+        stats.trajectory_file = TrajectoryFilePath(out_trajectory_file_path, k, stats.id);
+        trajectories.push_back(std::make_unique<TrajectoryWriter>());
+        if (!trajectories[k]->Open(stats.trajectory_file, timestamp)) {
+            return static_cast<int>(InitTrackErrorCode::CAMERA_CAPTURE_ERROR);
+        }
+    }
 
-    // 记录第一个点作为起点
-    bool first_point = true;
-    cv::Point2d start_point;
     int consecutive_failures = 0;
-    const int MAX_CONSECUTIVE_FAILURES = 200;  // 增加允许的连续失败次数
-    int frame_count = 0;
-    const double MAX_VELOCITY = 500.0;
-    int total_frames = 0;
-    int success_frames = 0;
+    cv::Size frame_size;
+    std::vector<int> recording(num_balls);                   // 仍在记录的球
+    for (int k = 0; k < num_balls; ++k) {
+        recording[k] = k;
+    }
+    std::vector<int> failures(num_balls, 0);                 // 每个球的连续检测失败次数
+    std::vector<uint8_t> detected(num_balls, 0);
+    std::vector<std::vector<int>> point_frames(num_balls);   // 每个轨迹点的帧号，用于学习速度曲线
+    int frame_index = -1;
 
     // 循环采集图像并记录轨迹
-    while (true) {
-        frame_count++;
-        total_frames++;
-
+    while (!recording.empty()) {
         // 采集图像
         cv::Mat frame;
         if (!camera_->Capture(frame)) {
-            std::cout << "视频文件读取结束" << std::endl;
-            break;
+            CaptureStatus status = camera_->GetLastStatus();
+            if (status == CaptureStatus::END_OF_STREAM) {
+                std::cout << "视频文件读取结束" << std::endl;
+                break;
+            }
+            // 超时和单帧转换失败可重试，设备丢失则终止初始化
+            if ((status == CaptureStatus::TIMEOUT || status == CaptureStatus::CONVERSION_ERROR) &&
+                ++consecutive_failures < kInitTrackMaxFailures) {
+                for (int k : recording) {
+                    init_track_stats_[k].total_frames++;
+                }
+                continue;
+            }
+            std::cout << "图像采集失败: " << CaptureStatusName(status) << std::endl;
+            return static_cast<int>(InitTrackErrorCode::CAMERA_CAPTURE_ERROR);
         }
+        consecutive_failures = 0;
+        frame_size = frame.size();
+        frame_index++;
+
+        // 解码只做一次，各球的检测分散到多个线程；同色球统一检测并分配
+        trackers_->BeginFrame();
+        trackers_->Associate(frame);
+        int num_recording = static_cast<int>(recording.size());
+        #pragma omp parallel for schedule(dynamic)
+        for (int r = 0; r < num_recording; ++r) {
+            detected[r] = trackers_->Detect(slots[recording[r]], frame) ? 1 : 0;
+        }
+        trackers_->EndFrame(frame);
+
+        for (int r = 0; r < num_recording; ++r) {
+            int k = recording[r];
+            InitTrackBallStats& stats = init_track_stats_[k];
+            stats.total_frames++;
+            auto status = trackers_->Get(slots[k]).GetStatus();
 
-        // 只使用第一个球来更新跟踪状态
-        if (!ball_trackers_.empty()) {
-            bool update_success = ball_trackers_[0]->UpdateWithImage(frame);
-            auto status = ball_trackers_[0]->GetStatus();
-            
             // 检查检测结果是否合理
-            bool is_valid = update_success;
-            if (update_success) {
+            bool is_valid = detected[r] != 0;
+            if (is_valid) {
                 // 检查速度是否在合理范围内
                 double speed = std::sqrt(status.vx * status.vx + status.vy * status.vy);
-                if (speed > MAX_VELOCITY) {
-                    std::cout << "速度过大: " << speed << std::endl;
+                if (speed > kInitTrackMaxVelocity) {
+                    std::cout << "球 " << stats.id << " 速度过大: " << speed << std::endl;
                     is_valid = false;
                 }
             }
 
             if (is_valid) {
-                // 记录轨迹点
-                nlohmann::json point;
-                point["x"] = status.x;
-                point["y"] = status.y;
-                trajectory_data["track_trajectory"]["points"].push_back(point);
-
-                // 记录起点
-                if (first_point) {
-                    start_point = cv::Point2d(status.x, status.y);
-                    trajectory_data["track_trajectory"]["start_point"]["x"] = status.x;
-                    trajectory_data["track_trajectory"]["start_point"]["y"] = status.y;
-                    first_point = false;
-                }
+                // 记录轨迹点，起点、终点与长度由写入器维护
+                trajectories[k]->Add(status.x, status.y);
+                point_frames[k].push_back(frame_index);
 
-                // 更新终点
-                trajectory_data["track_trajectory"]["end_point"]["x"] = status.x;
-                trajectory_data["track_trajectory"]["end_point"]["y"] = status.y;
-                
                 // 重置连续失败计数
-                consecutive_failures = 0;
-                success_frames++;
+                failures[k] = 0;
+                stats.success_frames++;
             } else {
-                consecutive_failures++;
-                std::cout << "检测失败，连续失败次数: " << consecutive_failures << std::endl;
-                
-                // 如果连续失败次数超过阈值，返回错误
-                if (consecutive_failures >= MAX_CONSECUTIVE_FAILURES) {
-                    std::cout << "连续失败次数超过阈值，终止跟踪" << std::endl;
-                    // 检查成功率是否足够
-                    double success_rate = static_cast<double>(success_frames) / total_frames;
-                    if (success_rate < 0.5) {  // 如果成功率低于50%，返回错误
-                        return static_cast<int>(InitTrackErrorCode::BALL_LOST_DURING_TRACKING);
-                    } else {
-                        break;  // 如果成功率足够，正常结束跟踪
-                    }
+                failures[k]++;
+                stats.max_consecutive_failures = std::max(stats.max_consecutive_failures, failures[k]);
+                std::cout << "球 " << stats.id << " 检测失败，连续失败次数: " << failures[k] << std::endl;
+
+                // 连续失败次数超过阈值，该球停止记录
+                if (failures[k] >= kInitTrackMaxFailures) {
+                    std::cout << "球 " << stats.id << " 连续失败次数超过阈值，终止跟踪" << std::endl;
+                    // 检查成功率是否足够，低于50%视为丢失
+                    double success_rate = static_cast<double>(stats.success_frames) / stats.total_frames;
+                    stats.lost = success_rate < 0.5;
+                    recording[r] = -1;
                 }
             }
         }
+        recording.erase(std::remove(recording.begin(), recording.end(), -1), recording.end());
+    }
+
+    // 写入剩余的点和轨迹长度
+    bool any_lost = false;
+    std::vector<std::vector<cv::Point_<float>>> compact(num_balls);
+    std::vector<const std::vector<cv::Point_<float>>*> paths;
+    std::vector<SpeedRun> runs;
+    for (int k = 0; k < num_balls; ++k) {
+        InitTrackBallStats& stats = init_track_stats_[k];
+        runs.push_back({&trajectories[k]->Points(), &point_frames[k]});
+        if (!CloseTrajectory(*trajectories[k], stats, compact[k])) {
+            return static_cast<int>(InitTrackErrorCode::CAMERA_CAPTURE_ERROR);
+        }
+        std::cout << "球 " << stats.id << " 轨迹点数: " << stats.points << " (压缩后 " << stats.compact_points
+                  << "), 长度: " << stats.length << ", 成功帧: " << stats.success_frames << "/"
+                  << stats.total_frames << std::endl;
+        any_lost = any_lost || stats.lost;
+        paths.push_back(compact[k].empty() ? &trajectories[k]->Points() : &compact[k]);
+    }
+    if (any_lost) {
+        return static_cast<int>(InitTrackErrorCode::BALL_LOST_DURING_TRACKING);
     }
 
-    // 计算轨迹总长度
-    double total_length = 0.0;
-    auto& points = trajectory_data["track_trajectory"]["points"];
-    for (size_t i = 1; i < points.size(); ++i) {
-        double dx = points[i]["x"].get<double>() - points[i-1]["x"].get<double>();
-        double dy = points[i]["y"].get<double>() - points[i-1]["y"].get<double>();
-        total_length += std::sqrt(dx*dx + dy*dy);
+    ApplyTrackModel(paths, runs, frame_size);
+    return static_cast<int>(InitTrackErrorCode::SUCCESS);
+}
+
+int BallTrackerInterface::InitTrackOffline(const std::string& video_path, const std::string& out_trajectory_file_path)
+{
+    std::string timestamp = CurrentTimestamp();
+    auto start_time = std::chrono::steady_clock::now();
+
+    // 所有配置的球都从录像中重新提取轨迹，起点取跟踪器当前的位置
+    std::vector<int> slots;
+    OfflineTrackBuilder builder(offline_config_);
+    for (int i = 0; i < trackers_->Size(); ++i) {
+        if (trackers_->IsActive(i)) {
+            const BallTracker& tracker = trackers_->Get(i);
+            cv::Scalar_<double> lower;
+            cv::Scalar_<double> upper;
+            tracker.GetColorRange(lower, upper);
+            builder.AddBall(trackers_->GetId(i), lower, upper, tracker.GetPosition());
+            slots.push_back(i);
+        }
     }
-    trajectory_data["track_trajectory"]["length"] = total_length;
 
-    // 保存轨迹数据到文件
-    std::ofstream trajectory_file(out_trajectory_file_path);
-    if (!trajectory_file.is_open()) {
-        return static_cast<int>(InitTrackErrorCode::CAMERA_CAPTURE_ERROR);
+    // 分段并行解码与粗检测，之后顺序关联各帧的检测结果
+    if (!builder.Detect(video_path)) {
+        return static_cast<int>(InitTrackErrorCode::CAMERA_NOT_CONNECTED);
     }
-    trajectory_file << std::setw(4) << trajectory_data << std::endl;
+    auto detect_time = std::chrono::steady_clock::now();
+    builder.Link(trackers_->GetAssociationConfig(), kInitTrackMaxVelocity, kInitTrackMaxFailures);
+    auto link_time = std::chrono::steady_clock::now();
+    std::cout << "离线检测: " << builder.GetFrameCount() << " 帧, " << builder.GetSegmentCount() << " 段, "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(detect_time - start_time).count() << " ms; 关联: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(link_time - detect_time).count() << " ms" << std::endl;
 
+    int num_balls = static_cast<int>(slots.size());
+    bool any_lost = false;
+    std::vector<std::unique_ptr<TrajectoryWriter>> trajectories;
+    std::vector<std::vector<cv::Point_<float>>> compact(num_balls);
+    std::vector<const std::vector<cv::Point_<float>>*> paths;
+    std::vector<SpeedRun> runs;
+    init_track_stats_.assign(num_balls, InitTrackBallStats());
+    for (int k = 0; k < num_balls; ++k) {
+        const OfflineBallTrack& track = builder.GetTrack(k);
+        InitTrackBallStats& stats = init_track_stats_[k];
+        stats.id = track.id;
+        stats.trajectory_file = TrajectoryFilePath(out_trajectory_file_path, k, stats.id);
+        stats.total_frames = track.total_frames;
+        stats.success_frames = track.success_frames;
+        stats.max_consecutive_failures = track.max_consecutive_failures;
+        stats.lost = track.lost;
+
+        trajectories.push_back(std::make_unique<TrajectoryWriter>());
+        TrajectoryWriter& writer = *trajectories[k];
+        if (!writer.Open(stats.trajectory_file, timestamp)) {
+            return static_cast<int>(InitTrackErrorCode::CAMERA_CAPTURE_ERROR);
+        }
+        for (const auto& point : track.points) {
+            writer.Add(point.x, point.y);
+        }
+        runs.push_back({&writer.Points(), &track.frames});
+        if (!CloseTrajectory(writer, stats, compact[k])) {
+            return static_cast<int>(InitTrackErrorCode::CAMERA_CAPTURE_ERROR);
+        }
+        std::cout << "球 " << stats.id << " 轨迹点数: " << stats.points << " (插值 " << track.filled_frames
+                  << ", 压缩后 " << stats.compact_points << "), 长度: " << stats.length << ", 成功帧: "
+                  << stats.success_frames << "/" << stats.total_frames << std::endl;
+        any_lost = any_lost || stats.lost;
+        paths.push_back(compact[k].empty() ? &writer.Points() : &compact[k]);
+    }
+    if (any_lost) {
+        return static_cast<int>(InitTrackErrorCode::BALL_LOST_DURING_TRACKING);
+    }
+
+    ApplyTrackModel(paths, runs, builder.GetFrameSize());
     return static_cast<int>(InitTrackErrorCode::SUCCESS);
 }
 
+bool BallTrackerInterface::CloseTrajectory(TrajectoryWriter& writer, InitTrackBallStats& stats,
+                                           std::vector<cv::Point_<float>>& compact) {
+    // 平滑、简化并等弧长重采样的轨迹与原始点一起保存，之后作为轨道模型使用
+    compact.clear();
+    if (compaction_config_.enabled && writer.Points().size() >= 2) {
+        float max_error = 0.0f;
+        compact = CompactTrajectory(writer.Points(), compaction_config_, max_error);
+        writer.SetCompact(compact, compaction_config_.spacing, max_error);
+        stats.compact_max_error = max_error;
+    }
+    if (!writer.Close()) {
+        return false;
+    }
+    stats.points = static_cast<int>(writer.Points().size());
+    stats.compact_points = static_cast<int>(compact.size());
+    stats.length = writer.Length();
+    return true;
+}
+
+std::string BallTrackerInterface::TrajectoryFilePath(const std::string& path, int index, int ball_id) {
+    // 第一个球使用给定的文件名，其余的球在扩展名前加上球的编号
+    if (index == 0) {
+        return path;
+    }
+    size_t slash = path.find_last_of("/\\");
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        dot = path.size();
+    }
+    return path.substr(0, dot) + "_ball" + std::to_string(ball_id) + path.substr(dot);
+}
+
+void BallTrackerInterface::ApplyTrackModel(const std::vector<const std::vector<cv::Point_<float>>*>& paths,
+                                           const std::vector<SpeedRun>& runs, const cv::Size& frame_size) {
+    // 所有轨迹都作为丢球后全局搜索的先验，并共同构成检测走廊
+    std::vector<cv::Point_<float>> prior;
+    std::vector<std::vector<cv::Point_<float>>> corridor_paths;
+    const std::vector<cv::Point_<float>>* longest = nullptr;
+    double longest_length = -1.0;
+    for (const auto* path : paths) {
+        if (path->empty()) {
+            continue;
+        }
+        prior.insert(prior.end(), path->begin(), path->end());
+        corridor_paths.push_back(*path);
+        double length = 0.0;
+        for (size_t i = 1; i < path->size(); ++i) {
+            length += cv::norm((*path)[i] - (*path)[i - 1]);
+        }
+        if (length > longest_length) {
+            longest_length = length;
+            longest = path;
+        }
+    }
+    trackers_->SetSearchPrior(prior);
+    if (longest == nullptr) {
+        return;
+    }
+
+    // 最长的轨迹作为轨道模型：沿弧长跟踪、出生区与终点都以它为准
+    // 所有球的记录合并为沿轨道的速度曲线，预测时加入各段的期望加速度
+    trackers_->SetTrackPath(*longest);
+    trackers_->SetSpeedProfile(runs);
+
+    // 球只会出现在轨迹附近：之后的检测与重新捕获都限制在按球半径膨胀的轨迹走廊内
+    if (corridor_config_.enabled) {
+        float radius = 0.0f;
+        for (int i = 0; i < trackers_->Size(); ++i) {
+            if (trackers_->IsActive(i)) {
+                radius = std::max(radius, trackers_->Get(i).GetRadius());
+            }
+        }
+        int half_width = std::max(corridor_config_.min_half_width,
+                                  static_cast<int>(std::ceil(corridor_config_.half_width_radii * radius)));
+        trackers_->SetCorridor(corridor_paths, half_width, frame_size);
+    }
+
+    // 新球从轨迹起点进入，到达终点后离开
+    trackers_->SetSpawnZones({longest->front()});
+    trackers_->SetEndPoint(longest->back());
+}
+
 void BallTrackerInterface::StartTracking()
 {
     std::lock_guard<std::mutex> lock(tracking_mutex_);
     if (is_tracking_) {
         return;  // 已经在跟踪中
     }
+    if (tracking_thread_.joinable()) {
+        tracking_thread_.join();  // 回收因输入结束而自行退出的跟踪线程
+    }
 
     // 检查相机是否已初始化
     if (!camera_->is_initialized) {
@@ -233,39 +595,513 @@ void BallTrackerInterface::StartTracking()
 
 void BallTrackerInterface::StopTracking() {
     std::lock_guard<std::mutex> lock(tracking_mutex_);
-    if (!is_tracking_) {
-        return;  // 已经停止跟踪
+    {
+        std::lock_guard<std::mutex> stop_lock(stop_mutex_);
+        is_tracking_ = false;
     }
-
-    is_tracking_ = false;
+    stop_cv_.notify_all();  // 立即唤醒处于退避等待中的跟踪线程
     if (tracking_thread_.joinable()) {
         tracking_thread_.join();
     }
 }
 
 void BallTrackerInterface::TrackingLoop() {
+    int consecutive_failures = 0;
+    int reconnect_attempts = 0;
+    cv::Mat frame;  // 跨帧保留，转换输出和视频文件预取环的缓冲区得以复用
+
     // 循环跟踪直到StopTracking被调用
     while (is_tracking_) {
         // 采集图像
-        cv::Mat frame;
+        int64_t capture_start_ns = MetricsNowNs();
         if (!camera_->Capture(frame)) {
-            continue;  // 采集失败，继续下一帧
+            CaptureStatus status = camera_->GetLastStatus();
+            last_capture_status_ = status;
+            consecutive_failures++;
+            metrics_->CaptureFailures(status).Add();
+            if (capture_event_callback_) {
+                capture_event_callback_(status, consecutive_failures);
+            }
+            if (!HandleCaptureFailure(status, consecutive_failures, reconnect_attempts)) {
+                is_tracking_ = false;
+                break;
+            }
+            continue;
         }
 
-        // 并行更新每个小球的跟踪状态
-        #pragma omp parallel for
-        for (int i = 0; i < ball_trackers_.size(); ++i) {
-            ball_trackers_[i]->UpdateWithImage(frame);
+        last_capture_status_ = CaptureStatus::OK;
+        if (consecutive_failures > 0) {
+            std::cout << "图像采集恢复，此前连续失败 " << consecutive_failures << " 次" << std::endl;
+            if (capture_event_callback_) {
+                capture_event_callback_(CaptureStatus::OK, consecutive_failures);
+            }
+            consecutive_failures = 0;
+            reconnect_attempts = 0;
         }
-        
-        // 确保所有线程都完成后再继续
-        #pragma omp barrier
 
-        // 通知回调函数
-        NotifyBallStatusUpdate();
+        RecordCaptureMetrics(capture_start_ns);
+
+        // 在帧截止时间内按优先级更新各小球
+        UpdateTrackers(frame);
+        RecordBallMetrics();
+        int64_t capture_ns = camera_->camera.GetLastTimestamp();
+        int64_t status_ns = MetricsNowNs();
+        if (capture_ns > 0 && status_ns >= capture_ns) {
+            metrics_->status_latency.Record(status_ns - capture_ns);
+        }
+
+        {
+            ScopedLatency output_latency(metrics_->output);
+            PublishStatus();
+            RecordRoiFrame(frame, capture_ns);
+
+            // 通知回调函数
+            NotifyBallStatusUpdate();
+        }
+        metrics_->frame.Record(MetricsNowNs() - capture_start_ns);
+    }
+}
+
+void BallTrackerInterface::RecordCaptureMetrics(int64_t capture_start_ns) {
+    PipelineMetrics& metrics = *metrics_;
+    int64_t now_ns = MetricsNowNs();
+    metrics.capture.Record(now_ns - capture_start_ns);
+    metrics.frames.Add();
+
+    // 源帧号跳跃即采集前丢帧；帧号回退说明源被重新打开
+    uint64_t frame_id = camera_->camera.GetLastFrameId();
+    if (metrics.last_capture_ns > 0 && frame_id > metrics.last_frame_id + 1) {
+        metrics.dropped_frames.Add(frame_id - metrics.last_frame_id - 1);
+    }
+    metrics.last_frame_id = frame_id;
+
+    if (metrics.last_capture_ns > 0) {
+        double interval = static_cast<double>(now_ns - metrics.last_capture_ns);
+        metrics.interval_ns = metrics.interval_ns > 0.0 ? 0.9 * metrics.interval_ns + 0.1 * interval : interval;
+        if (metrics.interval_ns > 0.0) {
+            metrics.fps.Set(1e9 / metrics.interval_ns);
+        }
+    }
+    metrics.last_capture_ns = now_ns;
+}
+
+void BallTrackerInterface::RecordBallMetrics() {
+    int active = 0;
+    for (int i = 0; i < trackers_->Size(); ++i) {
+        if (!trackers_->IsActive(i)) {
+            continue;
+        }
+        active++;
+        // 进入局部或全局搜索即视为丢失一次
+        TrackState state = trackers_->GetTrackState(i);
+        bool searching = state == TrackState::LOCAL_SEARCH || state == TrackState::GLOBAL_SEARCH;
+        PipelineMetrics::BallMetrics& ball = metrics_->balls[i];
+        int id = trackers_->GetId(i);
+        if (ball.id != id) {
+            ball.id = id;
+            ball.searching = false;
+        }
+        if (searching && !ball.searching) {
+            ball.lost->Add();
+        }
+        ball.searching = searching;
+    }
+    metrics_->active_balls.Set(active);
+}
+
+void BallTrackerInterface::UpdateTrackers(const cv::Mat& frame) {
+    auto deadline = FrameScheduler::Clock::now() + std::chrono::microseconds(
+        static_cast<int64_t>(scheduler_.GetDeadlineMs(camera_->GetFps()) * 1000.0));
+
+    // 已锁定的球优先，其次按调用方优先级或轨道进度排序，丢失球的搜索使用剩余时间
+    std::vector<ScheduledTask> tasks;
+    tasks.reserve(trackers_->Size());
+    {
+        std::lock_guard<std::mutex> lock(scheduler_mutex_);
+        for (int i = 0; i < trackers_->Size(); ++i) {
+            if (!trackers_->IsActive(i)) {
+                continue;
+            }
+            ScheduledTask task;
+            task.index = i;
+            TrackState state = trackers_->GetTrackState(i);
+            task.tier = (state == TrackState::LOCAL_SEARCH || state == TrackState::GLOBAL_SEARCH) ? 1 : 0;
+            task.priority = has_ball_priority_[i] ? ball_priorities_[i] : trackers_->GetProgress(i);
+            tasks.push_back(task);
+        }
+    }
+
+    // 卡尔曼预测与校正对所有球批量执行，同色球统一检测并分配，只有各球的图像检测按截止时间调度
+    PipelineMetrics& metrics = *metrics_;
+    int64_t stage_ns = MetricsNowNs();
+    trackers_->BeginFrame();
+    trackers_->Associate(frame);
+    int64_t now_ns = MetricsNowNs();
+    metrics.associate.Record(now_ns - stage_ns);
+    stage_ns = now_ns;
+    scheduler_.Run(tasks, deadline, [this, &frame, &metrics](int index) {
+        int64_t start_ns = MetricsNowNs();
+        trackers_->Detect(index, frame);
+        metrics.balls[index].detect->Record(MetricsNowNs() - start_ns);
+    });
+    now_ns = MetricsNowNs();
+    metrics.detect.Record(now_ns - stage_ns);
+    stage_ns = now_ns;
+    trackers_->EndFrame(frame);
+    now_ns = MetricsNowNs();
+    metrics.update.Record(now_ns - stage_ns);
+    stage_ns = now_ns;
+    trackers_->UpdateLifecycle(frame, lifecycle_changes_);
+    metrics.RecordLifecycle(trackers_->GetLifecycleStats());
+    metrics.lifecycle.Record(MetricsNowNs() - stage_ns);
+
+    std::lock_guard<std::mutex> lock(scheduler_mutex_);
+    for (int slot : lifecycle_changes_) {
+        // 槽位换了球，调用方为旧球设置的优先级不再适用
+        has_ball_priority_[slot] = 0;
+    }
+    for (int i = 0; i < trackers_->Size(); ++i) {
+        deferred_updates_[i] = scheduler_.IsDeferred(static_cast<int>(i)) ? 1 : 0;
+        metrics.deferred_updates.Add(deferred_updates_[i]);
+    }
+    scheduler_stats_ = scheduler_.GetStats();
+
+    // 本帧结束时的状态快照，其他线程只读快照，不直接读取跟踪线程正在写的跟踪器
+    // 只包含正在跟踪的槽位，并标记本帧因截止时间被推迟更新的小球
+    status_snapshot_.clear();
+    status_snapshot_slots_.clear();
+    for (int i = 0; i < trackers_->Size(); ++i) {
+        if (trackers_->IsActive(i)) {
+            status_snapshot_.push_back(trackers_->Get(i).GetStatus());
+            status_snapshot_.back().deferred = deferred_updates_[i] != 0;
+            status_snapshot_slots_.push_back(i);
+        }
     }
 }
 
+bool BallTrackerInterface::HandleCaptureFailure(CaptureStatus status, int consecutive_failures, int& reconnect_attempts) {
+    switch (status) {
+        case CaptureStatus::END_OF_STREAM:
+            std::cout << "输入源已结束，停止跟踪" << std::endl;
+            return false;
+        case CaptureStatus::CONVERSION_ERROR:
+            // 偶发转换失败只丢弃本帧；持续失败（如不支持的像素格式）不会等待出图节拍，
+            // 超过阈值后与超时一样退避重连，避免空转占满CPU
+            if (consecutive_failures < retry_policy_.conversion_errors_before_reconnect) {
+                return true;
+            }
+            break;
+        case CaptureStatus::TIMEOUT:
+            // 后端已在内部等待过，连续超时过多时按设备丢失处理
+            if (consecutive_failures < retry_policy_.timeouts_before_reconnect) {
+                return true;
+            }
+            break;
+        default:
+            break;
+    }
+
+    if (retry_policy_.max_reconnect_attempts >= 0 && reconnect_attempts >= retry_policy_.max_reconnect_attempts) {
+        std::cerr << "相机重连失败 " << reconnect_attempts << " 次，停止跟踪" << std::endl;
+        return false;
+    }
+
+    // 指数退避后重连，等待期间可被StopTracking立即打断
+    int64_t backoff_ms = static_cast<int64_t>(std::max(1, retry_policy_.initial_backoff_ms)) << std::min(reconnect_attempts, 16);
+    backoff_ms = std::min<int64_t>(backoff_ms, retry_policy_.max_backoff_ms);
+    std::cerr << "图像采集失败(" << CaptureStatusName(status) << ")，" << backoff_ms << " ms 后尝试重连" << std::endl;
+    if (WaitForStop(static_cast<int>(backoff_ms))) {
+        return false;
+    }
+    reconnect_attempts++;
+    camera_->Reconnect();
+    return true;
+}
+
+bool BallTrackerInterface::WaitForStop(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(stop_mutex_);
+    return stop_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] { return !is_tracking_; });
+}
+
+void BallTrackerInterface::RegisterCaptureEventCallback(CaptureEventCallback callback) {
+    capture_event_callback_ = std::move(callback);
+}
+
+void BallTrackerInterface::SetCaptureRetryPolicy(const CaptureRetryPolicy& policy) {
+    std::lock_guard<std::mutex> lock(tracking_mutex_);
+    if (is_tracking_) {
+        std::cerr << "Capture retry policy cannot be changed while tracking" << std::endl;
+        return;
+    }
+    retry_policy_ = policy;
+}
+
+void BallTrackerInterface::SetAdaptiveUpdateConfig(const AdaptiveUpdateConfig& config) {
+    std::lock_guard<std::mutex> lock(tracking_mutex_);
+    if (is_tracking_) {
+        std::cerr << "Adaptive update config cannot be changed while tracking" << std::endl;
+        return;
+    }
+    trackers_->SetAdaptiveUpdateConfig(config);
+}
+
+void BallTrackerInterface::SetAssociationConfig(const AssociationConfig& config) {
+    std::lock_guard<std::mutex> lock(tracking_mutex_);
+    if (is_tracking_) {
+        std::cerr << "Association config cannot be changed while tracking" << std::endl;
+        return;
+    }
+    trackers_->SetAssociationConfig(config);
+}
+
+void BallTrackerInterface::SetTrackerLifecycleConfig(const TrackerLifecycleConfig& config) {
+    std::lock_guard<std::mutex> lock(tracking_mutex_);
+    if (is_tracking_) {
+        std::cerr << "Tracker lifecycle config cannot be changed while tracking" << std::endl;
+        return;
+    }
+    trackers_->SetLifecycleConfig(config);
+    metrics_->AddSlots(trackers_->Size());
+    {
+        std::lock_guard<std::mutex> output_lock(status_output_mutex_);
+        if (status_ring_ && trackers_->Size() > kStatusRingMaxBalls) {
+            std::cerr << "Tracker pool of " << trackers_->Size() << " exceeds the " << kStatusRingMaxBalls
+                      << " balls of the status ring; extra balls are not shared" << std::endl;
+        }
+    }
+    metrics_->lifecycle_stats = TrackerLifecycleStats();  // 与跟踪器的计数一起清零
+    std::lock_guard<std::mutex> scheduler_lock(scheduler_mutex_);
+    ball_priorities_.resize(trackers_->Size(), 0.0);
+    has_ball_priority_.resize(trackers_->Size(), 0);
+    deferred_updates_.resize(trackers_->Size(), 0);
+    lifecycle_changes_.reserve(trackers_->Size());
+    // 槽位重新分配，旧快照中的槽位号不再有效
+    status_snapshot_.clear();
+    status_snapshot_slots_.clear();
+}
+
+void BallTrackerInterface::SetSpawnZones(const std::vector<std::pair<double, double>>& centers) {
+    std::lock_guard<std::mutex> lock(tracking_mutex_);
+    if (is_tracking_) {
+        std::cerr << "Spawn zones cannot be changed while tracking" << std::endl;
+        return;
+    }
+    std::vector<cv::Point_<float>> points;
+    for (const auto& center : centers) {
+        points.emplace_back(static_cast<float>(center.first), static_cast<float>(center.second));
+    }
+    trackers_->SetSpawnZones(points);
+}
+
+void BallTrackerInterface::SetTrackEndPoint(const std::pair<double, double>& point) {
+    std::lock_guard<std::mutex> lock(tracking_mutex_);
+    if (is_tracking_) {
+        std::cerr << "Track end point cannot be changed while tracking" << std::endl;
+        return;
+    }
+    trackers_->SetEndPoint(cv::Point_<float>(static_cast<float>(point.first), static_cast<float>(point.second)));
+}
+
+void BallTrackerInterface::SetTrackCorridorConfig(const TrackCorridorConfig& config) {
+    std::lock_guard<std::mutex> lock(tracking_mutex_);
+    if (is_tracking_) {
+        std::cerr << "Track corridor config cannot be changed while tracking" << std::endl;
+        return;
+    }
+    corridor_config_ = config;
+}
+
+void BallTrackerInterface::SetTrajectoryCompactionConfig(const TrajectoryCompactionConfig& config) {
+    std::lock_guard<std::mutex> lock(tracking_mutex_);
+    if (is_tracking_) {
+        std::cerr << "Trajectory compaction config cannot be changed while tracking" << std::endl;
+        return;
+    }
+    compaction_config_ = config;
+}
+
+void BallTrackerInterface::SetOfflineInitTrackConfig(const OfflineInitTrackConfig& config) {
+    std::lock_guard<std::mutex> lock(tracking_mutex_);
+    if (is_tracking_) {
+        std::cerr << "Offline init track config cannot be changed while tracking" << std::endl;
+        return;
+    }
+    offline_config_ = config;
+}
+
+void BallTrackerInterface::SetTrackModeConfig(const TrackModeConfig& config) {
+    std::lock_guard<std::mutex> lock(tracking_mutex_);
+    if (is_tracking_) {
+        std::cerr << "Track mode config cannot be changed while tracking" << std::endl;
+        return;
+    }
+    trackers_->SetTrackModeConfig(config);
+}
+
+void BallTrackerInterface::SetFrameSchedulerConfig(const FrameSchedulerConfig& config) {
+    std::lock_guard<std::mutex> lock(tracking_mutex_);
+    if (is_tracking_) {
+        std::cerr << "Frame scheduler config cannot be changed while tracking" << std::endl;
+        return;
+    }
+    scheduler_.SetConfig(config);
+}
+
+void BallTrackerInterface::SetBallPriority(int ball_id, double priority) {
+    std::lock_guard<std::mutex> lock(scheduler_mutex_);
+    for (int i = 0; i < trackers_->Size(); ++i) {
+        if (trackers_->IsActive(i) && trackers_->GetId(i) == ball_id) {
+            ball_priorities_[i] = priority;
+            has_ball_priority_[i] = 1;
+        }
+    }
+}
+
+FrameSchedulerStats BallTrackerInterface::GetSchedulerStats() const {
+    std::lock_guard<std::mutex> lock(scheduler_mutex_);
+    return scheduler_stats_;
+}
+
+void BallTrackerInterface::SetLostBallSearchConfig(const LostBallSearchConfig& config) {
+    std::lock_guard<std::mutex> lock(tracking_mutex_);
+    if (is_tracking_) {
+        std::cerr << "Lost ball search config cannot be changed while tracking" << std::endl;
+        return;
+    }
+    trackers_->SetSearchConfig(config);
+}
+
+bool BallTrackerInterface::StartRoiRecording(const std::string& path, int full_frame_interval) {
+    if (!camera_->is_initialized) {
+        std::cerr << "ROI recording requires an initialized camera" << std::endl;
+        return false;
+    }
+
+    RoiRecordingOptions options;
+    options.full_frame_interval = full_frame_interval;
+    auto recorder = std::make_unique<RoiRecorder>();
+    if (!recorder->Open(path, camera_->camera.GetWidth(), camera_->camera.GetHeight(), options)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(roi_recorder_mutex_);
+    roi_recorder_ = std::move(recorder);
+    return true;
+}
+
+void BallTrackerInterface::StopRoiRecording() {
+    std::unique_ptr<RoiRecorder> recorder;
+    {
+        std::lock_guard<std::mutex> lock(roi_recorder_mutex_);
+        recorder = std::move(roi_recorder_);
+    }
+    if (recorder) {
+        recorder->Close();
+    }
+}
+
+bool BallTrackerInterface::StartStatusSharing(const std::string& name, int slot_count, bool replace_existing) {
+    if (slot_count <= 0) {
+        std::cerr << "Status ring needs at least one slot" << std::endl;
+        return false;
+    }
+    if (trackers_->Size() > kStatusRingMaxBalls) {
+        std::cerr << "Status ring holds at most " << kStatusRingMaxBalls << " balls, tracker pool has "
+                  << trackers_->Size() << std::endl;
+        return false;
+    }
+    auto publisher = std::make_unique<StatusRingPublisher>();
+    if (!publisher->Open(name, static_cast<uint32_t>(slot_count), replace_existing)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(status_output_mutex_);
+    status_ring_ = std::move(publisher);
+    return true;
+}
+
+void BallTrackerInterface::StopStatusSharing() {
+    std::lock_guard<std::mutex> lock(status_output_mutex_);
+    status_ring_.reset();
+}
+
+bool BallTrackerInterface::StartStatusStreaming(const StatusStreamConfig& config) {
+    auto publisher = std::make_unique<UdpStatusPublisher>();
+    if (!publisher->Open(config)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(status_output_mutex_);
+    status_stream_ = std::move(publisher);
+    return true;
+}
+
+void BallTrackerInterface::StopStatusStreaming() {
+    std::unique_ptr<UdpStatusPublisher> publisher;
+    {
+        std::lock_guard<std::mutex> lock(status_output_mutex_);
+        publisher = std::move(status_stream_);
+    }
+    if (publisher) {
+        publisher->Close();
+    }
+}
+
+MetricsSnapshot BallTrackerInterface::GetMetrics() const {
+    return metrics_->registry.Snapshot();
+}
+
+bool BallTrackerInterface::StartMetricsServer(int port, const std::string& bind_address) {
+    StopMetricsServer();
+    auto server = std::make_unique<MetricsHttpServer>();
+    if (!server->Start(&metrics_->registry, port, bind_address)) {
+        return false;
+    }
+    metrics_server_ = std::move(server);
+    return true;
+}
+
+void BallTrackerInterface::StopMetricsServer() {
+    metrics_server_.reset();
+}
+
+void BallTrackerInterface::PublishStatus() {
+    std::lock_guard<std::mutex> lock(status_output_mutex_);
+    if (!status_ring_ && !status_stream_) {
+        return;
+    }
+    // 帧号与 ROI 录制一致，时间戳取图像的采集时间，读者可据此计算端到端延迟
+    std::vector<BallStatus> statuses = GetBallStatus();
+    uint64_t frame_index = tracking_frame_index_;
+    int64_t capture_ns = camera_->camera.GetLastTimestamp();
+    if (status_ring_) {
+        status_ring_->Publish(frame_index, capture_ns, statuses);
+    }
+    if (status_stream_) {
+        status_stream_->Publish(frame_index, capture_ns, statuses);
+    }
+}
+
+void BallTrackerInterface::RecordRoiFrame(const cv::Mat& frame, int64_t capture_ns) {
+    uint64_t frame_index = tracking_frame_index_++;
+    std::lock_guard<std::mutex> lock(roi_recorder_mutex_);
+    if (!roi_recorder_) {
+        return;
+    }
+
+    std::vector<BallTrackerSnapshot> snapshots;
+    snapshots.reserve(trackers_->Size());
+    for (int i = 0; i < trackers_->Size(); ++i) {
+        if (trackers_->IsActive(i)) {
+            snapshots.push_back(trackers_->Get(i).GetSnapshot());
+        }
+    }
+    // 使用采集时间戳，与原始帧录制的时间轴一致；源未提供时间戳时退回当前时间
+    int64_t timestamp_ns = capture_ns > 0 ? capture_ns : std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    roi_recorder_->RecordFrame(frame_index, timestamp_ns, frame, snapshots);
+}
+
 void BallTrackerInterface::RegisterBallStatusCallback(BallStatusCallback callback) {
     status_callback_ = std::move(callback);
 }
@@ -281,16 +1117,55 @@ void BallTrackerInterface::NotifyBallStatusUpdate() {
 }
 
 std::vector<BallStatus> BallTrackerInterface::GetBallStatus() {
-    std::vector<BallStatus> statuses;
-    for (const auto& tracker : ball_trackers_) {
-        statuses.push_back(tracker->GetStatus());
-    }
-    return statuses;
+    // 跟踪线程在锁外更新跟踪器，这里只返回上一帧结束时的快照
+    std::lock_guard<std::mutex> lock(scheduler_mutex_);
+    return status_snapshot_;
 }
 
 RobotTarget BallTrackerInterface::GetRobotTarget() {
-    // TODO: Implement robot target position and velocity calculation
-    return RobotTarget{};
+    RobotTarget target{};
+    target.id = -1;
+    int fps = camera_->GetFps();
+
+    // 快照、优先级、高度参数与映射表都由 scheduler_mutex_ 保护
+    std::lock_guard<std::mutex> lock(scheduler_mutex_);
+    if (arm_map_->Empty()) {
+        return target;
+    }
+
+    // 与调度器相同的排序：调用方优先级，其次轨道进度；本帧检测到的球优先
+    const BallStatus* best = nullptr;
+    double best_priority = 0.0;
+    for (size_t k = 0; k < status_snapshot_.size(); ++k) {
+        const BallStatus& status = status_snapshot_[k];
+        int slot = status_snapshot_slots_[k];
+        double priority = has_ball_priority_[slot] ? ball_priorities_[slot] : status.progress;
+        if (!best || (status.detected && !best->detected) ||
+            (status.detected == best->detected && priority > best_priority)) {
+            best = &status;
+            best_priority = priority;
+        }
+    }
+    if (!best) {
+        return target;
+    }
+
+    // 只对球心与速度查表映射，图像本身不做去畸变
+    const BallStatus& status = *best;
+    double progress = std::min(std::max(status.progress, 0.0), 1.0);
+    double height = height_params_.track_start_height +
+                    (height_params_.track_end_height - height_params_.track_start_height) * progress;
+    double vx, vy;
+    if (!arm_map_->ToArm(status.x, status.y, height, target.X_arm, target.Y_arm) ||
+        !arm_map_->VelocityToArm(status.x, status.y, status.vx, status.vy, height, vx, vy)) {
+        return target;
+    }
+    double scale = fps > 0 ? static_cast<double>(fps) : 1.0;
+    target.V_arm_x = vx * scale;
+    target.V_arm_y = vy * scale;
+    target.id = status.id;
+    target.valid = true;
+    return target;
 }
 
 bool BallTrackerInterface::GetFirstFrame(cv::Mat& frame) {
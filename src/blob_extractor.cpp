@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cmath>
+
+#include "blob_extractor.h"
+
+namespace {
+
+// 0..n 的平方和
+inline double SumOfSquares(double n) {
+    return n * (n + 1.0) * (2.0 * n + 1.0) / 6.0;
+}
+
+}  // namespace
+
+float Blob::MomentRadius() const {
+    return static_cast<float>(std::sqrt(std::max(0.0, 2.0 * (mu20 + mu02))));
+}
+
+BlobExtractor::BlobExtractor(const BlobExtractorConfig& config)
+    : config_(config)
+{
+}
+
+int BlobExtractor::Find(int label) {
+    // 路径减半压缩
+    while (parent_[label] != label) {
+        parent_[label] = parent_[parent_[label]];
+        label = parent_[label];
+    }
+    return label;
+}
+
+void BlobExtractor::Union(int a, int b) {
+    a = Find(a);
+    b = Find(b);
+    if (a == b) {
+        return;
+    }
+    // 以较小的标签为根，保证标签顺序与首次出现顺序一致
+    if (a < b) {
+        parent_[b] = a;
+    } else {
+        parent_[a] = b;
+    }
+}
+
+void BlobExtractor::EncodeRuns(const cv::Mat& mask) {
+    runs_.clear();
+    for (int y = 0; y < mask.rows; ++y) {
+        const uchar* row = mask.ptr<uchar>(y);
+        int x = 0;
+        int pending_start = -1;
+        int pending_end = -1;
+        while (x < mask.cols) {
+            // 跳过背景
+            while (x < mask.cols && row[x] == 0) {
+                ++x;
+            }
+            if (x >= mask.cols) {
+                break;
+            }
+            int start = x;
+            while (x < mask.cols && row[x] != 0) {
+                ++x;
+            }
+            int end = x - 1;
+
+            // 间隔不超过 max_run_gap 的相邻游程合并，代替水平方向的闭运算
+            if (pending_start >= 0 && start - pending_end - 1 <= config_.max_run_gap) {
+                pending_end = end;
+                continue;
+            }
+            if (pending_start >= 0 && pending_end - pending_start + 1 >= config_.min_run_length) {
+                runs_.push_back({y, pending_start, pending_end, -1});
+            }
+            pending_start = start;
+            pending_end = end;
+        }
+        // 过短的游程视为噪声，代替开运算
+        if (pending_start >= 0 && pending_end - pending_start + 1 >= config_.min_run_length) {
+            runs_.push_back({y, pending_start, pending_end, -1});
+        }
+    }
+}
+
+int BlobExtractor::Extract(const cv::Mat& mask, std::vector<Blob>& blobs) {
+    blobs.clear();
+    if (mask.empty() || mask.type() != CV_8UC1) {
+        runs_.clear();
+        return 0;
+    }
+
+    EncodeRuns(mask);
+
+    // 与上一行重叠（8连通）的游程合并为同一连通域
+    parent_.resize(runs_.size());
+    size_t prev_begin = 0;
+    size_t prev_end = 0;
+    size_t i = 0;
+    int next_label = 0;
+    while (i < runs_.size()) {
+        int row = runs_[i].row;
+        size_t row_begin = i;
+        size_t row_end = i;
+        while (row_end < runs_.size() && runs_[row_end].row == row) {
+            ++row_end;
+        }
+        bool prev_adjacent = prev_end > prev_begin && runs_[prev_begin].row == row - 1;
+
+        size_t p = prev_begin;
+        for (size_t r = row_begin; r < row_end; ++r) {
+            MaskRun& run = runs_[r];
+            run.label = -1;
+            if (prev_adjacent) {
+                // 跳过完全位于当前游程左侧的上一行游程
+                while (p < prev_end && runs_[p].end + 1 < run.start) {
+                    ++p;
+                }
+                for (size_t q = p; q < prev_end && runs_[q].start <= run.end + 1; ++q) {
+                    if (run.label < 0) {
+                        run.label = runs_[q].label;
+                    } else {
+                        Union(run.label, runs_[q].label);
+                    }
+                }
+            }
+            if (run.label < 0) {
+                run.label = next_label;
+                parent_[next_label] = next_label;
+                ++next_label;
+            }
+        }
+        prev_begin = row_begin;
+        prev_end = row_end;
+        i = row_end;
+    }
+
+    // 按游程闭式累加面积、一阶和二阶矩
+    accumulators_.assign(next_label, Accumulator{0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+                                                 mask.cols, mask.rows, -1, -1, -1});
+    for (size_t r = 0; r < runs_.size(); ++r) {
+        MaskRun& run = runs_[r];
+        int root = Find(run.label);
+        run.label = root;
+        Accumulator& acc = accumulators_[root];
+
+        double n = run.end - run.start + 1;
+        double y = run.row;
+        double sum_x = n * (run.start + run.end) / 2.0;
+        double sum_xx = SumOfSquares(run.end) - SumOfSquares(run.start - 1.0);
+        acc.area += n;
+        acc.sum_x += sum_x;
+        acc.sum_y += n * y;
+        acc.sum_xx += sum_xx;
+        acc.sum_yy += n * y * y;
+        acc.sum_xy += y * sum_x;
+        acc.min_x = std::min(acc.min_x, run.start);
+        acc.max_x = std::max(acc.max_x, run.end);
+        acc.min_y = std::min(acc.min_y, run.row);
+        acc.max_y = std::max(acc.max_y, run.row);
+        if (acc.first_run < 0) {
+            acc.first_run = static_cast<int>(r);
+        }
+    }
+
+    // 面积过滤并生成输出
+    root_to_blob_.assign(next_label, -1);
+    for (int label = 0; label < next_label; ++label) {
+        const Accumulator& acc = accumulators_[label];
+        if (acc.area <= 0.0 || acc.area < config_.min_area) {
+            continue;
+        }
+        Blob blob;
+        blob.area = static_cast<int>(acc.area);
+        blob.bbox = cv::Rect(acc.min_x, acc.min_y, acc.max_x - acc.min_x + 1, acc.max_y - acc.min_y + 1);
+        double cx = acc.sum_x / acc.area;
+        double cy = acc.sum_y / acc.area;
+        blob.centroid = cv::Point2f(static_cast<float>(cx), static_cast<float>(cy));
+        blob.mu20 = acc.sum_xx / acc.area - cx * cx;
+        blob.mu02 = acc.sum_yy / acc.area - cy * cy;
+        blob.mu11 = acc.sum_xy / acc.area - cx * cy;
+        blob.first_run = acc.first_run;
+        root_to_blob_[label] = static_cast<int>(blobs.size());
+        blobs.push_back(blob);
+    }
+    for (auto& run : runs_) {
+        run.label = root_to_blob_[run.label];
+    }
+    return static_cast<int>(blobs.size());
+}
+
+int BlobExtractor::LargestBlob(const std::vector<Blob>& blobs) {
+    int best = -1;
+    for (size_t i = 0; i < blobs.size(); ++i) {
+        if (best < 0 || blobs[i].area > blobs[best].area) {
+            best = static_cast<int>(i);
+        }
+    }
+    return best;
+}
+
+cv::Scalar_<double> BlobExtractor::MeanColor(const std::vector<Blob>& blobs, int index, const cv::Mat& image) const {
+    // 仅在该连通域的游程上累加，游程按行排列，从其第一个游程开始扫描
+    const Blob& blob = blobs[index];
+    cv::Scalar_<double> mean(0, 0, 0);
+    for (size_t i = blob.first_run; i < runs_.size(); ++i) {
+        const MaskRun& run = runs_[i];
+        if (run.label != index) {
+            continue;
+        }
+        const cv::Vec3b* row = image.ptr<cv::Vec3b>(run.row);
+        for (int x = run.start; x <= run.end; ++x) {
+            mean[0] += row[x][0];
+            mean[1] += row[x][1];
+            mean[2] += row[x][2];
+        }
+    }
+    return mean * (1.0 / blob.area);
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <limits>
+
+#include "data_association.h"
+
+int AssignmentSolver::Find(int node) {
+    while (parent_[node] != node) {
+        parent_[node] = parent_[parent_[node]];
+        node = parent_[node];
+    }
+    return node;
+}
+
+int AssignmentSolver::Solve(const std::vector<float>& cost, int rows, int cols, std::vector<int>& row_to_col) {
+    row_to_col.assign(rows, -1);
+    if (rows == 0 || cols == 0) {
+        return 0;
+    }
+
+    // 门限内的配对构成二分图，按连通分量分别求解
+    parent_.resize(rows + cols);
+    for (int i = 0; i < rows + cols; ++i) {
+        parent_[i] = i;
+    }
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            if (cost[i * cols + j] != kNotGated) {
+                int a = Find(i);
+                int b = Find(rows + j);
+                if (a != b) {
+                    parent_[a] = b;
+                }
+            }
+        }
+    }
+
+    int assigned = 0;
+    for (int root = 0; root < rows + cols; ++root) {
+        if (Find(root) != root) {
+            continue;
+        }
+        component_rows_.clear();
+        component_cols_.clear();
+        for (int i = 0; i < rows; ++i) {
+            if (Find(i) == root) {
+                component_rows_.push_back(i);
+            }
+        }
+        for (int j = 0; j < cols; ++j) {
+            if (Find(rows + j) == root) {
+                component_cols_.push_back(j);
+            }
+        }
+        if (component_rows_.empty() || component_cols_.empty()) {
+            continue;  // 孤立的航迹或测量
+        }
+        if (component_rows_.size() == 1 && component_cols_.size() == 1) {
+            row_to_col[component_rows_[0]] = component_cols_[0];
+            ++assigned;
+            continue;
+        }
+
+        // 补成方阵；门限外与虚拟配对的代价大于任意一组门限内配对之和，优先保证配对数最多
+        int num_rows = static_cast<int>(component_rows_.size());
+        int num_cols = static_cast<int>(component_cols_.size());
+        int size = std::max(num_rows, num_cols);
+        double max_cost = 0.0;
+        for (int r : component_rows_) {
+            for (int c : component_cols_) {
+                float value = cost[r * cols + c];
+                if (value != kNotGated) {
+                    max_cost = std::max(max_cost, static_cast<double>(value));
+                }
+            }
+        }
+        double blocked = (max_cost + 1.0) * (size + 1);
+        matrix_.assign(static_cast<size_t>(size) * size, blocked);
+        for (int r = 0; r < num_rows; ++r) {
+            for (int c = 0; c < num_cols; ++c) {
+                float value = cost[component_rows_[r] * cols + component_cols_[c]];
+                if (value != kNotGated) {
+                    matrix_[r * size + c] = value;
+                }
+            }
+        }
+
+        Hungarian(size);
+        for (int c = 0; c < num_cols; ++c) {
+            int r = match_[c + 1] - 1;
+            if (r >= 0 && r < num_rows && matrix_[r * size + c] < blocked) {
+                row_to_col[component_rows_[r]] = component_cols_[c];
+                ++assigned;
+            }
+        }
+    }
+    return assigned;
+}
+
+void AssignmentSolver::Hungarian(int size) {
+    // 带势函数的最短增广路实现，O(n^3)；下标从 1 开始，0 为哨兵
+    const double inf = std::numeric_limits<double>::infinity();
+    u_.assign(size + 1, 0.0);
+    v_.assign(size + 1, 0.0);
+    match_.assign(size + 1, 0);
+    way_.assign(size + 1, 0);
+    for (int i = 1; i <= size; ++i) {
+        match_[0] = i;
+        int j0 = 0;
+        min_slack_.assign(size + 1, inf);
+        used_.assign(size + 1, 0);
+        do {
+            used_[j0] = 1;
+            int i0 = match_[j0];
+            double delta = inf;
+            int j1 = 0;
+            for (int j = 1; j <= size; ++j) {
+                if (used_[j]) {
+                    continue;
+                }
+                double slack = matrix_[(i0 - 1) * size + (j - 1)] - u_[i0] - v_[j];
+                if (slack < min_slack_[j]) {
+                    min_slack_[j] = slack;
+                    way_[j] = j0;
+                }
+                if (min_slack_[j] < delta) {
+                    delta = min_slack_[j];
+                    j1 = j;
+                }
+            }
+            for (int j = 0; j <= size; ++j) {
+                if (used_[j]) {
+                    u_[match_[j]] += delta;
+                    v_[j] -= delta;
+                } else {
+                    min_slack_[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (match_[j0] != 0);
+        do {
+            int j1 = way_[j0];
+            match_[j0] = match_[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+}
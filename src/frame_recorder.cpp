@@ -0,0 +1,519 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include <opencv2/opencv.hpp>
+
+#include "frame_recorder.h"
+
+namespace {
+
+unsigned char* AlignedAlloc(size_t size) {
+#ifdef _WIN32
+    return static_cast<unsigned char*>(_aligned_malloc(size, kRawRecordingAlignment));
+#else
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, kRawRecordingAlignment, size) != 0) {
+        return nullptr;
+    }
+    return static_cast<unsigned char*>(ptr);
+#endif
+}
+
+void AlignedFree(unsigned char* ptr) {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+}  // namespace
+
+// 按文件偏移写入的文件句柄，多个写线程可并发写入不同区域
+class FrameRecorder::File {
+public:
+    ~File() { Close(); }
+
+    bool Open(const std::string& path, bool direct_io, bool& direct_io_active) {
+        direct_io_active = false;
+        direct_ = false;
+#ifdef _WIN32
+        DWORD flags = FILE_ATTRIBUTE_NORMAL;
+        if (direct_io) {
+            handle_ = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                                  flags | FILE_FLAG_NO_BUFFERING | FILE_FLAG_WRITE_THROUGH, nullptr);
+            direct_io_active = handle_ != INVALID_HANDLE_VALUE;
+        }
+        if (handle_ == INVALID_HANDLE_VALUE) {
+            handle_ = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                                  flags | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        }
+        return handle_ != INVALID_HANDLE_VALUE;
+#else
+        const int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+        if (direct_io) {
+            // tmpfs 等文件系统不支持 O_DIRECT，失败时退回带缓存写入
+            fd_ = ::open(path.c_str(), flags | O_DIRECT, 0644);
+            direct_io_active = fd_ >= 0;
+            direct_ = direct_io_active;
+        }
+#endif
+        if (fd_ < 0) {
+            fd_ = ::open(path.c_str(), flags, 0644);
+#ifdef F_NOCACHE
+            if (fd_ >= 0 && direct_io) {
+                direct_io_active = fcntl(fd_, F_NOCACHE, 1) == 0;
+            }
+#endif
+        }
+        return fd_ >= 0;
+#endif
+    }
+
+    // 将若干等长缓冲区写到连续的文件区域
+    bool WriteGather(const std::vector<unsigned char*>& buffers, size_t size, uint64_t offset, uint64_t& calls) {
+#if defined(__linux__)
+        std::vector<struct iovec> iov;
+        iov.reserve(buffers.size());
+        size_t total = size * buffers.size();
+        size_t done = 0;
+        while (done < total) {
+            // 从已写入的位置起重新组织剩余的缓冲区
+            iov.clear();
+            for (size_t i = 0; i < buffers.size(); ++i) {
+                size_t begin = i * size;
+                if (done >= begin + size) {
+                    continue;
+                }
+                size_t skip = done > begin ? done - begin : 0;
+                struct iovec vec;
+                vec.iov_base = buffers[i] + skip;
+                vec.iov_len = size - skip;
+                iov.push_back(vec);
+            }
+            calls++;
+            ssize_t ret = pwritev(fd_, iov.data(), static_cast<int>(iov.size()), static_cast<off_t>(offset + done));
+            if (ret < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            size_t next = Advance(done, static_cast<size_t>(ret), total);
+            if (next <= done) {
+                return false;
+            }
+            done = next;
+        }
+        return true;
+#else
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            if (!Write(buffers[i], size, offset + i * size, calls)) {
+                return false;
+            }
+        }
+        return true;
+#endif
+    }
+
+    bool Write(const unsigned char* data, size_t size, uint64_t offset, uint64_t& calls) {
+#ifdef _WIN32
+        while (size > 0) {
+            OVERLAPPED overlapped;
+            std::memset(&overlapped, 0, sizeof(overlapped));
+            overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFull);
+            overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+            DWORD written = 0;
+            calls++;
+            if (!WriteFile(handle_, data, chunk, &written, &overlapped) || written == 0) {
+                return false;
+            }
+            data += written;
+            size -= written;
+            offset += written;
+        }
+        return true;
+#else
+        size_t done = 0;
+        while (done < size) {
+            calls++;
+            ssize_t ret = pwrite(fd_, data + done, size - done, static_cast<off_t>(offset + done));
+            if (ret < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            size_t next = Advance(done, static_cast<size_t>(ret), size);
+            if (next <= done) {
+                return false;
+            }
+            done = next;
+        }
+        return true;
+#endif
+    }
+
+    // 截断到指定长度，丢弃其后的内容
+    bool Truncate(uint64_t size) {
+#ifdef _WIN32
+        LARGE_INTEGER position;
+        position.QuadPart = static_cast<LONGLONG>(size);
+        return SetFilePointerEx(handle_, position, nullptr, FILE_BEGIN) && SetEndOfFile(handle_);
+#else
+        return ftruncate(fd_, static_cast<off_t>(size)) == 0;
+#endif
+    }
+
+    void Close() {
+#ifdef _WIN32
+        if (handle_ != INVALID_HANDLE_VALUE) {
+            CloseHandle(handle_);
+            handle_ = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+#endif
+    }
+
+private:
+#ifdef _WIN32
+    HANDLE handle_ = INVALID_HANDLE_VALUE;
+#else
+    int fd_ = -1;
+#endif
+    bool direct_ = false;
+
+    // 部分写入后的续写位置；直接IO要求偏移和长度按块对齐，未对齐的尾部从块边界重写
+    size_t Advance(size_t done, size_t written, size_t total) const {
+        size_t next = done + written;
+        if (direct_ && next < total) {
+            next -= next % kRawRecordingAlignment;
+        }
+        return next;
+    }
+};
+
+FrameRecorder::FrameRecorder(const FrameRecorderConfig& config)
+    : config_(config)
+    , file_(std::make_unique<File>())
+    , is_open_(false)
+    , direct_io_active_(false)
+    , writes_in_progress_(0)
+    , submits_in_progress_(0)
+    , next_index_(0)
+    , first_failed_index_(UINT64_MAX)
+    , stop_(false)
+    , submitted_(0)
+    , written_(0)
+    , dropped_(0)
+    , write_errors_(0)
+    , bytes_written_(0)
+    , write_calls_(0)
+    , max_in_flight_(0)
+{
+    config_.num_buffers = std::max(1, config_.num_buffers);
+    config_.num_writer_threads = std::max(1, config_.num_writer_threads);
+    config_.max_batch_frames = std::max(1, config_.max_batch_frames);
+    std::memset(&header_, 0, sizeof(header_));
+}
+
+FrameRecorder::~FrameRecorder() {
+    Close();
+}
+
+bool FrameRecorder::Open(const std::string& path, const RawRecordingInfo& info) {
+    Close();
+
+    if (!MakeRawRecordingHeader(info, header_)) {
+        std::cerr << "Invalid recording format: " << info.width << "x" << info.height
+                  << " " << PixelFormatName(info.pixel_format) << std::endl;
+        return false;
+    }
+    if (!file_->Open(path, config_.direct_io, direct_io_active_)) {
+        std::cerr << "Failed to create recording: " << path << std::endl;
+        return false;
+    }
+
+    // 先写入文件头，异常退出时文件仍可按大小恢复
+    unsigned char* header_block = AlignedAlloc(header_.header_size);
+    if (header_block == nullptr) {
+        file_->Close();
+        return false;
+    }
+    std::memset(header_block, 0, header_.header_size);
+    std::memcpy(header_block, &header_, sizeof(header_));
+    uint64_t calls = 0;
+    bool ok = file_->Write(header_block, header_.header_size, 0, calls);
+    AlignedFree(header_block);
+    if (!ok) {
+        std::cerr << "Failed to write recording header: " << path << std::endl;
+        file_->Close();
+        return false;
+    }
+
+    // 预分配固定数量的页对齐帧缓冲区，录制期间循环复用
+    slots_.resize(config_.num_buffers);
+    free_slots_.clear();
+    for (int i = 0; i < config_.num_buffers; ++i) {
+        slots_[i].data = AlignedAlloc(header_.frame_stride);
+        if (slots_[i].data == nullptr) {
+            std::cerr << "Failed to allocate recording buffers" << std::endl;
+            ReleaseBuffers();
+            file_->Close();
+            return false;
+        }
+        std::memset(slots_[i].data, 0, header_.frame_stride);
+        free_slots_.push_back(config_.num_buffers - 1 - i);
+    }
+
+    pending_slots_.clear();
+    writes_in_progress_ = 0;
+    submits_in_progress_ = 0;
+    next_index_ = 0;
+    first_failed_index_ = UINT64_MAX;
+    stop_ = false;
+    submitted_ = 0;
+    written_ = 0;
+    dropped_ = 0;
+    write_errors_ = 0;
+    bytes_written_ = header_.header_size;
+    write_calls_ = calls;
+    max_in_flight_ = 0;
+
+    for (int i = 0; i < config_.num_writer_threads; ++i) {
+        writers_.emplace_back(&FrameRecorder::WriterThread, this);
+    }
+    is_open_ = true;
+    return true;
+}
+
+bool FrameRecorder::Submit(const RawFrame& frame) {
+    if (!is_open_) {
+        return false;
+    }
+    if (frame.image.cols != static_cast<int>(header_.width) ||
+        frame.image.rows != static_cast<int>(header_.height) ||
+        frame.image.elemSize() * frame.image.cols != header_.bytes_per_line ||
+        static_cast<uint32_t>(frame.format) != header_.pixel_format) {
+        std::cerr << "Frame does not match recording format" << std::endl;
+        return false;
+    }
+    submitted_++;
+
+    int slot_id = -1;
+    uint64_t index = 0;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stop_) {
+            return false;
+        }
+        if (free_slots_.empty() && config_.backpressure == RecorderBackpressure::BLOCK) {
+            free_cv_.wait_for(lock, std::chrono::milliseconds(config_.block_timeout_ms),
+                              [this]() { return !free_slots_.empty() || stop_; });
+        }
+        if (free_slots_.empty() || stop_) {
+            dropped_++;
+            return false;
+        }
+        slot_id = free_slots_.back();
+        free_slots_.pop_back();
+        index = next_index_++;
+        submits_in_progress_++;
+        int in_flight = config_.num_buffers - static_cast<int>(free_slots_.size());
+        max_in_flight_ = std::max(max_in_flight_, in_flight);
+    }
+
+    // 在锁外拷贝像素数据
+    Slot& slot = slots_[slot_id];
+    slot.index = index;
+    RawFrameRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.frame_id = frame.frame_id;
+    record.timestamp_ns = frame.timestamp_ns;
+    record.index = index;
+    std::memcpy(slot.data, &record, sizeof(record));
+
+    unsigned char* dst = slot.data + sizeof(RawFrameRecord);
+    if (frame.image.isContinuous()) {
+        std::memcpy(dst, frame.image.data, header_.frame_data_size);
+    } else {
+        for (int y = 0; y < frame.image.rows; ++y) {
+            std::memcpy(dst + static_cast<size_t>(y) * header_.bytes_per_line, frame.image.ptr(y), header_.bytes_per_line);
+        }
+    }
+
+    bool last_before_stop = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 按文件顺序插入，保证相邻帧可以合并写入
+        auto it = pending_slots_.end();
+        while (it != pending_slots_.begin() && slots_[*(it - 1)].index > index) {
+            --it;
+        }
+        pending_slots_.insert(it, slot_id);
+        submits_in_progress_--;
+        last_before_stop = stop_ && submits_in_progress_ == 0;
+    }
+    // Close() 等待最后一个拷贝中的帧入队后才让写线程退出
+    if (last_before_stop) {
+        pending_cv_.notify_all();
+    } else {
+        pending_cv_.notify_one();
+    }
+    return true;
+}
+
+void FrameRecorder::WriterThread() {
+    std::vector<int> batch;
+    std::vector<unsigned char*> buffers;
+    batch.reserve(config_.max_batch_frames);
+    buffers.reserve(config_.max_batch_frames);
+
+    while (true) {
+        batch.clear();
+        buffers.clear();
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            pending_cv_.wait(lock, [this]() {
+                return (stop_ && submits_in_progress_ == 0) || !pending_slots_.empty();
+            });
+            if (pending_slots_.empty()) {
+                break;  // stop_ 且队列已清空，没有仍在拷贝的帧
+            }
+
+            // 取出文件位置连续的一批帧
+            batch.push_back(pending_slots_.front());
+            pending_slots_.pop_front();
+            while (static_cast<int>(batch.size()) < config_.max_batch_frames &&
+                   !pending_slots_.empty() &&
+                   slots_[pending_slots_.front()].index == slots_[batch.back()].index + 1) {
+                batch.push_back(pending_slots_.front());
+                pending_slots_.pop_front();
+            }
+            writes_in_progress_++;
+        }
+
+        for (int slot_id : batch) {
+            buffers.push_back(slots_[slot_id].data);
+        }
+        uint64_t offset = header_.header_size + slots_[batch.front()].index * header_.frame_stride;
+        uint64_t calls = 0;
+        bool ok = file_->WriteGather(buffers, header_.frame_stride, offset, calls);
+        write_calls_ += calls;
+        if (ok) {
+            written_ += batch.size();
+            bytes_written_ += batch.size() * header_.frame_stride;
+        } else {
+            write_errors_ += batch.size();
+            std::cerr << "Failed to write " << batch.size() << " frame(s) at index "
+                      << slots_[batch.front()].index << std::endl;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!ok) {
+                first_failed_index_ = std::min(first_failed_index_, slots_[batch.front()].index);
+            }
+            for (int slot_id : batch) {
+                free_slots_.push_back(slot_id);
+            }
+            writes_in_progress_--;
+        }
+        free_cv_.notify_all();
+    }
+}
+
+void FrameRecorder::Flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    free_cv_.wait(lock, [this]() { return pending_slots_.empty() && writes_in_progress_ == 0; });
+}
+
+void FrameRecorder::Close() {
+    if (!is_open_) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    pending_cv_.notify_all();
+    free_cv_.notify_all();
+    // 写线程在仍有 Submit() 持有缓冲区时不会退出，join 之后才能释放缓冲区
+    for (auto& writer : writers_) {
+        if (writer.joinable()) {
+            writer.join();
+        }
+    }
+    writers_.clear();
+
+    // 回写最终帧数（直接IO要求对齐的缓冲区和长度）
+    // 写入失败的帧及其后的帧不计入并从文件中截掉，读取时不会把未写入的区域当作有效帧
+    header_.frame_count = std::min(next_index_, first_failed_index_);
+    if (header_.frame_count < next_index_ &&
+        !file_->Truncate(header_.header_size + header_.frame_count * header_.frame_stride)) {
+        std::cerr << "Failed to truncate recording after write errors" << std::endl;
+    }
+    unsigned char* header_block = AlignedAlloc(header_.header_size);
+    if (header_block != nullptr) {
+        std::memset(header_block, 0, header_.header_size);
+        std::memcpy(header_block, &header_, sizeof(header_));
+        uint64_t calls = 0;
+        if (!file_->Write(header_block, header_.header_size, 0, calls)) {
+            std::cerr << "Failed to finalize recording header" << std::endl;
+        }
+        AlignedFree(header_block);
+    }
+    file_->Close();
+    ReleaseBuffers();
+    is_open_ = false;
+}
+
+void FrameRecorder::ReleaseBuffers() {
+    for (auto& slot : slots_) {
+        if (slot.data != nullptr) {
+            AlignedFree(slot.data);
+            slot.data = nullptr;
+        }
+    }
+    slots_.clear();
+    free_slots_.clear();
+    pending_slots_.clear();
+}
+
+FrameRecorderStats FrameRecorder::GetStats() const {
+    FrameRecorderStats stats;
+    stats.submitted = submitted_;
+    stats.written = written_;
+    stats.dropped = dropped_;
+    stats.write_errors = write_errors_;
+    stats.bytes_written = bytes_written_;
+    stats.write_calls = write_calls_;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.max_in_flight = max_in_flight_;
+    }
+    return stats;
+}
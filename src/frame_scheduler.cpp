@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <atomic>
+
+#include "frame_scheduler.h"
+
+FrameScheduler::FrameScheduler(const FrameSchedulerConfig& config)
+    : config_(config)
+{
+}
+
+double FrameScheduler::GetDeadlineMs(int fps) const {
+    if (config_.deadline_ms > 0.0) {
+        return config_.deadline_ms;
+    }
+    double period_ms = fps > 0 ? 1000.0 / fps : config_.default_period_ms;
+    return period_ms * config_.period_fraction;
+}
+
+int FrameScheduler::Run(std::vector<ScheduledTask>& tasks, Clock::time_point deadline,
+                        const std::function<void(int)>& work) {
+    Clock::time_point start = Clock::now();
+
+    // 上一帧被推迟的任务在同一层级内优先执行，避免饿死
+    was_deferred_.swap(deferred_);
+    int max_index = -1;
+    for (const auto& task : tasks) {
+        max_index = std::max(max_index, task.index);
+    }
+    was_deferred_.resize(max_index + 1, 0);
+    deferred_.assign(max_index + 1, 0);
+    std::stable_sort(tasks.begin(), tasks.end(), [this](const ScheduledTask& a, const ScheduledTask& b) {
+        if (a.tier != b.tier) {
+            return a.tier < b.tier;
+        }
+        if (was_deferred_[a.index] != was_deferred_[b.index]) {
+            return was_deferred_[a.index] > was_deferred_[b.index];
+        }
+        return a.priority > b.priority;
+    });
+
+    // 各线程按顺序领取任务，截止时间后不再开始新任务
+    std::atomic<int> next(0);
+    std::atomic<int> deferred_count(0);
+    int num_tasks = static_cast<int>(tasks.size());
+    #pragma omp parallel
+    {
+        for (int k = next++; k < num_tasks; k = next++) {
+            const ScheduledTask& task = tasks[k];
+            if (k > 0 && Clock::now() >= deadline) {
+                deferred_[task.index] = 1;
+                deferred_count++;
+                continue;
+            }
+            work(task.index);
+        }
+    }
+
+    Clock::time_point end = Clock::now();
+    stats_.frames++;
+    stats_.deferred_tasks += deferred_count;
+    if (end > deadline) {
+        stats_.deadline_misses++;
+    }
+    stats_.last_frame_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    return deferred_count;
+}
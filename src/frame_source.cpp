@@ -0,0 +1,130 @@
+#include <opencv2/opencv.hpp>
+
+#include "frame_source.h"
+#include "opencv_capture_source.h"
+#include "video_file_source.h"
+#include "synthetic_frame_source.h"
+#include "raw_replay_source.h"
+#ifdef BALL_TRACKER_WITH_HUARUI_SDK
+#include "huarui_camera_source.h"
+#endif
+
+int PixelFormatBytesPerPixel(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::MONO8:
+        case PixelFormat::BAYER_RG8:
+        case PixelFormat::BAYER_GR8:
+        case PixelFormat::BAYER_GB8:
+        case PixelFormat::BAYER_BG8:
+            return 1;
+        case PixelFormat::BGR8:
+            return 3;
+        default:
+            return 0;
+    }
+}
+
+const char* PixelFormatName(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::MONO8:     return "Mono8";
+        case PixelFormat::BGR8:      return "BGR8";
+        case PixelFormat::BAYER_RG8: return "BayerRG8";
+        case PixelFormat::BAYER_GR8: return "BayerGR8";
+        case PixelFormat::BAYER_GB8: return "BayerGB8";
+        case PixelFormat::BAYER_BG8: return "BayerBG8";
+        default:                     return "Unknown";
+    }
+}
+
+const char* CaptureStatusName(CaptureStatus status) {
+    switch (status) {
+        case CaptureStatus::OK:               return "OK";
+        case CaptureStatus::END_OF_STREAM:    return "EndOfStream";
+        case CaptureStatus::TIMEOUT:          return "Timeout";
+        case CaptureStatus::DEVICE_LOST:      return "DeviceLost";
+        case CaptureStatus::CONVERSION_ERROR: return "ConversionError";
+        case CaptureStatus::NOT_OPEN:         return "NotOpen";
+        default:                              return "Unknown";
+    }
+}
+
+bool ConvertRawFrameToBGR(const RawFrame& frame, cv::Mat& bgr) {
+    if (frame.image.empty()) {
+        return false;
+    }
+
+    // OpenCV 的 Bayer 命名以第二行第二、三列为准，与传感器排列相差一个像素，
+    // 因此 RGGB 传感器对应 COLOR_BayerBG2BGR，其余依此类推
+    switch (frame.format) {
+        case PixelFormat::BGR8:
+            bgr = frame.image;  // 已是目标格式，浅拷贝
+            return true;
+        case PixelFormat::MONO8:
+            cv::cvtColor(frame.image, bgr, cv::COLOR_GRAY2BGR);
+            return true;
+        case PixelFormat::BAYER_RG8:
+            cv::cvtColor(frame.image, bgr, cv::COLOR_BayerBG2BGR);
+            return true;
+        case PixelFormat::BAYER_GR8:
+            cv::cvtColor(frame.image, bgr, cv::COLOR_BayerGB2BGR);
+            return true;
+        case PixelFormat::BAYER_GB8:
+            cv::cvtColor(frame.image, bgr, cv::COLOR_BayerGR2BGR);
+            return true;
+        case PixelFormat::BAYER_BG8:
+            cv::cvtColor(frame.image, bgr, cv::COLOR_BayerRG2BGR);
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool IFrameSource::ConvertToBGR(const RawFrame& frame, cv::Mat& bgr) {
+    return ConvertRawFrameToBGR(frame, bgr);
+}
+
+CaptureStatus IFrameSource::GetReadStatus() const {
+    if (IsEndOfStream()) {
+        return CaptureStatus::END_OF_STREAM;
+    }
+    return IsOpen() ? CaptureStatus::TIMEOUT : CaptureStatus::NOT_OPEN;
+}
+
+std::unique_ptr<IFrameSource> CreateFrameSource(CameraSourceType source_type) {
+    switch (source_type) {
+        case CameraSourceType::USB_CAMERA:
+            return std::make_unique<OpenCVCaptureSource>();
+        case CameraSourceType::VIDEO_FILE:
+            return std::make_unique<VideoFileSource>();
+        case CameraSourceType::SYNTHETIC:
+            return std::make_unique<SyntheticFrameSource>();
+        case CameraSourceType::RAW_REPLAY:
+            return std::make_unique<RawReplaySource>();
+        case CameraSourceType::HUARUI_CAMERA:
+#ifdef BALL_TRACKER_WITH_HUARUI_SDK
+            return std::make_unique<HuaruiCameraSource>();
+#else
+            return nullptr;  // 未编译华睿SDK后端
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+bool IsFrameSourceAvailable(CameraSourceType source_type) {
+#ifndef BALL_TRACKER_WITH_HUARUI_SDK
+    if (source_type == CameraSourceType::HUARUI_CAMERA) {
+        return false;
+    }
+#endif
+    switch (source_type) {
+        case CameraSourceType::HUARUI_CAMERA:
+        case CameraSourceType::USB_CAMERA:
+        case CameraSourceType::VIDEO_FILE:
+        case CameraSourceType::SYNTHETIC:
+        case CameraSourceType::RAW_REPLAY:
+            return true;
+        default:
+            return false;
+    }
+}
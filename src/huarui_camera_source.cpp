@@ -0,0 +1,273 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "IMV/IMVApi.h"
+
+#include "huarui_camera_source.h"
+
+struct HuaruiCameraSource::HeldFrame {
+    IMV_Frame frame;
+    bool valid = false;
+};
+
+HuaruiCameraSource::HuaruiCameraSource()
+    : dev_handle_(nullptr)
+    , held_frame_(std::make_unique<HeldFrame>())
+    , width_(0)
+    , height_(0)
+    , fps_(0)
+    , grab_timeout_ms_(100)
+    , read_status_(CaptureStatus::NOT_OPEN)
+{
+}
+
+HuaruiCameraSource::~HuaruiCameraSource() {
+    Close();
+}
+
+bool HuaruiCameraSource::EnumDevices(std::vector<CameraDeviceInfo>& device_list) {
+    device_list.clear();
+
+    IMV_DeviceList deviceInfoList;
+    int ret = IMV_EnumDevices(&deviceInfoList, interfaceTypeAll);
+    if (IMV_OK != ret) {
+        return false;
+    }
+
+    for (unsigned int i = 0; i < deviceInfoList.nDevNum; i++) {
+        IMV_DeviceInfo* pDevInfo = &deviceInfoList.pDevInfo[i];
+        CameraDeviceInfo info;
+
+        info.vendor_name = pDevInfo->vendorName;
+        info.model_name = pDevInfo->modelName;
+        info.serial_number = pDevInfo->serialNumber;
+        info.camera_name = pDevInfo->cameraName;
+        info.camera_type = pDevInfo->nCameraType;
+
+        if (pDevInfo->nCameraType == typeGigeCamera) {
+            info.ip_address = pDevInfo->DeviceSpecificInfo.gigeDeviceInfo.ipAddress;
+        }
+
+        device_list.push_back(info);
+    }
+
+    return true;
+}
+
+bool HuaruiCameraSource::Open(const std::string& source, int width, int height, int fps) {
+    std::vector<CameraDeviceInfo> devices;
+    if (!EnumDevices(devices) || devices.empty()) {
+        return false;
+    }
+
+    // 未指定序列号时直接使用第一个设备
+    int index = 0;
+    if (!source.empty()) {
+        index = -1;
+        for (size_t i = 0; i < devices.size(); ++i) {
+            if (devices[i].serial_number == source) {
+                index = static_cast<int>(i);
+                break;
+            }
+        }
+        if (index < 0) {
+            std::cerr << "Huarui camera not found: " << source << std::endl;
+            return false;
+        }
+    }
+    return OpenByIndex(index, width, height, fps);
+}
+
+bool HuaruiCameraSource::OpenByIndex(int index, int width, int height, int fps) {
+    Close();
+
+    IMV_DeviceList deviceInfoList;
+    int ret = IMV_EnumDevices(&deviceInfoList, interfaceTypeAll);
+    if (IMV_OK != ret) {
+        std::cerr << "Failed to enumerate devices, error code: " << ret << std::endl;
+        return false;
+    }
+
+    if (index < 0 || index >= static_cast<int>(deviceInfoList.nDevNum)) {
+        std::cerr << "Invalid device index: " << index << std::endl;
+        return false;
+    }
+
+    // 输出设备信息
+    std::cout << "Opening device: "
+              << "vendor=" << deviceInfoList.pDevInfo[index].vendorName
+              << ", model=" << deviceInfoList.pDevInfo[index].modelName
+              << ", serial=" << deviceInfoList.pDevInfo[index].serialNumber << std::endl;
+
+    // 创建设备句柄
+    ret = IMV_CreateHandle(&dev_handle_, modeByIndex, (void*)&index);
+    if (IMV_OK != ret) {
+        std::cerr << "Failed to create handle, error code: " << ret << std::endl;
+        dev_handle_ = nullptr;
+        return false;
+    }
+
+    // 打开相机
+    ret = IMV_Open(dev_handle_);
+    if (IMV_OK != ret) {
+        std::cerr << "Failed to open device, error code: " << ret << std::endl;
+        IMV_DestroyHandle(dev_handle_);
+        dev_handle_ = nullptr;
+        return false;
+    }
+
+    // 设置图像格式为BayerRG8
+    ret = IMV_SetEnumFeatureSymbol(dev_handle_, "PixelFormat", "BayerRG8");
+    if (IMV_OK != ret) {
+        std::cerr << "Failed to set pixel format to BayerRG8, error code: " << ret << std::endl;
+        IMV_Close(dev_handle_);
+        IMV_DestroyHandle(dev_handle_);
+        dev_handle_ = nullptr;
+        return false;
+    }
+
+    // 设置图像大小
+    width = 4096;  // 固定宽度
+    height = 3000; // 固定高度
+    ret = IMV_SetIntFeatureValue(dev_handle_, "Width", width);
+    if (IMV_OK != ret) {
+        std::cerr << "Failed to set width, error code: " << ret << std::endl;
+        IMV_Close(dev_handle_);
+        IMV_DestroyHandle(dev_handle_);
+        dev_handle_ = nullptr;
+        return false;
+    }
+
+    ret = IMV_SetIntFeatureValue(dev_handle_, "Height", height);
+    if (IMV_OK != ret) {
+        std::cerr << "Failed to set height, error code: " << ret << std::endl;
+        IMV_Close(dev_handle_);
+        IMV_DestroyHandle(dev_handle_);
+        dev_handle_ = nullptr;
+        return false;
+    }
+
+    // 开始拉流
+    ret = IMV_StartGrabbing(dev_handle_);
+    if (IMV_OK != ret) {
+        std::cerr << "Failed to start grabbing, error code: " << ret << std::endl;
+        IMV_Close(dev_handle_);
+        IMV_DestroyHandle(dev_handle_);
+        dev_handle_ = nullptr;
+        return false;
+    }
+
+    serial_number_ = deviceInfoList.pDevInfo[index].serialNumber;
+    width_ = width;
+    height_ = height;
+    fps_ = fps;
+
+    return true;
+}
+
+void HuaruiCameraSource::Close() {
+    if (dev_handle_ != nullptr) {
+        ReleaseHeldFrame();
+        IMV_StopGrabbing(dev_handle_);  // 停止拉流
+        IMV_Close(dev_handle_);
+        IMV_DestroyHandle(dev_handle_);
+        dev_handle_ = nullptr;
+    }
+    width_ = 0;
+    height_ = 0;
+    fps_ = 0;
+    serial_number_.clear();
+    read_status_ = CaptureStatus::NOT_OPEN;
+}
+
+void HuaruiCameraSource::ReleaseHeldFrame() {
+    if (held_frame_->valid) {
+        IMV_ReleaseFrame(dev_handle_, &held_frame_->frame);
+        held_frame_->valid = false;
+    }
+}
+
+bool HuaruiCameraSource::Read(RawFrame& frame) {
+    if (dev_handle_ == nullptr) {
+        read_status_ = CaptureStatus::NOT_OPEN;
+        return false;
+    }
+
+    // 归还上一帧的SDK缓冲区
+    ReleaseHeldFrame();
+
+    IMV_Frame& mv_frame = held_frame_->frame;
+    int ret = IMV_GetFrame(dev_handle_, &mv_frame, grab_timeout_ms_);
+    if (IMV_OK != ret) {
+        // 超时及SDK自动恢复中的错误可直接重试，其余错误需要重新连接相机
+        if (ret == IMV_TIMEOUT || ret == IMV_RESTORE_STREAM || ret == IMV_RECONNECT_DEVICE) {
+            read_status_ = CaptureStatus::TIMEOUT;
+        } else {
+            read_status_ = CaptureStatus::DEVICE_LOST;
+            std::cerr << "Failed to get frame, error code: " << ret << std::endl;
+        }
+        return false;
+    }
+    held_frame_->valid = true;
+
+    if (mv_frame.frameInfo.pixelFormat != gvspPixelBayRG8) {
+        std::cerr << "Unexpected pixel format: " << mv_frame.frameInfo.pixelFormat << std::endl;
+        ReleaseHeldFrame();
+        read_status_ = CaptureStatus::CONVERSION_ERROR;
+        return false;
+    }
+    read_status_ = CaptureStatus::OK;
+
+    // 直接引用SDK缓冲区（零拷贝），步长包含行填充
+    frame.image = cv::Mat(mv_frame.frameInfo.height, mv_frame.frameInfo.width, CV_8UC1,
+                          mv_frame.pData, mv_frame.frameInfo.width + mv_frame.frameInfo.paddingX);
+    frame.format = PixelFormat::BAYER_RG8;
+    frame.frame_id = mv_frame.frameInfo.blockId;
+    frame.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return true;
+}
+
+bool HuaruiCameraSource::ConvertToBGR(const RawFrame& frame, cv::Mat& bgr) {
+    if (frame.format != PixelFormat::BAYER_RG8 || dev_handle_ == nullptr) {
+        return ConvertRawFrameToBGR(frame, bgr);
+    }
+
+    // 复用预分配的输出缓冲区
+    bgr_buffer_.create(frame.image.rows, frame.image.cols, CV_8UC3);
+
+    // 设置转换参数
+    IMV_PixelConvertParam stPixelConvertParam;
+    memset(&stPixelConvertParam, 0, sizeof(stPixelConvertParam));
+    stPixelConvertParam.nWidth = frame.image.cols;
+    stPixelConvertParam.nHeight = frame.image.rows;
+    stPixelConvertParam.ePixelFormat = gvspPixelBayRG8;
+    stPixelConvertParam.pSrcData = frame.image.data;
+    stPixelConvertParam.nSrcDataLen = static_cast<unsigned int>(frame.image.step[0] * frame.image.rows);
+    stPixelConvertParam.nPaddingX = static_cast<unsigned int>(frame.image.step[0] - frame.image.cols);
+    stPixelConvertParam.nPaddingY = 0;
+    stPixelConvertParam.eBayerDemosaic = demosaicEdgeSensing;
+    stPixelConvertParam.eDstPixelFormat = gvspPixelBGR8;
+    stPixelConvertParam.pDstBuf = bgr_buffer_.data;
+    stPixelConvertParam.nDstBufSize = static_cast<unsigned int>(bgr_buffer_.total() * bgr_buffer_.elemSize());
+
+    // 执行转换
+    int ret = IMV_PixelConvert(dev_handle_, &stPixelConvertParam);
+    if (IMV_OK != ret) {
+        std::cerr << "Failed to convert image format, error code: " << ret << std::endl;
+        return false;
+    }
+
+    bgr = bgr_buffer_;
+    return true;
+}
+
+FrameSourceCaps HuaruiCameraSource::GetCaps() const {
+    FrameSourceCaps caps;
+    caps.native_format = PixelFormat::BAYER_RG8;
+    caps.zero_copy = true;
+    caps.native_bgr_convert = true;
+    caps.is_live = true;
+    return caps;
+}
@@ -0,0 +1,217 @@
+#include <algorithm>
+
+#include "kalman_bank.h"
+
+KalmanBank::KalmanBank(const KalmanNoise& noise)
+    : noise_(noise)
+    , size_(0)
+    , padded_(0)
+{
+}
+
+void KalmanBank::Resize(int padded) {
+    for (auto* array : {&x_, &y_, &vx_, &vy_, &p00_, &p01_, &p02_, &p03_, &p11_, &p12_, &p13_,
+                        &p22_, &p23_, &p33_, &zx_, &zy_, &predict_mask_, &correct_mask_}) {
+        array->resize(padded, 0.0f);
+    }
+    padded_ = padded;
+}
+
+void KalmanBank::Reserve(int lanes) {
+    // 按批大小补齐，批处理时无需处理尾部
+    int padded = (lanes + kKalmanBlock - 1) / kKalmanBlock * kKalmanBlock;
+    if (padded > padded_) {
+        Resize(padded);
+    }
+}
+
+int KalmanBank::AddLane() {
+    Reserve(size_ + 1);
+    int lane = size_++;
+    Reset(lane, 0.0f, 0.0f);
+    return lane;
+}
+
+void KalmanBank::Reset(int lane, float x, float y, float vx, float vy) {
+    x_[lane] = x;
+    y_[lane] = y;
+    vx_[lane] = vx;
+    vy_[lane] = vy;
+    p00_[lane] = p11_[lane] = p22_[lane] = p33_[lane] = noise_.initial;
+    p01_[lane] = p02_[lane] = p03_[lane] = p12_[lane] = p13_[lane] = p23_[lane] = 0.0f;
+    predict_mask_[lane] = 0.0f;
+    correct_mask_[lane] = 0.0f;
+}
+
+float KalmanBank::Variance(int lane, int state) const {
+    switch (state) {
+        case 0: return p00_[lane];
+        case 1: return p11_[lane];
+        case 2: return p22_[lane];
+        default: return p33_[lane];
+    }
+}
+
+float KalmanBank::Mahalanobis2(int lane, float x, float y, float extra_variance) const {
+    // 新息协方差 S = H P H^T + R
+    float s00 = p00_[lane] + noise_.measurement + extra_variance;
+    float s11 = p11_[lane] + noise_.measurement + extra_variance;
+    float s01 = p01_[lane];
+    float e0 = x - x_[lane];
+    float e1 = y - y_[lane];
+    return (s11 * e0 * e0 - 2.0f * s01 * e0 * e1 + s00 * e1 * e1) / (s00 * s11 - s01 * s01);
+}
+
+void KalmanBank::PredictRange(int begin, int end, const float* mask) {
+    float* x = x_.data();
+    float* y = y_.data();
+    float* vx = vx_.data();
+    float* vy = vy_.data();
+    float* p00 = p00_.data();
+    float* p01 = p01_.data();
+    float* p02 = p02_.data();
+    float* p03 = p03_.data();
+    float* p11 = p11_.data();
+    float* p12 = p12_.data();
+    float* p13 = p13_.data();
+    float* p22 = p22_.data();
+    float* p23 = p23_.data();
+    float* p33 = p33_.data();
+    const float q = noise_.process;
+
+    // x' = F x, P' = F P F^T + Q，F 为匀速模型
+    // 按掩码 (0/1) 混合新旧值而不分支，未选中的通道保持不变，循环可向量化
+    #pragma omp simd
+    for (int i = begin; i < end; ++i) {
+        const float m = mask[i];
+        float n00 = p00[i] + 2.0f * p02[i] + p22[i] + q;
+        float n01 = p01[i] + p03[i] + p12[i] + p23[i];
+        float n02 = p02[i] + p22[i];
+        float n03 = p03[i] + p23[i];
+        float n11 = p11[i] + 2.0f * p13[i] + p33[i] + q;
+        float n12 = p12[i] + p23[i];
+        float n13 = p13[i] + p33[i];
+        x[i] += m * vx[i];
+        y[i] += m * vy[i];
+        p00[i] += m * (n00 - p00[i]);
+        p01[i] += m * (n01 - p01[i]);
+        p02[i] += m * (n02 - p02[i]);
+        p03[i] += m * (n03 - p03[i]);
+        p11[i] += m * (n11 - p11[i]);
+        p12[i] += m * (n12 - p12[i]);
+        p13[i] += m * (n13 - p13[i]);
+        p22[i] += m * q;
+        p33[i] += m * q;
+    }
+}
+
+void KalmanBank::CorrectRange(int begin, int end, const float* mask) {
+    float* x = x_.data();
+    float* y = y_.data();
+    float* vx = vx_.data();
+    float* vy = vy_.data();
+    float* p00 = p00_.data();
+    float* p01 = p01_.data();
+    float* p02 = p02_.data();
+    float* p03 = p03_.data();
+    float* p11 = p11_.data();
+    float* p12 = p12_.data();
+    float* p13 = p13_.data();
+    float* p22 = p22_.data();
+    float* p23 = p23_.data();
+    float* p33 = p33_.data();
+    const float* zx = zx_.data();
+    const float* zy = zy_.data();
+    const float r = noise_.measurement;
+
+    // K = P H^T (H P H^T + R)^-1，H 取位置分量，2x2 求逆展开
+    #pragma omp simd
+    for (int i = begin; i < end; ++i) {
+        const float m = mask[i];
+        float s00 = p00[i] + r;
+        float s11 = p11[i] + r;
+        float s01 = p01[i];
+        float inv_det = 1.0f / (s00 * s11 - s01 * s01);
+        float i00 = s11 * inv_det;
+        float i01 = -s01 * inv_det;
+        float i11 = s00 * inv_det;
+
+        float k00 = p00[i] * i00 + p01[i] * i01;
+        float k01 = p00[i] * i01 + p01[i] * i11;
+        float k10 = p01[i] * i00 + p11[i] * i01;
+        float k11 = p01[i] * i01 + p11[i] * i11;
+        float k20 = p02[i] * i00 + p12[i] * i01;
+        float k21 = p02[i] * i01 + p12[i] * i11;
+        float k30 = p03[i] * i00 + p13[i] * i01;
+        float k31 = p03[i] * i01 + p13[i] * i11;
+
+        float e0 = zx[i] - x[i];
+        float e1 = zy[i] - y[i];
+
+        // P' = (I - K H) P
+        float n00 = p00[i] - k00 * p00[i] - k01 * p01[i];
+        float n01 = p01[i] - k00 * p01[i] - k01 * p11[i];
+        float n02 = p02[i] - k00 * p02[i] - k01 * p12[i];
+        float n03 = p03[i] - k00 * p03[i] - k01 * p13[i];
+        float n11 = p11[i] - k10 * p01[i] - k11 * p11[i];
+        float n12 = p12[i] - k10 * p02[i] - k11 * p12[i];
+        float n13 = p13[i] - k10 * p03[i] - k11 * p13[i];
+        float n22 = p22[i] - k20 * p02[i] - k21 * p12[i];
+        float n23 = p23[i] - k20 * p03[i] - k21 * p13[i];
+        float n33 = p33[i] - k30 * p03[i] - k31 * p13[i];
+
+        x[i] += m * (k00 * e0 + k01 * e1);
+        y[i] += m * (k10 * e0 + k11 * e1);
+        vx[i] += m * (k20 * e0 + k21 * e1);
+        vy[i] += m * (k30 * e0 + k31 * e1);
+        p00[i] += m * (n00 - p00[i]);
+        p01[i] += m * (n01 - p01[i]);
+        p02[i] += m * (n02 - p02[i]);
+        p03[i] += m * (n03 - p03[i]);
+        p11[i] += m * (n11 - p11[i]);
+        p12[i] += m * (n12 - p12[i]);
+        p13[i] += m * (n13 - p13[i]);
+        p22[i] += m * (n22 - p22[i]);
+        p23[i] += m * (n23 - p23[i]);
+        p33[i] += m * (n33 - p33[i]);
+    }
+}
+
+void KalmanBank::Predict(int lane) {
+    predict_mask_[lane] = 1.0f;
+    PredictRange(lane, lane + 1, predict_mask_.data());
+    predict_mask_[lane] = 0.0f;
+}
+
+void KalmanBank::PredictPending(int lane) {
+    if (predict_mask_[lane] != 0.0f) {
+        PredictRange(lane, lane + 1, predict_mask_.data());
+        predict_mask_[lane] = 0.0f;
+    }
+}
+
+void KalmanBank::Correct(int lane, float x, float y) {
+    SetMeasurement(lane, x, y);
+    CorrectPending(lane);
+}
+
+void KalmanBank::CorrectPending(int lane) {
+    if (correct_mask_[lane] != 0.0f) {
+        CorrectRange(lane, lane + 1, correct_mask_.data());
+        correct_mask_[lane] = 0.0f;
+    }
+}
+
+void KalmanBank::PredictBatch() {
+    for (int begin = 0; begin < padded_; begin += kKalmanBlock) {
+        PredictRange(begin, begin + kKalmanBlock, predict_mask_.data());
+    }
+    std::fill(predict_mask_.begin(), predict_mask_.end(), 0.0f);
+}
+
+void KalmanBank::CorrectBatch() {
+    for (int begin = 0; begin < padded_; begin += kKalmanBlock) {
+        CorrectRange(begin, begin + kKalmanBlock, correct_mask_.data());
+    }
+    std::fill(correct_mask_.begin(), correct_mask_.end(), 0.0f);
+}
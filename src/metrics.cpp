@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "metrics.h"
+
+namespace {
+
+// 最高有效位的位置，value 必须非零
+int HighestBit(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+std::string FormatDouble(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    return buffer;
+}
+
+// 名称加标签，例如 name{slot="3"}；extra 为附加标签
+std::string SeriesName(const std::string& name, const std::string& labels, const std::string& extra = "") {
+    std::string series = name;
+    if (!labels.empty() || !extra.empty()) {
+        series += "{" + labels;
+        if (!labels.empty() && !extra.empty()) {
+            series += ",";
+        }
+        series += extra + "}";
+    }
+    return series;
+}
+
+template <typename T>
+std::vector<const T*> SortedByName(const std::vector<T>& entries) {
+    std::vector<const T*> sorted;
+    for (const auto& entry : entries) {
+        sorted.push_back(&entry);
+    }
+    // 同名的序列必须相邻输出
+    std::stable_sort(sorted.begin(), sorted.end(), [](const T* a, const T* b) { return a->name < b->name; });
+    return sorted;
+}
+
+void WriteFamilyHeader(std::ostringstream& out, const std::string& name, const std::string& help,
+                       const char* type, std::string& last_name) {
+    if (name == last_name) {
+        return;
+    }
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+    last_name = name;
+}
+
+}  // namespace
+
+int64_t MetricsNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int LatencyHistogram::BucketIndex(uint64_t value) {
+    if (value < static_cast<uint64_t>(kSubBuckets)) {
+        return static_cast<int>(value);
+    }
+    int exponent = HighestBit(value);
+    if (exponent > kMaxExponent) {
+        return kBucketCount - 1;
+    }
+    // 每个 2 的幂区间按次高 kSubBucketBits 位线性细分
+    int sub = static_cast<int>((value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1));
+    return (exponent - kSubBucketBits + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(int index) {
+    if (index < kSubBuckets) {
+        return static_cast<uint64_t>(index);
+    }
+    int exponent = index / kSubBuckets + kSubBucketBits - 1;
+    uint64_t sub = static_cast<uint64_t>(index % kSubBuckets);
+    uint64_t width = 1ull << (exponent - kSubBucketBits);
+    return ((kSubBuckets + sub) << (exponent - kSubBucketBits)) + width - 1;
+}
+
+void LatencyHistogram::Record(int64_t value_ns) {
+    uint64_t value = value_ns > 0 ? static_cast<uint64_t>(value_ns) : 0;
+    buckets_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_ns_.fetch_add(value, std::memory_order_relaxed);
+    // 最大值只在变大时才写入
+    uint64_t max = max_ns_.load(std::memory_order_relaxed);
+    while (value > max && !max_ns_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::QuantileNs(double quantile) const {
+    uint64_t count = Count();
+    if (count == 0) {
+        return 0;
+    }
+    quantile = std::min(std::max(quantile, 0.0), 1.0);
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(quantile * count + 0.5));
+    uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(BucketUpperBound(i), MaxNs());
+        }
+    }
+    return MaxNs();
+}
+
+ScopedLatency::ScopedLatency(LatencyHistogram& histogram)
+    : histogram_(histogram)
+    , start_ns_(MetricsNowNs()) {
+}
+
+ScopedLatency::~ScopedLatency() {
+    histogram_.Record(MetricsNowNs() - start_ns_);
+}
+
+template <typename T>
+T& MetricsRegistry::GetOrCreate(std::vector<Entry<T>>& entries, const std::string& name, const std::string& help,
+                                const std::string& labels) {
+    for (auto& entry : entries) {
+        if (entry.name == name && entry.labels == labels) {
+            return *entry.metric;
+        }
+    }
+    entries.push_back(Entry<T>{name, help, labels, std::make_unique<T>()});
+    return *entries.back().metric;
+}
+
+MetricCounter& MetricsRegistry::Counter(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return GetOrCreate(counters_, name, help, labels);
+}
+
+MetricGauge& MetricsRegistry::Gauge(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return GetOrCreate(gauges_, name, help, labels);
+}
+
+LatencyHistogram& MetricsRegistry::Histogram(const std::string& name, const std::string& help,
+                                             const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return GetOrCreate(histograms_, name, help, labels);
+}
+
+MetricsSnapshot MetricsRegistry::Snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    MetricsSnapshot snapshot;
+    for (const auto& entry : counters_) {
+        snapshot.counters.push_back({entry.name, entry.labels, static_cast<double>(entry.metric->Value())});
+    }
+    for (const auto& entry : gauges_) {
+        snapshot.gauges.push_back({entry.name, entry.labels, entry.metric->Value()});
+    }
+    for (const auto& entry : histograms_) {
+        const LatencyHistogram& histogram = *entry.metric;
+        LatencySummary summary;
+        summary.name = entry.name;
+        summary.labels = entry.labels;
+        summary.count = histogram.Count();
+        summary.sum_ms = histogram.SumNs() * 1e-6;
+        summary.p50_ms = histogram.QuantileNs(0.5) * 1e-6;
+        summary.p90_ms = histogram.QuantileNs(0.9) * 1e-6;
+        summary.p99_ms = histogram.QuantileNs(0.99) * 1e-6;
+        summary.p999_ms = histogram.QuantileNs(0.999) * 1e-6;
+        summary.max_ms = histogram.MaxNs() * 1e-6;
+        snapshot.latencies.push_back(summary);
+    }
+    return snapshot;
+}
+
+std::string MetricsRegistry::RenderPrometheus() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream out;
+    std::string last_name;
+    for (const auto* entry : SortedByName(counters_)) {
+        WriteFamilyHeader(out, entry->name, entry->help, "counter", last_name);
+        out << SeriesName(entry->name, entry->labels) << " " << entry->metric->Value() << "\n";
+    }
+    for (const auto* entry : SortedByName(gauges_)) {
+        WriteFamilyHeader(out, entry->name, entry->help, "gauge", last_name);
+        out << SeriesName(entry->name, entry->labels) << " " << FormatDouble(entry->metric->Value()) << "\n";
+    }
+    static const double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+    for (const auto* entry : SortedByName(histograms_)) {
+        const LatencyHistogram& histogram = *entry->metric;
+        WriteFamilyHeader(out, entry->name, entry->help, "summary", last_name);
+        for (double quantile : kQuantiles) {
+            out << SeriesName(entry->name, entry->labels, "quantile=\"" + FormatDouble(quantile) + "\"") << " "
+                << FormatDouble(histogram.QuantileNs(quantile) * 1e-9) << "\n";
+        }
+        out << SeriesName(entry->name + "_sum", entry->labels) << " " << FormatDouble(histogram.SumNs() * 1e-9) << "\n";
+        out << SeriesName(entry->name + "_count", entry->labels) << " " << histogram.Count() << "\n";
+    }
+    return out.str();
+}
@@ -0,0 +1,209 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "metrics.h"
+#include "metrics_http_server.h"
+
+namespace {
+
+#ifdef _WIN32
+using Socket = SOCKET;
+#else
+using Socket = int;
+#endif
+
+// 接受连接与读取请求的等待上限，保证 Stop() 能及时退出
+constexpr int kPollIntervalMs = 100;
+constexpr int kRequestTimeoutMs = 1000;
+constexpr size_t kMaxRequestBytes = 8192;
+
+// 抓取方提前断开时 send() 不能触发 SIGPIPE 终止整个进程；
+// Linux 按次传 MSG_NOSIGNAL，macOS 在连接上设置 SO_NOSIGPIPE
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+void CloseSocket(intptr_t socket) {
+#ifdef _WIN32
+    closesocket(static_cast<Socket>(socket));
+#else
+    close(static_cast<Socket>(socket));
+#endif
+}
+
+bool WaitReadable(intptr_t socket, int timeout_ms) {
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(static_cast<Socket>(socket), &readable);
+    timeval timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    return select(static_cast<int>(socket + 1), &readable, nullptr, nullptr, &timeout) > 0;
+}
+
+bool SendAll(intptr_t socket, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        int n = static_cast<int>(send(static_cast<Socket>(socket), data.data() + sent,
+                                      static_cast<int>(data.size() - sent), kSendFlags));
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+std::string Response(const char* status, const char* content_type, const std::string& body) {
+    return std::string("HTTP/1.0 ") + status + "\r\nContent-Type: " + content_type +
+           "\r\nContent-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+}
+
+}  // namespace
+
+MetricsHttpServer::~MetricsHttpServer() {
+    Stop();
+}
+
+bool MetricsHttpServer::Start(const MetricsRegistry* registry, int port, const std::string& bind_address) {
+    Stop();
+    if (!registry || port < 0 || port > 65535) {
+        return false;
+    }
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, bind_address.c_str(), &address.sin_addr) != 1) {
+        std::cerr << "Invalid metrics bind address " << bind_address << std::endl;
+        return false;
+    }
+
+#ifdef _WIN32
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+        std::cerr << "Failed to initialize sockets" << std::endl;
+        return false;
+    }
+    started_ = true;
+    Socket listener = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener == INVALID_SOCKET) {
+        Stop();
+        return false;
+    }
+#else
+    Socket listener = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener < 0) {
+        return false;
+    }
+#endif
+    socket_ = static_cast<intptr_t>(listener);
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+    if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 8) != 0) {
+        std::cerr << "Failed to listen for metrics on " << bind_address << ":" << port << std::endl;
+        Stop();
+        return false;
+    }
+    sockaddr_in bound{};
+    socklen_t length = sizeof(bound);
+    getsockname(listener, reinterpret_cast<sockaddr*>(&bound), &length);
+    port_ = ntohs(bound.sin_port);
+    if ((ntohl(address.sin_addr.s_addr) >> 24) != 127) {
+        // 端点没有鉴权，非回环地址需要调用方显式指定，这里提示一次
+        std::cerr << "Metrics endpoint exposed on " << bind_address << ":" << port_ << " without authentication" << std::endl;
+    }
+
+    registry_ = registry;
+    running_ = true;
+    thread_ = std::thread(&MetricsHttpServer::ServeLoop, this);
+    return true;
+}
+
+void MetricsHttpServer::Stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (socket_ >= 0) {
+        CloseSocket(socket_);
+        socket_ = -1;
+    }
+#ifdef _WIN32
+    if (started_) {
+        WSACleanup();
+    }
+#endif
+    started_ = false;
+    port_ = 0;
+}
+
+void MetricsHttpServer::ServeLoop() {
+    while (running_) {
+        if (!WaitReadable(socket_, kPollIntervalMs)) {
+            continue;
+        }
+        Socket connection = accept(static_cast<Socket>(socket_), nullptr, nullptr);
+#ifdef _WIN32
+        if (connection == INVALID_SOCKET) {
+            continue;
+        }
+#else
+        if (connection < 0) {
+            continue;
+        }
+#ifdef SO_NOSIGPIPE
+        int no_sigpipe = 1;
+        setsockopt(connection, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+#endif
+        Serve(static_cast<intptr_t>(connection));
+        CloseSocket(static_cast<intptr_t>(connection));
+    }
+}
+
+void MetricsHttpServer::Serve(intptr_t connection) {
+    // 只需要请求行，读到头部结束或超时为止
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < kMaxRequestBytes) {
+        if (!WaitReadable(connection, kRequestTimeoutMs)) {
+            break;
+        }
+        int n = static_cast<int>(recv(static_cast<Socket>(connection), buffer, sizeof(buffer), 0));
+        if (n <= 0) {
+            break;
+        }
+        request.append(buffer, static_cast<size_t>(n));
+    }
+
+    std::string line = request.substr(0, request.find("\r\n"));
+    std::string response;
+    if (line.compare(0, 4, "GET ") != 0) {
+        response = Response("405 Method Not Allowed", "text/plain", "Method not allowed\n");
+    } else {
+        std::string path = line.substr(4, line.find(' ', 4) - 4);
+        if (path == "/metrics" || path.compare(0, 9, "/metrics?") == 0) {
+            response = Response("200 OK", "text/plain; version=0.0.4; charset=utf-8", registry_->RenderPrometheus());
+        } else {
+            response = Response("404 Not Found", "text/plain", "Not found\n");
+        }
+    }
+    SendAll(connection, response);
+}
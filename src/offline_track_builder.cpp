@@ -0,0 +1,329 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+
+#include <omp.h>
+
+#include "offline_track_builder.h"
+
+OfflineTrackBuilder::OfflineTrackBuilder(const OfflineInitTrackConfig& config)
+    : config_(config)
+{
+}
+
+int OfflineTrackBuilder::AddBall(int id, const cv::Scalar_<double>& lower, const cv::Scalar_<double>& upper,
+                                 const cv::Point_<float>& start) {
+    // 颜色范围相同的球共用一次颜色分割
+    int model = -1;
+    for (size_t i = 0; i < models_.size(); ++i) {
+        if (models_[i].lower == lower && models_[i].upper == upper) {
+            model = static_cast<int>(i);
+            break;
+        }
+    }
+    if (model < 0) {
+        model = static_cast<int>(models_.size());
+        models_.push_back({lower, upper});
+    }
+    balls_.push_back({id, model, start});
+    return static_cast<int>(balls_.size()) - 1;
+}
+
+int OfflineTrackBuilder::SegmentCount(int64_t frame_count) const {
+    if (frame_count <= 0) {
+        return 1;  // 帧数未知时无法分段
+    }
+    int64_t segments = config_.segments > 0 ? config_.segments : omp_get_max_threads();
+    segments = std::min<int64_t>(segments, frame_count / std::max(1, config_.min_segment_frames));
+    return static_cast<int>(std::max<int64_t>(1, segments));
+}
+
+bool OfflineTrackBuilder::Detect(const std::string& video_path) {
+    cv::VideoCapture cap;
+    if (!cap.open(video_path)) {
+        std::cerr << "Failed to open video: " << video_path << std::endl;
+        return false;
+    }
+    int64_t frame_count = std::max<int64_t>(0, static_cast<int64_t>(cap.get(cv::CAP_PROP_FRAME_COUNT)));
+    int segments = SegmentCount(frame_count);
+
+    // 分段解码依赖按帧号精确跳转，容器不支持时退回单段顺序解码
+    if (segments > 1) {
+        int64_t probe = frame_count / segments;
+        if (!cap.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(probe)) ||
+            static_cast<int64_t>(cap.get(cv::CAP_PROP_POS_FRAMES)) != probe) {
+            std::cerr << "Frame accurate seeking unavailable for " << video_path
+                      << ", decoding as one segment" << std::endl;
+            segments = 1;
+        }
+    }
+    cap.release();
+
+    segments_.assign(segments, Segment());
+    for (int s = 0; s < segments; ++s) {
+        segments_[s].start = frame_count * s / segments;
+        segments_[s].end = s + 1 == segments ? -1 : frame_count * (s + 1) / segments;
+    }
+
+    // 每段由一个线程用独立的解码器解码并检测，段之间没有依赖
+    #pragma omp parallel for schedule(static, 1) num_threads(segments)
+    for (int s = 0; s < segments; ++s) {
+        Segment& segment = segments_[s];
+        cv::VideoCapture segment_cap;
+        if (!segment_cap.open(video_path) ||
+            (segment.start > 0 && !segment_cap.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(segment.start)))) {
+            continue;
+        }
+        if (segment.end > 0) {
+            segment.frames.reserve(static_cast<size_t>(segment.end - segment.start));
+        }
+        FrameDetector detector(*this);
+        cv::Mat image;
+        for (int64_t index = segment.start; segment.end < 0 || index < segment.end; ++index) {
+            if (!segment_cap.read(image) || image.empty()) {
+                break;
+            }
+            segment.frame_size = image.size();
+            segment.frames.emplace_back();
+            detector.Detect(image, segment.frames.back());
+        }
+        segment.complete = segment.end < 0 ||
+                           segment.start + static_cast<int64_t>(segment.frames.size()) == segment.end;
+    }
+
+    MergeSegments();
+    return !frames_.empty();
+}
+
+void OfflineTrackBuilder::Detect(const std::vector<cv::Mat>& images) {
+    int64_t frame_count = static_cast<int64_t>(images.size());
+    int segments = SegmentCount(frame_count);
+    segments_.assign(segments, Segment());
+
+    #pragma omp parallel for schedule(static, 1) num_threads(segments)
+    for (int s = 0; s < segments; ++s) {
+        Segment& segment = segments_[s];
+        segment.start = frame_count * s / segments;
+        segment.end = frame_count * (s + 1) / segments;
+        segment.frames.resize(static_cast<size_t>(segment.end - segment.start));
+        FrameDetector detector(*this);
+        for (int64_t index = segment.start; index < segment.end; ++index) {
+            segment.frame_size = images[index].size();
+            detector.Detect(images[index], segment.frames[index - segment.start]);
+        }
+        segment.complete = true;
+    }
+
+    MergeSegments();
+}
+
+void OfflineTrackBuilder::MergeSegments() {
+    frames_.clear();
+    frame_size_ = cv::Size();
+    segment_count_ = static_cast<int>(segments_.size());
+    for (size_t s = 0; s < segments_.size(); ++s) {
+        Segment& segment = segments_[s];
+        if (frame_size_.area() == 0) {
+            frame_size_ = segment.frame_size;
+        }
+        std::move(segment.frames.begin(), segment.frames.end(), std::back_inserter(frames_));
+        // 某段提前结束说明文件实际在此结束（容器报告的帧数偏大），之后的段不再使用
+        if (!segment.complete) {
+            if (s + 1 < segments_.size()) {
+                std::cerr << "Video ends at frame " << frames_.size() << " in segment " << s
+                          << ", later segments dropped" << std::endl;
+            }
+            break;
+        }
+    }
+    segments_.clear();
+}
+
+OfflineTrackBuilder::FrameDetector::FrameDetector(const OfflineTrackBuilder& builder)
+    : builder_(builder)
+{
+    // 降采样后的游程与面积阈值按比例缩小
+    int scale = std::max(1, builder.config_.detect_scale);
+    BlobExtractorConfig config;
+    config.max_run_gap = std::max(1, config.max_run_gap / scale);
+    config.min_run_length = std::max(1, config.min_run_length / scale);
+    config.min_area = std::max(1, config.min_area / (scale * scale));
+    extractor_.SetConfig(config);
+}
+
+void OfflineTrackBuilder::FrameDetector::Detect(const cv::Mat& image, OfflineFrame& frame) {
+    int scale = std::max(1, builder_.config_.detect_scale);
+    if (scale > 1) {
+        // 最近邻降采样只取样不混色，球的边缘不会出现混合出的色调
+        cv::resize(image, small_, cv::Size(image.cols / scale, image.rows / scale), 0, 0, cv::INTER_NEAREST);
+        cv::cvtColor(small_, hsv_image_, cv::COLOR_BGR2HSV);
+    } else {
+        cv::cvtColor(image, hsv_image_, cv::COLOR_BGR2HSV);
+    }
+
+    frame.detections.clear();
+    frame.model_begin.clear();
+    for (const auto& model : builder_.models_) {
+        frame.model_begin.push_back(static_cast<int>(frame.detections.size()));
+        cv::inRange(hsv_image_, model.lower, model.upper, mask_);
+        int num_blobs = extractor_.Extract(mask_, blobs_);
+        for (int k = 0; k < num_blobs; ++k) {
+            OfflineDetection detection;
+            detection.center = cv::Point_<float>(blobs_[k].centroid.x * scale, blobs_[k].centroid.y * scale);
+            detection.radius = blobs_[k].MomentRadius() * scale;
+            frame.detections.push_back(detection);
+        }
+    }
+    frame.model_begin.push_back(static_cast<int>(frame.detections.size()));
+}
+
+bool OfflineTrackBuilder::IsLocked(int ball) const {
+    // 漏检不超过可插值的帧数时仍按卡尔曼预测关联，否则重新搜索
+    return states_[ball].started && states_[ball].misses <= config_.max_gap_frames;
+}
+
+void OfflineTrackBuilder::Link(const AssociationConfig& association, double max_velocity,
+                               int max_consecutive_failures) {
+    int num_balls = GetBallCount();
+    kalman_ = KalmanBank();
+    kalman_.Reserve(num_balls);
+    tracks_.assign(num_balls, OfflineBallTrack());
+    for (int b = 0; b < num_balls; ++b) {
+        kalman_.AddLane();  // 通道编号与球的下标一致
+        tracks_[b].id = balls_[b].id;
+    }
+    states_.assign(num_balls, LinkState());
+    assigned_.assign(num_balls, -1);
+
+    for (int f = 0; f < GetFrameCount(); ++f) {
+        bool any_recording = false;
+        for (int b = 0; b < num_balls; ++b) {
+            if (states_[b].recording && states_[b].started) {
+                kalman_.RequestPredict(b);
+            }
+            any_recording = any_recording || states_[b].recording;
+        }
+        if (!any_recording) {
+            break;
+        }
+        kalman_.PredictBatch();
+
+        // 同色的球统一分配：先分配锁定的球，搜索中的球只能取剩余的检测
+        const OfflineFrame& frame = frames_[f];
+        std::fill(assigned_.begin(), assigned_.end(), -1);
+        taken_.assign(frame.detections.size(), 0);
+        for (int model = 0; model < static_cast<int>(models_.size()); ++model) {
+            AssignStage(frame, model, f, true, association, max_velocity);
+            AssignStage(frame, model, f, false, association, max_velocity);
+        }
+
+        for (int b = 0; b < num_balls; ++b) {
+            if (states_[b].recording) {
+                Record(b, f, assigned_[b] >= 0 ? &frame.detections[assigned_[b]] : nullptr, max_consecutive_failures);
+            }
+        }
+    }
+}
+
+void OfflineTrackBuilder::AssignStage(const OfflineFrame& frame, int model, int frame_index, bool locked,
+                                      const AssociationConfig& association, double max_velocity) {
+    rows_.clear();
+    cols_.clear();
+    for (int b = 0; b < GetBallCount(); ++b) {
+        if (balls_[b].model == model && states_[b].recording && IsLocked(b) == locked) {
+            rows_.push_back(b);
+        }
+    }
+    for (int c = frame.model_begin[model]; c < frame.model_begin[model + 1]; ++c) {
+        if (!taken_[c]) {
+            cols_.push_back(c);
+        }
+    }
+    int rows = static_cast<int>(rows_.size());
+    int cols = static_cast<int>(cols_.size());
+    if (rows == 0 || cols == 0) {
+        return;
+    }
+
+    float extent = static_cast<float>(frame_size_.width * frame_size_.width + frame_size_.height * frame_size_.height);
+    extent = std::max(extent, 1.0f);
+    cost_.assign(static_cast<size_t>(rows) * cols, kNotGated);
+    for (int r = 0; r < rows; ++r) {
+        int b = rows_[r];
+        const LinkState& state = states_[b];
+        cv::Point_<float> reference = state.started ? state.last : balls_[b].start;
+        float reach = static_cast<float>(max_velocity * (frame_index - state.last_frame));
+        float sigma = association.min_sigma_radii * state.radius;
+        for (int k = 0; k < cols; ++k) {
+            const OfflineDetection& detection = frame.detections[cols_[k]];
+            float dx = detection.center.x - reference.x;
+            float dy = detection.center.y - reference.y;
+            float distance2 = dx * dx + dy * dy;
+            // 与上次检测相比速度过大的检测视为误检
+            if (state.started && distance2 > reach * reach) {
+                continue;
+            }
+            if (locked) {
+                float distance = kalman_.Mahalanobis2(b, detection.center.x, detection.center.y, sigma * sigma);
+                if (distance <= association.gate) {
+                    cost_[r * cols + k] = distance;
+                }
+            } else {
+                // 重新搜索时不受门限限制，离起点或上次位置越近代价越低
+                cost_[r * cols + k] = distance2 / extent;
+            }
+        }
+    }
+
+    solver_.Solve(cost_, rows, cols, row_to_col_);
+    for (int r = 0; r < rows; ++r) {
+        if (row_to_col_[r] >= 0) {
+            int c = cols_[row_to_col_[r]];
+            assigned_[rows_[r]] = c;
+            taken_[c] = 1;
+        }
+    }
+}
+
+void OfflineTrackBuilder::Record(int ball, int frame_index, const OfflineDetection* detection,
+                                 int max_consecutive_failures) {
+    LinkState& state = states_[ball];
+    OfflineBallTrack& track = tracks_[ball];
+    track.total_frames++;
+
+    if (detection == nullptr) {
+        state.misses++;
+        track.max_consecutive_failures = std::max(track.max_consecutive_failures, state.misses);
+        // 连续失败次数超过阈值，该球停止记录，成功率低于50%视为丢失
+        if (state.misses >= max_consecutive_failures) {
+            state.recording = false;
+            track.lost = static_cast<double>(track.success_frames) / track.total_frames < 0.5;
+        }
+        return;
+    }
+
+    const cv::Point_<float>& center = detection->center;
+    if (IsLocked(ball)) {
+        // 短暂漏检的帧按前后两次检测线性插值补齐
+        int gap = frame_index - state.last_frame - 1;
+        for (int i = 1; i <= gap; ++i) {
+            float t = static_cast<float>(i) / (gap + 1);
+            track.points.push_back(state.last + (center - state.last) * t);
+            track.frames.push_back(state.last_frame + i);
+        }
+        track.filled_frames += gap;
+        kalman_.Correct(ball, center.x, center.y);
+    } else {
+        kalman_.Reset(ball, center.x, center.y);
+    }
+
+    state.started = true;
+    state.last_frame = frame_index;
+    state.last = center;
+    state.radius = detection->radius;
+    state.misses = 0;
+    track.points.push_back(center);
+    track.frames.push_back(frame_index);
+    track.success_frames++;
+}
@@ -0,0 +1,83 @@
+#include <chrono>
+#include <iostream>
+
+#include "opencv_capture_source.h"
+
+OpenCVCaptureSource::OpenCVCaptureSource()
+    : width_(0)
+    , height_(0)
+    , fps_(0)
+    , frame_id_(0)
+{
+}
+
+OpenCVCaptureSource::~OpenCVCaptureSource() {
+    Close();
+}
+
+bool OpenCVCaptureSource::Open(const std::string& source, int width, int height, int fps) {
+    Close();
+
+    int camera_id = 0;
+    try {
+        camera_id = std::stoi(source);
+    } catch (const std::exception&) {
+        std::cerr << "Invalid camera id: " << source << std::endl;
+        return false;
+    }
+
+    if (!cap_.open(camera_id)) {
+        return false;
+    }
+    if (width > 0) cap_.set(cv::CAP_PROP_FRAME_WIDTH, width);
+    if (height > 0) cap_.set(cv::CAP_PROP_FRAME_HEIGHT, height);
+    if (fps > 0) cap_.set(cv::CAP_PROP_FPS, fps);
+
+    width_ = static_cast<int>(cap_.get(cv::CAP_PROP_FRAME_WIDTH));
+    height_ = static_cast<int>(cap_.get(cv::CAP_PROP_FRAME_HEIGHT));
+    fps_ = static_cast<int>(cap_.get(cv::CAP_PROP_FPS));
+
+    // 相机不支持请求的参数时视为打开失败
+    if ((width > 0 && width_ != width) ||
+        (height > 0 && height_ != height) ||
+        (fps > 0 && fps_ != fps)) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void OpenCVCaptureSource::Close() {
+    if (cap_.isOpened()) {
+        cap_.release();
+    }
+    width_ = 0;
+    height_ = 0;
+    fps_ = 0;
+    frame_id_ = 0;
+}
+
+bool OpenCVCaptureSource::Read(RawFrame& frame) {
+    if (!cap_.read(frame.image)) {
+        return false;
+    }
+    frame.format = PixelFormat::BGR8;
+    frame.frame_id = frame_id_++;
+    frame.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return !frame.image.empty();
+}
+
+CaptureStatus OpenCVCaptureSource::GetReadStatus() const {
+    // VideoCapture 对实时相机阻塞读取，读取失败即设备断开或停止出图
+    return cap_.isOpened() ? CaptureStatus::DEVICE_LOST : CaptureStatus::NOT_OPEN;
+}
+
+FrameSourceCaps OpenCVCaptureSource::GetCaps() const {
+    FrameSourceCaps caps;
+    caps.native_format = PixelFormat::BGR8;
+    caps.zero_copy = false;
+    caps.native_bgr_convert = false;
+    caps.is_live = true;
+    return caps;
+}
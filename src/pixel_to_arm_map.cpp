@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+#include <nlohmann/json.hpp>
+
+#include "pixel_to_arm_map.h"
+
+namespace {
+
+// 畸变反解的迭代次数，与 cv::undistortPoints 的默认值一致
+constexpr int kUndistortIterations = 20;
+
+}  // namespace
+
+bool PixelToArmMap::LoadCalibration(const std::string& path, CameraCalibration& calibration) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open camera calibration file: " << path << std::endl;
+        return false;
+    }
+
+    try {
+        nlohmann::json json;
+        file >> json;
+        CameraCalibration result;
+        result.image_width = json.at("image_size").at(0);
+        result.image_height = json.at("image_size").at(1);
+        const auto& camera_matrix = json.at("camera_matrix");
+        result.fx = camera_matrix.at(0);
+        result.cx = camera_matrix.at(2);
+        result.fy = camera_matrix.at(4);
+        result.cy = camera_matrix.at(5);
+        const auto& distortion = json.at("distortion");
+        double* coefficients[] = {&result.k1, &result.k2, &result.p1, &result.p2, &result.k3};
+        for (size_t i = 0; i < distortion.size() && i < 5; ++i) {
+            *coefficients[i] = distortion[i];
+        }
+        if (json.contains("rotation")) {
+            for (int i = 0; i < 9; ++i) {
+                result.rotation[i] = json["rotation"].at(i);
+            }
+        }
+        if (json.contains("camera_position")) {
+            result.camera_x = json["camera_position"].at(0);
+            result.camera_y = json["camera_position"].at(1);
+        }
+        result.grid_step = json.value("grid_step", result.grid_step);
+        calibration = result;
+    } catch (const nlohmann::json::exception& e) {
+        std::cerr << "Invalid camera calibration file " << path << ": " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool PixelToArmMap::Build(const CameraCalibration& calibration) {
+    if (calibration.image_width <= 0 || calibration.image_height <= 0 || calibration.fx <= 0.0 ||
+        calibration.fy <= 0.0 || calibration.grid_step <= 0) {
+        std::cerr << "Incomplete camera calibration" << std::endl;
+        grid_.clear();
+        return false;
+    }
+    calibration_ = calibration;
+
+    // 网格节点间隔 grid_step 像素，最后一个节点覆盖到图像边缘之外
+    int step = calibration.grid_step;
+    grid_cols_ = (calibration.image_width - 1 + step - 1) / step + 1;
+    grid_rows_ = (calibration.image_height - 1 + step - 1) / step + 1;
+    grid_cols_ = std::max(grid_cols_, 2);
+    grid_rows_ = std::max(grid_rows_, 2);
+    grid_.resize(static_cast<size_t>(grid_cols_) * grid_rows_ * 2);
+
+    const CameraCalibration& c = calibration_;
+    for (int row = 0; row < grid_rows_; ++row) {
+        for (int col = 0; col < grid_cols_; ++col) {
+            // 与 cv::undistortPoints 相同的不动点迭代反解畸变
+            double x0 = (col * step - c.cx) / c.fx;
+            double y0 = (row * step - c.cy) / c.fy;
+            double x = x0;
+            double y = y0;
+            for (int i = 0; i < kUndistortIterations; ++i) {
+                double r2 = x * x + y * y;
+                double inverse_radial = 1.0 / (1.0 + ((c.k3 * r2 + c.k2) * r2 + c.k1) * r2);
+                double dx = 2.0 * c.p1 * x * y + c.p2 * (r2 + 2.0 * x * x);
+                double dy = c.p1 * (r2 + 2.0 * y * y) + 2.0 * c.p2 * x * y;
+                x = (x0 - dx) * inverse_radial;
+                y = (y0 - dy) * inverse_radial;
+            }
+            float* node = &grid_[(static_cast<size_t>(row) * grid_cols_ + col) * 2];
+            node[0] = static_cast<float>(x);
+            node[1] = static_cast<float>(y);
+        }
+    }
+    return true;
+}
+
+void PixelToArmMap::Undistort(double u, double v, double& x, double& y) const {
+    // 双线性插值，图像外的点按边缘网格外推
+    double step = calibration_.grid_step;
+    double gu = u / step;
+    double gv = v / step;
+    int col = std::min(std::max(static_cast<int>(std::floor(gu)), 0), grid_cols_ - 2);
+    int row = std::min(std::max(static_cast<int>(std::floor(gv)), 0), grid_rows_ - 2);
+    double tu = gu - col;
+    double tv = gv - row;
+    const float* n00 = &grid_[(static_cast<size_t>(row) * grid_cols_ + col) * 2];
+    const float* n01 = n00 + 2;
+    const float* n10 = n00 + static_cast<size_t>(grid_cols_) * 2;
+    const float* n11 = n10 + 2;
+    for (int axis = 0; axis < 2; ++axis) {
+        double top = n00[axis] + (n01[axis] - n00[axis]) * tu;
+        double bottom = n10[axis] + (n11[axis] - n10[axis]) * tu;
+        (axis == 0 ? x : y) = top + (bottom - top) * tv;
+    }
+}
+
+bool PixelToArmMap::ToArm(double u, double v, double height, double& x, double& y) const {
+    if (grid_.empty()) {
+        return false;
+    }
+    double nx, ny;
+    Undistort(u, v, nx, ny);
+
+    // 视线方向转到机械臂坐标系，与高度为 height 的水平面求交
+    const double* r = calibration_.rotation;
+    double dx = r[0] * nx + r[1] * ny + r[2];
+    double dy = r[3] * nx + r[4] * ny + r[5];
+    double dz = r[6] * nx + r[7] * ny + r[8];
+    if (std::abs(dz) < 1e-12) {
+        return false;
+    }
+    double t = (height - camera_height_) / dz;
+    if (t <= 0.0) {
+        return false;
+    }
+    x = calibration_.camera_x + t * dx;
+    y = calibration_.camera_y + t * dy;
+    return true;
+}
+
+bool PixelToArmMap::VelocityToArm(double u, double v, double vu, double vv, double height, double& vx,
+                                  double& vy) const {
+    double x0, y0, x1, y1;
+    if (!ToArm(u - 0.5 * vu, v - 0.5 * vv, height, x0, y0) || !ToArm(u + 0.5 * vu, v + 0.5 * vv, height, x1, y1)) {
+        return false;
+    }
+    vx = x1 - x0;
+    vy = y1 - y0;
+    return true;
+}
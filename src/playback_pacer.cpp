@@ -0,0 +1,89 @@
+#include <thread>
+
+#include "playback_pacer.h"
+
+PlaybackPacer::PlaybackPacer()
+    : pacing_(ReplayPacing::MAX_SPEED)
+    , step_credits_(0)
+    , cancel_count_(0)
+    , started_(false)
+    , media_start_ns_(0)
+{
+}
+
+void PlaybackPacer::SetPacing(ReplayPacing pacing) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pacing_ = pacing;
+    started_ = false;
+    step_credits_ = 0;
+}
+
+ReplayPacing PlaybackPacer::GetPacing() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pacing_;
+}
+
+void PlaybackPacer::Step(int frames) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        step_credits_ += frames;
+    }
+    step_cv_.notify_all();
+}
+
+bool PlaybackPacer::AcquireStep(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (pacing_ != ReplayPacing::STEP) {
+        return true;
+    }
+    uint64_t cancel_count = cancel_count_;
+    step_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this, cancel_count] {
+        return step_credits_ > 0 || cancel_count_ != cancel_count || pacing_ != ReplayPacing::STEP;
+    });
+    if (pacing_ != ReplayPacing::STEP) {
+        return true;  // 等待期间切换了模式
+    }
+    if (step_credits_ <= 0) {
+        return false;
+    }
+    step_credits_--;
+    return true;
+}
+
+void PlaybackPacer::Cancel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancel_count_++;
+        step_credits_ = 0;
+    }
+    step_cv_.notify_all();
+}
+
+void PlaybackPacer::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    started_ = false;
+}
+
+int64_t PlaybackPacer::WaitUntil(int64_t media_time_ns) {
+    std::chrono::steady_clock::time_point due;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pacing_ != ReplayPacing::REAL_TIME) {
+            return 0;
+        }
+        if (!started_) {
+            wall_start_ = std::chrono::steady_clock::now();
+            media_start_ns_ = media_time_ns;
+            started_ = true;
+            return 0;
+        }
+        due = wall_start_ + std::chrono::nanoseconds(media_time_ns - media_start_ns_);
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now >= due) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(now - due).count();
+    }
+    std::this_thread::sleep_until(due);
+    return 0;
+}
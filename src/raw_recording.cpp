@@ -0,0 +1,297 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <opencv2/opencv.hpp>
+
+#include "raw_recording.h"
+
+namespace {
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void CopyString(char* dst, size_t dst_size, const std::string& src) {
+    std::memset(dst, 0, dst_size);
+    std::memcpy(dst, src.data(), std::min(src.size(), dst_size - 1));
+}
+
+}  // namespace
+
+bool MakeRawRecordingHeader(const RawRecordingInfo& info, RawRecordingHeader& header) {
+    int bpp = PixelFormatBytesPerPixel(info.pixel_format);
+    if (info.width <= 0 || info.height <= 0 || bpp == 0) {
+        return false;
+    }
+
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kRawRecordingMagic, sizeof(header.magic));
+    header.version = kRawRecordingVersion;
+    header.header_size = kRawRecordingAlignment;
+    header.width = static_cast<uint32_t>(info.width);
+    header.height = static_cast<uint32_t>(info.height);
+    header.pixel_format = static_cast<uint32_t>(info.pixel_format);
+    header.bytes_per_line = static_cast<uint32_t>(info.width * bpp);
+    header.frame_data_size = static_cast<uint64_t>(header.bytes_per_line) * header.height;
+    header.frame_stride = AlignUp(sizeof(RawFrameRecord) + header.frame_data_size, kRawRecordingAlignment);
+    header.frame_count = 0;
+    header.fps = info.fps;
+    header.start_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    header.source_type = static_cast<uint32_t>(info.source_type);
+    CopyString(header.vendor_name, sizeof(header.vendor_name), info.vendor_name);
+    CopyString(header.model_name, sizeof(header.model_name), info.model_name);
+    CopyString(header.serial_number, sizeof(header.serial_number), info.serial_number);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// RawRecordingWriter
+// ---------------------------------------------------------------------------
+
+RawRecordingWriter::RawRecordingWriter() {
+    std::memset(&header_, 0, sizeof(header_));
+}
+
+RawRecordingWriter::~RawRecordingWriter() {
+    Close();
+}
+
+bool RawRecordingWriter::Open(const std::string& path, const RawRecordingInfo& info) {
+    Close();
+
+    if (!MakeRawRecordingHeader(info, header_)) {
+        std::cerr << "Invalid raw recording format: " << info.width << "x" << info.height
+                  << " " << PixelFormatName(info.pixel_format) << std::endl;
+        return false;
+    }
+
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        std::cerr << "Failed to create raw recording: " << path << std::endl;
+        return false;
+    }
+
+    // 文件头占满一个对齐块
+    std::vector<char> header_block(header_.header_size, 0);
+    std::memcpy(header_block.data(), &header_, sizeof(header_));
+    file_.write(header_block.data(), static_cast<std::streamsize>(header_block.size()));
+
+    padding_.assign(header_.frame_stride - sizeof(RawFrameRecord) - header_.frame_data_size, 0);
+    return static_cast<bool>(file_);
+}
+
+bool RawRecordingWriter::Write(const RawFrame& frame) {
+    if (!file_.is_open()) {
+        return false;
+    }
+    if (frame.image.cols != static_cast<int>(header_.width) ||
+        frame.image.rows != static_cast<int>(header_.height) ||
+        frame.image.elemSize() * frame.image.cols != header_.bytes_per_line ||
+        static_cast<uint32_t>(frame.format) != header_.pixel_format) {
+        std::cerr << "Frame does not match raw recording format" << std::endl;
+        return false;
+    }
+
+    RawFrameRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.frame_id = frame.frame_id;
+    record.timestamp_ns = frame.timestamp_ns;
+    record.index = header_.frame_count;
+    file_.write(reinterpret_cast<const char*>(&record), sizeof(record));
+
+    // 连续内存一次写入，带行填充的（如SDK缓冲区）逐行写入
+    if (frame.image.isContinuous()) {
+        file_.write(reinterpret_cast<const char*>(frame.image.data),
+                    static_cast<std::streamsize>(header_.frame_data_size));
+    } else {
+        for (int y = 0; y < frame.image.rows; ++y) {
+            file_.write(reinterpret_cast<const char*>(frame.image.ptr(y)), header_.bytes_per_line);
+        }
+    }
+    if (!padding_.empty()) {
+        file_.write(padding_.data(), static_cast<std::streamsize>(padding_.size()));
+    }
+
+    if (!file_) {
+        std::cerr << "Failed to write raw frame " << record.index << std::endl;
+        return false;
+    }
+    header_.frame_count++;
+    return true;
+}
+
+void RawRecordingWriter::Close() {
+    if (!file_.is_open()) {
+        return;
+    }
+    // 回写最终帧数
+    file_.seekp(0);
+    file_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    file_.close();
+}
+
+// ---------------------------------------------------------------------------
+// RawRecordingReader
+// ---------------------------------------------------------------------------
+
+struct RawRecordingReader::Mapping {
+    const unsigned char* data = nullptr;
+    uint64_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+
+    bool Map(const std::string& path) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+            Unmap();
+            return false;
+        }
+        size = static_cast<uint64_t>(file_size.QuadPart);
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) {
+            Unmap();
+            return false;
+        }
+        data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (data == nullptr) {
+            Unmap();
+            return false;
+        }
+#else
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            Unmap();
+            return false;
+        }
+        size = static_cast<uint64_t>(st.st_size);
+        void* ptr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (ptr == MAP_FAILED) {
+            Unmap();
+            return false;
+        }
+        data = static_cast<const unsigned char*>(ptr);
+        // 回放通常顺序访问，提示内核预读
+        madvise(ptr, size, MADV_SEQUENTIAL);
+#endif
+        return true;
+    }
+
+    void Unmap() {
+#ifdef _WIN32
+        if (data != nullptr) UnmapViewOfFile(data);
+        if (mapping != nullptr) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (data != nullptr) munmap(const_cast<unsigned char*>(data), size);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+    ~Mapping() { Unmap(); }
+};
+
+RawRecordingReader::RawRecordingReader()
+    : mapping_(std::make_unique<Mapping>())
+    , frame_count_(0)
+{
+    std::memset(&header_, 0, sizeof(header_));
+}
+
+RawRecordingReader::~RawRecordingReader() {
+    Close();
+}
+
+bool RawRecordingReader::Open(const std::string& path) {
+    Close();
+
+    if (!mapping_->Map(path)) {
+        std::cerr << "Failed to map raw recording: " << path << std::endl;
+        return false;
+    }
+    if (mapping_->size < sizeof(RawRecordingHeader)) {
+        std::cerr << "Raw recording too small: " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    std::memcpy(&header_, mapping_->data, sizeof(header_));
+    if (std::memcmp(header_.magic, kRawRecordingMagic, sizeof(header_.magic)) != 0 ||
+        header_.version != kRawRecordingVersion ||
+        header_.frame_stride < sizeof(RawFrameRecord) + header_.frame_data_size ||
+        header_.frame_data_size != static_cast<uint64_t>(header_.bytes_per_line) * header_.height ||
+        PixelFormatBytesPerPixel(static_cast<PixelFormat>(header_.pixel_format)) == 0) {
+        std::cerr << "Not a valid raw recording: " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    // 写入端异常退出时帧数为0，按文件大小恢复完整帧数
+    uint64_t available = mapping_->size > header_.header_size
+        ? (mapping_->size - header_.header_size) / header_.frame_stride : 0;
+    frame_count_ = (header_.frame_count == 0 || header_.frame_count > available)
+        ? available : header_.frame_count;
+    return true;
+}
+
+void RawRecordingReader::Close() {
+    mapping_->Unmap();
+    frame_count_ = 0;
+}
+
+bool RawRecordingReader::IsOpen() const {
+    return mapping_->data != nullptr;
+}
+
+bool RawRecordingReader::GetFrame(uint64_t index, RawFrame& frame) const {
+    if (!IsOpen() || index >= frame_count_) {
+        return false;
+    }
+
+    const unsigned char* slot = mapping_->data + header_.header_size + index * header_.frame_stride;
+    RawFrameRecord record;
+    std::memcpy(&record, slot, sizeof(record));
+
+    PixelFormat format = static_cast<PixelFormat>(header_.pixel_format);
+    int type = PixelFormatBytesPerPixel(format) == 3 ? CV_8UC3 : CV_8UC1;
+    // 映射为只读，cv::Mat 需要非const指针，调用方不得写入
+    frame.image = cv::Mat(static_cast<int>(header_.height), static_cast<int>(header_.width), type,
+                          const_cast<unsigned char*>(slot + sizeof(RawFrameRecord)),
+                          header_.bytes_per_line);
+    frame.format = format;
+    frame.frame_id = record.frame_id;
+    frame.timestamp_ns = record.timestamp_ns;
+    return true;
+}
@@ -0,0 +1,60 @@
+#include "raw_replay_source.h"
+
+RawReplaySource::RawReplaySource()
+    : next_index_(0)
+{
+}
+
+RawReplaySource::~RawReplaySource() {
+    Close();
+}
+
+bool RawReplaySource::Open(const std::string& source, int width, int height, int /*fps*/) {
+    Close();
+
+    if (!reader_.Open(source)) {
+        return false;
+    }
+    if ((width > 0 && GetWidth() != width) || (height > 0 && GetHeight() != height)) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void RawReplaySource::Close() {
+    pacer_.Cancel();
+    reader_.Close();
+    next_index_ = 0;
+    pacer_.Reset();
+}
+
+bool RawReplaySource::Seek(uint64_t index) {
+    if (index >= reader_.GetFrameCount()) {
+        return false;
+    }
+    next_index_ = index;
+    pacer_.Reset();  // 跳转后重新建立节拍基准
+    return true;
+}
+
+bool RawReplaySource::Read(RawFrame& frame) {
+    if (IsEndOfStream() || !pacer_.AcquireStep(kPlaybackStepWaitMs)) {
+        return false;  // 回放结束或单步模式下暂无许可
+    }
+    if (!reader_.GetFrame(next_index_, frame)) {
+        return false;
+    }
+    next_index_++;
+    pacer_.WaitUntil(frame.timestamp_ns);
+    return true;
+}
+
+FrameSourceCaps RawReplaySource::GetCaps() const {
+    FrameSourceCaps caps;
+    caps.native_format = static_cast<PixelFormat>(reader_.GetHeader().pixel_format);
+    caps.zero_copy = true;
+    caps.native_bgr_convert = false;
+    caps.is_live = pacer_.GetPacing() == ReplayPacing::REAL_TIME;
+    return caps;
+}
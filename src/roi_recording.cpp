@@ -0,0 +1,392 @@
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+#include "roi_recording.h"
+#include "ball_tracker_algo.h"
+
+namespace {
+
+template <typename T>
+void Append(std::vector<char>& buffer, const T& value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+// 按行追加 BGR 像素，兼容非连续的 ROI 视图
+void AppendPixels(std::vector<char>& buffer, const cv::Mat& image) {
+    size_t row_bytes = image.cols * image.elemSize();
+    for (int y = 0; y < image.rows; ++y) {
+        const char* row = reinterpret_cast<const char*>(image.ptr(y));
+        buffer.insert(buffer.end(), row, row + row_bytes);
+    }
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// RoiRecorder
+// ---------------------------------------------------------------------------
+
+RoiRecorder::RoiRecorder()
+    : is_open_(false)
+    , frames_seen_(0)
+    , queued_bytes_(0)
+    , stop_(false)
+    , recorded_frames_(0)
+    , dropped_frames_(0)
+    , bytes_written_(0)
+{
+    std::memset(&header_, 0, sizeof(header_));
+}
+
+RoiRecorder::~RoiRecorder() {
+    Close();
+}
+
+bool RoiRecorder::Open(const std::string& path, int frame_width, int frame_height,
+                       const RoiRecordingOptions& options) {
+    Close();
+
+    if (frame_width <= 0 || frame_height <= 0) {
+        std::cerr << "Invalid ROI recording frame size: " << frame_width << "x" << frame_height << std::endl;
+        return false;
+    }
+
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        std::cerr << "Failed to create ROI recording: " << path << std::endl;
+        return false;
+    }
+
+    options_ = options;
+    std::memset(&header_, 0, sizeof(header_));
+    std::memcpy(header_.magic, kRoiRecordingMagic, sizeof(header_.magic));
+    header_.version = kRoiRecordingVersion;
+    header_.frame_width = static_cast<uint32_t>(frame_width);
+    header_.frame_height = static_cast<uint32_t>(frame_height);
+    header_.full_frame_interval = static_cast<uint32_t>(std::max(options.full_frame_interval, 0));
+    header_.start_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    file_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    if (!file_) {
+        std::cerr << "Failed to write ROI recording header: " << path << std::endl;
+        file_.close();
+        return false;
+    }
+
+    frame_offsets_.clear();
+    last_detected_.clear();
+    frames_seen_ = 0;
+    queue_.clear();
+    queued_bytes_ = 0;
+    stop_ = false;
+    recorded_frames_ = 0;
+    dropped_frames_ = 0;
+    bytes_written_ = sizeof(header_);
+    is_open_ = true;
+    writer_thread_ = std::thread(&RoiRecorder::WriterThread, this);
+    return true;
+}
+
+bool RoiRecorder::RecordFrame(uint64_t frame_index, int64_t timestamp_ns, const cv::Mat& frame,
+                              const std::vector<BallTrackerSnapshot>& snapshots) {
+    if (!is_open_ || frame.empty() || frame.type() != CV_8UC3) {
+        return false;
+    }
+
+    // 检测丢失事件：上一帧检测到、本帧未检测到
+    bool lost_event = false;
+    if (last_detected_.size() != snapshots.size()) {
+        last_detected_.assign(snapshots.size(), false);
+    }
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+        if (last_detected_[i] && !snapshots[i].detected) {
+            lost_event = true;
+        }
+        last_detected_[i] = snapshots[i].detected;
+    }
+
+    bool full_frame = (header_.full_frame_interval > 0 && frames_seen_ % header_.full_frame_interval == 0) ||
+                      (lost_event && options_.full_frame_on_lost);
+    frames_seen_++;
+
+    std::vector<char> buffer;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_buffers_.empty()) {
+            buffer = std::move(free_buffers_.back());
+            free_buffers_.pop_back();
+        }
+    }
+    buffer.clear();
+
+    RoiFrameHeader frame_header;
+    std::memset(&frame_header, 0, sizeof(frame_header));
+    frame_header.magic = kRoiFrameMagic;
+    frame_header.num_balls = static_cast<uint32_t>(snapshots.size());
+    frame_header.frame_index = frame_index;
+    frame_header.timestamp_ns = timestamp_ns;
+    frame_header.flags = (full_frame ? ROI_FRAME_HAS_FULL_FRAME : 0u) | (lost_event ? ROI_FRAME_LOST_EVENT : 0u);
+    Append(buffer, frame_header);
+
+    cv::Rect frame_rect(0, 0, frame.cols, frame.rows);
+    for (const auto& snapshot : snapshots) {
+        cv::Rect roi = snapshot.search_roi & frame_rect;
+        bool store_patch = roi.area() > 0 && roi.area() <= options_.max_patch_pixels;
+
+        RoiBallRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.id = snapshot.id;
+        record.roi_x = roi.x;
+        record.roi_y = roi.y;
+        record.roi_width = roi.width;
+        record.roi_height = roi.height;
+        record.detected = snapshot.detected ? 1u : 0u;
+        record.center_x = snapshot.center.x;
+        record.center_y = snapshot.center.y;
+        record.radius = snapshot.radius;
+        for (int i = 0; i < 3; ++i) {
+            record.hsv[i] = static_cast<float>(snapshot.hsv[i]);
+        }
+        for (int i = 0; i < 4; ++i) {
+            record.state[i] = snapshot.state[i];
+            record.covariance[i] = snapshot.covariance[i];
+        }
+        record.patch_bytes = store_patch ? static_cast<uint32_t>(roi.area() * 3) : 0u;
+        Append(buffer, record);
+        if (store_patch) {
+            AppendPixels(buffer, frame(roi));
+        }
+    }
+    if (full_frame) {
+        AppendPixels(buffer, frame);
+    }
+
+    // 回填记录长度
+    uint64_t record_size = buffer.size();
+    std::memcpy(buffer.data() + offsetof(RoiFrameHeader, record_size), &record_size, sizeof(record_size));
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_ || queued_bytes_ + buffer.size() > options_.max_queued_bytes) {
+            // 写盘跟不上时丢弃本帧，不阻塞跟踪线程
+            free_buffers_.push_back(std::move(buffer));
+            dropped_frames_++;
+            return false;
+        }
+        queued_bytes_ += buffer.size();
+        queue_.push_back(std::move(buffer));
+    }
+    queue_cv_.notify_one();
+    return true;
+}
+
+void RoiRecorder::WriterThread() {
+    uint64_t offset = sizeof(RoiRecordingHeader);
+    while (true) {
+        std::vector<char> buffer;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            queue_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            buffer = std::move(queue_.front());
+            queue_.pop_front();
+            queued_bytes_ -= buffer.size();
+        }
+
+        file_.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (file_) {
+            frame_offsets_.push_back(offset);
+            offset += buffer.size();
+            bytes_written_ += buffer.size();
+            recorded_frames_++;
+        } else {
+            std::cerr << "Failed to write ROI record" << std::endl;
+            dropped_frames_++;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_buffers_.push_back(std::move(buffer));
+    }
+}
+
+void RoiRecorder::Close() {
+    if (!is_open_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    queue_cv_.notify_all();
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+
+    // 追加帧索引并回写文件头
+    header_.index_offset = static_cast<uint64_t>(file_.tellp());
+    header_.frame_count = frame_offsets_.size();
+    file_.write(reinterpret_cast<const char*>(frame_offsets_.data()),
+                static_cast<std::streamsize>(frame_offsets_.size() * sizeof(uint64_t)));
+    file_.seekp(0);
+    file_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    if (!file_) {
+        std::cerr << "Failed to finalize ROI recording" << std::endl;
+    }
+    file_.close();
+
+    free_buffers_.clear();
+    is_open_ = false;
+}
+
+// ---------------------------------------------------------------------------
+// RoiReplay
+// ---------------------------------------------------------------------------
+
+RoiReplay::RoiReplay() {
+    std::memset(&header_, 0, sizeof(header_));
+}
+
+bool RoiReplay::Open(const std::string& path) {
+    Close();
+
+    file_.open(path, std::ios::binary);
+    if (!file_.is_open()) {
+        std::cerr << "Failed to open ROI recording: " << path << std::endl;
+        return false;
+    }
+    file_.seekg(0, std::ios::end);
+    uint64_t file_size = static_cast<uint64_t>(file_.tellg());
+    file_.seekg(0);
+    file_.read(reinterpret_cast<char*>(&header_), sizeof(header_));
+    if (!file_ || std::memcmp(header_.magic, kRoiRecordingMagic, sizeof(header_.magic)) != 0 ||
+        header_.version != kRoiRecordingVersion || header_.frame_width == 0 || header_.frame_height == 0) {
+        std::cerr << "Not a valid ROI recording: " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    bool indexed = header_.index_offset >= sizeof(header_) &&
+                   header_.index_offset + header_.frame_count * sizeof(uint64_t) <= file_size;
+    if (indexed) {
+        offsets_.resize(header_.frame_count);
+        file_.seekg(static_cast<std::streamoff>(header_.index_offset));
+        file_.read(reinterpret_cast<char*>(offsets_.data()),
+                   static_cast<std::streamsize>(offsets_.size() * sizeof(uint64_t)));
+        indexed = static_cast<bool>(file_);
+    }
+    if (!indexed) {
+        // 录制端未正常关闭，顺序扫描重建索引
+        file_.clear();
+        if (!ScanFrames(file_size)) {
+            Close();
+            return false;
+        }
+    }
+    background_ = cv::Mat::zeros(static_cast<int>(header_.frame_height),
+                                 static_cast<int>(header_.frame_width), CV_8UC3);
+    return true;
+}
+
+bool RoiReplay::ScanFrames(uint64_t file_size) {
+    offsets_.clear();
+    uint64_t offset = sizeof(RoiRecordingHeader);
+    while (offset + sizeof(RoiFrameHeader) <= file_size) {
+        RoiFrameHeader frame_header;
+        file_.seekg(static_cast<std::streamoff>(offset));
+        file_.read(reinterpret_cast<char*>(&frame_header), sizeof(frame_header));
+        if (!file_ || frame_header.magic != kRoiFrameMagic ||
+            frame_header.record_size < sizeof(RoiFrameHeader) ||
+            offset + frame_header.record_size > file_size) {
+            break;  // 截断的末尾记录
+        }
+        offsets_.push_back(offset);
+        offset += frame_header.record_size;
+    }
+    file_.clear();
+    return true;
+}
+
+void RoiReplay::Close() {
+    if (file_.is_open()) {
+        file_.close();
+    }
+    file_.clear();
+    offsets_.clear();
+    background_.release();
+}
+
+bool RoiReplay::ReadFrame(uint64_t index, RoiRecordedFrame& frame) {
+    if (!IsOpen() || index >= offsets_.size()) {
+        return false;
+    }
+
+    file_.seekg(static_cast<std::streamoff>(offsets_[index]));
+    file_.read(reinterpret_cast<char*>(&frame.header), sizeof(frame.header));
+    if (!file_ || frame.header.magic != kRoiFrameMagic) {
+        std::cerr << "Corrupt ROI record " << index << std::endl;
+        file_.clear();
+        return false;
+    }
+
+    frame.balls.resize(frame.header.num_balls);
+    frame.patches.resize(frame.header.num_balls);
+    for (uint32_t i = 0; i < frame.header.num_balls; ++i) {
+        RoiBallRecord& record = frame.balls[i];
+        file_.read(reinterpret_cast<char*>(&record), sizeof(record));
+        if (!file_) {
+            break;
+        }
+        if (record.patch_bytes > 0 &&
+            record.patch_bytes == static_cast<uint64_t>(record.roi_width) * record.roi_height * 3) {
+            frame.patches[i].create(record.roi_height, record.roi_width, CV_8UC3);
+            file_.read(reinterpret_cast<char*>(frame.patches[i].data), record.patch_bytes);
+        } else {
+            frame.patches[i].release();
+            file_.seekg(record.patch_bytes, std::ios::cur);
+        }
+    }
+
+    if (file_ && (frame.header.flags & ROI_FRAME_HAS_FULL_FRAME)) {
+        frame.full_frame.create(static_cast<int>(header_.frame_height),
+                                static_cast<int>(header_.frame_width), CV_8UC3);
+        file_.read(reinterpret_cast<char*>(frame.full_frame.data),
+                   static_cast<std::streamsize>(frame.full_frame.total() * frame.full_frame.elemSize()));
+    } else {
+        frame.full_frame.release();
+    }
+
+    if (!file_) {
+        std::cerr << "Truncated ROI record " << index << std::endl;
+        file_.clear();
+        return false;
+    }
+    return true;
+}
+
+bool RoiReplay::ComposeFrame(uint64_t index, cv::Mat& image) {
+    if (!ReadFrame(index, scratch_)) {
+        return false;
+    }
+
+    if (!scratch_.full_frame.empty()) {
+        scratch_.full_frame.copyTo(background_);
+    }
+    background_.copyTo(image);
+
+    cv::Rect frame_rect(0, 0, image.cols, image.rows);
+    for (size_t i = 0; i < scratch_.balls.size(); ++i) {
+        const RoiBallRecord& record = scratch_.balls[i];
+        cv::Rect roi(record.roi_x, record.roi_y, record.roi_width, record.roi_height);
+        if (scratch_.patches[i].empty() || (roi & frame_rect) != roi) {
+            continue;
+        }
+        cv::Mat target = image(roi);
+        scratch_.patches[i].copyTo(target);
+    }
+    return true;
+}
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+#include <new>
+
+#include "status_ring_publisher.h"
+
+bool StatusRingPublisher::Open(const std::string& name, uint32_t slot_count, bool replace_existing) {
+    Close();
+#ifdef _WIN32
+    std::cerr << "Shared memory status ring is not supported on this platform" << std::endl;
+    (void)name;
+    (void)slot_count;
+    (void)replace_existing;
+    return false;
+#else
+    if (slot_count == 0) {
+        std::cerr << "Status ring needs at least one slot" << std::endl;
+        return false;
+    }
+
+    // 同名对象可能属于正在运行的发布者，默认不接管；上次异常退出遗留的对象由调用方显式替换，
+    // 已映射旧对象的读者不受影响
+    if (replace_existing) {
+        shm_unlink(name.c_str());
+    }
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        if (errno == EEXIST) {
+            std::cerr << "Shared memory " << name << " already exists; another publisher may be running" << std::endl;
+        } else {
+            std::cerr << "Failed to create shared memory " << name << std::endl;
+        }
+        return false;
+    }
+    struct stat object_stat;
+    size_t size = StatusRingSize(slot_count);
+    if (fstat(fd, &object_stat) != 0 || ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        std::cerr << "Failed to size shared memory " << name << std::endl;
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        std::cerr << "Failed to map shared memory " << name << std::endl;
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // ftruncate 后内容全为零；先写好槽位与几何信息，最后写 magic，读者据此判断环已就绪
+    header_ = new (base) StatusRingHeader();
+    slots_ = reinterpret_cast<StatusRingSlot*>(static_cast<char*>(base) + sizeof(StatusRingHeader));
+    for (uint32_t i = 0; i < slot_count; ++i) {
+        new (&slots_[i]) StatusRingSlot();
+        slots_[i].sequence.store(0, std::memory_order_relaxed);
+    }
+    header_->version = kStatusRingVersion;
+    header_->slot_count = slot_count;
+    header_->slot_size = sizeof(StatusRingSlot);
+    header_->max_balls = kStatusRingMaxBalls;
+    header_->published.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = kStatusRingMagic;
+
+    name_ = name;
+    base_ = base;
+    size_ = size;
+    device_ = static_cast<uint64_t>(object_stat.st_dev);
+    inode_ = static_cast<uint64_t>(object_stat.st_ino);
+    sequence_ = 0;
+    overflow_reported_ = false;
+    return true;
+#endif
+}
+
+void StatusRingPublisher::Close() {
+#ifndef _WIN32
+    if (base_) {
+        munmap(base_, size_);
+        // 名称可能已被另一个发布者显式替换，只删除自己创建的对象
+        int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+        if (fd >= 0) {
+            struct stat object_stat;
+            bool own = fstat(fd, &object_stat) == 0 && static_cast<uint64_t>(object_stat.st_dev) == device_ &&
+                       static_cast<uint64_t>(object_stat.st_ino) == inode_;
+            close(fd);
+            if (own) {
+                shm_unlink(name_.c_str());
+            }
+        }
+    }
+#endif
+    base_ = nullptr;
+    size_ = 0;
+    header_ = nullptr;
+    slots_ = nullptr;
+    name_.clear();
+}
+
+void StatusRingPublisher::Publish(uint64_t frame_index, int64_t capture_ns, const std::vector<BallStatus>& statuses) {
+    if (!header_) {
+        return;
+    }
+
+    uint64_t sequence = ++sequence_;
+    StatusRingSlot& slot = slots_[(sequence - 1) % header_->slot_count];
+
+    // 顺序锁：写入期间序号为 kStatusRingWriting，读者拷贝前后序号不一致即放弃本次拷贝
+    slot.sequence.store(kStatusRingWriting, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    StatusFrame& frame = slot.frame;
+    frame.sequence = sequence;
+    frame.frame_index = frame_index;
+    frame.capture_ns = capture_ns;
+    frame.publish_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    uint32_t count = static_cast<uint32_t>(std::min<size_t>(statuses.size(), kStatusRingMaxBalls));
+    if (count < statuses.size() && !overflow_reported_) {
+        std::cerr << "Status ring holds " << kStatusRingMaxBalls << " balls, dropping "
+                  << statuses.size() - count << std::endl;
+        overflow_reported_ = true;
+    }
+    frame.ball_count = count;
+    for (uint32_t i = 0; i < count; ++i) {
+        const BallStatus& status = statuses[i];
+        StatusRingBall& ball = frame.balls[i];
+        ball.id = status.id;
+        ball.detected = status.detected ? 1 : 0;
+        ball.deferred = status.deferred ? 1 : 0;
+        ball.x = static_cast<float>(status.x);
+        ball.y = static_cast<float>(status.y);
+        ball.vx = static_cast<float>(status.vx);
+        ball.vy = static_cast<float>(status.vy);
+        ball.progress = static_cast<float>(status.progress);
+    }
+
+    slot.sequence.store(sequence, std::memory_order_release);
+    header_->published.store(sequence, std::memory_order_release);
+}
@@ -0,0 +1,145 @@
+#include <cmath>
+#include <thread>
+
+#include "synthetic_frame_source.h"
+
+SyntheticFrameSource::SyntheticFrameSource()
+    : SyntheticFrameSource(SyntheticSourceConfig())
+{
+}
+
+SyntheticFrameSource::SyntheticFrameSource(const SyntheticSourceConfig& config)
+    : config_(config)
+    , is_open_(false)
+    , width_(0)
+    , height_(0)
+    , fps_(0)
+    , frame_id_(0)
+{
+}
+
+SyntheticFrameSource::~SyntheticFrameSource() {
+    Close();
+}
+
+bool SyntheticFrameSource::Open(const std::string& /*source*/, int width, int height, int fps) {
+    Close();
+
+    if (config_.output_format != PixelFormat::BGR8 && config_.output_format != PixelFormat::BAYER_RG8) {
+        return false;
+    }
+
+    width_ = width > 0 ? width : 1280;
+    height_ = height > 0 ? height : 720;
+    fps_ = fps > 0 ? fps : 30;
+
+    // 默认轨道：从左到右的一段正弦曲线
+    path_ = config_.path;
+    if (path_.size() < 2) {
+        path_.clear();
+        const int segments = 64;
+        for (int i = 0; i <= segments; ++i) {
+            double t = static_cast<double>(i) / segments;
+            path_.emplace_back(width_ * (0.1 + 0.8 * t),
+                               height_ * (0.5 + 0.3 * std::sin(2.0 * CV_PI * t)));
+        }
+    }
+    path_length_.assign(path_.size(), 0.0);
+    for (size_t i = 1; i < path_.size(); ++i) {
+        double dx = path_[i].x - path_[i - 1].x;
+        double dy = path_[i].y - path_[i - 1].y;
+        path_length_[i] = path_length_[i - 1] + std::sqrt(dx * dx + dy * dy);
+    }
+
+    // HSV 转 BGR 得到绘制颜色
+    cv::Mat hsv(1, 1, CV_8UC3, cv::Scalar(config_.ball_hsv[0], config_.ball_hsv[1], config_.ball_hsv[2]));
+    cv::Mat bgr;
+    cv::cvtColor(hsv, bgr, cv::COLOR_HSV2BGR);
+    cv::Vec3b c = bgr.at<cv::Vec3b>(0, 0);
+    ball_bgr_ = cv::Scalar_<double>(c[0], c[1], c[2]);
+
+    canvas_.create(height_, width_, CV_8UC3);
+    if (config_.output_format == PixelFormat::BAYER_RG8) {
+        output_.create(height_, width_, CV_8UC1);
+    }
+    frame_id_ = 0;
+    next_frame_time_ = std::chrono::steady_clock::now();
+    is_open_ = true;
+    return true;
+}
+
+void SyntheticFrameSource::Close() {
+    is_open_ = false;
+    width_ = 0;
+    height_ = 0;
+    fps_ = 0;
+}
+
+cv::Point_<double> SyntheticFrameSource::PointAt(double s) const {
+    double total = path_length_.back();
+    if (total <= 0.0) {
+        return path_.front();
+    }
+    s = std::fmod(s, total);
+    auto it = std::upper_bound(path_length_.begin(), path_length_.end(), s);
+    size_t i = static_cast<size_t>(std::distance(path_length_.begin(), it));
+    if (i == 0) {
+        return path_.front();
+    }
+    if (i >= path_.size()) {
+        return path_.back();
+    }
+    double seg = path_length_[i] - path_length_[i - 1];
+    double t = seg > 0.0 ? (s - path_length_[i - 1]) / seg : 0.0;
+    return path_[i - 1] + (path_[i] - path_[i - 1]) * t;
+}
+
+bool SyntheticFrameSource::Read(RawFrame& frame) {
+    if (!is_open_) {
+        return false;
+    }
+    if (IsEndOfStream()) {
+        return false;
+    }
+
+    if (config_.real_time) {
+        std::this_thread::sleep_until(next_frame_time_);
+        next_frame_time_ += std::chrono::nanoseconds(1000000000LL / fps_);
+    }
+
+    ground_truth_ = PointAt(config_.speed * static_cast<double>(frame_id_));
+    canvas_.setTo(config_.background_bgr);
+    cv::circle(canvas_, cv::Point(static_cast<int>(std::lround(ground_truth_.x)),
+                                  static_cast<int>(std::lround(ground_truth_.y))),
+               config_.ball_radius, ball_bgr_, cv::FILLED, cv::LINE_AA);
+
+    if (config_.output_format == PixelFormat::BAYER_RG8) {
+        // 按 RGGB 排列对渲染结果做马赛克采样
+        for (int y = 0; y < height_; ++y) {
+            const cv::Vec3b* src = canvas_.ptr<cv::Vec3b>(y);
+            uchar* dst = output_.ptr<uchar>(y);
+            for (int x = 0; x < width_; ++x) {
+                int channel = (y & 1) == 0 ? ((x & 1) == 0 ? 2 : 1) : ((x & 1) == 0 ? 1 : 0);
+                dst[x] = src[x][channel];
+            }
+        }
+        frame.image = output_;
+    } else {
+        frame.image = canvas_;
+    }
+
+    frame.format = config_.output_format;
+    frame.frame_id = frame_id_++;
+    frame.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return true;
+}
+
+FrameSourceCaps SyntheticFrameSource::GetCaps() const {
+    FrameSourceCaps caps;
+    caps.native_format = config_.output_format;
+    caps.zero_copy = true;
+    caps.native_bgr_convert = false;
+    caps.is_live = config_.real_time;
+    return caps;
+}
@@ -0,0 +1,171 @@
+#include <algorithm>
+
+#include "hsv_pixel.h"
+#include "track_corridor.h"
+
+void TrackCorridor::Build(const std::vector<cv::Point_<float>>& path, int half_width, const cv::Size& image_size) {
+    Build(std::vector<std::vector<cv::Point_<float>>>{path}, half_width, image_size);
+}
+
+void TrackCorridor::Build(const std::vector<std::vector<cv::Point_<float>>>& paths, int half_width,
+                          const cv::Size& image_size) {
+    Clear();
+    if (image_size.width <= 0 || image_size.height <= 0) {
+        return;
+    }
+
+    // 粗线段两端自带圆头，连起来即轨迹按半宽膨胀后的区域；只在设置轨迹时计算一次
+    cv::Mat mask = cv::Mat::zeros(image_size, CV_8UC1);
+    half_width = std::max(0, half_width);
+    std::vector<cv::Point> points;
+    for (const auto& path : paths) {
+        points.clear();
+        for (const auto& point : path) {
+            cv::Point pixel(cvRound(point.x), cvRound(point.y));
+            if (points.empty() || points.back() != pixel) {
+                points.push_back(pixel);
+            }
+        }
+        if (points.size() == 1) {
+            cv::circle(mask, points[0], half_width, cv::Scalar(255), cv::FILLED, cv::LINE_8);
+        }
+        for (size_t i = 1; i < points.size(); ++i) {
+            cv::line(mask, points[i - 1], points[i], cv::Scalar(255), 2 * half_width + 1, cv::LINE_8);
+        }
+    }
+
+    // 按行编码为游程
+    image_size_ = image_size;
+    row_offsets_.resize(image_size.height + 1);
+    for (int y = 0; y < image_size.height; ++y) {
+        row_offsets_[y] = static_cast<int>(spans_.size());
+        const uchar* row = mask.ptr<uchar>(y);
+        int x = 0;
+        while (x < image_size.width) {
+            while (x < image_size.width && row[x] == 0) {
+                ++x;
+            }
+            if (x == image_size.width) {
+                break;
+            }
+            int start = x;
+            while (x < image_size.width && row[x] != 0) {
+                ++x;
+            }
+            spans_.push_back(CorridorSpan{start, x - 1});
+            area_ += x - start;
+        }
+    }
+    row_offsets_[image_size.height] = static_cast<int>(spans_.size());
+    if (spans_.empty()) {
+        Clear();
+    }
+}
+
+void TrackCorridor::Clear() {
+    image_size_ = cv::Size();
+    spans_.clear();
+    row_offsets_.clear();
+    area_ = 0;
+}
+
+const CorridorSpan* TrackCorridor::RowSpans(int row, int& count) const {
+    if (row < 0 || row >= image_size_.height) {
+        count = 0;
+        return nullptr;
+    }
+    count = row_offsets_[row + 1] - row_offsets_[row];
+    return spans_.data() + row_offsets_[row];
+}
+
+bool TrackCorridor::Contains(int x, int y) const {
+    int count;
+    const CorridorSpan* spans = RowSpans(y, count);
+    for (int k = 0; k < count; ++k) {
+        if (x < spans[k].start) {
+            return false;
+        }
+        if (x <= spans[k].end) {
+            return true;
+        }
+    }
+    return false;
+}
+
+cv::Rect_<int> TrackCorridor::BoundingRect(const cv::Rect_<int>& rect) const {
+    int x0 = rect.x + rect.width;
+    int x1 = rect.x - 1;
+    int y0 = -1;
+    int y1 = -1;
+    for (int y = std::max(rect.y, 0); y < std::min(rect.y + rect.height, image_size_.height); ++y) {
+        int count;
+        const CorridorSpan* spans = RowSpans(y, count);
+        for (int k = 0; k < count; ++k) {
+            int start = std::max(spans[k].start, rect.x);
+            int end = std::min(spans[k].end, rect.x + rect.width - 1);
+            if (start > end) {
+                continue;
+            }
+            x0 = std::min(x0, start);
+            x1 = std::max(x1, end);
+            if (y0 < 0) {
+                y0 = y;
+            }
+            y1 = y;
+        }
+    }
+    if (y0 < 0) {
+        return cv::Rect_<int>();
+    }
+    return cv::Rect_<int>(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+}
+
+void TrackCorridor::Threshold(const cv::Mat& image, const cv::Rect_<int>& rect, const cv::Scalar_<double>& lower,
+                              const cv::Scalar_<double>& upper, cv::Mat& hsv_image, cv::Mat& mask) const {
+    hsv_image.create(rect.height, rect.width, CV_8UC3);
+    mask.create(rect.height, rect.width, CV_8UC1);
+    mask.setTo(cv::Scalar(0));
+    // 连通域提取会跨过短间隙合并游程，间隙可能落在走廊外；清零使其颜色确定，而不是沿用上一次的内容
+    hsv_image.setTo(cv::Scalar::all(0));
+
+    // 只转换并判定走廊内的像素，走廊外保持为背景
+    for (int y = 0; y < rect.height; ++y) {
+        int count;
+        const CorridorSpan* spans = RowSpans(rect.y + y, count);
+        const uchar* src = image.ptr<uchar>(rect.y + y);
+        uchar* hsv_row = hsv_image.ptr<uchar>(y);
+        uchar* mask_row = mask.ptr<uchar>(y);
+        for (int k = 0; k < count; ++k) {
+            int start = std::max(spans[k].start, rect.x);
+            int end = std::min(spans[k].end, rect.x + rect.width - 1);
+            for (int x = start; x <= end; ++x) {
+                int h, s, v;
+                BgrToHsv(src + 3 * x, h, s, v);
+                uchar* hsv = hsv_row + 3 * (x - rect.x);
+                hsv[0] = static_cast<uchar>(h);
+                hsv[1] = static_cast<uchar>(s);
+                hsv[2] = static_cast<uchar>(v);
+                mask_row[x - rect.x] = HsvInRange(h, s, v, lower, upper) ? 255 : 0;
+            }
+        }
+    }
+}
+
+void TrackCorridor::ClearOutside(cv::Mat& mask, const cv::Rect_<int>& rect) const {
+    for (int y = 0; y < rect.height; ++y) {
+        int count;
+        const CorridorSpan* spans = RowSpans(rect.y + y, count);
+        uchar* mask_row = mask.ptr<uchar>(y);
+        int x = rect.x;
+        for (int k = 0; k <= count; ++k) {
+            // 清除上一个游程之后、下一个游程之前的像素
+            int gap_end = k < count ? std::min(spans[k].start, rect.x + rect.width) : rect.x + rect.width;
+            if (gap_end > x) {
+                std::fill(mask_row + (x - rect.x), mask_row + (gap_end - rect.x), static_cast<uchar>(0));
+            }
+            if (k < count) {
+                x = std::max(x, spans[k].end + 1);
+            }
+        }
+    }
+}
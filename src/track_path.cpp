@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "track_path.h"
+
+void TrackPath::Build(const std::vector<cv::Point_<float>>& points) {
+    Clear();
+    points_.reserve(points.size());
+    cumulative_.reserve(points.size());
+    for (const auto& point : points) {
+        if (points_.empty()) {
+            points_.push_back(point);
+            cumulative_.push_back(0.0f);
+            continue;
+        }
+        float length = static_cast<float>(cv::norm(point - points_.back()));
+        if (length <= 0.0f) {
+            continue;
+        }
+        points_.push_back(point);
+        cumulative_.push_back(cumulative_.back() + length);
+    }
+}
+
+void TrackPath::Clear() {
+    points_.clear();
+    cumulative_.clear();
+}
+
+int TrackPath::Segment(float s) const {
+    // 第一个累计弧长大于 s 的点之前的线段
+    int index = static_cast<int>(std::upper_bound(cumulative_.begin(), cumulative_.end(), s) - cumulative_.begin()) - 1;
+    return std::max(0, std::min(index, static_cast<int>(points_.size()) - 2));
+}
+
+cv::Point_<float> TrackPath::PointAt(float s) const {
+    if (Empty()) {
+        return points_.empty() ? cv::Point_<float>() : points_[0];
+    }
+    s = std::max(0.0f, std::min(s, Length()));
+    int i = Segment(s);
+    float t = (s - cumulative_[i]) / (cumulative_[i + 1] - cumulative_[i]);
+    return points_[i] + (points_[i + 1] - points_[i]) * t;
+}
+
+cv::Point_<float> TrackPath::TangentAt(float s) const {
+    if (Empty()) {
+        return cv::Point_<float>();
+    }
+    int i = Segment(s);
+    return (points_[i + 1] - points_[i]) * (1.0f / (cumulative_[i + 1] - cumulative_[i]));
+}
+
+float TrackPath::Project(const cv::Point_<float>& point, float s_min, float s_max, float& distance) const {
+    if (Empty()) {
+        distance = points_.empty() ? 0.0f : static_cast<float>(cv::norm(point - points_[0]));
+        return 0.0f;
+    }
+    s_min = std::max(0.0f, s_min);
+    s_max = std::min(Length(), s_max);
+    if (s_min > s_max) {
+        s_min = s_max = std::max(0.0f, std::min(s_min, Length()));
+    }
+
+    // 只在区间覆盖的线段上求最近点，区间两端的线段截断到区间内
+    float best_s = s_min;
+    float best_d2 = std::numeric_limits<float>::max();
+    int last = Segment(s_max);
+    for (int i = Segment(s_min); i <= last; ++i) {
+        float start = std::max(s_min, cumulative_[i]);
+        float end = std::min(s_max, cumulative_[i + 1]);
+        float length = cumulative_[i + 1] - cumulative_[i];
+        cv::Point_<float> direction = (points_[i + 1] - points_[i]) * (1.0f / length);
+        float s = cumulative_[i] + (point - points_[i]).dot(direction);
+        s = std::max(start, std::min(s, end));
+        cv::Point_<float> offset = point - (points_[i] + direction * (s - cumulative_[i]));
+        float d2 = offset.dot(offset);
+        if (d2 < best_d2) {
+            best_d2 = d2;
+            best_s = s;
+        }
+    }
+    distance = std::sqrt(best_d2);
+    return best_s;
+}
+
+cv::Rect_<int> TrackPath::Bounds(float s_min, float s_max, float margin) const {
+    if (Empty()) {
+        return cv::Rect_<int>();
+    }
+    s_min = std::max(0.0f, s_min);
+    s_max = std::min(Length(), s_max);
+    cv::Point_<float> first = PointAt(s_min);
+    float x0 = first.x, x1 = first.x, y0 = first.y, y1 = first.y;
+    auto extend = [&](const cv::Point_<float>& p) {
+        x0 = std::min(x0, p.x);
+        x1 = std::max(x1, p.x);
+        y0 = std::min(y0, p.y);
+        y1 = std::max(y1, p.y);
+    };
+    // 区间内部的折线顶点加上两个端点
+    int last = Segment(s_max);
+    for (int i = Segment(s_min) + 1; i <= last; ++i) {
+        extend(points_[i]);
+    }
+    extend(PointAt(s_max));
+    int left = static_cast<int>(std::floor(x0 - margin));
+    int top = static_cast<int>(std::floor(y0 - margin));
+    int right = static_cast<int>(std::ceil(x1 + margin));
+    int bottom = static_cast<int>(std::ceil(y1 + margin));
+    return cv::Rect_<int>(left, top, right - left + 1, bottom - top + 1);
+}
+
+bool SpeedProfile::Build(const TrackPath& path, const std::vector<SpeedRun>& runs, float segment_length) {
+    Clear();
+    if (path.Empty() || segment_length <= 0.0f) {
+        return false;
+    }
+    int segments = std::max(1, static_cast<int>(std::ceil(path.Length() / segment_length)));
+    std::vector<double> sum(segments, 0.0);
+    std::vector<double> sum2(segments, 0.0);
+    std::vector<int> count(segments, 0);
+
+    for (const auto& run : runs) {
+        const std::vector<cv::Point_<float>>& points = *run.points;
+        const std::vector<int>& frames = *run.frames;
+        size_t n = std::min(points.size(), frames.size());
+        float previous_s = 0.0f;
+        float distance;
+        for (size_t i = 0; i < n; ++i) {
+            float s;
+            if (i == 0) {
+                s = path.Project(points[i], 0.0f, path.Length(), distance);
+            } else {
+                // 弧长的前进量与相邻两点间的直线距离相当，只在其附近投影，避免跳到相邻的另一段轨道
+                float chord = static_cast<float>(cv::norm(points[i] - points[i - 1]));
+                float margin = std::max(4.0f, chord);
+                s = path.Project(points[i], previous_s - margin, previous_s + chord + margin, distance);
+                int elapsed = frames[i] - frames[i - 1];
+                if (elapsed > 0) {
+                    float speed = (s - previous_s) / elapsed;
+                    int k = std::min(segments - 1, static_cast<int>(0.5f * (s + previous_s) / segment_length));
+                    sum[k] += speed;
+                    sum2[k] += static_cast<double>(speed) * speed;
+                    count[k]++;
+                }
+            }
+            previous_s = s;
+        }
+    }
+
+    // 各段取所有样本的平均速度，没有样本的段按两侧有样本的段线性插值
+    std::vector<int> known;
+    for (int k = 0; k < segments; ++k) {
+        if (count[k] > 0) {
+            known.push_back(k);
+        }
+    }
+    if (known.empty()) {
+        return false;
+    }
+    speed_.assign(segments, 0.0f);
+    speed_variance_.assign(segments, 0.0f);
+    for (int k : known) {
+        double mean = sum[k] / count[k];
+        speed_[k] = static_cast<float>(mean);
+        speed_variance_[k] = static_cast<float>(std::max(0.0, sum2[k] / count[k] - mean * mean));
+    }
+    for (int k = 0; k < segments; ++k) {
+        if (count[k] > 0) {
+            continue;
+        }
+        auto next = std::lower_bound(known.begin(), known.end(), k);
+        if (next == known.begin()) {
+            speed_[k] = speed_[*next];
+            speed_variance_[k] = speed_variance_[*next];
+        } else if (next == known.end()) {
+            speed_[k] = speed_[*(next - 1)];
+            speed_variance_[k] = speed_variance_[*(next - 1)];
+        } else {
+            int a = *(next - 1);
+            int b = *next;
+            float t = static_cast<float>(k - a) / (b - a);
+            speed_[k] = speed_[a] + (speed_[b] - speed_[a]) * t;
+            speed_variance_[k] = speed_variance_[a] + (speed_variance_[b] - speed_variance_[a]) * t;
+        }
+    }
+
+    // 沿轨道的加速度 a = dv/dt = v dv/ds，由相邻段的速度差分得到
+    segment_length_ = segment_length;
+    acceleration_.assign(segments, 0.0f);
+    for (int k = 0; k < segments; ++k) {
+        int a = std::max(0, k - 1);
+        int b = std::min(segments - 1, k + 1);
+        if (b > a) {
+            acceleration_[k] = speed_[k] * (speed_[b] - speed_[a]) / ((b - a) * segment_length);
+        }
+    }
+    return true;
+}
+
+void SpeedProfile::Clear() {
+    segment_length_ = 0.0f;
+    speed_.clear();
+    speed_variance_.clear();
+    acceleration_.clear();
+}
+
+float SpeedProfile::Interpolate(const std::vector<float>& values, float s) const {
+    if (values.empty()) {
+        return 0.0f;
+    }
+    // 段中心之间线性插值，两端保持端点段的值
+    float position = s / segment_length_ - 0.5f;
+    int last = static_cast<int>(values.size()) - 1;
+    if (position <= 0.0f) {
+        return values[0];
+    }
+    if (position >= last) {
+        return values[last];
+    }
+    int k = static_cast<int>(position);
+    float t = position - k;
+    return values[k] + (values[k + 1] - values[k]) * t;
+}
+
+void ArcKalman::Reset(float s, float v, float s_variance, float v_variance) {
+    s_ = s;
+    v_ = v;
+    p00_ = s_variance;
+    p01_ = 0.0f;
+    p11_ = v_variance;
+}
+
+void ArcKalman::Predict(float process_noise, float acceleration) {
+    // F = [1 1; 0 1]，P = F P F^T + qI；加速度作为已知输入
+    s_ += v_ + 0.5f * acceleration;
+    v_ += acceleration;
+    p00_ += 2.0f * p01_ + p11_ + process_noise;
+    p01_ += p11_;
+    p11_ += process_noise;
+}
+
+void ArcKalman::Correct(float s, float measurement_noise) {
+    // H = [1 0]
+    float innovation = s - s_;
+    float denom = p00_ + measurement_noise;
+    float k0 = p00_ / denom;
+    float k1 = p01_ / denom;
+    s_ += k0 * innovation;
+    v_ += k1 * innovation;
+    p11_ -= k1 * p01_;
+    p01_ -= k0 * p01_;
+    p00_ -= k0 * p00_;
+}
@@ -0,0 +1,444 @@
+#include <algorithm>
+
+#include "tracker_bank.h"
+
+TrackerBank::TrackerBank(int capacity) {
+    if (capacity > 0) {
+        kalman_.Reserve(capacity);
+        trackers_.reserve(capacity);
+        ids_.reserve(capacity);
+        states_.reserve(capacity);
+        progress_.reserve(capacity);
+        rois_.reserve(capacity);
+        groups_.reserve(capacity);
+        active_.reserve(capacity);
+    }
+}
+
+int TrackerBank::Add(int ball_id, const std::string& color, const cv::Scalar_<double>& hsv_mean,
+                     const cv::Scalar_<double>& hsv_stddev, const cv::Point_<double>& init_pos) {
+    int index = Size();
+    AddSlot();
+    BallTracker& tracker = trackers_[index];
+    tracker.Restart(ball_id, color, hsv_mean, hsv_stddev, init_pos);
+    ids_[index] = ball_id;
+    states_[index] = tracker.GetTrackState();
+    rois_[index] = tracker.GetROI();
+    groups_[index] = FindModel(color, hsv_mean, hsv_stddev);
+    active_[index] = 1;
+    next_id_ = std::max(next_id_, ball_id + 1);
+    return index;
+}
+
+void TrackerBank::AddSlot() {
+    // 通道编号与下标一致，卡尔曼状态移入共享的批处理结构
+    int lane = kalman_.AddLane();
+    trackers_.emplace_back(-1, std::string(), cv::Scalar_<double>(), cv::Scalar_<double>(), cv::Point_<double>());
+    BallTracker& tracker = trackers_.back();
+    tracker.AttachKalman(&kalman_, lane);
+    tracker.SetSearchConfig(search_config_);
+    tracker.SetAdaptiveUpdateConfig(adaptive_config_);
+    tracker.SetSearchPrior(search_prior_);
+    tracker.SetCorridor(&corridor_);
+    tracker.SetTrackPath(&track_path_);
+    tracker.SetSpeedProfile(&speed_profile_);
+    tracker.SetTrackModeConfig(track_mode_config_);
+
+    ids_.push_back(-1);
+    states_.push_back(tracker.GetTrackState());
+    progress_.push_back(0.0);
+    rois_.push_back(tracker.GetROI());
+    groups_.push_back(-1);
+    active_.push_back(0);
+}
+
+int TrackerBank::FindModel(const std::string& color, const cv::Scalar_<double>& hsv_mean,
+                           const cv::Scalar_<double>& hsv_stddev) {
+    // 颜色模型相同的球归为一组，在 Associate 中统一检测与分配
+    for (size_t i = 0; i < models_.size(); ++i) {
+        if (models_[i].hsv_mean == hsv_mean && models_[i].hsv_stddev == hsv_stddev) {
+            return static_cast<int>(i);
+        }
+    }
+    models_.push_back(ColorModel{color, hsv_mean, hsv_stddev});
+    return static_cast<int>(models_.size()) - 1;
+}
+
+void TrackerBank::SetSearchConfig(const LostBallSearchConfig& config) {
+    search_config_ = config;
+    for (auto& tracker : trackers_) {
+        tracker.SetSearchConfig(config);
+    }
+}
+
+void TrackerBank::SetAdaptiveUpdateConfig(const AdaptiveUpdateConfig& config) {
+    adaptive_config_ = config;
+    for (auto& tracker : trackers_) {
+        tracker.SetAdaptiveUpdateConfig(config);
+    }
+}
+
+void TrackerBank::SetSearchPrior(const std::vector<cv::Point_<float>>& points) {
+    search_prior_ = points;
+    for (auto& tracker : trackers_) {
+        tracker.SetSearchPrior(points);
+    }
+}
+
+void TrackerBank::SetCorridor(const std::vector<std::vector<cv::Point_<float>>>& paths, int half_width,
+                              const cv::Size& image_size) {
+    corridor_.Build(paths, half_width, image_size);
+    for (auto& tracker : trackers_) {
+        tracker.SetCorridor(&corridor_);
+    }
+}
+
+void TrackerBank::SetTrackPath(const std::vector<cv::Point_<float>>& points) {
+    track_path_.Build(points);
+    speed_profile_.Clear();
+    for (auto& tracker : trackers_) {
+        tracker.SetTrackPath(&track_path_);
+    }
+}
+
+bool TrackerBank::SetSpeedProfile(const std::vector<SpeedRun>& runs) {
+    speed_profile_.Clear();
+    if (!track_mode_config_.speed_profile ||
+        !speed_profile_.Build(track_path_, runs, track_mode_config_.profile_segment_length)) {
+        return false;
+    }
+    return true;
+}
+
+void TrackerBank::SetTrackModeConfig(const TrackModeConfig& config) {
+    track_mode_config_ = config;
+    for (auto& tracker : trackers_) {
+        tracker.SetTrackModeConfig(config);
+    }
+}
+
+int TrackerBank::Find(int ball_id) const {
+    for (size_t i = 0; i < ids_.size(); ++i) {
+        if (active_[i] && ids_[i] == ball_id) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void TrackerBank::BeginFrame() {
+    for (int i = 0; i < Size(); ++i) {
+        if (active_[i]) {
+            trackers_[i].BeginUpdate();
+        }
+    }
+    kalman_.PredictBatch();
+}
+
+void TrackerBank::Associate(const cv::Mat& image) {
+    if (!association_config_.enabled || image.empty()) {
+        return;
+    }
+    for (int group = 0; group < static_cast<int>(models_.size()); ++group) {
+        members_.clear();
+        for (int i = 0; i < Size(); ++i) {
+            if (active_[i] && groups_[i] == group) {
+                members_.push_back(i);
+            }
+        }
+        // 颜色唯一的球仍由各自的种子区域生长检测
+        if (members_.size() >= 2) {
+            AssociateGroup(image);
+        }
+    }
+}
+
+void TrackerBank::AssociateGroup(const cv::Mat& image) {
+    const cv::Size image_size = image.size();
+    windows_.clear();
+    for (int index : members_) {
+        windows_.push_back(trackers_[index].GetSearchWindow(image_size));
+    }
+
+    // 合并相互重叠的搜索窗口，每个区域只做一次颜色分割和连通域分析
+    regions_ = windows_;
+    for (bool merged = true; merged; ) {
+        merged = false;
+        for (size_t a = 0; a < regions_.size() && !merged; ++a) {
+            for (size_t b = a + 1; b < regions_.size(); ++b) {
+                if ((regions_[a] & regions_[b]).area() > 0) {
+                    regions_[a] |= regions_[b];
+                    regions_.erase(regions_.begin() + b);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    cv::Scalar_<double> lower;
+    cv::Scalar_<double> upper;
+    trackers_[members_[0]].GetColorRange(lower, upper);
+    candidates_.clear();
+    for (const auto& region : regions_) {
+        if (region.width <= 0 || region.height <= 0) {
+            continue;  // 搜索窗口与走廊不相交
+        }
+        if (corridor_.Empty()) {
+            cv::cvtColor(image(region), hsv_image_, cv::COLOR_BGR2HSV);
+            cv::inRange(hsv_image_, lower, upper, mask_);
+        } else {
+            corridor_.Threshold(image, region, lower, upper, hsv_image_, mask_);
+        }
+        int num_blobs = blob_extractor_.Extract(mask_, blobs_);
+        for (int k = 0; k < num_blobs; ++k) {
+            Candidate candidate;
+            candidate.center = cv::Point_<float>(blobs_[k].centroid.x + region.x, blobs_[k].centroid.y + region.y);
+            candidate.radius = blobs_[k].MomentRadius();
+            candidate.hsv = blob_extractor_.MeanColor(blobs_, k, hsv_image_);
+            candidates_.push_back(candidate);
+        }
+    }
+
+    // 先为锁定的球分配，搜索中的球只能取剩余的候选，避免抢走已锁定球的位置
+    member_candidate_.assign(members_.size(), -1);
+    taken_.assign(candidates_.size(), 0);
+    AssignStage(true);
+    AssignStage(false);
+
+    for (size_t m = 0; m < members_.size(); ++m) {
+        BallTracker& tracker = trackers_[members_[m]];
+        if (tracker.IsResting()) {
+            continue;  // 静止的球只占用其候选，仍做自己的小块检查
+        }
+        int c = member_candidate_[m];
+        if (c >= 0) {
+            tracker.AssignMeasurement(true, candidates_[c].center, candidates_[c].radius, candidates_[c].hsv, windows_[m]);
+        } else {
+            tracker.AssignMeasurement(false, cv::Point_<float>(), 0.0f, cv::Scalar_<double>(), windows_[m]);
+        }
+    }
+}
+
+void TrackerBank::AssignStage(bool locked) {
+    stage_rows_.clear();
+    stage_cols_.clear();
+    for (size_t m = 0; m < members_.size(); ++m) {
+        if (trackers_[members_[m]].IsLocked() == locked) {
+            stage_rows_.push_back(static_cast<int>(m));
+        }
+    }
+    for (size_t c = 0; c < candidates_.size(); ++c) {
+        if (!taken_[c]) {
+            stage_cols_.push_back(static_cast<int>(c));
+        }
+    }
+    int rows = static_cast<int>(stage_rows_.size());
+    int cols = static_cast<int>(stage_cols_.size());
+    if (rows == 0 || cols == 0) {
+        return;
+    }
+
+    cost_.assign(static_cast<size_t>(rows) * cols, kNotGated);
+    for (int r = 0; r < rows; ++r) {
+        int m = stage_rows_[r];
+        int lane = members_[m];  // 通道编号与下标一致
+        const BallTracker& tracker = trackers_[lane];
+        const cv::Rect_<int>& window = windows_[m];
+        float sigma = association_config_.min_sigma_radii * tracker.GetRadius();
+        float cx = window.x + window.width / 2.0f;
+        float cy = window.y + window.height / 2.0f;
+        float extent = static_cast<float>(window.width * window.width + window.height * window.height);
+        for (int k = 0; k < cols; ++k) {
+            const Candidate& candidate = candidates_[stage_cols_[k]];
+            if (locked) {
+                // 卡尔曼新息的马氏距离门限，下限为约一个球半径的位置不确定度
+                float distance = kalman_.Mahalanobis2(lane, candidate.center.x, candidate.center.y, sigma * sigma);
+                if (distance <= association_config_.gate) {
+                    cost_[r * cols + k] = distance;
+                }
+            } else if (window.contains(cv::Point(static_cast<int>(candidate.center.x), static_cast<int>(candidate.center.y)))) {
+                // 搜索窗口内的候选，离窗口中心越近代价越低
+                float dx = candidate.center.x - cx;
+                float dy = candidate.center.y - cy;
+                cost_[r * cols + k] = (dx * dx + dy * dy) / extent;
+            }
+        }
+    }
+
+    solver_.Solve(cost_, rows, cols, row_to_col_);
+    for (int r = 0; r < rows; ++r) {
+        if (row_to_col_[r] >= 0) {
+            int c = stage_cols_[row_to_col_[r]];
+            member_candidate_[stage_rows_[r]] = c;
+            taken_[c] = 1;
+        }
+    }
+}
+
+void TrackerBank::EndFrame(const cv::Mat& image) {
+    kalman_.CorrectBatch();
+    for (size_t i = 0; i < trackers_.size(); ++i) {
+        if (!active_[i]) {
+            continue;
+        }
+        BallTracker& tracker = trackers_[i];
+        tracker.FinishUpdate(image);
+        states_[i] = tracker.GetTrackState();
+        progress_[i] = tracker.GetStatus().progress;
+        rois_[i] = tracker.GetROI();
+    }
+}
+
+bool TrackerBank::Update(const cv::Mat& image) {
+    if (image.empty()) {
+        return false;
+    }
+    BeginFrame();
+    Associate(image);
+    for (int i = 0; i < Size(); ++i) {
+        if (active_[i]) {
+            Detect(i, image);
+        }
+    }
+    EndFrame(image);
+    return true;
+}
+
+void TrackerBank::SetLifecycleConfig(const TrackerLifecycleConfig& config) {
+    lifecycle_config_ = config;
+    lifecycle_stats_ = TrackerLifecycleStats();
+    if (!config.enabled) {
+        return;
+    }
+    // 一次性分配全部槽位，跟踪过程中出生的球只复用空闲槽位
+    kalman_.Reserve(config.max_trackers);
+    trackers_.reserve(config.max_trackers);
+    while (Size() < config.max_trackers) {
+        AddSlot();
+    }
+}
+
+void TrackerBank::SetSpawnZones(const std::vector<cv::Point_<float>>& centers) {
+    spawn_zones_ = centers;
+    spawn_hits_.assign(spawn_zones_.size() * models_.size(), 0);
+}
+
+void TrackerBank::SetEndPoint(const cv::Point_<float>& point) {
+    end_point_ = point;
+    has_end_point_ = true;
+}
+
+void TrackerBank::UpdateLifecycle(const cv::Mat& image, std::vector<int>& changed) {
+    changed.clear();
+    if (!lifecycle_config_.enabled || image.empty()) {
+        return;
+    }
+
+    // 跟踪到终点附近或丢失过久的球退出跟踪，槽位留给新球
+    float end_radius2 = lifecycle_config_.retire_end_radius * lifecycle_config_.retire_end_radius;
+    for (int i = 0; i < Size(); ++i) {
+        if (!active_[i]) {
+            continue;
+        }
+        const BallTracker& tracker = trackers_[i];
+        bool finished = false;
+        if (has_end_point_ && states_[i] == TrackState::TRACKING) {
+            cv::Point_<float> offset = tracker.GetPosition() - end_point_;
+            finished = offset.x * offset.x + offset.y * offset.y <= end_radius2;
+        }
+        if (finished || tracker.GetMissCount() >= lifecycle_config_.retire_lost_frames) {
+            if (finished) {
+                lifecycle_stats_.retired_finished++;
+            } else {
+                lifecycle_stats_.retired_lost++;
+            }
+            active_[i] = 0;
+            changed.push_back(i);
+        }
+    }
+
+    // 出生区内未被任何跟踪器占用的球连续出现若干帧后，为其分配空闲槽位
+    int num_models = static_cast<int>(models_.size());
+    // 计数按 区域 * 颜色模型数 + 模型 排列；出生区设置后又新增颜色模型时布局改变，旧计数作废
+    if (spawn_hits_.size() != spawn_zones_.size() * num_models) {
+        spawn_hits_.assign(spawn_zones_.size() * num_models, 0);
+    }
+    int half = lifecycle_config_.spawn_zone_radius;
+    cv::Rect_<int> image_rect(0, 0, image.cols, image.rows);
+    for (size_t z = 0; z < spawn_zones_.size(); ++z) {
+        cv::Rect_<int> zone = cv::Rect_<int>(static_cast<int>(spawn_zones_[z].x) - half,
+                                             static_cast<int>(spawn_zones_[z].y) - half,
+                                             2 * half, 2 * half) & image_rect;
+        if (zone.width <= 0 || zone.height <= 0) {
+            continue;
+        }
+        cv::cvtColor(image(zone), hsv_image_, cv::COLOR_BGR2HSV);
+        for (int m = 0; m < num_models; ++m) {
+            int& hits = spawn_hits_[z * num_models + m];
+            cv::Point_<float> center;
+            if (!FindNewBlob(zone, m, center)) {
+                hits = 0;
+                continue;
+            }
+            if (++hits < lifecycle_config_.spawn_confirm_frames) {
+                continue;
+            }
+            hits = 0;
+
+            int slot = -1;
+            for (int i = 0; i < Size(); ++i) {
+                if (!active_[i]) {
+                    slot = i;
+                    break;
+                }
+            }
+            if (slot < 0) {
+                lifecycle_stats_.spawns_skipped++;  // 池已满
+                continue;
+            }
+            const ColorModel& model = models_[m];
+            BallTracker& tracker = trackers_[slot];
+            tracker.Restart(next_id_, model.color, model.hsv_mean, model.hsv_stddev, cv::Point_<double>(center.x, center.y));
+            ids_[slot] = next_id_++;
+            states_[slot] = tracker.GetTrackState();
+            progress_[slot] = 0.0;
+            rois_[slot] = tracker.GetROI();
+            groups_[slot] = m;
+            active_[slot] = 1;
+            changed.push_back(slot);
+            lifecycle_stats_.spawned++;
+        }
+    }
+}
+
+bool TrackerBank::FindNewBlob(const cv::Rect_<int>& zone, int model, cv::Point_<float>& center) {
+    const ColorModel& color_model = models_[model];
+    cv::inRange(hsv_image_, color_model.hsv_mean - color_model.hsv_stddev * 2.0,
+                color_model.hsv_mean + color_model.hsv_stddev * 2.0, mask_);
+    if (!corridor_.Empty()) {
+        corridor_.ClearOutside(mask_, zone);
+    }
+    int num_blobs = blob_extractor_.Extract(mask_, blobs_);
+
+    // 离同色跟踪器（包括正在搜索的）两个半径以内的球视为已被占用
+    int best = -1;
+    for (int k = 0; k < num_blobs; ++k) {
+        cv::Point_<float> blob_center(blobs_[k].centroid.x + zone.x, blobs_[k].centroid.y + zone.y);
+        float blob_radius = blobs_[k].MomentRadius();
+        bool claimed = false;
+        for (int i = 0; i < Size() && !claimed; ++i) {
+            if (!active_[i] || groups_[i] != model) {
+                continue;
+            }
+            cv::Point_<float> offset = trackers_[i].GetPosition() - blob_center;
+            float reach = 2.0f * std::max(trackers_[i].GetRadius(), blob_radius);
+            claimed = offset.x * offset.x + offset.y * offset.y <= reach * reach;
+        }
+        if (!claimed && (best < 0 || blobs_[k].area > blobs_[best].area)) {
+            best = k;
+            center = blob_center;
+        }
+    }
+    return best >= 0;
+}
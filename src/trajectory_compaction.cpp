@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+#include "trajectory_compaction.h"
+
+namespace {
+
+/**
+ * @brief Distance of a point from the segment a-b.
+ */
+float SegmentDistance(const cv::Point_<float>& point, const cv::Point_<float>& a, const cv::Point_<float>& b) {
+    cv::Point_<float> ab = b - a;
+    cv::Point_<float> ap = point - a;
+    float length2 = ab.dot(ab);
+    float t = length2 > 0.0f ? std::min(1.0f, std::max(0.0f, ap.dot(ab) / length2)) : 0.0f;
+    cv::Point_<float> d = ap - ab * t;
+    return std::sqrt(d.dot(d));
+}
+
+/**
+ * @brief RTS smoothing of one coordinate with a constant-velocity model.
+ */
+void SmoothAxis(const std::vector<double>& z, double q, double r, std::vector<double>& smoothed) {
+    struct State {
+        double p, v;            // 位置与速度
+        double p00, p01, p11;   // 协方差
+    };
+    size_t n = z.size();
+    std::vector<State> predicted(n);
+    std::vector<State> filtered(n);
+
+    // 前向卡尔曼滤波，初始速度未知
+    filtered[0] = {z[0], 0.0, r, 0.0, 100.0};
+    for (size_t k = 1; k < n; ++k) {
+        const State& f = filtered[k - 1];
+        State& pred = predicted[k];
+        pred.p = f.p + f.v;
+        pred.v = f.v;
+        pred.p00 = f.p00 + 2.0 * f.p01 + f.p11 + q * 0.25;
+        pred.p01 = f.p01 + f.p11 + q * 0.5;
+        pred.p11 = f.p11 + q;
+
+        double s = pred.p00 + r;
+        double k0 = pred.p00 / s;
+        double k1 = pred.p01 / s;
+        double innovation = z[k] - pred.p;
+        State& cur = filtered[k];
+        cur.p = pred.p + k0 * innovation;
+        cur.v = pred.v + k1 * innovation;
+        cur.p00 = (1.0 - k0) * pred.p00;
+        cur.p01 = (1.0 - k0) * pred.p01;
+        cur.p11 = pred.p11 - k1 * pred.p01;
+    }
+
+    // 后向 RTS 平滑：x_s(k) = x_f(k) + C (x_s(k+1) - x_p(k+1))，C = P_f(k) F^T P_p(k+1)^-1
+    smoothed.resize(n);
+    double next_p = filtered[n - 1].p;
+    double next_v = filtered[n - 1].v;
+    smoothed[n - 1] = next_p;
+    for (size_t k = n - 1; k-- > 0; ) {
+        const State& f = filtered[k];
+        const State& pred = predicted[k + 1];
+        double a00 = f.p00 + f.p01;
+        double a01 = f.p01;
+        double a10 = f.p01 + f.p11;
+        double a11 = f.p11;
+        double det = pred.p00 * pred.p11 - pred.p01 * pred.p01;
+        double dp = next_p - pred.p;
+        double dv = next_v - pred.v;
+        double p = f.p;
+        double v = f.v;
+        if (det > 0.0) {
+            double c00 = (a00 * pred.p11 - a01 * pred.p01) / det;
+            double c01 = (a01 * pred.p00 - a00 * pred.p01) / det;
+            double c10 = (a10 * pred.p11 - a11 * pred.p01) / det;
+            double c11 = (a11 * pred.p00 - a10 * pred.p01) / det;
+            p += c00 * dp + c01 * dv;
+            v += c10 * dp + c11 * dv;
+        }
+        smoothed[k] = p;
+        next_p = p;
+        next_v = v;
+    }
+}
+
+}  // namespace
+
+std::vector<cv::Point_<float>> SmoothTrajectory(const std::vector<cv::Point_<float>>& points, float process_noise,
+                                                float measurement_noise) {
+    if (points.size() < 3) {
+        return points;
+    }
+    std::vector<double> x(points.size());
+    std::vector<double> y(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        x[i] = points[i].x;
+        y[i] = points[i].y;
+    }
+    double q = std::max(process_noise, 1e-6f);
+    double r = std::max(measurement_noise, 1e-6f);
+    std::vector<double> smoothed_x;
+    std::vector<double> smoothed_y;
+    SmoothAxis(x, q, r, smoothed_x);
+    SmoothAxis(y, q, r, smoothed_y);
+
+    std::vector<cv::Point_<float>> smoothed(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        smoothed[i] = cv::Point_<float>(static_cast<float>(smoothed_x[i]), static_cast<float>(smoothed_y[i]));
+    }
+    return smoothed;
+}
+
+std::vector<cv::Point_<float>> SimplifyTrajectory(const std::vector<cv::Point_<float>>& points, float tolerance) {
+    if (points.size() < 3) {
+        return points;
+    }
+
+    // 非递归的 Douglas-Peucker：区间内离弦最远的点超出容差则保留并拆分区间
+    std::vector<uint8_t> keep(points.size(), 0);
+    keep.front() = 1;
+    keep.back() = 1;
+    std::vector<std::pair<size_t, size_t>> ranges;
+    ranges.emplace_back(0, points.size() - 1);
+    while (!ranges.empty()) {
+        size_t first = ranges.back().first;
+        size_t last = ranges.back().second;
+        ranges.pop_back();
+        float max_distance = -1.0f;
+        size_t farthest = first;
+        for (size_t i = first + 1; i < last; ++i) {
+            float distance = SegmentDistance(points[i], points[first], points[last]);
+            if (distance > max_distance) {
+                max_distance = distance;
+                farthest = i;
+            }
+        }
+        if (max_distance > tolerance) {
+            keep[farthest] = 1;
+            ranges.emplace_back(first, farthest);
+            ranges.emplace_back(farthest, last);
+        }
+    }
+
+    std::vector<cv::Point_<float>> simplified;
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (keep[i]) {
+            simplified.push_back(points[i]);
+        }
+    }
+    return simplified;
+}
+
+std::vector<cv::Point_<float>> ResampleTrajectory(const std::vector<cv::Point_<float>>& points, float spacing) {
+    if (points.size() < 2 || spacing <= 0.0f) {
+        return points;
+    }
+
+    std::vector<cv::Point_<float>> resampled;
+    resampled.push_back(points.front());
+    double travelled = 0.0;
+    double target = spacing;
+    for (size_t i = 1; i < points.size(); ++i) {
+        cv::Point_<float> step = points[i] - points[i - 1];
+        double length = std::sqrt(static_cast<double>(step.dot(step)));
+        // 在本段内依次放置弧长为 spacing 整数倍的点
+        while (length > 0.0 && travelled + length >= target) {
+            float t = static_cast<float>((target - travelled) / length);
+            resampled.push_back(points[i - 1] + step * t);
+            target += spacing;
+        }
+        travelled += length;
+    }
+    cv::Point_<float> tail = points.back() - resampled.back();
+    if (tail.dot(tail) > 1e-6f) {
+        resampled.push_back(points.back());
+    }
+    return resampled;
+}
+
+float TrajectoryDeviation(const std::vector<cv::Point_<float>>& points, const std::vector<cv::Point_<float>>& polyline) {
+    if (polyline.empty()) {
+        return points.empty() ? 0.0f : std::numeric_limits<float>::infinity();
+    }
+    float max_distance = 0.0f;
+    for (const auto& point : points) {
+        float distance = SegmentDistance(point, polyline[0], polyline[0]);
+        for (size_t i = 1; i < polyline.size(); ++i) {
+            distance = std::min(distance, SegmentDistance(point, polyline[i - 1], polyline[i]));
+        }
+        max_distance = std::max(max_distance, distance);
+    }
+    return max_distance;
+}
+
+std::vector<cv::Point_<float>> CompactTrajectory(const std::vector<cv::Point_<float>>& points,
+                                                 const TrajectoryCompactionConfig& config, float& max_error) {
+    // 平滑去除检测抖动，简化去除冗余点，再按等弧长重采样
+    std::vector<cv::Point_<float>> smoothed = SmoothTrajectory(points, config.process_noise, config.measurement_noise);
+    std::vector<cv::Point_<float>> simplified = SimplifyTrajectory(smoothed, config.tolerance);
+    std::vector<cv::Point_<float>> compact = ResampleTrajectory(simplified, config.spacing);
+    max_error = TrajectoryDeviation(smoothed, compact);
+    return compact;
+}
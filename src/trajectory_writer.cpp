@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+#include "trajectory_writer.h"
+
+TrajectoryWriter::TrajectoryWriter(size_t chunk_points, size_t reserve_points)
+    : chunk_points_(std::max<size_t>(1, chunk_points))
+{
+    points_.reserve(reserve_points);
+    buffer_.reserve(chunk_points_ * 48 + 256);
+}
+
+TrajectoryWriter::~TrajectoryWriter() {
+    Close();
+}
+
+bool TrajectoryWriter::Open(const std::string& path, const std::string& timestamp) {
+    Close();
+    points_.clear();
+    written_ = 0;
+    length_ = 0.0;
+    tail_size_ = 0;
+    compact_.clear();
+
+    file_.open(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file_.is_open()) {
+        std::cerr << "Failed to open trajectory file: " << path << std::endl;
+        return false;
+    }
+    file_ << "{\n    \"track_trajectory\": {\n        \"timestamp\": \"" << timestamp << "\",\n        \"points\": [";
+    tail_offset_ = file_.tellp();
+    return Flush();
+}
+
+bool TrajectoryWriter::Add(double x, double y) {
+    cv::Point_<float> point(static_cast<float>(x), static_cast<float>(y));
+    if (!points_.empty()) {
+        float dx = point.x - points_.back().x;
+        float dy = point.y - points_.back().y;
+        length_ += std::sqrt(static_cast<double>(dx) * dx + static_cast<double>(dy) * dy);
+    }
+    points_.push_back(point);
+    if (file_.is_open() && points_.size() - written_ >= chunk_points_) {
+        return Flush();
+    }
+    return true;
+}
+
+void TrajectoryWriter::AppendPoint(const cv::Point_<float>& point) {
+    char text[64];
+    int size = std::snprintf(text, sizeof(text), "{\"x\": %.3f, \"y\": %.3f}", point.x, point.y);
+    buffer_.append(text, size);
+}
+
+bool TrajectoryWriter::Flush() {
+    if (!file_.is_open()) {
+        return false;
+    }
+
+    // 新的点覆盖上一次写入的结尾部分，之后重新写结尾，文件始终是完整的 JSON
+    buffer_.clear();
+    for (size_t i = written_; i < points_.size(); ++i) {
+        buffer_.append(i == 0 ? "\n            " : ",\n            ");
+        AppendPoint(points_[i]);
+    }
+    std::streamoff points_end = tail_offset_ + static_cast<std::streamoff>(buffer_.size());
+
+    char text[64];
+    int size = std::snprintf(text, sizeof(text), "\n        ],\n        \"length\": %.3f", length_);
+    buffer_.append(text, size);
+    if (!points_.empty()) {
+        buffer_.append(",\n        \"start_point\": ");
+        AppendPoint(points_.front());
+        buffer_.append(",\n        \"end_point\": ");
+        AppendPoint(points_.back());
+    }
+    if (!compact_.empty()) {
+        size = std::snprintf(text, sizeof(text), ",\n        \"compact\": {\n            \"spacing\": %.3f", compact_spacing_);
+        buffer_.append(text, size);
+        size = std::snprintf(text, sizeof(text), ",\n            \"max_error\": %.3f,\n            \"points\": [", compact_error_);
+        buffer_.append(text, size);
+        for (size_t i = 0; i < compact_.size(); ++i) {
+            buffer_.append(i == 0 ? "\n                " : ",\n                ");
+            AppendPoint(compact_[i]);
+        }
+        buffer_.append("\n            ]\n        }");
+    }
+    buffer_.append("\n    }\n}\n");
+
+    // 写入内容比文件中原有的结尾短时，用空白覆盖剩余部分
+    if (buffer_.size() < tail_size_) {
+        buffer_.append(tail_size_ - buffer_.size(), ' ');
+    }
+
+    file_.seekp(tail_offset_);
+    file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    file_.flush();
+    if (!file_) {
+        std::cerr << "Failed to write trajectory file" << std::endl;
+        return false;
+    }
+    tail_size_ = buffer_.size() - static_cast<size_t>(points_end - tail_offset_);
+    written_ = points_.size();
+    tail_offset_ = points_end;
+    return true;
+}
+
+void TrajectoryWriter::SetCompact(const std::vector<cv::Point_<float>>& points, float spacing, float max_error) {
+    compact_ = points;
+    compact_spacing_ = spacing;
+    compact_error_ = max_error;
+}
+
+bool TrajectoryWriter::Close() {
+    if (!file_.is_open()) {
+        return true;
+    }
+    bool ok = Flush();
+    file_.close();
+    return ok;
+}
@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "udp_status_publisher.h"
+
+UdpStatusPublisher::~UdpStatusPublisher() {
+    Close();
+}
+
+bool UdpStatusPublisher::Open(const StatusStreamConfig& config) {
+    Close();
+    if (config.port <= 0 || config.port > 65535) {
+        std::cerr << "Invalid status stream port " << config.port << std::endl;
+        return false;
+    }
+    sockaddr_in destination{};
+    destination.sin_family = AF_INET;
+    destination.sin_port = htons(static_cast<uint16_t>(config.port));
+    if (inet_pton(AF_INET, config.address.c_str(), &destination.sin_addr) != 1) {
+        std::cerr << "Invalid status stream address " << config.address << std::endl;
+        return false;
+    }
+
+    if (!StatusSocketStartup()) {
+        std::cerr << "Failed to initialize sockets" << std::endl;
+        return false;
+    }
+    started_ = true;
+    socket_ = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (socket_ == kInvalidStatusSocket) {
+        std::cerr << "Failed to create status stream socket" << std::endl;
+        Close();
+        return false;
+    }
+
+    // 组播地址：设置跳数与出口网卡，并允许本机接收以便回环测试
+    uint32_t host_address = ntohl(destination.sin_addr.s_addr);
+    if ((host_address >> 28) == 0xE) {
+        int ttl = std::max(config.multicast_ttl, 0);
+        int loop = 1;
+        bool ok = setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_TTL, reinterpret_cast<const char*>(&ttl),
+                             sizeof(ttl)) == 0;
+        ok = ok && setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_LOOP, reinterpret_cast<const char*>(&loop),
+                              sizeof(loop)) == 0;
+        if (ok && !config.interface_address.empty()) {
+            in_addr interface_address{};
+            ok = inet_pton(AF_INET, config.interface_address.c_str(), &interface_address) == 1 &&
+                 setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_IF, reinterpret_cast<const char*>(&interface_address),
+                            sizeof(interface_address)) == 0;
+        }
+        if (!ok) {
+            std::cerr << "Failed to configure multicast for " << config.address << std::endl;
+            Close();
+            return false;
+        }
+    }
+
+    config_ = config;
+    config_.max_balls_per_datagram = std::min(std::max(config.max_balls_per_datagram, 1), kStatusDatagramMaxBalls);
+    config_.queue_frames = std::max(config.queue_frames, 1);
+    destination_ = destination;
+    sequence_ = 0;
+    stop_ = false;
+    queue_.clear();
+    sender_thread_ = std::thread(&UdpStatusPublisher::SenderThread, this);
+    return true;
+}
+
+void UdpStatusPublisher::Close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    queue_cv_.notify_all();
+    if (sender_thread_.joinable()) {
+        sender_thread_.join();
+    }
+    if (socket_ != kInvalidStatusSocket) {
+        CloseStatusSocket(socket_);
+        socket_ = kInvalidStatusSocket;
+    }
+    if (started_) {
+        StatusSocketCleanup();
+        started_ = false;
+    }
+}
+
+void UdpStatusPublisher::Publish(uint64_t frame_index, int64_t capture_ns, const std::vector<BallStatus>& statuses) {
+    PendingFrame frame;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_ || socket_ == kInvalidStatusSocket) {
+            return;
+        }
+        if (!free_frames_.empty()) {
+            frame = std::move(free_frames_.back());
+            free_frames_.pop_back();
+        }
+    }
+
+    frame.frame_index = frame_index;
+    frame.capture_ns = capture_ns;
+    frame.balls.resize(statuses.size());
+    for (size_t i = 0; i < statuses.size(); ++i) {
+        const BallStatus& status = statuses[i];
+        StatusDatagramBall& ball = frame.balls[i];
+        ball.id = status.id;
+        ball.flags = static_cast<uint16_t>((status.detected ? STATUS_BALL_DETECTED : 0) |
+                                           (status.deferred ? STATUS_BALL_DEFERRED : 0));
+        ball.reserved = 0;
+        ball.x = static_cast<float>(status.x);
+        ball.y = static_cast<float>(status.y);
+        ball.vx = static_cast<float>(status.vx);
+        ball.vy = static_cast<float>(status.vy);
+        ball.progress = static_cast<float>(status.progress);
+        ball.reserved2 = 0.0f;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (static_cast<int>(queue_.size()) >= config_.queue_frames) {
+            // 发送跟不上时丢弃最旧的帧，控制端只关心最新状态
+            free_frames_.push_back(std::move(queue_.front()));
+            queue_.pop_front();
+            dropped_frames_++;
+        }
+        queue_.push_back(std::move(frame));
+    }
+    queue_cv_.notify_one();
+}
+
+void UdpStatusPublisher::SenderThread() {
+    std::vector<char> buffer(kStatusDatagramMaxSize);
+    while (true) {
+        PendingFrame frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            queue_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            frame = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        Send(frame, buffer);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_frames_.push_back(std::move(frame));
+    }
+}
+
+void UdpStatusPublisher::Send(const PendingFrame& frame, std::vector<char>& buffer) {
+    // 一帧的球按上限分批打包，没有球时也发送一个空报文作为心跳
+    int per_datagram = config_.max_balls_per_datagram;
+    int total = static_cast<int>(frame.balls.size());
+    int part_count = std::max(1, (total + per_datagram - 1) / per_datagram);
+    for (int part = 0; part < part_count; ++part) {
+        int first = part * per_datagram;
+        int count = std::min(per_datagram, total - first);
+
+        StatusDatagramHeader header{};
+        header.magic = kStatusDatagramMagic;
+        header.version = kStatusDatagramVersion;
+        header.ball_count = static_cast<uint16_t>(count);
+        header.sequence = ++sequence_;
+        header.frame_index = frame.frame_index;
+        header.capture_ns = frame.capture_ns;
+        header.part = static_cast<uint16_t>(part);
+        header.part_count = static_cast<uint16_t>(part_count);
+        size_t size = sizeof(header) + count * sizeof(StatusDatagramBall);
+        if (count > 0) {
+            std::memcpy(buffer.data() + sizeof(header), &frame.balls[first], count * sizeof(StatusDatagramBall));
+        }
+
+        // 发送时间在拷贝完成后、发送前打点
+        header.publish_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        std::memcpy(buffer.data(), &header, sizeof(header));
+        int sent = static_cast<int>(sendto(socket_, buffer.data(), static_cast<int>(size), 0,
+                                           reinterpret_cast<const sockaddr*>(&destination_), sizeof(destination_)));
+        if (sent == static_cast<int>(size)) {
+            sent_datagrams_++;
+        } else {
+            send_errors_++;
+        }
+    }
+}
@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "video_file_source.h"
+
+VideoFileSource::VideoFileSource()
+    : VideoFileSource(VideoFileSourceConfig())
+{
+}
+
+VideoFileSource::VideoFileSource(const VideoFileSourceConfig& config)
+    : config_(config)
+    , is_open_(false)
+    , width_(0)
+    , height_(0)
+    , fps_(0)
+    , media_fps_(0.0)
+    , frame_count_(0)
+    , next_index_(0)
+    , dropped_frames_(0)
+    , allocated_frames_(0)
+    , end_index_(-1)
+    , stop_(false)
+{
+}
+
+VideoFileSource::~VideoFileSource() {
+    Close();
+}
+
+bool VideoFileSource::Open(const std::string& source, int width, int height, int fps) {
+    Close();
+
+    if (!cap_.open(source)) {
+        return false;
+    }
+    if (width > 0) cap_.set(cv::CAP_PROP_FRAME_WIDTH, width);
+    if (height > 0) cap_.set(cv::CAP_PROP_FRAME_HEIGHT, height);
+    if (fps > 0) cap_.set(cv::CAP_PROP_FPS, fps);
+
+    width_ = static_cast<int>(cap_.get(cv::CAP_PROP_FRAME_WIDTH));
+    height_ = static_cast<int>(cap_.get(cv::CAP_PROP_FRAME_HEIGHT));
+    media_fps_ = cap_.get(cv::CAP_PROP_FPS);
+    fps_ = static_cast<int>(media_fps_);
+
+    if ((width > 0 && width_ != width) ||
+        (height > 0 && height_ != height) ||
+        (fps > 0 && fps_ != fps)) {
+        Close();
+        return false;
+    }
+
+    path_ = source;
+    frame_count_ = std::max<int64_t>(0, static_cast<int64_t>(cap_.get(cv::CAP_PROP_FRAME_COUNT)));
+    next_index_ = 0;
+    end_index_ = -1;
+    stop_ = false;
+    dropped_frames_ = 0;
+    allocated_frames_ = 0;
+    pacer_.SetPacing(config_.pacing);
+    is_open_ = true;
+
+    if (config_.prefetch_frames <= 0) {
+        return true;  // 在读取线程上同步解码
+    }
+
+    // 多线程解码依赖按帧号精确跳转，容器不支持时退回单线程
+    int num_threads = std::max(1, config_.decode_threads);
+    int chunk_frames = std::max(1, config_.chunk_frames);
+    if (num_threads > 1 && frame_count_ <= chunk_frames) {
+        num_threads = 1;
+    } else if (num_threads > 1 && !ProbeSeek(chunk_frames)) {
+        std::cerr << "Frame accurate seeking unavailable for " << source
+                  << ", decoding with one thread" << std::endl;
+        num_threads = 1;
+    }
+
+    size_t ring_size = static_cast<size_t>(config_.prefetch_frames);
+    if (num_threads > 1) {
+        ring_size = std::max(ring_size, static_cast<size_t>(num_threads) * chunk_frames);
+    }
+    slots_.assign(ring_size, Slot());
+    for (int i = 0; i < num_threads; ++i) {
+        decoders_.emplace_back(&VideoFileSource::DecoderThread, this, i, num_threads);
+    }
+    return true;
+}
+
+void VideoFileSource::Close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    ready_cv_.notify_all();
+    free_cv_.notify_all();
+    pacer_.Cancel();
+    for (auto& decoder : decoders_) {
+        if (decoder.joinable()) {
+            decoder.join();
+        }
+    }
+    decoders_.clear();
+    slots_.clear();
+
+    if (cap_.isOpened()) {
+        cap_.release();
+    }
+    is_open_ = false;
+    width_ = 0;
+    height_ = 0;
+    fps_ = 0;
+    media_fps_ = 0.0;
+    frame_count_ = 0;
+    next_index_ = 0;
+    end_index_ = -1;
+}
+
+bool VideoFileSource::ProbeSeek(int64_t index) {
+    bool ok = cap_.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(index)) &&
+              static_cast<int64_t>(cap_.get(cv::CAP_PROP_POS_FRAMES)) == index;
+    cap_.set(cv::CAP_PROP_POS_FRAMES, 0);
+    return ok;
+}
+
+void VideoFileSource::DecoderThread(int thread_index, int num_threads) {
+    if (num_threads == 1) {
+        for (int64_t index = 0; DecodeFrame(cap_, index, false); ++index) {
+        }
+        return;
+    }
+
+    // 每个线程持有独立的解码器，轮流解码第 thread_index, thread_index + num_threads, ... 个分块
+    cv::VideoCapture own_cap;
+    cv::VideoCapture& cap = thread_index == 0 ? cap_ : own_cap;
+    if (thread_index != 0 && !own_cap.open(path_)) {
+        std::cerr << "Decoder thread " << thread_index << " failed to open " << path_ << std::endl;
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 无法解码本线程负责的分块，文件在其第一个分块处结束
+        int64_t first = static_cast<int64_t>(thread_index) * config_.chunk_frames;
+        end_index_ = end_index_ < 0 ? first : std::min(end_index_, first);
+        ready_cv_.notify_all();
+        return;
+    }
+
+    int64_t chunk_frames = std::max(1, config_.chunk_frames);
+    for (int64_t chunk = thread_index; ; chunk += num_threads) {
+        int64_t start = chunk * chunk_frames;
+        for (int64_t index = start; index < start + chunk_frames; ++index) {
+            if (!DecodeFrame(cap, index, index == start)) {
+                return;
+            }
+        }
+    }
+}
+
+bool VideoFileSource::DecodeFrame(cv::VideoCapture& cap, int64_t index, bool seek) {
+    Slot& slot = slots_[static_cast<size_t>(index) % slots_.size()];
+    cv::Mat image;
+    {
+        // 等待该帧进入预取窗口，窗口外的帧会占用尚未消费的槽位
+        std::unique_lock<std::mutex> lock(mutex_);
+        free_cv_.wait(lock, [&] {
+            return stop_ || (end_index_ >= 0 && index >= end_index_) ||
+                   (index < next_index_ + static_cast<int64_t>(slots_.size()) && slot.index < 0);
+        });
+        if (stop_ || (end_index_ >= 0 && index >= end_index_)) {
+            return false;
+        }
+        image = std::move(slot.image);
+    }
+
+    // 在锁外解码，复用槽位中的图像内存
+    if (image.empty()) {
+        allocated_frames_++;
+    }
+    bool ok = true;
+    if (seek) {
+        ok = cap.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(index));
+    }
+    ok = ok && cap.read(image) && !image.empty();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slot.image = std::move(image);
+        if (ok) {
+            slot.index = index;
+        } else {
+            end_index_ = end_index_ < 0 ? index : std::min(end_index_, index);
+        }
+    }
+    ready_cv_.notify_all();
+    if (!ok) {
+        free_cv_.notify_all();  // 唤醒等待结束位置之后帧的其他解码线程
+    }
+    return ok;
+}
+
+bool VideoFileSource::NextFrame(cv::Mat& image, int64_t& index) {
+    if (decoders_.empty()) {
+        if (!cap_.read(image) || image.empty()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            end_index_ = next_index_;
+            return false;
+        }
+        index = next_index_++;
+        return true;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        Slot& slot = slots_[static_cast<size_t>(next_index_) % slots_.size()];
+        ready_cv_.wait(lock, [&] {
+            return stop_ || slot.index == next_index_ || (end_index_ >= 0 && next_index_ >= end_index_);
+        });
+        if (slot.index != next_index_) {
+            return false;  // 文件结束或已关闭
+        }
+
+        // 与调用方交换图像：调用方上一帧的内存回到槽位中复用，
+        // 若仍被其他地方引用或不是自有内存则释放，避免解码覆盖其内容
+        std::swap(image, slot.image);
+        if (slot.image.u == nullptr || slot.image.u->refcount > 1) {
+            slot.image.release();
+        }
+        slot.index = -1;
+        index = next_index_++;
+    }
+    free_cv_.notify_all();
+    return true;
+}
+
+bool VideoFileSource::Read(RawFrame& frame) {
+    if (!is_open_ || IsEndOfStream() || !pacer_.AcquireStep(kPlaybackStepWaitMs)) {
+        return false;
+    }
+
+    double fps = media_fps_ > 0.0 ? media_fps_ : 30.0;
+    int64_t period_ns = static_cast<int64_t>(1e9 / fps);
+    int64_t index = 0;
+    while (true) {
+        if (!NextFrame(frame.image, index)) {
+            return false;
+        }
+        int64_t late_ns = pacer_.WaitUntil(static_cast<int64_t>(index * 1e9 / fps));
+        if (config_.drop_late_frames && late_ns > period_ns) {
+            dropped_frames_++;  // 实时模式下处理跟不上，像实时相机一样丢弃过期帧
+            continue;
+        }
+        break;
+    }
+
+    frame.format = PixelFormat::BGR8;
+    frame.frame_id = static_cast<uint64_t>(index);
+    frame.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return true;
+}
+
+bool VideoFileSource::IsEndOfStream() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return is_open_ && end_index_ >= 0 && next_index_ >= end_index_;
+}
+
+FrameSourceCaps VideoFileSource::GetCaps() const {
+    FrameSourceCaps caps;
+    caps.native_format = PixelFormat::BGR8;
+    caps.zero_copy = false;
+    caps.native_bgr_convert = false;
+    caps.is_live = pacer_.GetPacing() == ReplayPacing::REAL_TIME;
+    return caps;
+}
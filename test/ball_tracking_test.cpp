@@ -1,10 +1,19 @@
 #include <gtest/gtest.h>
 #include <opencv2/opencv.hpp>
 #include <thread>
+#include <cmath>
 #include <chrono>
 #include <filesystem>
+#include <fstream>
+#include <mutex>
 
+#include <nlohmann/json.hpp>
+
+#include "ball_tracker_algo.h"
 #include "ball_tracker_interface.h"
+#include "raw_recording.h"
+#include "synthetic_frame_source.h"
+#include "tracker_bank.h"
 
 class BallTrackingTest : public ::testing::Test {
 protected:
@@ -95,6 +104,352 @@ TEST_F(BallTrackingTest, TestVideoTracking) {
     interface_->StopTracking();
 }
 
+// End of stream is reported as a typed capture event and ends the tracking loop without spinning
+TEST_F(BallTrackingTest, TestEndOfStreamEvent) {
+    std::filesystem::create_directories("test_data");
+    const std::string path = "test_data/end_of_stream_test.btraw";
+    {
+        SyntheticSourceConfig config;
+        config.num_frames = 20;
+        SyntheticFrameSource source(config);
+        ASSERT_TRUE(source.Open("", 320, 240, 30));
+        RawRecordingInfo info;
+        info.width = 320;
+        info.height = 240;
+        info.pixel_format = PixelFormat::BGR8;
+        info.fps = 30;
+        RawRecordingWriter writer;
+        ASSERT_TRUE(writer.Open(path, info));
+        RawFrame frame;
+        while (source.Read(frame)) {
+            ASSERT_TRUE(writer.Write(frame));
+        }
+    }
+
+    interface_ = std::make_unique<BallTrackerInterface>("config/balls_config.json",
+                                                      std::make_pair(160, 120));
+    ASSERT_TRUE(interface_->InitializeCamera(CameraSourceType::RAW_REPLAY, path));
+
+    std::vector<CaptureStatus> events;
+    std::mutex events_mutex;
+    interface_->RegisterCaptureEventCallback([&](CaptureStatus status, int) {
+        std::lock_guard<std::mutex> lock(events_mutex);
+        events.push_back(status);
+    });
+
+    interface_->StartTracking();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (interface_->GetLastCaptureStatus() != CaptureStatus::END_OF_STREAM &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(interface_->GetLastCaptureStatus(), CaptureStatus::END_OF_STREAM);
+
+    auto stop_start = std::chrono::steady_clock::now();
+    interface_->StopTracking();
+    EXPECT_LT(std::chrono::steady_clock::now() - stop_start, std::chrono::milliseconds(100));
+    {
+        std::lock_guard<std::mutex> lock(events_mutex);
+        ASSERT_EQ(events.size(), 1u);
+        EXPECT_EQ(events[0], CaptureStatus::END_OF_STREAM);
+    }
+    interface_.reset();
+    std::filesystem::remove(path);
+}
+
+// A moving ball tracked without a recorded track still reports its velocity in arm coordinates
+TEST_F(BallTrackingTest, TestRobotTargetVelocity) {
+    SyntheticSourceConfig config;
+    SyntheticFrameSource source(config);
+    ASSERT_TRUE(source.Open("", 640, 480, 30));
+    RawFrame frame;
+    ASSERT_TRUE(source.Read(frame));
+    cv::Point_<double> start = source.GetGroundTruth();
+
+    interface_ = std::make_unique<BallTrackerInterface>("config/balls_config.json",
+                                                      std::make_pair(start.x, start.y));
+    ASSERT_TRUE(interface_->InitializeCamera(CameraSourceType::SYNTHETIC, "", 640, 480, 30));
+
+    // 垂直向下的相机，地面上一个像素对应 camera_height / fx = 2 个长度单位
+    CameraCalibration calibration;
+    calibration.image_width = 640;
+    calibration.image_height = 480;
+    calibration.fx = 500.0;
+    calibration.fy = 500.0;
+    calibration.cx = 320.0;
+    calibration.cy = 240.0;
+    ASSERT_TRUE(interface_->SetCameraCalibration(calibration));
+    HeightParameters heights;
+    heights.camera_height = 1000.0;
+    heights.track_start_height = 0.0;
+    heights.track_end_height = 0.0;
+    interface_->SetHeightParameters(heights);
+
+    interface_->StartTracking();
+    const double expected_speed = config.speed * 30.0 * 2.0;
+    double max_speed = 0.0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (std::chrono::steady_clock::now() < deadline && max_speed < 0.5 * expected_speed) {
+        RobotTarget target = interface_->GetRobotTarget();
+        if (target.valid) {
+            max_speed = std::max(max_speed, std::hypot(target.V_arm_x, target.V_arm_y));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    interface_->StopTracking();
+
+    EXPECT_GT(max_speed, 0.5 * expected_speed);
+    EXPECT_LT(max_speed, 2.0 * expected_speed);
+}
+
+namespace {
+
+// 合成小球颜色的 HSV 标准差，与 config/balls_config.json 中的球一致
+const cv::Scalar kBallHsvStddev(0.57, 19.56, 1.84);
+
+// 合成场景中小球的 BGR 颜色，用于手工绘制测试图像
+cv::Scalar SyntheticBallBgr(const SyntheticSourceConfig& config) {
+    cv::Mat hsv(1, 1, CV_8UC3, config.ball_hsv);
+    cv::Mat bgr;
+    cv::cvtColor(hsv, bgr, cv::COLOR_HSV2BGR);
+    cv::Vec3b color = bgr.at<cv::Vec3b>(0, 0);
+    return cv::Scalar(color[0], color[1], color[2]);
+}
+
+// 读取 InitTrack() 写出的轨迹点
+std::vector<cv::Point_<float>> ReadTrajectoryPoints(const std::string& path) {
+    std::vector<cv::Point_<float>> points;
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return points;
+    }
+    nlohmann::json trajectory = nlohmann::json::parse(file)["track_trajectory"];
+    for (const auto& point : trajectory["points"]) {
+        points.emplace_back(point["x"].get<float>(), point["y"].get<float>());
+    }
+    return points;
+}
+
+}  // namespace
+
+// Once locked, the tracker finds the ball by growing from the prediction instead of searching the ROI
+TEST(BallTrackerSeedTest, TestSeededDetectionFollowsBall) {
+    SyntheticSourceConfig config;
+    config.num_frames = 40;
+    SyntheticFrameSource source(config);
+    ASSERT_TRUE(source.Open("", 320, 240, 30));
+
+    RawFrame frame;
+    ASSERT_TRUE(source.Read(frame));
+    BallTracker tracker(1, "test_ball", config.ball_hsv, kBallHsvStddev, source.GetGroundTruth());
+    int frames = 0;
+    do {
+        ASSERT_TRUE(tracker.UpdateWithImage(frame.image)) << "frame " << frames;
+        BallTrackerSnapshot snapshot = tracker.GetSnapshot();
+        EXPECT_NEAR(snapshot.center.x, source.GetGroundTruth().x, 1.0) << "frame " << frames;
+        EXPECT_NEAR(snapshot.center.y, source.GetGroundTruth().y, 1.0) << "frame " << frames;
+        EXPECT_NEAR(snapshot.radius, config.ball_radius, 1.5) << "frame " << frames;
+        if (frames > 0) {
+            // 种子窗口为数倍半径，远小于初始 ROI
+            EXPECT_LE(snapshot.search_roi.area(), 80 * 80) << "frame " << frames;
+            EXPECT_TRUE(snapshot.search_roi.contains(cv::Point(cvRound(snapshot.center.x), cvRound(snapshot.center.y))));
+        }
+        ++frames;
+    } while (source.Read(frame));
+    EXPECT_EQ(frames, config.num_frames);
+}
+
+// A lost ball is searched within the pixel budget: coasting, then local windows, then rotating global tiles
+TEST(BallTrackerSearchTest, TestLostBallSearchIsBounded) {
+    SyntheticSourceConfig config;
+    SyntheticFrameSource source(config);
+    ASSERT_TRUE(source.Open("", 640, 480, 30));
+
+    RawFrame frame;
+    ASSERT_TRUE(source.Read(frame));
+    BallTracker tracker(1, "test_ball", config.ball_hsv, kBallHsvStddev, source.GetGroundTruth());
+    LostBallSearchConfig search_config;
+    search_config.pixel_budget = 160 * 160;
+    tracker.SetSearchConfig(search_config);
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(tracker.UpdateWithImage(frame.image));
+        ASSERT_TRUE(source.Read(frame));
+    }
+    EXPECT_EQ(tracker.GetTrackState(), TrackState::TRACKING);
+
+    // 球消失：各状态的搜索区域都不超过像素预算
+    cv::Mat empty(480, 640, CV_8UC3, config.background_bgr);
+    int misses = search_config.coast_frames + search_config.local_search_frames + 30;
+    for (int i = 1; i <= misses; ++i) {
+        EXPECT_FALSE(tracker.UpdateWithImage(empty));
+        EXPECT_LE(tracker.GetSnapshot().search_roi.area(), search_config.pixel_budget);
+        TrackState expected = TrackState::GLOBAL_SEARCH;
+        if (i <= search_config.coast_frames) {
+            expected = TrackState::COASTING;
+        } else if (i <= search_config.coast_frames + search_config.local_search_frames) {
+            expected = TrackState::LOCAL_SEARCH;
+        }
+        EXPECT_EQ(tracker.GetTrackState(), expected) << "miss " << i;
+    }
+
+    // 球在远处重新出现：一轮全局搜索内重新捕获
+    cv::Mat reappeared = empty.clone();
+    cv::circle(reappeared, cv::Point(600, 40), config.ball_radius, SyntheticBallBgr(config), cv::FILLED);
+    int frames = 0;
+    while (!tracker.UpdateWithImage(reappeared) && frames < 40) {
+        EXPECT_LE(tracker.GetSnapshot().search_roi.area(), search_config.pixel_budget);
+        ++frames;
+    }
+    EXPECT_LT(frames, 40);
+    EXPECT_EQ(tracker.GetTrackState(), TrackState::TRACKING);
+    // 球可能被搜索块边界截断，下一帧以完整的球修正位置
+    EXPECT_TRUE(tracker.UpdateWithImage(reappeared));
+    EXPECT_NEAR(tracker.GetStatus().x, 600.0, 1.0);
+    EXPECT_NEAR(tracker.GetStatus().y, 40.0, 1.0);
+}
+
+// A ball at rest is only checked on a small patch and gets a full detection again once it moves
+TEST(BallTrackerRestTest, TestRestingBallSkipsDetection) {
+    SyntheticSourceConfig config;
+    cv::Scalar ball_bgr = SyntheticBallBgr(config);
+
+    cv::Mat image(240, 320, CV_8UC3, config.background_bgr);
+    cv::circle(image, cv::Point(100, 120), config.ball_radius, ball_bgr, cv::FILLED);
+    BallTracker tracker(1, "test_ball", config.ball_hsv, kBallHsvStddev, cv::Point_<double>(100, 120));
+
+    AdaptiveUpdateConfig adaptive;
+    for (int i = 0; i <= adaptive.rest_frames; ++i) {
+        ASSERT_TRUE(tracker.UpdateWithImage(image));
+    }
+    EXPECT_TRUE(tracker.IsResting());
+
+    // 静止期间只检查球上的小块
+    ASSERT_TRUE(tracker.UpdateWithImage(image));
+    BallTrackerSnapshot snapshot = tracker.GetSnapshot();
+    EXPECT_TRUE(snapshot.resting);
+    EXPECT_LE(snapshot.search_roi.area(), 4 * config.ball_radius * config.ball_radius);
+
+    // 球移动后立即恢复完整检测
+    cv::Mat moved(240, 320, CV_8UC3, config.background_bgr);
+    cv::circle(moved, cv::Point(106, 120), config.ball_radius, ball_bgr, cv::FILLED);
+    ASSERT_TRUE(tracker.UpdateWithImage(moved));
+    EXPECT_FALSE(tracker.IsResting());
+    EXPECT_NEAR(tracker.GetStatus().x, 106.0, 1.0);
+    EXPECT_NEAR(tracker.GetStatus().y, 120.0, 1.0);
+}
+
+// A ball entering the spawn zone gets a tracker from the pool, which is retired at the end point
+TEST(TrackerBankTest, TestSpawnAndRetire) {
+    SyntheticSourceConfig config;
+    cv::Scalar ball_bgr = SyntheticBallBgr(config);
+
+    // 配置中的球不在画面内，只作为颜色模型；较小的搜索预算使其找不到新球
+    TrackerBank bank;
+    LostBallSearchConfig search_config;
+    search_config.pixel_budget = 40 * 40;
+    bank.SetSearchConfig(search_config);
+    bank.Add(1, "test_ball", config.ball_hsv, kBallHsvStddev, cv::Point_<double>(290, 220));
+    TrackerLifecycleConfig lifecycle;
+    lifecycle.enabled = true;
+    lifecycle.max_trackers = 4;
+    lifecycle.spawn_zone_radius = 30;
+    bank.SetLifecycleConfig(lifecycle);
+    EXPECT_EQ(bank.Size(), 4);
+    bank.SetSpawnZones({cv::Point_<float>(40, 120)});
+    bank.SetEndPoint(cv::Point_<float>(260, 120));
+
+    std::vector<int> changed;
+    int spawned = -1;
+    bool retired = false;
+    for (int frame = 0; frame < 60 && !retired; ++frame) {
+        int x = std::min(40 + 6 * frame, 280);
+        cv::Mat image(240, 320, CV_8UC3, config.background_bgr);
+        cv::circle(image, cv::Point(x, 120), config.ball_radius, ball_bgr, cv::FILLED);
+        ASSERT_TRUE(bank.Update(image));
+        if (spawned >= 0 && bank.Get(spawned).GetStatus().detected) {
+            EXPECT_NEAR(bank.Get(spawned).GetStatus().x, x, 1.0) << "frame " << frame;
+        }
+        bank.UpdateLifecycle(image, changed);
+        for (int slot : changed) {
+            if (bank.IsActive(slot)) {
+                // 连续若干帧出现在出生区后才创建，且只创建一次
+                EXPECT_EQ(spawned, -1);
+                EXPECT_EQ(frame + 1, lifecycle.spawn_confirm_frames);
+                EXPECT_EQ(bank.GetId(slot), 2);
+                EXPECT_EQ(bank.Get(slot).GetStatus().color, "test_ball");
+                spawned = slot;
+            } else {
+                EXPECT_EQ(slot, spawned);
+                EXPECT_GE(x, 230);
+                retired = true;
+            }
+        }
+    }
+    EXPECT_NE(spawned, -1);
+    EXPECT_TRUE(retired);
+    EXPECT_TRUE(bank.IsActive(0));
+    const TrackerLifecycleStats& stats = bank.GetLifecycleStats();
+    EXPECT_EQ(stats.spawned, 1u);
+    EXPECT_EQ(stats.retired_finished, 1u);
+    EXPECT_EQ(stats.retired_lost, 0u);
+    EXPECT_EQ(stats.spawns_skipped, 0u);
+}
+
+// InitTrackOffline() recovers the trajectory of the sequential InitTrack() from the same recording to within a pixel
+TEST(InitTrackOfflineTest, TestMatchesSequentialInitTrack) {
+    std::filesystem::create_directories("test_data/offline_init");
+    const std::string pattern = "test_data/offline_init/frame_%03d.png";  // 无损图像序列，两条路径解码出相同的像素
+    const int num_frames = 90;
+    SyntheticSourceConfig config;
+    config.num_frames = num_frames;
+    SyntheticFrameSource source(config);
+    ASSERT_TRUE(source.Open("", 640, 480, 30));
+    cv::Point_<double> start;
+    RawFrame frame;
+    for (int f = 0; source.Read(frame); ++f) {
+        if (f == 0) {
+            start = source.GetGroundTruth();
+        }
+        ASSERT_TRUE(cv::imwrite(cv::format(pattern.c_str(), f), frame.image));
+    }
+
+    const std::string sequential_path = "test_data/offline_init/sequential.json";
+    BallTrackerInterface sequential("config/balls_config.json", std::make_pair(start.x, start.y));
+    ASSERT_TRUE(sequential.InitializeCamera(CameraSourceType::VIDEO_FILE, pattern));
+    ASSERT_EQ(sequential.InitTrack(sequential_path), 0);
+
+    // 分段数固定为 3，确保跨段的帧也参与比较
+    const std::string offline_path = "test_data/offline_init/offline.json";
+    BallTrackerInterface offline("config/balls_config.json", std::make_pair(start.x, start.y));
+    OfflineInitTrackConfig offline_config;
+    offline_config.segments = 3;
+    offline_config.min_segment_frames = 16;
+    offline.SetOfflineInitTrackConfig(offline_config);
+    ASSERT_EQ(offline.InitTrackOffline(pattern, offline_path), 0);
+
+    std::vector<InitTrackBallStats> sequential_stats = sequential.GetInitTrackStats();
+    std::vector<InitTrackBallStats> offline_stats = offline.GetInitTrackStats();
+    ASSERT_EQ(sequential_stats.size(), 1u);
+    ASSERT_EQ(offline_stats.size(), 1u);
+    EXPECT_EQ(offline_stats[0].total_frames, sequential_stats[0].total_frames);
+    EXPECT_EQ(offline_stats[0].success_frames, sequential_stats[0].success_frames);
+
+    // 容差：离线检测在 1/detect_scale 分辨率上求质心，逐点偏差不超过 1 像素，平均不超过 0.5 像素
+    std::vector<cv::Point_<float>> expected = ReadTrajectoryPoints(sequential_path);
+    std::vector<cv::Point_<float>> actual = ReadTrajectoryPoints(offline_path);
+    ASSERT_EQ(expected.size(), static_cast<size_t>(num_frames));
+    ASSERT_EQ(actual.size(), expected.size());
+    double total_error = 0.0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        double error = cv::norm(actual[i] - expected[i]);
+        EXPECT_LE(error, 1.0) << "frame " << i;
+        total_error += error;
+    }
+    EXPECT_LE(total_error / expected.size(), 0.5);
+    EXPECT_NEAR(offline_stats[0].length, sequential_stats[0].length, 0.02 * sequential_stats[0].length);
+    std::filesystem::remove_all("test_data/offline_init");
+}
+
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
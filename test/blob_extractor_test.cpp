@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "blob_extractor.h"
+
+// A filled disc yields one blob whose centroid and moment radius match the disc
+TEST(BlobExtractorTest, TestDiscMoments) {
+    cv::Mat mask = cv::Mat::zeros(120, 160, CV_8UC1);
+    cv::circle(mask, cv::Point(70, 55), 20, cv::Scalar(255), -1);
+
+    // 不做噪声过滤，结果应与逐像素统计一致
+    BlobExtractorConfig config;
+    config.max_run_gap = 0;
+    config.min_run_length = 1;
+    BlobExtractor extractor(config);
+    std::vector<Blob> blobs;
+    ASSERT_EQ(extractor.Extract(mask, blobs), 1);
+
+    const Blob& blob = blobs[0];
+    EXPECT_EQ(blob.area, cv::countNonZero(mask));
+    EXPECT_NEAR(blob.centroid.x, 70.0f, 0.1f);
+    EXPECT_NEAR(blob.centroid.y, 55.0f, 0.1f);
+    EXPECT_NEAR(blob.MomentRadius(), 20.0f, 1.0f);
+    EXPECT_NEAR(blob.mu11, 0.0, 0.5);
+    EXPECT_TRUE(blob.bbox.contains(cv::Point(70, 55)));
+    EXPECT_NEAR(blob.bbox.width, 41, 1);
+    EXPECT_NEAR(blob.bbox.height, 41, 1);
+}
+
+// Runs are merged through 8-connectivity, separate regions stay separate
+TEST(BlobExtractorTest, TestConnectivity) {
+    cv::Mat mask = cv::Mat::zeros(60, 60, CV_8UC1);
+    // U 形区域：两条竖边在底部相连
+    cv::rectangle(mask, cv::Rect(5, 5, 5, 30), cv::Scalar(255), -1);
+    cv::rectangle(mask, cv::Rect(25, 5, 5, 30), cv::Scalar(255), -1);
+    cv::rectangle(mask, cv::Rect(5, 35, 25, 5), cv::Scalar(255), -1);
+    // 独立方块
+    cv::rectangle(mask, cv::Rect(40, 40, 10, 10), cv::Scalar(255), -1);
+
+    BlobExtractorConfig config;
+    config.max_run_gap = 0;
+    BlobExtractor extractor(config);
+    std::vector<Blob> blobs;
+    ASSERT_EQ(extractor.Extract(mask, blobs), 2);
+    EXPECT_EQ(blobs[0].area, 5 * 30 * 2 + 25 * 5);
+    EXPECT_EQ(blobs[1].area, 100);
+    EXPECT_EQ(BlobExtractor::LargestBlob(blobs), 0);
+
+    for (const auto& run : extractor.GetRuns()) {
+        EXPECT_GE(run.label, 0);
+    }
+}
+
+// Isolated noise pixels and short runs are filtered without morphology
+TEST(BlobExtractorTest, TestNoiseFiltering) {
+    cv::Mat mask = cv::Mat::zeros(80, 80, CV_8UC1);
+    cv::rectangle(mask, cv::Rect(20, 20, 20, 20), cv::Scalar(255), -1);
+    // 散点噪声与小块
+    mask.at<uchar>(5, 5) = 255;
+    mask.at<uchar>(60, 70) = 255;
+    mask.at<uchar>(61, 71) = 255;
+    cv::rectangle(mask, cv::Rect(60, 10, 4, 4), cv::Scalar(255), -1);
+    // 球内的一列空洞由游程合并填补
+    mask.col(30).rowRange(20, 40).setTo(0);
+
+    BlobExtractor extractor;
+    std::vector<Blob> blobs;
+    ASSERT_EQ(extractor.Extract(mask, blobs), 1);
+    EXPECT_EQ(blobs[0].area, 400);
+    EXPECT_EQ(blobs[0].bbox, cv::Rect(20, 20, 20, 20));
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 #include <opencv2/opencv.hpp>
 #include "camera_control.h"
+#include "playback_pacer.h"
+#include "synthetic_frame_source.h"
+#include "video_file_source.h"
+#include <chrono>
 #include <filesystem>
 #include <thread>
 
@@ -56,6 +60,223 @@ TEST_F(CameraControlTest, TestVideoFile) {
     }
 }
 
+// Prefetching decoder must return every frame in file order and then signal end of stream
+TEST_F(CameraControlTest, TestVideoFilePrefetch) {
+    std::filesystem::create_directories("test_data");
+    const std::string path = "test_data/prefetch_test.avi";
+    const int num_frames = 40;
+    {
+        cv::VideoWriter writer(path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), 30, cv::Size(160, 120));
+        if (!writer.isOpened()) {
+            std::cout << "MJPG encoder unavailable" << std::endl;
+            GTEST_SKIP();
+        }
+        for (int i = 0; i < num_frames; ++i) {
+            writer.write(cv::Mat(120, 160, CV_8UC3, cv::Scalar::all(i * 5)));
+        }
+    }
+
+    for (int threads : {1, 3}) {
+        VideoFileSourceConfig config;
+        config.decode_threads = threads;
+        config.chunk_frames = 8;
+        ASSERT_TRUE(camera_.Open(std::make_unique<VideoFileSource>(config), path));
+
+        int frames = 0;
+        cv::Mat frame;
+        while (camera_.Capture(frame)) {
+            EXPECT_NEAR(cv::mean(frame)[0], frames * 5, 3.0) << "threads " << threads;
+            frames++;
+        }
+        EXPECT_EQ(frames, num_frames);
+        EXPECT_TRUE(camera_.IsEndOfStream());
+        camera_.Close();
+    }
+    std::filesystem::remove(path);
+}
+
+// Capturing into the same Mat through the camera hands each decoded buffer back to the prefetch ring
+TEST_F(CameraControlTest, TestVideoFileBufferReuse) {
+    std::filesystem::create_directories("test_data");
+    const std::string path = "test_data/reuse_test.avi";
+    const int num_frames = 60;
+    {
+        cv::VideoWriter writer(path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), 30, cv::Size(160, 120));
+        if (!writer.isOpened()) {
+            std::cout << "MJPG encoder unavailable" << std::endl;
+            GTEST_SKIP();
+        }
+        for (int i = 0; i < num_frames; ++i) {
+            writer.write(cv::Mat(120, 160, CV_8UC3, cv::Scalar::all(i * 4)));
+        }
+    }
+
+    VideoFileSourceConfig config;
+    config.prefetch_frames = 4;
+    auto source = std::make_unique<VideoFileSource>(config);
+    VideoFileSource* video = source.get();
+    ASSERT_TRUE(camera_.Open(std::move(source), path));
+
+    int frames = 0;
+    cv::Mat frame;
+    while (camera_.Capture(frame)) {
+        EXPECT_NEAR(cv::mean(frame)[0], frames * 4, 3.0);
+        frames++;
+    }
+    EXPECT_EQ(frames, num_frames);
+    // 环形缓冲区的槽位加上相机持有的当前帧
+    EXPECT_LE(video->GetAllocatedFrames(), static_cast<uint64_t>(config.prefetch_frames + 2));
+
+    // 调用方保留每一帧时不能覆盖其内容
+    ASSERT_TRUE(camera_.Reconnect());
+    std::vector<cv::Mat> kept;
+    while (camera_.Capture(frame)) {
+        kept.push_back(frame);
+    }
+    ASSERT_EQ(static_cast<int>(kept.size()), num_frames);
+    for (int i = 0; i < num_frames; ++i) {
+        EXPECT_NEAR(cv::mean(kept[i])[0], i * 4, 3.0);
+    }
+    camera_.Close();
+    std::filesystem::remove(path);
+}
+
+// Each pacing mode hands out frames at its own rate
+TEST_F(CameraControlTest, TestPlaybackPacer) {
+    using Clock = std::chrono::steady_clock;
+    const int64_t period_ns = 20000000;
+    PlaybackPacer pacer;
+
+    // 最快速度：不等待
+    EXPECT_EQ(pacer.GetPacing(), ReplayPacing::MAX_SPEED);
+    auto start = Clock::now();
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(pacer.AcquireStep(kPlaybackStepWaitMs));
+        EXPECT_EQ(pacer.WaitUntil(i * period_ns), 0);
+    }
+    EXPECT_LT(Clock::now() - start, std::chrono::milliseconds(50));
+
+    // 实时：第一帧立即返回，之后按媒体时间戳节拍
+    pacer.SetPacing(ReplayPacing::REAL_TIME);
+    start = Clock::now();
+    for (int i = 0; i < 6; ++i) {
+        EXPECT_TRUE(pacer.AcquireStep(kPlaybackStepWaitMs));
+        pacer.WaitUntil(1000000000 + i * period_ns);
+    }
+    EXPECT_GE(Clock::now() - start, std::chrono::nanoseconds(5 * period_ns));
+    // 落后的帧不再等待，并报告延迟
+    std::this_thread::sleep_for(std::chrono::nanoseconds(3 * period_ns));
+    EXPECT_GE(pacer.WaitUntil(1000000000 + 6 * period_ns), period_ns);
+
+    // 单步：只有授权的帧可以读取，没有授权时等待超时
+    pacer.SetPacing(ReplayPacing::STEP);
+    start = Clock::now();
+    EXPECT_FALSE(pacer.AcquireStep(30));
+    EXPECT_GE(Clock::now() - start, std::chrono::milliseconds(30));
+    pacer.Step(2);
+    EXPECT_TRUE(pacer.AcquireStep(30));
+    EXPECT_TRUE(pacer.AcquireStep(30));
+    EXPECT_FALSE(pacer.AcquireStep(30));
+
+    // 另一线程授权时立即唤醒等待者
+    std::thread stepper([&pacer] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        pacer.Step();
+    });
+    EXPECT_TRUE(pacer.AcquireStep(5000));
+    stepper.join();
+
+    // 取消唤醒等待者并丢弃未用的授权
+    pacer.Step(3);
+    pacer.Cancel();
+    EXPECT_FALSE(pacer.AcquireStep(30));
+    EXPECT_EQ(pacer.WaitUntil(0), 0);
+}
+
+// A video file source paces frames by pacing mode: as fast as decoded, real time, or by Step()
+TEST_F(CameraControlTest, TestVideoFilePacing) {
+    std::filesystem::create_directories("test_data");
+    const std::string path = "test_data/pacing_test.avi";
+    const int fps = 25;
+    {
+        cv::VideoWriter writer(path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), fps, cv::Size(160, 120));
+        if (!writer.isOpened()) {
+            std::cout << "MJPG encoder unavailable" << std::endl;
+            GTEST_SKIP();
+        }
+        for (int i = 0; i < 12; ++i) {
+            writer.write(cv::Mat(120, 160, CV_8UC3, cv::Scalar::all(i * 10)));
+        }
+    }
+    using Clock = std::chrono::steady_clock;
+    const auto period = std::chrono::microseconds(1000000 / fps);
+    cv::Mat frame;
+
+    VideoFileSourceConfig config;
+    config.pacing = ReplayPacing::MAX_SPEED;
+    ASSERT_TRUE(camera_.Open(std::make_unique<VideoFileSource>(config), path));
+    auto start = Clock::now();
+    int frames = 0;
+    while (camera_.Capture(frame)) {
+        frames++;
+    }
+    EXPECT_EQ(frames, 12);
+    EXPECT_LT(Clock::now() - start, 11 * period);
+    EXPECT_FALSE(camera_.GetCaps().is_live);
+    camera_.Close();
+
+    config.pacing = ReplayPacing::REAL_TIME;
+    ASSERT_TRUE(camera_.Open(std::make_unique<VideoFileSource>(config), path));
+    EXPECT_TRUE(camera_.GetCaps().is_live);
+    start = Clock::now();
+    for (int i = 0; i < 6; ++i) {
+        ASSERT_TRUE(camera_.Capture(frame));
+    }
+    EXPECT_GE(Clock::now() - start, 5 * period - std::chrono::milliseconds(2));
+    camera_.Close();
+
+    config.pacing = ReplayPacing::STEP;
+    auto source = std::make_unique<VideoFileSource>(config);
+    VideoFileSource* stepped = source.get();
+    ASSERT_TRUE(camera_.Open(std::move(source), path));
+    EXPECT_FALSE(camera_.Capture(frame));
+    EXPECT_EQ(camera_.GetLastStatus(), CaptureStatus::TIMEOUT);
+    stepped->Step(2);
+    ASSERT_TRUE(camera_.Capture(frame));
+    EXPECT_NEAR(cv::mean(frame)[0], 0.0, 3.0);
+    ASSERT_TRUE(camera_.Capture(frame));
+    EXPECT_NEAR(cv::mean(frame)[0], 10.0, 3.0);
+    EXPECT_FALSE(camera_.Capture(frame));
+    EXPECT_EQ(camera_.GetLastStatus(), CaptureStatus::TIMEOUT);
+    // 切回最快速度后不再需要授权
+    stepped->SetPacing(ReplayPacing::MAX_SPEED);
+    ASSERT_TRUE(camera_.Capture(frame));
+    EXPECT_NEAR(cv::mean(frame)[0], 20.0, 3.0);
+    camera_.Close();
+    std::filesystem::remove(path);
+}
+
+// Failed captures are classified and a reconnect restarts the source
+TEST_F(CameraControlTest, TestCaptureStatusAndReconnect) {
+    SyntheticSourceConfig config;
+    config.num_frames = 2;
+    ASSERT_TRUE(camera_.Open(std::make_unique<SyntheticFrameSource>(config), "", 320, 240, 30));
+
+    cv::Mat frame;
+    EXPECT_TRUE(camera_.Capture(frame));
+    EXPECT_TRUE(camera_.Capture(frame));
+    EXPECT_EQ(camera_.GetLastStatus(), CaptureStatus::OK);
+    EXPECT_FALSE(camera_.Capture(frame));
+    EXPECT_EQ(camera_.GetLastStatus(), CaptureStatus::END_OF_STREAM);
+
+    ASSERT_TRUE(camera_.Reconnect());
+    EXPECT_TRUE(camera_.Capture(frame));
+    EXPECT_EQ(camera_.GetLastStatus(), CaptureStatus::OK);
+    camera_.Close();
+    EXPECT_FALSE(camera_.Capture(frame));
+    EXPECT_EQ(camera_.GetLastStatus(), CaptureStatus::NOT_OPEN);
+}
+
 // Test Huarui camera (currently reserved interface)
 TEST_F(CameraControlTest, TestHuaruiCamera) {
     if (camera_.Open("SN123456", 640, 480, 30, CameraSourceType::HUARUI_CAMERA)) {
@@ -78,6 +299,41 @@ TEST_F(CameraControlTest, TestHuaruiCamera) {
     }
 }
 
+// Test synthetic source (no hardware required)
+TEST_F(CameraControlTest, TestSyntheticSource) {
+    ASSERT_TRUE(camera_.Open("", 320, 240, 30, CameraSourceType::SYNTHETIC));
+    std::cout << camera_.GetInfo() << std::endl;
+
+    FrameSourceCaps caps = camera_.GetCaps();
+    EXPECT_EQ(caps.native_format, PixelFormat::BGR8);
+    EXPECT_TRUE(caps.zero_copy);
+
+    cv::Mat frame;
+    ASSERT_TRUE(camera_.Capture(frame));
+    EXPECT_EQ(frame.cols, 320);
+    EXPECT_EQ(frame.rows, 240);
+    EXPECT_EQ(frame.type(), CV_8UC3);
+    camera_.Close();
+}
+
+// Test Bayer conversion path with a synthetic BayerRG8 source
+TEST_F(CameraControlTest, TestSyntheticBayerSource) {
+    SyntheticSourceConfig config;
+    config.output_format = PixelFormat::BAYER_RG8;
+    config.num_frames = 3;
+    ASSERT_TRUE(camera_.Open(std::make_unique<SyntheticFrameSource>(config), "", 320, 240, 30));
+    EXPECT_EQ(camera_.GetCaps().native_format, PixelFormat::BAYER_RG8);
+
+    int frames = 0;
+    cv::Mat frame;
+    while (camera_.Capture(frame)) {
+        EXPECT_EQ(frame.type(), CV_8UC3);
+        frames++;
+    }
+    EXPECT_EQ(frames, 3);
+    camera_.Close();
+}
+
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
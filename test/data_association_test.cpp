@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "data_association.h"
+
+namespace {
+
+// 穷举所有配对，返回 (配对数最多, 代价最小) 的最优值
+void BruteForce(const std::vector<float>& cost, int rows, int cols, int row, std::vector<char>& used,
+                int count, double sum, int& best_count, double& best_sum) {
+    if (row == rows) {
+        if (count > best_count || (count == best_count && sum < best_sum)) {
+            best_count = count;
+            best_sum = sum;
+        }
+        return;
+    }
+    BruteForce(cost, rows, cols, row + 1, used, count, sum, best_count, best_sum);
+    for (int j = 0; j < cols; ++j) {
+        float value = cost[row * cols + j];
+        if (!used[j] && value != kNotGated) {
+            used[j] = 1;
+            BruteForce(cost, rows, cols, row + 1, used, count + 1, sum + value, best_count, best_sum);
+            used[j] = 0;
+        }
+    }
+}
+
+}  // namespace
+
+// The greedy choice (track 0 takes its nearest measurement) leaves track 1 unassigned
+TEST(AssignmentSolverTest, TestBeatsGreedy) {
+    std::vector<float> cost = {
+        1.0f, 2.0f,
+        kNotGated, 3.0f,
+    };
+    AssignmentSolver solver;
+    std::vector<int> row_to_col;
+    EXPECT_EQ(solver.Solve(cost, 2, 2, row_to_col), 2);
+    EXPECT_EQ(row_to_col, (std::vector<int>{0, 1}));
+}
+
+// Random gated problems match exhaustive search in assignment count and total cost
+TEST(AssignmentSolverTest, TestMatchesBruteForce) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> uniform(0.0f, 10.0f);
+    AssignmentSolver solver;
+    for (int trial = 0; trial < 200; ++trial) {
+        int rows = 1 + trial % 6;
+        int cols = 1 + (trial / 6) % 7;
+        std::vector<float> cost(rows * cols);
+        for (float& value : cost) {
+            value = uniform(rng) < 4.0f ? kNotGated : uniform(rng);
+        }
+
+        std::vector<int> row_to_col;
+        int count = solver.Solve(cost, rows, cols, row_to_col);
+        double sum = 0.0;
+        std::vector<int> used(cols, 0);
+        for (int i = 0; i < rows; ++i) {
+            if (row_to_col[i] >= 0) {
+                ASSERT_NE(cost[i * cols + row_to_col[i]], kNotGated);
+                ASSERT_EQ(used[row_to_col[i]]++, 0);
+                sum += cost[i * cols + row_to_col[i]];
+            }
+        }
+
+        std::vector<char> flags(cols, 0);
+        int best_count = -1;
+        double best_sum = 0.0;
+        BruteForce(cost, rows, cols, 0, flags, 0, 0.0, best_count, best_sum);
+        EXPECT_EQ(count, best_count) << "trial " << trial;
+        EXPECT_NEAR(sum, best_sum, 1e-4) << "trial " << trial;
+    }
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
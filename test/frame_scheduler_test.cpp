@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <omp.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "frame_scheduler.h"
+
+class FrameSchedulerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // 单线程执行，任务顺序可预期
+        threads_ = omp_get_max_threads();
+        omp_set_num_threads(1);
+    }
+
+    void TearDown() override {
+        omp_set_num_threads(threads_);
+    }
+
+    int threads_ = 1;
+};
+
+// Tasks run by tier first, then by descending priority
+TEST_F(FrameSchedulerTest, TestPriorityOrder) {
+    FrameScheduler scheduler;
+    std::vector<ScheduledTask> tasks = {
+        {0, 1, 5.0},
+        {1, 0, 0.2},
+        {2, 0, 0.9},
+        {3, 1, 7.0},
+    };
+    std::vector<int> order;
+    auto deadline = FrameScheduler::Clock::now() + std::chrono::seconds(10);
+    EXPECT_EQ(scheduler.Run(tasks, deadline, [&](int index) { order.push_back(index); }), 0);
+    EXPECT_EQ(order, (std::vector<int>{2, 1, 3, 0}));
+    EXPECT_EQ(scheduler.GetStats().frames, 1u);
+    EXPECT_EQ(scheduler.GetStats().deadline_misses, 0u);
+}
+
+// Work not started by the deadline is deferred and runs first in its tier on the next frame
+TEST_F(FrameSchedulerTest, TestDeferredWorkRunsNextFrame) {
+    FrameScheduler scheduler;
+    auto make_tasks = []() {
+        return std::vector<ScheduledTask>{{0, 0, 3.0}, {1, 0, 2.0}, {2, 1, 1.0}};
+    };
+    std::vector<int> order;
+    auto slow_work = [&](int index) {
+        order.push_back(index);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    };
+
+    std::vector<ScheduledTask> tasks = make_tasks();
+    int deferred = scheduler.Run(tasks, FrameScheduler::Clock::now() + std::chrono::milliseconds(5), slow_work);
+    EXPECT_EQ(deferred, 2);
+    EXPECT_EQ(order, (std::vector<int>{0}));
+    EXPECT_FALSE(scheduler.IsDeferred(0));
+    EXPECT_TRUE(scheduler.IsDeferred(1));
+    EXPECT_TRUE(scheduler.IsDeferred(2));
+    EXPECT_EQ(scheduler.GetStats().deadline_misses, 1u);
+    EXPECT_EQ(scheduler.GetStats().deferred_tasks, 2u);
+
+    order.clear();
+    tasks = make_tasks();
+    scheduler.Run(tasks, FrameScheduler::Clock::now() + std::chrono::seconds(10), slow_work);
+    EXPECT_EQ(order, (std::vector<int>{1, 0, 2}));
+    EXPECT_FALSE(scheduler.IsDeferred(1));
+    EXPECT_FALSE(scheduler.IsDeferred(2));
+}
+
+TEST_F(FrameSchedulerTest, TestDeadlineFromCameraPeriod) {
+    FrameSchedulerConfig config;
+    config.period_fraction = 0.5;
+    FrameScheduler scheduler(config);
+    EXPECT_DOUBLE_EQ(scheduler.GetDeadlineMs(100), 5.0);
+    EXPECT_DOUBLE_EQ(scheduler.GetDeadlineMs(0), config.default_period_ms * 0.5);
+    config.deadline_ms = 3.0;
+    scheduler.SetConfig(config);
+    EXPECT_DOUBLE_EQ(scheduler.GetDeadlineMs(100), 3.0);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -9,6 +9,7 @@
 #include <atomic>
 #include <opencv2/opencv.hpp>
 #include "camera_control.h"
+#include "frame_recorder.h"
 
 struct ImageData {
     cv::Mat frame;
@@ -92,14 +93,16 @@ private:
 
 int main(int argc, char** argv) {
     // 检查参数
-    if (argc != 3) {
-        std::cout << "Usage: " << argv[0] << " <num_images> <save_dir>" << std::endl;
+    if (argc != 3 && !(argc == 4 && std::string(argv[3]) == "--raw")) {
+        std::cout << "Usage: " << argv[0] << " <num_images> <save_dir> [--raw]" << std::endl;
         std::cout << "Example: " << argv[0] << " 60 ./test_images" << std::endl;
+        std::cout << "  --raw  record undemosaiced frames into <save_dir>/capture.btraw" << std::endl;
         return -1;
     }
 
     int num_images = std::stoi(argv[1]);
     std::string save_dir = argv[2];
+    bool raw_mode = (argc == 4);
 
     // 创建保存目录
     std::filesystem::create_directories(save_dir);
@@ -116,6 +119,44 @@ int main(int argc, char** argv) {
     std::cout << "Camera information:" << std::endl;
     std::cout << camera.GetInfo() << std::endl;
 
+    if (raw_mode) {
+        // 原始帧模式：按传感器原生格式顺序写入，不做去马赛克和压缩
+        RawRecordingInfo info;
+        info.width = camera.GetWidth();
+        info.height = camera.GetHeight();
+        info.pixel_format = camera.GetCaps().native_format;
+        info.fps = camera.GetFps();
+        info.source_type = CameraSourceType::HUARUI_CAMERA;
+
+        std::string raw_path = save_dir + "/capture.btraw";
+        FrameRecorder recorder;
+        if (!recorder.Open(raw_path, info)) {
+            camera.Close();
+            return -1;
+        }
+
+        RawFrame raw_frame;
+        for (int i = 0; i < num_images; ++i) {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            if (!camera.CaptureRaw(raw_frame)) {
+                std::cerr << "Failed to capture image " << i + 1 << std::endl;
+                continue;
+            }
+            recorder.Submit(raw_frame);
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::high_resolution_clock::now() - start_time);
+            std::cout << "\rFrames: " << i + 1 << "/" << num_images
+                      << ", Capture time: " << duration.count() << "ms\n" << std::flush;
+        }
+
+        recorder.Close();
+        camera.Close();
+        FrameRecorderStats stats = recorder.GetStats();
+        std::cout << "Capture completed. " << stats.written << " raw frames saved to " << raw_path
+                  << " (dropped: " << stats.dropped << ", write errors: " << stats.write_errors << ")" << std::endl;
+        return 0;
+    }
+
     // 创建图像保存器
     ImageSaver image_saver;
 
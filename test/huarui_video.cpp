@@ -10,6 +10,7 @@
 #include <signal.h>
 #include <opencv2/opencv.hpp>
 #include "camera_control.h"
+#include "frame_recorder.h"
 
 std::atomic<bool> g_running(true);
 
@@ -127,18 +128,76 @@ private:
     std::chrono::high_resolution_clock::time_point start_time_;
 };
 
+// 无损录制原始帧，直到收到 Ctrl+C
+int RecordRaw(std::string output_file) {
+    std::filesystem::path output_path(output_file);
+    output_path.replace_extension(".btraw");
+    output_file = output_path.string();
+
+    BallTrackerCamera camera;
+    if (!camera.Open("", 4096, 3000, 30, CameraSourceType::HUARUI_CAMERA)) {
+        std::cerr << "Failed to open camera!" << std::endl;
+        return -1;
+    }
+    std::cout << camera.GetInfo() << std::endl;
+
+    RawRecordingInfo info;
+    info.width = camera.GetWidth();
+    info.height = camera.GetHeight();
+    info.pixel_format = camera.GetCaps().native_format;
+    info.fps = camera.GetFps();
+    info.source_type = CameraSourceType::HUARUI_CAMERA;
+
+    FrameRecorder recorder;
+    if (!recorder.Open(output_file, info)) {
+        camera.Close();
+        return -1;
+    }
+
+    std::cout << "Raw recording started. Press Ctrl+C to stop." << std::endl;
+    RawFrame raw_frame;
+    int frame_count = 0;
+    while (g_running) {
+        if (!camera.CaptureRaw(raw_frame)) {
+            std::cerr << "Failed to capture frame" << std::endl;
+            break;
+        }
+        recorder.Submit(raw_frame);
+        if (++frame_count % 30 == 0) {
+            FrameRecorderStats stats = recorder.GetStats();
+            std::cout << "\rFrames: " << frame_count << ", written: " << stats.written
+                      << ", dropped: " << stats.dropped << std::flush;
+        }
+    }
+
+    std::cout << "\nStopping recording..." << std::endl;
+    recorder.Close();
+    camera.Close();
+
+    FrameRecorderStats stats = recorder.GetStats();
+    std::cout << "Recording completed. Written: " << stats.written
+              << ", dropped: " << stats.dropped
+              << ", write errors: " << stats.write_errors << std::endl;
+    std::cout << "Raw recording saved to: " << output_file << std::endl;
+    return 0;
+}
+
 int main(int argc, char** argv) {
     // 注册信号处理
     signal(SIGINT, signalHandler);
 
     // 检查参数
-    if (argc != 2) {
-        std::cout << "Usage: " << argv[0] << " <output_video>" << std::endl;
+    if (argc != 2 && !(argc == 3 && std::string(argv[2]) == "--raw")) {
+        std::cout << "Usage: " << argv[0] << " <output_video> [--raw]" << std::endl;
         std::cout << "Example: " << argv[0] << " output.avi" << std::endl;
+        std::cout << "  --raw  record undemosaiced frames losslessly into <output>.btraw" << std::endl;
         return -1;
     }
 
     std::string output_file = argv[1];
+    if (argc == 3) {
+        return RecordRaw(output_file);
+    }
 
     // 检查输出文件扩展名
     std::filesystem::path output_path(output_file);
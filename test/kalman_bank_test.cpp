@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include "kalman_bank.h"
+
+namespace {
+
+// 直接按矩阵公式实现的匀速卡尔曼滤波，作为参照
+struct ReferenceKalman {
+    double s[4] = {0, 0, 0, 0};
+    double p[4][4] = {};
+    double q = 0.01;
+    double r = 0.1;
+
+    void Reset(double x, double y, double initial) {
+        s[0] = x; s[1] = y; s[2] = 0; s[3] = 0;
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                p[i][j] = i == j ? initial : 0.0;
+            }
+        }
+    }
+
+    void Predict() {
+        const double f[4][4] = {{1, 0, 1, 0}, {0, 1, 0, 1}, {0, 0, 1, 0}, {0, 0, 0, 1}};
+        double ns[4] = {};
+        double fp[4][4] = {};
+        double np[4][4] = {};
+        for (int i = 0; i < 4; ++i) {
+            for (int k = 0; k < 4; ++k) {
+                ns[i] += f[i][k] * s[k];
+                for (int j = 0; j < 4; ++j) {
+                    fp[i][j] += f[i][k] * p[k][j];
+                }
+            }
+        }
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                for (int k = 0; k < 4; ++k) {
+                    np[i][j] += fp[i][k] * f[j][k];
+                }
+                p[i][j] = np[i][j] + (i == j ? q : 0.0);
+            }
+            s[i] = ns[i];
+        }
+    }
+
+    void Correct(double zx, double zy) {
+        double s00 = p[0][0] + r, s01 = p[0][1], s11 = p[1][1] + r;
+        double det = s00 * s11 - s01 * s01;
+        double inv[2][2] = {{s11 / det, -s01 / det}, {-s01 / det, s00 / det}};
+        double k[4][2];
+        for (int i = 0; i < 4; ++i) {
+            k[i][0] = p[i][0] * inv[0][0] + p[i][1] * inv[1][0];
+            k[i][1] = p[i][0] * inv[0][1] + p[i][1] * inv[1][1];
+        }
+        double e0 = zx - s[0], e1 = zy - s[1];
+        double np[4][4];
+        for (int i = 0; i < 4; ++i) {
+            s[i] += k[i][0] * e0 + k[i][1] * e1;
+            for (int j = 0; j < 4; ++j) {
+                np[i][j] = p[i][j] - k[i][0] * p[0][j] - k[i][1] * p[1][j];
+            }
+        }
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                p[i][j] = np[i][j];
+            }
+        }
+    }
+};
+
+}  // namespace
+
+// Batch updates over many lanes match a plain matrix implementation lane by lane
+TEST(KalmanBankTest, TestBatchMatchesReference) {
+    const int lanes = 19;  // 不是批大小的整数倍
+    KalmanBank bank;
+    std::vector<ReferenceKalman> reference(lanes);
+    for (int i = 0; i < lanes; ++i) {
+        ASSERT_EQ(bank.AddLane(), i);
+        bank.Reset(i, 10.0f * i, 5.0f * i);
+        reference[i].Reset(10.0 * i, 5.0 * i, 0.1);
+    }
+
+    for (int frame = 0; frame < 50; ++frame) {
+        for (int i = 0; i < lanes; ++i) {
+            // 部分通道跳过预测或测量
+            if ((i + frame) % 5 != 0) {
+                bank.RequestPredict(i);
+                reference[i].Predict();
+            }
+            if ((i + frame) % 3 != 0) {
+                double zx = 10.0 * i + 2.0 * frame + std::sin(frame + i);
+                double zy = 5.0 * i - 1.5 * frame + std::cos(frame * 0.7 + i);
+                bank.SetMeasurement(i, static_cast<float>(zx), static_cast<float>(zy));
+                reference[i].Correct(static_cast<float>(zx), static_cast<float>(zy));
+            }
+        }
+        bank.PredictBatch();
+        bank.CorrectBatch();
+    }
+
+    for (int i = 0; i < lanes; ++i) {
+        EXPECT_NEAR(bank.X(i), reference[i].s[0], 1e-2) << "lane " << i;
+        EXPECT_NEAR(bank.Y(i), reference[i].s[1], 1e-2) << "lane " << i;
+        EXPECT_NEAR(bank.Vx(i), reference[i].s[2], 1e-3) << "lane " << i;
+        EXPECT_NEAR(bank.Vy(i), reference[i].s[3], 1e-3) << "lane " << i;
+        for (int k = 0; k < 4; ++k) {
+            EXPECT_NEAR(bank.Variance(i, k), reference[i].p[k][k], 1e-4) << "lane " << i;
+        }
+    }
+}
+
+// Single-lane updates follow a ball moving at constant velocity
+TEST(KalmanBankTest, TestSingleLaneConverges) {
+    KalmanBank bank;
+    int lane = bank.AddLane();
+    bank.Reset(lane, 0.0f, 0.0f);
+    for (int frame = 1; frame <= 100; ++frame) {
+        bank.Predict(lane);
+        bank.Correct(lane, 3.0f * frame, -2.0f * frame);
+    }
+    EXPECT_NEAR(bank.Vx(lane), 3.0f, 0.05f);
+    EXPECT_NEAR(bank.Vy(lane), -2.0f, 0.05f);
+    EXPECT_NEAR(bank.X(lane), 300.0f, 0.5f);
+    EXPECT_LT(bank.Variance(lane, 0), 0.1f);
+}
+
+// The gate distance is the squared Mahalanobis distance under the innovation covariance
+TEST(KalmanBankTest, TestMahalanobisDistance) {
+    KalmanNoise noise;
+    KalmanBank bank(noise);
+    int lane = bank.AddLane();
+    bank.Reset(lane, 10.0f, 20.0f);
+    float variance = noise.initial + noise.measurement;
+    EXPECT_NEAR(bank.Mahalanobis2(lane, 13.0f, 24.0f), 25.0f / variance, 1e-3f);
+    EXPECT_NEAR(bank.Mahalanobis2(lane, 13.0f, 24.0f, 4.0f), 25.0f / (variance + 4.0f), 1e-4f);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,188 @@
+#include <chrono>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "metrics.h"
+#include "metrics_http_server.h"
+
+// Every value falls in a bucket whose bounds are within the histogram precision
+TEST(MetricsTest, TestHistogramBuckets) {
+    for (uint64_t value : {0ull, 1ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull, 1ull << 39}) {
+        int index = LatencyHistogram::BucketIndex(value);
+        ASSERT_GE(index, 0);
+        ASSERT_LT(index, LatencyHistogram::kBucketCount);
+        uint64_t upper = LatencyHistogram::BucketUpperBound(index);
+        EXPECT_GE(upper, value);
+        EXPECT_LE(static_cast<double>(upper), value * (1.0 + 1.0 / LatencyHistogram::kSubBuckets) + 1.0);
+        if (index > 0) {
+            EXPECT_LT(LatencyHistogram::BucketUpperBound(index - 1), value);
+        }
+    }
+    EXPECT_EQ(LatencyHistogram::BucketIndex(~0ull), LatencyHistogram::kBucketCount - 1);
+}
+
+// Quantiles of a uniform distribution of latencies are within the bucket precision
+TEST(MetricsTest, TestHistogramQuantiles) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.QuantileNs(0.5), 0u);
+    for (int us = 1; us <= 10000; ++us) {
+        histogram.Record(us * 1000LL);
+    }
+    histogram.Record(-5);
+    EXPECT_EQ(histogram.Count(), 10001u);
+    EXPECT_EQ(histogram.MaxNs(), 10000000u);
+    EXPECT_NEAR(static_cast<double>(histogram.QuantileNs(0.5)), 5e6, 5e6 * 0.07);
+    EXPECT_NEAR(static_cast<double>(histogram.QuantileNs(0.99)), 9.9e6, 9.9e6 * 0.07);
+    EXPECT_EQ(histogram.QuantileNs(1.0), 10000000u);
+    EXPECT_EQ(histogram.SumNs(), 10000ull * 10001 / 2 * 1000);
+}
+
+// Counters and histograms recorded from several threads lose no updates
+TEST(MetricsTest, TestConcurrentRecording) {
+    MetricsRegistry registry;
+    MetricCounter& counter = registry.Counter("test_total", "Test counter");
+    LatencyHistogram& histogram = registry.Histogram("test_seconds", "Test latency");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&counter, &histogram] {
+            for (int i = 0; i < 100000; ++i) {
+                counter.Add();
+                histogram.Record(i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(counter.Value(), 400000u);
+    EXPECT_EQ(histogram.Count(), 400000u);
+    EXPECT_EQ(&registry.Counter("test_total", "Test counter"), &counter);
+}
+
+// Snapshot and Prometheus text list every series, grouped by name
+TEST(MetricsTest, TestSnapshotAndExposition) {
+    MetricsRegistry registry;
+    registry.Counter("ball_tracker_ball_lost_total", "Times the ball in a tracker slot was lost", "slot=\"1\"").Add(2);
+    registry.Counter("ball_tracker_frames_total", "Frames").Add(7);
+    registry.Counter("ball_tracker_ball_lost_total", "Times the ball in a tracker slot was lost", "slot=\"2\"").Add();
+    registry.Gauge("ball_tracker_fps", "Capture rate").Set(59.5);
+    LatencyHistogram& stage = registry.Histogram("ball_tracker_stage_seconds", "Stage time", "stage=\"detect\"");
+    stage.Record(2000000);
+
+    MetricsSnapshot snapshot = registry.Snapshot();
+    ASSERT_EQ(snapshot.counters.size(), 3u);
+    EXPECT_EQ(snapshot.counters[1].name, "ball_tracker_frames_total");
+    EXPECT_DOUBLE_EQ(snapshot.counters[1].value, 7.0);
+    ASSERT_EQ(snapshot.gauges.size(), 1u);
+    EXPECT_DOUBLE_EQ(snapshot.gauges[0].value, 59.5);
+    ASSERT_EQ(snapshot.latencies.size(), 1u);
+    EXPECT_EQ(snapshot.latencies[0].labels, "stage=\"detect\"");
+    EXPECT_EQ(snapshot.latencies[0].count, 1u);
+    EXPECT_NEAR(snapshot.latencies[0].p50_ms, 2.0, 0.2);
+
+    std::string text = registry.RenderPrometheus();
+    EXPECT_NE(text.find("# TYPE ball_tracker_ball_lost_total counter\n"
+                        "ball_tracker_ball_lost_total{slot=\"1\"} 2\n"
+                        "ball_tracker_ball_lost_total{slot=\"2\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("ball_tracker_frames_total 7\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE ball_tracker_fps gauge\nball_tracker_fps 59.5\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE ball_tracker_stage_seconds summary\n"), std::string::npos);
+    EXPECT_NE(text.find("ball_tracker_stage_seconds{stage=\"detect\",quantile=\"0.5\"} 0.002"), std::string::npos);
+    EXPECT_NE(text.find("ball_tracker_stage_seconds_count{stage=\"detect\"} 1\n"), std::string::npos);
+}
+
+#ifndef _WIN32
+
+namespace {
+
+std::string HttpGet(int port, const std::string& path) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return "";
+    }
+    std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    send(fd, request.data(), request.size(), 0);
+    std::string response;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, static_cast<size_t>(n));
+    }
+    close(fd);
+    return response;
+}
+
+}  // namespace
+
+// The endpoint serves the registry at /metrics and nothing else
+TEST(MetricsTest, TestHttpEndpoint) {
+    MetricsRegistry registry;
+    registry.Counter("ball_tracker_frames_total", "Frames").Add(3);
+    MetricsHttpServer server;
+    ASSERT_TRUE(server.Start(&registry, 0, "127.0.0.1"));
+    ASSERT_GT(server.GetPort(), 0);
+
+    std::string response = HttpGet(server.GetPort(), "/metrics");
+    EXPECT_EQ(response.compare(0, 15, "HTTP/1.0 200 OK"), 0);
+    EXPECT_NE(response.find("text/plain; version=0.0.4"), std::string::npos);
+    EXPECT_NE(response.find("\r\n\r\n# HELP ball_tracker_frames_total Frames\n"), std::string::npos);
+    EXPECT_NE(response.find("ball_tracker_frames_total 3\n"), std::string::npos);
+
+    // 指标实时更新
+    registry.Counter("ball_tracker_frames_total", "Frames").Add();
+    EXPECT_NE(HttpGet(server.GetPort(), "/metrics").find("ball_tracker_frames_total 4\n"), std::string::npos);
+
+    EXPECT_EQ(HttpGet(server.GetPort(), "/").compare(0, 12, "HTTP/1.0 404"), 0);
+    server.Stop();
+    EXPECT_FALSE(server.IsRunning());
+}
+
+// A scraper disconnecting before the response must not kill the process with SIGPIPE
+TEST(MetricsTest, TestClientClosesEarly) {
+    MetricsRegistry registry;
+    registry.Counter("ball_tracker_frames_total", "Frames").Add();
+    MetricsHttpServer server;
+    ASSERT_TRUE(server.Start(&registry, 0, "127.0.0.1"));
+
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(server.GetPort()));
+        inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+        ASSERT_EQ(connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), 0);
+        // 请求头不完整，服务端继续读取时收到 RST，随后的应答写入已重置的连接
+        std::string request = "GET /metrics HTTP/1.1\r\n";
+        send(fd, request.data(), request.size(), 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        linger abort_close{1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_LINGER, &abort_close, sizeof(abort_close));
+        close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    // 进程仍在，服务端继续应答
+    EXPECT_NE(HttpGet(server.GetPort(), "/metrics").find("ball_tracker_frames_total 1\n"), std::string::npos);
+    EXPECT_TRUE(server.IsRunning());
+}
+
+#endif  // _WIN32
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "offline_track_builder.h"
+
+// Two balls of the same color detected in parallel segments and linked; a short miss is bridged
+TEST(OfflineTrackBuilderTest, TestSegmentedLinking) {
+    const int num_frames = 120;
+    std::vector<cv::Mat> images;
+    for (int f = 0; f < num_frames; ++f) {
+        cv::Mat image = cv::Mat::zeros(240, 320, CV_8UC3);
+        // 球 1 在第 40~42 帧被遮挡
+        if (f < 40 || f > 42) {
+            cv::circle(image, cv::Point(20 + 2 * f, 60), 8, cv::Scalar(0, 255, 0), cv::FILLED);
+        }
+        cv::circle(image, cv::Point(300 - 2 * f, 180), 8, cv::Scalar(0, 255, 0), cv::FILLED);
+        images.push_back(image);
+    }
+
+    OfflineInitTrackConfig config;
+    config.segments = 4;
+    config.min_segment_frames = 16;
+    config.detect_scale = 2;
+    config.max_gap_frames = 5;
+    OfflineTrackBuilder builder(config);
+    cv::Scalar_<double> lower(50, 100, 100);
+    cv::Scalar_<double> upper(70, 255, 255);
+    builder.AddBall(1, lower, upper, cv::Point_<float>(20.0f, 60.0f));
+    builder.AddBall(2, lower, upper, cv::Point_<float>(300.0f, 180.0f));
+
+    builder.Detect(images);
+    EXPECT_EQ(builder.GetSegmentCount(), 4);
+    ASSERT_EQ(builder.GetFrameCount(), num_frames);
+    EXPECT_EQ(builder.GetFrameSize(), cv::Size(320, 240));
+
+    builder.Link(AssociationConfig(), 500.0, 200);
+    const OfflineBallTrack& first = builder.GetTrack(0);
+    EXPECT_EQ(first.id, 1);
+    EXPECT_EQ(first.success_frames, num_frames - 3);
+    EXPECT_EQ(first.filled_frames, 3);
+    EXPECT_FALSE(first.lost);
+    ASSERT_EQ(first.points.size(), static_cast<size_t>(num_frames));
+    for (int f = 0; f < num_frames; ++f) {
+        EXPECT_NEAR(first.points[f].x, 20.0f + 2.0f * f, 1.5f);
+        EXPECT_NEAR(first.points[f].y, 60.0f, 1.5f);
+    }
+
+    // 同色的另一个球不会被当作球 1 的检测
+    const OfflineBallTrack& second = builder.GetTrack(1);
+    EXPECT_EQ(second.success_frames, num_frames);
+    EXPECT_EQ(second.filled_frames, 0);
+    ASSERT_EQ(second.points.size(), static_cast<size_t>(num_frames));
+    EXPECT_NEAR(second.points.back().x, 300.0f - 2.0f * (num_frames - 1), 1.5f);
+    EXPECT_NEAR(second.points.back().y, 180.0f, 1.5f);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+
+#include "pixel_to_arm_map.h"
+
+namespace {
+
+CameraCalibration TestCalibration() {
+    CameraCalibration calibration;
+    calibration.image_width = 1280;
+    calibration.image_height = 1024;
+    calibration.fx = 1100.0;
+    calibration.fy = 1080.0;
+    calibration.cx = 652.0;
+    calibration.cy = 505.0;
+    calibration.k1 = -0.21;
+    calibration.k2 = 0.06;
+    calibration.p1 = 0.001;
+    calibration.p2 = -0.0008;
+    calibration.k3 = -0.01;
+    calibration.camera_x = 300.0;
+    calibration.camera_y = -150.0;
+    return calibration;
+}
+
+// 机械臂坐标投影到带畸变的像素坐标，作为查找表的参照
+void ProjectToPixel(const CameraCalibration& c, double camera_height, double x, double y, double height,
+                    double& u, double& v) {
+    const double* r = c.rotation;
+    double px = x - c.camera_x;
+    double py = y - c.camera_y;
+    double pz = height - camera_height;
+    double xc = r[0] * px + r[3] * py + r[6] * pz;
+    double yc = r[1] * px + r[4] * py + r[7] * pz;
+    double zc = r[2] * px + r[5] * py + r[8] * pz;
+    double xn = xc / zc;
+    double yn = yc / zc;
+    double r2 = xn * xn + yn * yn;
+    double radial = 1.0 + ((c.k3 * r2 + c.k2) * r2 + c.k1) * r2;
+    double xd = xn * radial + 2.0 * c.p1 * xn * yn + c.p2 * (r2 + 2.0 * xn * xn);
+    double yd = yn * radial + c.p1 * (r2 + 2.0 * yn * yn) + 2.0 * c.p2 * xn * yn;
+    u = c.fx * xd + c.cx;
+    v = c.fy * yd + c.cy;
+}
+
+}  // namespace
+
+// Points across a distorted image map back to the arm plane they were projected from
+TEST(PixelToArmMapTest, TestToArm) {
+    CameraCalibration calibration = TestCalibration();
+    PixelToArmMap map;
+    ASSERT_TRUE(map.Build(calibration));
+    const double camera_height = 1200.0;
+    map.SetCameraHeight(camera_height);
+
+    for (double height : {0.0, 150.0}) {
+        for (double x = 0.0; x <= 600.0; x += 60.0) {
+            for (double y = -400.0; y <= 100.0; y += 50.0) {
+                double u, v;
+                ProjectToPixel(calibration, camera_height, x, y, height, u, v);
+                if (u < 0.0 || v < 0.0 || u >= calibration.image_width || v >= calibration.image_height) {
+                    continue;
+                }
+                double mapped_x, mapped_y;
+                ASSERT_TRUE(map.ToArm(u, v, height, mapped_x, mapped_y));
+                EXPECT_NEAR(mapped_x, x, 0.2);
+                EXPECT_NEAR(mapped_y, y, 0.2);
+            }
+        }
+    }
+
+    // 高于相机的平面在相机后方，无法映射
+    double x, y;
+    EXPECT_FALSE(map.ToArm(640.0, 512.0, camera_height + 10.0, x, y));
+}
+
+// An image velocity maps to the arm velocity that produced it
+TEST(PixelToArmMapTest, TestVelocityToArm) {
+    CameraCalibration calibration = TestCalibration();
+    PixelToArmMap map;
+    ASSERT_TRUE(map.Build(calibration));
+    map.SetCameraHeight(1200.0);
+
+    double u0, v0, u1, v1;
+    ProjectToPixel(calibration, 1200.0, 97.5, -52.0, 80.0, u0, v0);
+    ProjectToPixel(calibration, 1200.0, 102.5, -48.0, 80.0, u1, v1);
+    double vx, vy;
+    ASSERT_TRUE(map.VelocityToArm(0.5 * (u0 + u1), 0.5 * (v0 + v1), u1 - u0, v1 - v0, 80.0, vx, vy));
+    EXPECT_NEAR(vx, 5.0, 0.05);
+    EXPECT_NEAR(vy, 4.0, 0.05);
+}
+
+// A calibration file is read into the calibration fields
+TEST(PixelToArmMapTest, TestLoadCalibration) {
+    const char* path = "pixel_to_arm_map_test.json";
+    {
+        std::ofstream file(path);
+        file << R"({"image_size": [1280, 1024],
+                   "camera_matrix": [1100, 0, 652, 0, 1080, 505, 0, 0, 1],
+                   "distortion": [-0.21, 0.06, 0.001, -0.0008, -0.01],
+                   "camera_position": [300, -150],
+                   "grid_step": 8})";
+    }
+    CameraCalibration calibration;
+    ASSERT_TRUE(PixelToArmMap::LoadCalibration(path, calibration));
+    std::remove(path);
+    EXPECT_EQ(calibration.image_width, 1280);
+    EXPECT_DOUBLE_EQ(calibration.fy, 1080.0);
+    EXPECT_DOUBLE_EQ(calibration.cy, 505.0);
+    EXPECT_DOUBLE_EQ(calibration.p2, -0.0008);
+    EXPECT_DOUBLE_EQ(calibration.camera_y, -150.0);
+    EXPECT_DOUBLE_EQ(calibration.rotation[8], -1.0);
+    EXPECT_EQ(calibration.grid_step, 8);
+
+    EXPECT_FALSE(PixelToArmMap::LoadCalibration("missing_calibration.json", calibration));
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
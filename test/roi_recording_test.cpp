@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <opencv2/opencv.hpp>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "ball_tracker_algo.h"
+#include "roi_recording.h"
+#include "synthetic_frame_source.h"
+
+class RoiRecordingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::filesystem::create_directories("test_data");
+        path_ = "test_data/roi_recording_test.btroi";
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path_);
+    }
+
+    std::unique_ptr<BallTracker> MakeTracker(const cv::Point_<double>& init_pos) {
+        return std::make_unique<BallTracker>(1, "test_ball", cv::Scalar(37.30, 181.83, 252.62),
+                                             cv::Scalar(0.57, 19.56, 1.84), init_pos);
+    }
+
+    std::string path_;
+};
+
+// A tracker fed with composed replay frames must reproduce the recorded session
+TEST_F(RoiRecordingTest, TestReplayReproducesTracking) {
+    SyntheticSourceConfig config;
+    config.num_frames = 30;
+    SyntheticFrameSource source(config);
+    ASSERT_TRUE(source.Open("", 320, 240, 30));
+
+    RawFrame frame;
+    ASSERT_TRUE(source.Read(frame));
+    cv::Point_<double> init_pos = source.GetGroundTruth();
+
+    RoiRecordingOptions options;
+    options.full_frame_interval = 10;
+    RoiRecorder recorder;
+    ASSERT_TRUE(recorder.Open(path_, 320, 240, options));
+
+    auto tracker = MakeTracker(init_pos);
+    std::vector<BallTrackerSnapshot> recorded;
+    uint64_t index = 0;
+    do {
+        tracker->UpdateWithImage(frame.image);
+        std::vector<BallTrackerSnapshot> snapshots{tracker->GetSnapshot()};
+        ASSERT_TRUE(recorder.RecordFrame(index++, frame.timestamp_ns, frame.image, snapshots));
+        recorded.push_back(snapshots[0]);
+    } while (source.Read(frame));
+    recorder.Close();
+    EXPECT_EQ(recorder.GetRecordedFrames(), recorded.size());
+    EXPECT_EQ(recorder.GetDroppedFrames(), 0u);
+
+    RoiReplay replay;
+    ASSERT_TRUE(replay.Open(path_));
+    ASSERT_EQ(replay.GetFrameCount(), recorded.size());
+
+    RoiRecordedFrame record;
+    ASSERT_TRUE(replay.ReadFrame(10, record));
+    EXPECT_TRUE(record.header.flags & ROI_FRAME_HAS_FULL_FRAME);
+    ASSERT_TRUE(replay.ReadFrame(11, record));
+    EXPECT_FALSE(record.header.flags & ROI_FRAME_HAS_FULL_FRAME);
+    ASSERT_EQ(record.balls.size(), 1u);
+    EXPECT_FALSE(record.patches[0].empty());
+
+    auto replay_tracker = MakeTracker(init_pos);
+    cv::Mat image;
+    for (uint64_t i = 0; i < replay.GetFrameCount(); ++i) {
+        ASSERT_TRUE(replay.ComposeFrame(i, image));
+        replay_tracker->UpdateWithImage(image);
+        BallTrackerSnapshot snapshot = replay_tracker->GetSnapshot();
+        EXPECT_EQ(snapshot.detected, recorded[i].detected) << "frame " << i;
+        EXPECT_EQ(snapshot.search_roi, recorded[i].search_roi) << "frame " << i;
+        EXPECT_FLOAT_EQ(snapshot.state[0], recorded[i].state[0]) << "frame " << i;
+        EXPECT_FLOAT_EQ(snapshot.state[1], recorded[i].state[1]) << "frame " << i;
+    }
+}
+
+// Losing a ball stores a full frame; an unclosed file is indexed by scanning
+TEST_F(RoiRecordingTest, TestLostEventAndRecovery) {
+    cv::Mat image(240, 320, CV_8UC3, cv::Scalar(40, 40, 40));
+    BallTrackerSnapshot snapshot{};
+    snapshot.id = 1;
+    snapshot.search_roi = cv::Rect(100, 80, 64, 64);
+
+    RoiRecordingOptions options;
+    options.full_frame_interval = 0;
+    {
+        RoiRecorder recorder;
+        ASSERT_TRUE(recorder.Open(path_, 320, 240, options));
+        for (int i = 0; i < 4; ++i) {
+            snapshot.detected = (i < 2);
+            ASSERT_TRUE(recorder.RecordFrame(i, i, image, {snapshot}));
+        }
+        recorder.Close();
+    }
+
+    RoiReplay replay;
+    ASSERT_TRUE(replay.Open(path_));
+    ASSERT_EQ(replay.GetFrameCount(), 4u);
+    RoiRecordedFrame record;
+    ASSERT_TRUE(replay.ReadFrame(1, record));
+    EXPECT_EQ(record.header.flags, 0u);
+    ASSERT_TRUE(replay.ReadFrame(2, record));
+    EXPECT_TRUE(record.header.flags & ROI_FRAME_LOST_EVENT);
+    EXPECT_FALSE(record.full_frame.empty());
+    EXPECT_EQ(cv::norm(record.full_frame, image, cv::NORM_INF), 0.0);
+    ASSERT_TRUE(replay.ReadFrame(3, record));
+    EXPECT_FALSE(record.header.flags & ROI_FRAME_LOST_EVENT);
+    replay.Close();
+
+    // Simulate a crash: drop the index and truncate the last record
+    RoiRecordingHeader header = replay.GetHeader();
+    uint64_t truncated_size = header.index_offset - 10;
+    header.index_offset = 0;
+    header.frame_count = 0;
+    {
+        std::fstream file(path_, std::ios::binary | std::ios::in | std::ios::out);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    std::filesystem::resize_file(path_, truncated_size);
+
+    ASSERT_TRUE(replay.Open(path_));
+    EXPECT_EQ(replay.GetFrameCount(), 3u);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "status_ring_publisher.h"
+
+#ifndef _WIN32
+
+namespace {
+
+std::string TestRingName() {
+    return "/ball_tracker_status_test_" + std::to_string(getpid());
+}
+
+std::vector<BallStatus> TestStatuses(uint64_t frame_index) {
+    std::vector<BallStatus> statuses(3);
+    for (int i = 0; i < 3; ++i) {
+        BallStatus& status = statuses[i];
+        status.id = i + 1;
+        status.x = static_cast<double>(frame_index);
+        status.y = static_cast<double>(frame_index) * 0.5 + i;
+        status.vx = 1.0;
+        status.vy = -1.0;
+        status.progress = 0.25 * i;
+        status.detected = (frame_index + i) % 2 == 0;
+        status.deferred = false;
+    }
+    return statuses;
+}
+
+// 读者进程：逐帧读取直到最后一帧，检查每帧内容完整且序号连续
+int RunReader(const std::string& name, int ready_fd, uint64_t last_sequence) {
+    StatusRingReader reader;
+    if (!reader.Open(name)) {
+        return 10;
+    }
+    char ready = 1;
+    if (write(ready_fd, &ready, 1) != 1) {
+        return 11;
+    }
+
+    uint64_t expected = 1;
+    uint64_t received = 0;
+    uint64_t total_missed = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    StatusFrame frame;
+    while (expected <= last_sequence) {
+        uint64_t missed = 0;
+        if (!reader.ReadNext(frame, missed)) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return 12;
+            }
+            continue;
+        }
+        total_missed += missed;
+        if (frame.sequence != expected + missed || frame.ball_count != 3 || frame.frame_index != frame.sequence * 10) {
+            return 13;
+        }
+        for (uint32_t i = 0; i < frame.ball_count; ++i) {
+            const StatusRingBall& ball = frame.balls[i];
+            if (ball.id != static_cast<int32_t>(i + 1) || ball.x != static_cast<float>(frame.frame_index) ||
+                ball.y != static_cast<float>(frame.frame_index * 0.5 + i) ||
+                ball.detected != ((frame.frame_index + i) % 2 == 0 ? 1 : 0) || frame.publish_ns < frame.capture_ns) {
+                return 14;
+            }
+        }
+        received++;
+        expected = frame.sequence + 1;
+    }
+    if (received + total_missed != last_sequence) {
+        return 15;
+    }
+    if (!reader.ReadLatest(frame) || frame.sequence != last_sequence) {
+        return 16;
+    }
+    return 0;
+}
+
+}  // namespace
+
+// A reader process sees every frame of a writer process complete, or counts it as overwritten
+TEST(StatusRingTest, TestTwoProcesses) {
+    const std::string name = TestRingName();
+    const uint64_t num_frames = 200000;
+    StatusRingPublisher publisher;
+    ASSERT_TRUE(publisher.Open(name, 64));
+
+    int pipe_fds[2];
+    ASSERT_EQ(pipe(pipe_fds), 0);
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        close(pipe_fds[0]);
+        _exit(RunReader(name, pipe_fds[1], num_frames));
+    }
+    close(pipe_fds[1]);
+    char ready = 0;
+    ASSERT_EQ(read(pipe_fds[0], &ready, 1), 1);
+    close(pipe_fds[0]);
+
+    for (uint64_t sequence = 1; sequence <= num_frames; ++sequence) {
+        uint64_t frame_index = sequence * 10;
+        int64_t capture_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        publisher.Publish(frame_index, capture_ns, TestStatuses(frame_index));
+    }
+
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+// A reader that falls more than a ring behind skips to the oldest frame still in the ring
+TEST(StatusRingTest, TestOverrunIsReported) {
+    const std::string name = TestRingName();
+    StatusRingPublisher publisher;
+    ASSERT_TRUE(publisher.Open(name, 4));
+    StatusRingReader reader;
+    ASSERT_TRUE(reader.Open(name));
+
+    StatusFrame frame;
+    uint64_t missed = 0;
+    EXPECT_FALSE(reader.ReadLatest(frame));
+    EXPECT_FALSE(reader.ReadNext(frame, missed));
+
+    for (uint64_t sequence = 1; sequence <= 10; ++sequence) {
+        publisher.Publish(sequence, 0, TestStatuses(sequence));
+    }
+    ASSERT_TRUE(reader.ReadNext(frame, missed));
+    EXPECT_EQ(missed, 6u);
+    EXPECT_EQ(frame.sequence, 7u);
+    for (uint64_t sequence = 8; sequence <= 10; ++sequence) {
+        ASSERT_TRUE(reader.ReadNext(frame, missed));
+        EXPECT_EQ(missed, 0u);
+        EXPECT_EQ(frame.sequence, sequence);
+    }
+    EXPECT_FALSE(reader.ReadNext(frame, missed));
+
+    // 写者关闭后对象被删除，已映射的读者仍可读取最后的数据
+    publisher.Close();
+    ASSERT_TRUE(reader.ReadLatest(frame));
+    EXPECT_EQ(frame.frame_index, 10u);
+    StatusRingReader late_reader;
+    EXPECT_FALSE(late_reader.Open(name));
+}
+
+// A second publisher does not take over a running ring unless it asks to replace it
+TEST(StatusRingTest, TestExistingRingIsKept) {
+    const std::string name = TestRingName();
+    StatusRingPublisher publisher;
+    ASSERT_TRUE(publisher.Open(name, 4));
+    publisher.Publish(1, 0, TestStatuses(1));
+
+    StatusRingPublisher second;
+    EXPECT_FALSE(second.Open(name, 4));
+    StatusRingReader reader;
+    ASSERT_TRUE(reader.Open(name));
+    StatusFrame frame;
+    ASSERT_TRUE(reader.ReadLatest(frame));
+    EXPECT_EQ(frame.frame_index, 1u);
+
+    // 显式替换（如上次异常退出遗留的对象）时新建环，新读者看到的是新环
+    ASSERT_TRUE(second.Open(name, 4, true));
+    StatusRingReader new_reader;
+    ASSERT_TRUE(new_reader.Open(name));
+    EXPECT_FALSE(new_reader.ReadLatest(frame));
+
+    // 被替换的发布者关闭时不删除新环
+    publisher.Close();
+    StatusRingReader late_reader;
+    EXPECT_TRUE(late_reader.Open(name));
+    second.Close();
+    EXPECT_FALSE(late_reader.Open(name));
+}
+
+// Balls beyond the ring capacity are dropped, the rest of the frame is published
+TEST(StatusRingTest, TestBallsBeyondCapacity) {
+    const std::string name = TestRingName();
+    StatusRingPublisher publisher;
+    ASSERT_TRUE(publisher.Open(name, 4));
+    std::vector<BallStatus> statuses(kStatusRingMaxBalls + 4, TestStatuses(1)[0]);
+    publisher.Publish(1, 0, statuses);
+
+    StatusRingReader reader;
+    ASSERT_TRUE(reader.Open(name));
+    StatusFrame frame;
+    ASSERT_TRUE(reader.ReadLatest(frame));
+    EXPECT_EQ(frame.ball_count, static_cast<uint32_t>(kStatusRingMaxBalls));
+}
+
+#endif  // _WIN32
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "track_corridor.h"
+
+// A straight trajectory becomes one span per row within the half width of the line
+TEST(TrackCorridorTest, TestSpans) {
+    TrackCorridor corridor;
+    corridor.Build({cv::Point_<float>(20.0f, 40.0f), cv::Point_<float>(120.0f, 40.0f)}, 5, cv::Size(160, 80));
+    ASSERT_FALSE(corridor.Empty());
+
+    int count;
+    const CorridorSpan* spans = corridor.RowSpans(40, count);
+    ASSERT_EQ(count, 1);
+    EXPECT_NEAR(spans[0].start, 15, 1);
+    EXPECT_NEAR(spans[0].end, 125, 1);
+    corridor.RowSpans(10, count);
+    EXPECT_EQ(count, 0);
+    corridor.RowSpans(-1, count);
+    EXPECT_EQ(count, 0);
+
+    EXPECT_TRUE(corridor.Contains(70, 43));
+    EXPECT_FALSE(corridor.Contains(70, 50));
+    EXPECT_FALSE(corridor.Contains(140, 40));
+
+    // 外接矩形只覆盖走廊在给定矩形内的部分
+    cv::Rect_<int> bounds = corridor.BoundingRect(cv::Rect_<int>(0, 0, 60, 80));
+    EXPECT_NEAR(bounds.x, 15, 1);
+    EXPECT_EQ(bounds.x + bounds.width, 60);
+    EXPECT_NEAR(bounds.y, 35, 1);
+    EXPECT_NEAR(bounds.height, 11, 1);
+    EXPECT_EQ(corridor.BoundingRect(cv::Rect_<int>(0, 60, 160, 20)).area(), 0);
+}
+
+// Thresholding matches cvtColor + inRange inside the corridor and ignores everything outside
+TEST(TrackCorridorTest, TestThreshold) {
+    cv::Mat image(120, 200, CV_8UC3, cv::Scalar(90, 90, 90));
+    cv::circle(image, cv::Point(60, 60), 10, cv::Scalar(255, 0, 0), -1);   // 轨道上的蓝球
+    cv::circle(image, cv::Point(150, 20), 10, cv::Scalar(255, 0, 0), -1);  // 轨道外的蓝色干扰物
+
+    TrackCorridor corridor;
+    corridor.Build({cv::Point_<float>(10.0f, 60.0f), cv::Point_<float>(190.0f, 60.0f)}, 15, image.size());
+
+    cv::Scalar_<double> lower(110, 200, 200);
+    cv::Scalar_<double> upper(130, 255, 255);
+    cv::Rect_<int> rect(0, 0, image.cols, image.rows);
+    cv::Mat hsv_image(image.rows, image.cols, CV_8UC3, cv::Scalar::all(255));  // 复用的缓冲区中残留上一次的内容
+    cv::Mat mask;
+    corridor.Threshold(image, rect, lower, upper, hsv_image, mask);
+
+    cv::Mat reference_hsv;
+    cv::Mat reference;
+    cv::cvtColor(image, reference_hsv, cv::COLOR_BGR2HSV);
+    cv::inRange(reference_hsv, lower, upper, reference);
+    corridor.ClearOutside(reference, rect);
+
+    EXPECT_EQ(cv::countNonZero(mask != reference), 0);
+    EXPECT_GT(cv::countNonZero(mask), 250);
+    EXPECT_EQ(mask.at<uchar>(20, 150), 0);
+    EXPECT_EQ(reference_hsv.at<cv::Vec3b>(60, 60), hsv_image.at<cv::Vec3b>(60, 60));
+    EXPECT_EQ(hsv_image.at<cv::Vec3b>(20, 150), cv::Vec3b(0, 0, 0));
+    EXPECT_EQ(hsv_image.at<cv::Vec3b>(0, 0), cv::Vec3b(0, 0, 0));
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
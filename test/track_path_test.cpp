@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "track_path.h"
+
+// Arc length lookups, projection and bounds on an L-shaped track
+TEST(TrackPathTest, TestArcLength) {
+    TrackPath path;
+    path.Build({cv::Point_<float>(0.0f, 0.0f), cv::Point_<float>(100.0f, 0.0f), cv::Point_<float>(100.0f, 0.0f),
+                cv::Point_<float>(100.0f, 50.0f)});
+    ASSERT_FALSE(path.Empty());
+    EXPECT_FLOAT_EQ(path.Length(), 150.0f);
+
+    cv::Point_<float> point = path.PointAt(120.0f);
+    EXPECT_FLOAT_EQ(point.x, 100.0f);
+    EXPECT_FLOAT_EQ(point.y, 20.0f);
+    EXPECT_FLOAT_EQ(path.PointAt(-10.0f).x, 0.0f);
+    EXPECT_FLOAT_EQ(path.PointAt(500.0f).y, 50.0f);
+    cv::Point_<float> tangent = path.TangentAt(120.0f);
+    EXPECT_FLOAT_EQ(tangent.x, 0.0f);
+    EXPECT_FLOAT_EQ(tangent.y, 1.0f);
+
+    float distance;
+    EXPECT_FLOAT_EQ(path.Project(cv::Point_<float>(50.0f, 5.0f), 0.0f, path.Length(), distance), 50.0f);
+    EXPECT_FLOAT_EQ(distance, 5.0f);
+    EXPECT_FLOAT_EQ(path.Project(cv::Point_<float>(95.0f, 30.0f), 0.0f, path.Length(), distance), 130.0f);
+    // 限定区间后只能投影到区间内
+    EXPECT_FLOAT_EQ(path.Project(cv::Point_<float>(50.0f, 0.0f), 110.0f, 150.0f, distance), 110.0f);
+
+    cv::Rect_<int> bounds = path.Bounds(90.0f, 120.0f, 2.0f);
+    EXPECT_EQ(bounds.x, 88);
+    EXPECT_EQ(bounds.y, -2);
+    EXPECT_EQ(bounds.x + bounds.width - 1, 102);
+    EXPECT_EQ(bounds.y + bounds.height - 1, 22);
+}
+
+// The arc filter follows a ball rolling at constant speed and its uncertainty shrinks
+TEST(TrackPathTest, TestArcKalman) {
+    ArcKalman arc;
+    arc.Reset(10.0f, 0.0f, 1.0f, 25.0f);
+    for (int frame = 1; frame <= 40; ++frame) {
+        arc.Predict(0.05f);
+        arc.Correct(10.0f + 3.0f * frame + ((frame % 2) ? 0.5f : -0.5f), 1.0f);
+    }
+    EXPECT_NEAR(arc.S(), 130.0f, 1.0f);
+    EXPECT_NEAR(arc.V(), 3.0f, 0.2f);
+    EXPECT_LT(arc.VarianceS(), 1.0f);
+    EXPECT_GT(arc.PredictedVarianceS(0.05f), arc.VarianceS());
+}
+
+// A ball that speeds up uniformly along a straight track yields its speed and acceleration per segment
+TEST(TrackPathTest, TestSpeedProfile) {
+    TrackPath path;
+    path.Build({cv::Point_<float>(0.0f, 100.0f), cv::Point_<float>(1000.0f, 100.0f)});
+
+    // 两次记录：初速 2 像素/帧，加速度 0.02 像素/帧^2，第二次有轻微的垂直抖动
+    const float v0 = 2.0f;
+    const float a = 0.02f;
+    std::vector<std::vector<cv::Point_<float>>> points(2);
+    std::vector<std::vector<int>> frames(2);
+    for (int run = 0; run < 2; ++run) {
+        for (int f = 0; ; ++f) {
+            float s = v0 * f + 0.5f * a * f * f;
+            if (s > 1000.0f) {
+                break;
+            }
+            points[run].emplace_back(s, 100.0f + (run == 1 ? 0.5f * ((f % 2) ? 1.0f : -1.0f) : 0.0f));
+            frames[run].push_back(f);
+        }
+    }
+    std::vector<SpeedRun> runs = {{&points[0], &frames[0]}, {&points[1], &frames[1]}};
+
+    SpeedProfile profile;
+    ASSERT_TRUE(profile.Build(path, runs, 50.0f));
+    EXPECT_EQ(profile.Segments(), 20);
+    for (float s = 100.0f; s <= 900.0f; s += 200.0f) {
+        EXPECT_NEAR(profile.Speed(s), std::sqrt(v0 * v0 + 2.0f * a * s), 0.1f);
+        EXPECT_NEAR(profile.Acceleration(s), a, 0.005f);
+    }
+
+    // 预测加入期望加速度后，不带测量的外推仍贴近真实运动
+    ArcKalman arc;
+    arc.Reset(0.0f, v0, 1.0f, 1.0f);
+    for (int f = 1; f <= 100; ++f) {
+        arc.Predict(0.0f, profile.Acceleration(arc.S()));
+    }
+    EXPECT_NEAR(arc.S(), v0 * 100 + 0.5f * a * 100 * 100, 10.0f);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
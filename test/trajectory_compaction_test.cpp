@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "trajectory_compaction.h"
+
+// A straight line simplifies to its end points; resampling spaces points evenly along it
+TEST(TrajectoryCompactionTest, TestSimplifyAndResample) {
+    std::vector<cv::Point_<float>> line;
+    for (int i = 0; i <= 100; ++i) {
+        line.emplace_back(static_cast<float>(i), 0.5f * i);
+    }
+    std::vector<cv::Point_<float>> simplified = SimplifyTrajectory(line, 0.1f);
+    ASSERT_EQ(simplified.size(), 2u);
+    EXPECT_FLOAT_EQ(simplified.back().x, 100.0f);
+
+    std::vector<cv::Point_<float>> resampled = ResampleTrajectory(simplified, 10.0f);
+    ASSERT_GE(resampled.size(), 3u);
+    for (size_t i = 1; i + 1 < resampled.size(); ++i) {
+        EXPECT_NEAR(cv::norm(resampled[i] - resampled[i - 1]), 10.0, 1e-3);
+    }
+    EXPECT_FLOAT_EQ(resampled.back().x, 100.0f);
+    EXPECT_FLOAT_EQ(resampled.back().y, 50.0f);
+}
+
+// A jittery arc compacts to far fewer points that stay close to the true arc
+TEST(TrajectoryCompactionTest, TestCompactNoisyArc) {
+    const float radius = 200.0f;
+    std::vector<cv::Point_<float>> raw;
+    for (int i = 0; i < 1000; ++i) {
+        float angle = i * 0.003f;
+        // 确定性的检测抖动，幅度约半个像素
+        float jitter = 0.5f * std::sin(i * 2.3f);
+        raw.emplace_back((radius + jitter) * std::cos(angle) + 300.0f, (radius - jitter) * std::sin(angle) + 300.0f);
+    }
+
+    TrajectoryCompactionConfig config;
+    float max_error = 0.0f;
+    std::vector<cv::Point_<float>> compact = CompactTrajectory(raw, config, max_error);
+    EXPECT_LE(compact.size() * 10, raw.size());
+    EXPECT_LT(max_error, config.tolerance + 0.5f);
+
+    // 平滑后的压缩轨迹贴近真实圆弧，起点与终点保留
+    for (const auto& point : compact) {
+        float distance = std::hypot(point.x - 300.0f, point.y - 300.0f);
+        EXPECT_NEAR(distance, radius, 1.0f);
+    }
+    EXPECT_NEAR(compact.front().x, raw.front().x, 1.0f);
+    EXPECT_NEAR(compact.back().y, raw.back().y, 1.0f);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
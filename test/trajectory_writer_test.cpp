@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <fstream>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "trajectory_writer.h"
+
+namespace {
+
+nlohmann::json ReadJson(const std::string& path) {
+    std::ifstream file(path);
+    return nlohmann::json::parse(file);
+}
+
+}  // namespace
+
+// The file is a complete trajectory after every chunk, before the writer is closed
+TEST(TrajectoryWriterTest, TestChunkedFile) {
+    const std::string path = "trajectory_writer_test.json";
+    TrajectoryWriter writer(16, 64);
+    ASSERT_TRUE(writer.Open(path, "2024-01-01 00:00:00"));
+    EXPECT_EQ(ReadJson(path)["track_trajectory"]["points"].size(), 0u);
+
+    // 沿半径 100 的圆弧记录 40 个点，前 32 个点已分两块写入文件
+    for (int i = 0; i < 40; ++i) {
+        double angle = i * 0.05;
+        ASSERT_TRUE(writer.Add(200.0 + 100.0 * std::cos(angle), 200.0 + 100.0 * std::sin(angle)));
+    }
+    nlohmann::json partial = ReadJson(path)["track_trajectory"];
+    EXPECT_EQ(partial["points"].size(), 32u);
+    EXPECT_NEAR(partial["start_point"]["x"].get<double>(), 300.0, 1e-3);
+    EXPECT_NEAR(partial["end_point"]["x"].get<double>(), partial["points"][31]["x"].get<double>(), 1e-9);
+    EXPECT_EQ(partial["timestamp"].get<std::string>(), "2024-01-01 00:00:00");
+
+    // 压缩后的轨迹随结尾部分一起写入
+    writer.SetCompact({writer.Points().front(), writer.Points().back()}, 16.0f, 0.5f);
+    ASSERT_TRUE(writer.Close());
+    nlohmann::json full = ReadJson(path)["track_trajectory"];
+    ASSERT_EQ(full["points"].size(), 40u);
+    EXPECT_EQ(writer.Points().size(), 40u);
+    ASSERT_EQ(full["compact"]["points"].size(), 2u);
+    EXPECT_NEAR(full["compact"]["spacing"].get<double>(), 16.0, 1e-9);
+    EXPECT_NEAR(full["compact"]["points"][1]["y"].get<double>(), full["end_point"]["y"].get<double>(), 1e-9);
+
+    // 增量累计的长度与逐点重新计算一致
+    double length = 0.0;
+    for (size_t i = 1; i < full["points"].size(); ++i) {
+        double dx = full["points"][i]["x"].get<double>() - full["points"][i - 1]["x"].get<double>();
+        double dy = full["points"][i]["y"].get<double>() - full["points"][i - 1]["y"].get<double>();
+        length += std::sqrt(dx * dx + dy * dy);
+    }
+    EXPECT_NEAR(full["length"].get<double>(), length, 1e-2);
+    EXPECT_NEAR(writer.Length(), 100.0 * 39 * 0.05, 0.1);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "udp_status_publisher.h"
+
+namespace {
+
+std::vector<BallStatus> TestStatuses(int num_balls, uint64_t frame_index) {
+    std::vector<BallStatus> statuses(num_balls);
+    for (int i = 0; i < num_balls; ++i) {
+        BallStatus& status = statuses[i];
+        status.id = i + 1;
+        status.x = static_cast<double>(frame_index) + i;
+        status.y = 100.0 - i;
+        status.vx = 2.0;
+        status.vy = -0.5;
+        status.progress = 0.1 * i;
+        status.detected = i != 1;
+        status.deferred = i == 2;
+    }
+    return statuses;
+}
+
+int64_t SteadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+// Frames batched over several datagrams arrive complete over loopback; one-way latency is measured
+TEST(UdpStatusPublisherTest, TestLoopbackLatency) {
+    UdpStatusReceiver receiver;
+    ASSERT_TRUE(receiver.Open(0));
+    ASSERT_NE(receiver.GetPort(), 0);
+
+    StatusStreamConfig config;
+    config.address = "127.0.0.1";
+    config.port = receiver.GetPort();
+    config.max_balls_per_datagram = 2;
+    UdpStatusPublisher publisher;
+    ASSERT_TRUE(publisher.Open(config));
+
+    const int num_frames = 200;
+    const int num_balls = 5;
+    std::vector<int64_t> latencies;
+    StatusDatagram datagram;
+    for (int f = 0; f < num_frames; ++f) {
+        publisher.Publish(f, SteadyNowNs(), TestStatuses(num_balls, f));
+
+        // 5 个球按每包 2 个拆成 3 个报文，逐帧收齐后再发下一帧
+        for (int part = 0; part < 3; ++part) {
+            ASSERT_TRUE(receiver.Receive(datagram, 1000));
+            const StatusDatagramHeader& header = datagram.header;
+            EXPECT_EQ(header.frame_index, static_cast<uint64_t>(f));
+            EXPECT_EQ(header.part, part);
+            EXPECT_EQ(header.part_count, 3);
+            EXPECT_EQ(header.ball_count, part < 2 ? 2 : 1);
+            EXPECT_LE(header.capture_ns, header.publish_ns);
+            EXPECT_LE(header.publish_ns, datagram.receive_ns);
+            for (int i = 0; i < header.ball_count; ++i) {
+                const StatusDatagramBall& ball = datagram.balls[i];
+                int index = part * 2 + i;
+                EXPECT_EQ(ball.id, index + 1);
+                EXPECT_FLOAT_EQ(ball.x, static_cast<float>(f + index));
+                EXPECT_EQ((ball.flags & STATUS_BALL_DETECTED) != 0, index != 1);
+                EXPECT_EQ((ball.flags & STATUS_BALL_DEFERRED) != 0, index == 2);
+            }
+            latencies.push_back(datagram.receive_ns - header.publish_ns);
+        }
+    }
+    EXPECT_EQ(receiver.Received(), static_cast<uint64_t>(num_frames * 3));
+    EXPECT_EQ(receiver.Lost(), 0u);
+    EXPECT_EQ(publisher.GetSentDatagrams(), static_cast<uint64_t>(num_frames * 3));
+    EXPECT_EQ(publisher.GetSendErrors(), 0u);
+
+    std::sort(latencies.begin(), latencies.end());
+    int64_t median = latencies[latencies.size() / 2];
+    int64_t p99 = latencies[latencies.size() * 99 / 100];
+    std::printf("Loopback one-way latency: median %.1f us, p99 %.1f us\n", median / 1000.0, p99 / 1000.0);
+    EXPECT_LT(median, 50 * 1000000LL);
+}
+
+// A gap in the datagram sequence is counted as loss
+TEST(UdpStatusPublisherTest, TestLossDetection) {
+    UdpStatusReceiver receiver;
+    ASSERT_TRUE(receiver.Open(0));
+    StatusSocket sender = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ASSERT_NE(sender, kInvalidStatusSocket);
+    sockaddr_in destination{};
+    destination.sin_family = AF_INET;
+    destination.sin_port = htons(receiver.GetPort());
+    inet_pton(AF_INET, "127.0.0.1", &destination.sin_addr);
+
+    // 手工构造序号 1、2、5 的报文，以及一个无效报文
+    for (uint64_t sequence : {1, 2, 5}) {
+        StatusDatagramHeader header{};
+        header.magic = kStatusDatagramMagic;
+        header.version = kStatusDatagramVersion;
+        header.sequence = sequence;
+        header.part_count = 1;
+        sendto(sender, reinterpret_cast<const char*>(&header), sizeof(header), 0,
+               reinterpret_cast<const sockaddr*>(&destination), sizeof(destination));
+        if (sequence == 2) {
+            const char garbage[] = "not a status datagram";
+            sendto(sender, garbage, sizeof(garbage), 0, reinterpret_cast<const sockaddr*>(&destination),
+                   sizeof(destination));
+        }
+    }
+    CloseStatusSocket(sender);
+
+    StatusDatagram datagram;
+    for (uint64_t sequence : {1, 2, 5}) {
+        ASSERT_TRUE(receiver.Receive(datagram, 1000));
+        EXPECT_EQ(datagram.header.sequence, sequence);
+    }
+    EXPECT_FALSE(receiver.Receive(datagram, 10));
+    EXPECT_EQ(receiver.Received(), 3u);
+    EXPECT_EQ(receiver.Lost(), 2u);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}